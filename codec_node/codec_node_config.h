@@ -42,4 +42,18 @@ typedef struct codec_ichn_attr_s {
 	uint32_t  height;
 } codec_ichn_attr_t;
 
+/* buffer of codec src exported as dma-buf fds, for CODEC_CMD_EXPORT_BUF */
+typedef struct codec_export_buf_s {
+	int32_t  bufferindex;	/* in */
+	uint32_t num_planes;	/* out, 1 for contiguous buffer */
+	int32_t  dmabuf_fd[VIO_BUFFER_MAX_PLANES];	/* out, -1 for unused plane */
+} codec_export_buf_t;
+
+/* sync_file fence for CODEC_CMD_DQBUF_FENCE, signalled when a frame of
+ * codec src can be dequeued without waiting, error -ECANCELED on stop */
+typedef struct codec_dqbuf_fence_s {
+	int32_t  fence_fd;	/* out */
+	uint32_t seqno;		/* out */
+} codec_dqbuf_fence_t;
+
 #endif /*CODEC_NODE_CONFIGs_H*/
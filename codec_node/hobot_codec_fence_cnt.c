@@ -0,0 +1,78 @@
+/**
+ * @file: hobot_codec_fence_cnt.c
+ * @brief       codec src dqbuf fence accounting
+ * @details     one fence is signalled per frame queued, a frame already
+ *              promised to a signalled fence is not promised again
+ * @copyright   Copyright (C) 2023 Horizon Robotics Inc.
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ */
+
+#include "hobot_codec_fence_cnt.h"
+
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Account a new dqbuf fence, it is signalled at once only when no
+ * older fence waits and a queued frame is not promised to a signalled fence yet
+ * @retval 1: signal the fence now
+ * @retval 0: the fence is pending
+ * @param[in] *cnt: fence counters
+ * @param[in] queued: frames in the REQUEST queue of the src channel
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+uint32_t codec_fence_cnt_request(struct codec_fence_cnt *cnt, uint32_t queued)
+{
+	if ((cnt->pending == 0u) && (queued > cnt->outstanding)) {
+		cnt->outstanding++;
+		return 1u;
+	}
+	cnt->pending++;
+
+	return 0u;
+}
+
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Account a frame queued to the src channel
+ * @retval 1: signal the oldest pending fence
+ * @retval 0: no fence waits
+ * @param[in] *cnt: fence counters
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+uint32_t codec_fence_cnt_frame(struct codec_fence_cnt *cnt)
+{
+	if (cnt->pending == 0u)
+		return 0u;
+	cnt->pending--;
+	cnt->outstanding++;
+
+	return 1u;
+}
+
+/* a src frame is dequeued, it settles the oldest signalled fence if any */
+void codec_fence_cnt_dqbuf(struct codec_fence_cnt *cnt)
+{
+	if (cnt->outstanding > 0u)
+		cnt->outstanding--;
+}
+
+/* the channel stops: pending fences are cancelled, no frame is left to dequeue */
+void codec_fence_cnt_cancel(struct codec_fence_cnt *cnt)
+{
+	cnt->pending = 0u;
+	cnt->outstanding = 0u;
+}
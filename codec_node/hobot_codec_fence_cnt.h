@@ -0,0 +1,36 @@
+/***************************************************************************
+ *                      COPYRIGHT NOTICE
+ *             Copyright 2019 Horizon Robotics, Inc.
+ *                     All rights reserved.
+ ***************************************************************************/
+
+#ifndef HOBOT_CODEC_FENCE_CNT_H
+#define HOBOT_CODEC_FENCE_CNT_H
+
+/*
+ * dqbuf fence accounting of a codec src channel: which fence is signalled
+ * for which frame, pure integer without kernel dependency, so the same
+ * source may be built and checked on host. The caller holds the fence lock.
+ */
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdint.h>
+#endif
+
+/**
+ * @struct codec_fence_cnt
+ * @brief dqbuf fence counters of one codec src channel.
+ * @NO{S10E01C01}
+ */
+struct codec_fence_cnt {
+	uint32_t pending;	/* fences waiting for a frame, oldest signalled first */
+	uint32_t outstanding;	/* fences signalled whose frame is not dequeued yet */
+};
+
+uint32_t codec_fence_cnt_request(struct codec_fence_cnt *cnt, uint32_t queued);
+uint32_t codec_fence_cnt_frame(struct codec_fence_cnt *cnt);
+void codec_fence_cnt_dqbuf(struct codec_fence_cnt *cnt);
+void codec_fence_cnt_cancel(struct codec_fence_cnt *cnt);
+
+#endif
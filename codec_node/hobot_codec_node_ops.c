@@ -4,6 +4,9 @@
  *                     All rights reserved.
  ***************************************************************************/
 
+#include <linux/file.h>
+#include <linux/dma-buf.h>
+#include <linux/sync_file.h>
 #include "hobot_codec_common.h"
 #include "codec_node_config.h"
 #include "hobot_codec_node_ops.h"
@@ -262,9 +265,134 @@ s32 codec_node_start(struct vio_video_ctx *vctx)
 s32 codec_node_stop(struct vio_video_ctx *vctx)
 {
 	s32 ret = 0;
+	u32 encoding;
+	u64 flags = 0;
+	struct vio_subdev *vdev;
+	struct vio_framemgr *framemgr;
+	struct j6_codec_node_dev *codec_node_dev = (struct j6_codec_node_dev *)vctx->device;
+
+	if (vctx->dev->vid != VNODE_ID_SRC)
+		return ret;
+
+	/* no frame will come, release the encoder waiting on dqbuf fences */
+	vdev = codec_node_dev->vnode[vctx->ctx_id].ich_subdev[0];
+	codec_node_fence_cancel(vdev, -ECANCELED);
+
+	/* src frames the encoder never queued back must not stay busy */
+	framemgr = vdev->cur_fmgr;
+	if (framemgr == NULL)
+		return ret;
+	vio_e_barrier_irqs(framemgr, flags);
+	encoding = framemgr->queued_count[FS_PROCESS];
+	vio_x_barrier_irqr(framemgr, flags);
+	while (encoding-- > 0u)
+		vio_hw_util_event(vdev->vnode->id, vdev->vnode->hw_id, VIO_UTIL_SRC_GTASK, 0u);
+
 	return ret;
 }
 
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Count one qbuf/dqbuf of a channel and send its vtrace event
+ * @retval None
+ * @param[in] *vdev: vio_subdev of the channel
+ * @param[in] type: QBUF_EVENT or DQBUF_EVENT
+ * @param[in] *frameinfo: buffer queued or dequeued, NULL on failure
+ * @param[in] depth: frames left in the queue
+ * @param[in] wait_us: dqbuf blocked time, 0 for qbuf
+ * @param[in] ret: result of the qbuf/dqbuf
+ * @param[out] None
+ * @data_read None
+ * @data_updated codec_node_subdev::stats
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static void codec_node_buf_trace(struct vio_subdev *vdev, u32 type,
+		const struct frame_info *frameinfo, u32 depth, u32 wait_us, s32 ret)
+{
+	u64 flags = 0;
+	u32 param[3];
+	struct vio_node *vnode;
+	struct codec_node_stats *stats;
+
+	vnode = vdev->vnode;
+	stats = &container_of(vdev, struct codec_node_subdev, vdev)->stats;
+
+	vio_e_barrier_irqs(stats, flags);
+	if (ret != 0) {
+		if (ret == -ETIMEDOUT)
+			stats->timeout++;
+		else
+			stats->fail++;
+	} else if (type == QBUF_EVENT) {
+		stats->qbuf++;
+	} else {
+		stats->dqbuf++;
+	}
+	if (type == DQBUF_EVENT) {
+		stats->wait_cnt++;
+		stats->wait_sum_us += wait_us;
+		stats->wait_last_us = wait_us;
+		if (wait_us > stats->wait_max_us)
+			stats->wait_max_us = wait_us;
+	}
+	vio_x_barrier_irqr(stats, flags);
+
+	if ((ret != 0) || (frameinfo == NULL))
+		return;
+
+	/* index, depth, wait_us as PUBLIC_BUF_PARAM_NAME of vtrace */
+	param[0] = (u32)frameinfo->bufferindex;
+	param[1] = depth;
+	param[2] = wait_us;
+	vio_vtrace_send(vnode->id, type, param, vnode->flow_id,
+			frameinfo->frameid.frame_id, vnode->ctx_id, vdev->id);
+}
+
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Wait for a frame of a channel within timeout
+ * @retval 0: frame ready
+ * @retval <0: fail
+ * @param[in] *vdev: vio_subdev of the channel
+ * @param[in] timeout: ms
+ * @param[out] *wait_us: blocked time
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static s32 codec_dqbuf_wait(struct vio_subdev *vdev, int32_t timeout, u32 *wait_us)
+{
+	s32 ret = 0;
+	u64 start;
+	struct vio_framemgr *framemgr;
+
+	framemgr = vdev->cur_fmgr;
+	*wait_us = 0;
+	if (framemgr->queued_count[FS_REQUEST] != 0)
+		return 0;
+
+	start = osal_time_get_ns();
+	ret = wait_event_interruptible_timeout(vdev->vctx[0]->done_wq,
+			framemgr->queued_count[FS_REQUEST] > 0, msecs_to_jiffies(timeout));
+	*wait_us = (u32)((osal_time_get_ns() - start) / 1000u);
+	if (ret == 0) {
+		return -ETIMEDOUT;
+	} else if (ret < 0) {
+		vio_err("%s:%d, wq failed %d\n", __func__, __LINE__, ret);
+		return ret;
+	}
+
+	return 0;
+}
+
 /**
  * @NO{S10E01C01}
  * @ASIL{B}
@@ -284,6 +412,7 @@ static s32 codec_src_dqbuf(
 	struct vio_video_ctx *vctx, struct frame_info *frameinfo, int32_t timeout)
 {
 	s32 ret = 0;
+	u32 depth = 0, wait_us = 0;
 	u64 flags = 0;
 	struct vio_framemgr *framemgr;
 	struct vio_frame *frame;
@@ -295,31 +424,31 @@ static s32 codec_src_dqbuf(
 	framemgr = vdev->cur_fmgr;
 	vnode = vdev->vnode;
 
-	if (framemgr->queued_count[FS_REQUEST] == 0) {
-		ret = wait_event_interruptible_timeout(vdev->vctx[0]->done_wq,
-				framemgr->queued_count[FS_REQUEST] > 0, msecs_to_jiffies(timeout));
-		if (ret == 0) {
-			return -ETIMEDOUT;
-		} else if (ret < 0) {
-			vio_err("%s:%d, wq failed %d\n", __func__, __LINE__, ret);
-			return ret;
-		}
+	ret = codec_dqbuf_wait(vdev, timeout, &wait_us);
+	if (ret < 0) {
+		codec_node_buf_trace(vdev, DQBUF_EVENT, NULL, 0, wait_us, ret);
+		return ret;
 	}
 
 	vio_e_barrier_irqs(framemgr, flags);
 	frame = peek_frame(framemgr, FS_REQUEST);
 	if (frame != NULL) {
 		trans_frame(framemgr, frame, FS_PROCESS);
+		depth = framemgr->queued_count[FS_REQUEST];
 		memcpy(&vdev->curinfo, &frame->frameinfo, sizeof(struct frame_info));
 		vio_x_barrier_irqr(framemgr, flags);
 		memcpy(frameinfo, &frame->frameinfo, sizeof(struct frame_info));
+		codec_node_fence_dqbuf(vdev);
+		/* the encoder is busy from taking a src frame until it queues it back */
+		vio_hw_util_event(vnode->id, vnode->hw_id, VIO_UTIL_SRC_GTASK, 1u);
 	} else {
 		ret = -EINVAL;
 		framemgr_print_queues(framemgr);
 		vio_x_barrier_irqr(framemgr, flags);
 	}
 
-	vio_info("[S%d][%s][V%d] %s index %d internal_buf %d\n", vnode->flow_id, vnode->name, vdev->id,
+	codec_node_buf_trace(vdev, DQBUF_EVENT, frameinfo, depth, wait_us, ret);
+	vio_dbg("[S%d][%s][V%d] %s index %d internal_buf %d\n", vnode->flow_id, vnode->name, vdev->id,
 			__func__, frameinfo->bufferindex, frameinfo->internal_buf);
 
 	return ret;
@@ -328,6 +457,7 @@ static s32 codec_src_dqbuf(
 static s32 codec_cap_dqbuf(struct vio_video_ctx *vctx, struct frame_info *frameinfo, int32_t timeout)
 {
 	s32 ret = 0;
+	u32 depth = 0, wait_us = 0;
 	u64 flags = 0;
 	struct vio_framemgr *framemgr;
 	struct vio_frame *frame;
@@ -339,21 +469,17 @@ static s32 codec_cap_dqbuf(struct vio_video_ctx *vctx, struct frame_info *framei
 	framemgr = vdev->cur_fmgr;
 	vnode = vdev->vnode;
 
-	if (framemgr->queued_count[FS_REQUEST] == 0) {
-		ret = wait_event_interruptible_timeout(vdev->vctx[0]->done_wq,
-				framemgr->queued_count[FS_REQUEST] > 0, msecs_to_jiffies(timeout));
-		if (ret == 0) {
-			return -ETIMEDOUT;
-		} else if (ret < 0) {
-			vio_err("%s:%d, wq failed %d\n", __func__, __LINE__, ret);
-			return ret;
-		}
+	ret = codec_dqbuf_wait(vdev, timeout, &wait_us);
+	if (ret < 0) {
+		codec_node_buf_trace(vdev, DQBUF_EVENT, NULL, 0, wait_us, ret);
+		return ret;
 	}
 
 	vio_e_barrier_irqs(framemgr, flags);
 	frame = peek_frame(framemgr, FS_REQUEST);
 	if (frame != NULL) {
 		trans_frame(framemgr, frame, FS_FREE);
+		depth = framemgr->queued_count[FS_REQUEST];
 		memcpy(&vdev->curinfo, &frame->frameinfo, sizeof(struct frame_info));
 		vio_x_barrier_irqr(framemgr, flags);
 
@@ -364,7 +490,8 @@ static s32 codec_cap_dqbuf(struct vio_video_ctx *vctx, struct frame_info *framei
 		vio_x_barrier_irqr(framemgr, flags);
 	}
 
-	vio_info("[S%d][%s][V%d] %s index %d internal_buf %d\n",
+	codec_node_buf_trace(vdev, DQBUF_EVENT, frameinfo, depth, wait_us, ret);
+	vio_dbg("[S%d][%s][V%d] %s index %d internal_buf %d\n",
 		vnode->flow_id, vnode->name, vdev->id, __func__, frameinfo->bufferindex, frameinfo->internal_buf);
 
 	return ret;
@@ -393,7 +520,7 @@ s32 codec_node_dqbuf(struct vio_video_ctx *vctx, unsigned long arg)
 		return -EFAULT;
 	}
 
-	vio_info("[S%d][%s][V%d] %s done\n", vctx->flow_id, vctx->name, vctx->id, __func__);
+	vio_dbg("[S%d][%s][V%d] %s done\n", vctx->flow_id, vctx->name, vctx->id, __func__);
 
 	return ret;
 }
@@ -416,7 +543,8 @@ s32 codec_node_dqbuf(struct vio_video_ctx *vctx, unsigned long arg)
 s32 codec_src_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 {
 	s32 ret = 0;
-	u32 index;
+	u32 index, depth;
+	u32 encoded = 0;
 	u64 flags = 0;
 	struct vio_framemgr *framemgr;
 	struct vio_frame *frame;
@@ -429,6 +557,7 @@ s32 codec_src_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 	if (index >= framemgr->num_frames) {
 		vio_err("[S%d][%s][V%d]%s: wrong frame index(%d)\n",
 				vnode->flow_id, vnode->name, vdev->id, __func__, index);
+		codec_node_buf_trace(vdev, QBUF_EVENT, NULL, 0, 0, -EINVAL);
 		return -EINVAL;
 	}
 
@@ -438,19 +567,27 @@ s32 codec_src_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 		frame->internal_buf = frameinfo->internal_buf;
 
 		vio_e_barrier_irqs(framemgr, flags);
+		encoded = (frame->state == FS_PROCESS) ? 1u : 0u;
 		trans_frame(framemgr, frame, FS_COMPLETE);
+		depth = framemgr->queued_count[FS_COMPLETE];
 		vio_x_barrier_irqr(framemgr, flags);
 	} else {
 		vio_err("[S%d][%s][V%d] %s:F%d is invalid state(%d)\n",
 			vnode->flow_id, vnode->name, vdev->id, __func__, index, frame->state);
 		framemgr_print_queues(framemgr);
+		codec_node_buf_trace(vdev, QBUF_EVENT, NULL, 0, 0, -EINVAL);
 		return -EINVAL;
 	}
 
+	/* only a frame taken by codec_src_dqbuf opened a busy period */
+	if (encoded != 0u)
+		vio_hw_util_event(vnode->id, vnode->hw_id, VIO_UTIL_SRC_GTASK, 0u);
+
 	if (vdev->prev != NULL)
 		vio_return_buf_to_prev(vdev);
 
-	vio_info("[S%d][%s][V%d] %s index %d internal_buf %d\n", vnode->flow_id, vnode->name,
+	codec_node_buf_trace(vdev, QBUF_EVENT, frameinfo, depth, 0, ret);
+	vio_dbg("[S%d][%s][V%d] %s index %d internal_buf %d\n", vnode->flow_id, vnode->name,
 			vdev->id, __func__, frameinfo->bufferindex, frameinfo->internal_buf);
 
 	return ret;
@@ -474,7 +611,7 @@ s32 codec_src_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 s32 codec_cap_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 {
 	s32 ret = 0;
-	u32 index;
+	u32 index, depth;
 	u64 flags = 0;
 	struct vio_framemgr *framemgr;
 	struct vio_frame *frame;
@@ -487,6 +624,7 @@ s32 codec_cap_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 	if (index >= framemgr->num_frames) {
 		vio_err("[S%d][%s][V%d]%s: wrong frame index(%d)\n",
 			vnode->flow_id, vnode->name, vdev->id, __func__, index);
+		codec_node_buf_trace(vdev, QBUF_EVENT, NULL, 0, 0, -EINVAL);
 		return -EINVAL;
 	}
 
@@ -495,17 +633,20 @@ s32 codec_cap_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 		memcpy(&frame->frameinfo, frameinfo, sizeof(struct frame_info));
 		vio_e_barrier_irqs(framemgr, flags);
 		trans_frame(framemgr, frame, FS_COMPLETE);
+		depth = framemgr->queued_count[FS_COMPLETE];
 		vio_x_barrier_irqr(framemgr, flags);
 	} else {
 		vio_err("[S%d][%s][V%d] %s:F%d is invalid state(%d)\n",
 			vnode->flow_id, vnode->name, vdev->id, __func__, index, frame->state);
 		framemgr_print_queues(framemgr);
+		codec_node_buf_trace(vdev, QBUF_EVENT, NULL, 0, 0, -EINVAL);
 		return -EINVAL;
 	}
 	if (vdev->next != NULL)
 		vio_push_buf_to_next(vdev);
 
-	vio_info("[S%d][%s][V%d] %s index %d internal_buf %d\n", vnode->flow_id, vnode->name,
+	codec_node_buf_trace(vdev, QBUF_EVENT, frameinfo, depth, 0, ret);
+	vio_dbg("[S%d][%s][V%d] %s index %d internal_buf %d\n", vnode->flow_id, vnode->name,
 			vdev->id, __func__, frameinfo->bufferindex, frameinfo->internal_buf);
 
 	return ret;
@@ -538,7 +679,7 @@ s32 codec_node_qbuf(struct vio_video_ctx *vctx, unsigned long arg)
 		ret = codec_cap_qbuf(vdev, &frameinfo);
 	}
 
-	vio_info("[S%d][%s][V%d] %s done\n", vctx->flow_id, vctx->name, vctx->id, __func__);
+	vio_dbg("[S%d][%s][V%d] %s done\n", vctx->flow_id, vctx->name, vctx->id, __func__);
 
 	return ret;
 }
@@ -788,6 +929,8 @@ s32 codec_node_close(struct vio_video_ctx *vctx)
 		subdev = &codec_node_dev->subdev[vctx->ctx_id][0];
 	else
 		subdev = &codec_node_dev->subdev[vctx->ctx_id][1];
+	if (vctx->id == VNODE_ID_SRC)
+		codec_node_fence_cancel(&subdev->vdev, -ECANCELED);
 	clear_bit(subdev->codec_attr.channel_idx, codec_node_dev->channel_idx_bitmap);
 	subdev->codec_attr.channel_idx = -1;
 	subdev->user_bind = 0;
@@ -796,4 +939,364 @@ s32 codec_node_close(struct vio_video_ctx *vctx)
 	vio_info("[S%d]%s done\n", vctx->ctx_id, __func__);
 
 	return ret;
-}
\ No newline at end of file
+}
+
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Export the buffer of a codec src frame as dma-buf fds, so that
+ * the encoder imports it once instead of by ion id on every frame
+ * @retval 0: success
+ * @retval <0: fail
+ * @param[in] *vctx: vio_video_ctx
+ * @param[in] arg: user pointer of codec_export_buf_t
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 codec_node_export_buf(struct vio_video_ctx *vctx, unsigned long arg)
+{
+	s32 ret = 0;
+	u32 i, index;
+	u64 copy_ret;
+	struct vio_subdev *vdev;
+	struct vio_framemgr *framemgr;
+	struct vbuf_group_info *group_info;
+	struct dma_buf *dmabuf[VIO_BUFFER_MAX_PLANES];
+	struct codec_export_buf_s export_buf;
+	struct j6_codec_node_dev *codec_node_dev = (struct j6_codec_node_dev *)vctx->device;
+
+	if (vctx->dev->vid != VNODE_ID_SRC) {
+		vio_err("%s: codec node cap donot support\n", __func__);
+		return -EINVAL;
+	}
+
+	copy_ret = osal_copy_from_app((void *)&export_buf, (void __user *)arg, sizeof(export_buf));
+	if (copy_ret != 0u) {
+		vio_err("%s: failed to copy from user, ret = %lld\n", __func__, copy_ret);
+		return -EFAULT;
+	}
+
+	/* src frames are the buffers of the upstream channel when bound */
+	vdev = codec_node_dev->vnode[vctx->ctx_id].ich_subdev[0];
+	if (vdev->prev != NULL)
+		framemgr = vdev->prev->cur_fmgr;
+	else
+		framemgr = vdev->cur_fmgr;
+	if (framemgr == NULL) {
+		vio_err("[S%d]%s: no buffer requested\n", vctx->ctx_id, __func__);
+		return -EINVAL;
+	}
+
+	index = (u32)export_buf.bufferindex;
+	if (index >= framemgr->num_frames) {
+		vio_err("[S%d]%s: wrong frame index(%d)\n", vctx->ctx_id, __func__, export_buf.bufferindex);
+		return -EINVAL;
+	}
+
+	group_info = &framemgr->frames[index].vbuf.group_info;
+	export_buf.num_planes = group_info->info[0].buf_attr.planecount;
+	if (group_info->is_contig == BUF_CONTIG)
+		export_buf.num_planes = 1;
+	if ((export_buf.num_planes == 0u) || (export_buf.num_planes > VIO_BUFFER_MAX_PLANES)) {
+		vio_err("[S%d]%s: wrong planecount %d\n", vctx->ctx_id, __func__, export_buf.num_planes);
+		return -EINVAL;
+	}
+
+	/* fds are installed only after the copy out succeeds */
+	for (i = 0; i < VIO_BUFFER_MAX_PLANES; i++) {
+		dmabuf[i] = NULL;
+		export_buf.dmabuf_fd[i] = -1;
+	}
+	for (i = 0; i < export_buf.num_planes; i++) {
+		dmabuf[i] = vio_ion_export_dmabuf(group_info->dev_num, (s32)group_info->info[0].share_id[i]);
+		if (IS_ERR(dmabuf[i])) {
+			ret = (s32)PTR_ERR(dmabuf[i]);
+			dmabuf[i] = NULL;
+			goto err_put;
+		}
+		export_buf.dmabuf_fd[i] = get_unused_fd_flags(O_CLOEXEC);
+		if (export_buf.dmabuf_fd[i] < 0) {
+			ret = export_buf.dmabuf_fd[i];
+			goto err_put;
+		}
+	}
+
+	copy_ret = osal_copy_to_app((void __user *)arg, (void *)&export_buf, sizeof(export_buf));
+	if (copy_ret != 0u) {
+		vio_err("%s: failed to copy to user, ret = %lld\n", __func__, copy_ret);
+		ret = -EFAULT;
+		goto err_put;
+	}
+
+	for (i = 0; i < export_buf.num_planes; i++)
+		fd_install((u32)export_buf.dmabuf_fd[i], dmabuf[i]->file);
+
+	vio_info("[S%d]%s index %d planes %d\n", vctx->ctx_id, __func__, index, export_buf.num_planes);
+
+	return 0;
+
+err_put:
+	vio_err("[S%d]%s: index %d failed %d\n", vctx->ctx_id, __func__, index, ret);
+	for (i = 0; i < export_buf.num_planes; i++) {
+		if (export_buf.dmabuf_fd[i] >= 0)
+			put_unused_fd((u32)export_buf.dmabuf_fd[i]);
+		if (dmabuf[i] != NULL)
+			dma_buf_put(dmabuf[i]);
+	}
+
+	return ret;
+}
+
+static const char *codec_fence_get_driver_name(struct dma_fence *fence)
+{
+	return "codec_node";
+}
+
+static const char *codec_fence_get_timeline_name(struct dma_fence *fence)
+{
+	return "codec_src";
+}
+
+static const struct dma_fence_ops codec_fence_ops = {
+	.get_driver_name = codec_fence_get_driver_name,
+	.get_timeline_name = codec_fence_get_timeline_name,
+};
+
+/* base first: the default dma_fence release frees the whole entry */
+struct codec_fence_entry {
+	struct dma_fence base;
+	osal_list_head_t list;
+};
+
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Init the dqbuf fence timeline of a codec src channel
+ * @retval None
+ * @param[in] *vdev: vio_subdev of the src channel
+ * @param[out] None
+ * @data_read None
+ * @data_updated codec_node_subdev::fence
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void codec_node_fence_init(struct vio_subdev *vdev)
+{
+	struct codec_node_fence *fence;
+
+	fence = &container_of(vdev, struct codec_node_subdev, vdev)->fence;
+	spin_lock_init(&fence->lock);
+	osal_list_head_init(&fence->list);
+	fence->context = dma_fence_context_alloc(1);
+	fence->seqno = 0;
+	codec_fence_cnt_cancel(&fence->cnt);
+}
+
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Signal the oldest pending dqbuf fence of a codec src channel,
+ * called once for each frame queued to the channel, bound or not
+ * @retval None
+ * @param[in] *vdev: vio_subdev of the src channel
+ * @param[out] None
+ * @data_read None
+ * @data_updated codec_node_subdev::fence
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void codec_node_fence_signal(struct vio_subdev *vdev)
+{
+	unsigned long flags;
+	struct codec_fence_entry *entry, *temp, *oldest = NULL;
+	struct codec_node_fence *fence;
+
+	fence = &container_of(vdev, struct codec_node_subdev, vdev)->fence;
+	spin_lock_irqsave(&fence->lock, flags);
+	if (codec_fence_cnt_frame(&fence->cnt) != 0u) {
+		osal_list_for_each_entry_safe(entry, temp, &fence->list, list) {/*PRQA S 2810,2741,0497*/
+			osal_list_del(&entry->list);
+			oldest = entry;
+			break;
+		}
+	}
+	spin_unlock_irqrestore(&fence->lock, flags);
+
+	if (oldest != NULL) {
+		(void)dma_fence_signal(&oldest->base);
+		dma_fence_put(&oldest->base);
+	}
+}
+
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Signal all pending dqbuf fences of a codec src channel with
+ * an error, called when the channel stops and no frame will come
+ * @retval None
+ * @param[in] *vdev: vio_subdev of the src channel
+ * @param[in] err: fence error
+ * @param[out] None
+ * @data_read None
+ * @data_updated codec_node_subdev::fence
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void codec_node_fence_cancel(struct vio_subdev *vdev, s32 err)
+{
+	unsigned long flags;
+	osal_list_head_t done;
+	struct codec_fence_entry *entry, *temp;
+	struct codec_node_fence *fence;
+
+	fence = &container_of(vdev, struct codec_node_subdev, vdev)->fence;
+	osal_list_head_init(&done);
+	spin_lock_irqsave(&fence->lock, flags);
+	osal_list_for_each_entry_safe(entry, temp, &fence->list, list) {/*PRQA S 2810,2741,0497*/
+		osal_list_del(&entry->list);
+		osal_list_add_tail(&entry->list, &done);
+	}
+	codec_fence_cnt_cancel(&fence->cnt);
+	spin_unlock_irqrestore(&fence->lock, flags);
+
+	osal_list_for_each_entry_safe(entry, temp, &done, list) {/*PRQA S 2810,2741,0497*/
+		osal_list_del(&entry->list);
+		dma_fence_set_error(&entry->base, err);
+		(void)dma_fence_signal(&entry->base);
+		dma_fence_put(&entry->base);
+	}
+}
+
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Settle the oldest signalled dqbuf fence of a codec src channel,
+ * called when a src frame is dequeued
+ * @retval None
+ * @param[in] *vdev: vio_subdev of the src channel
+ * @param[out] None
+ * @data_read None
+ * @data_updated codec_node_subdev::fence
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void codec_node_fence_dqbuf(struct vio_subdev *vdev)
+{
+	unsigned long flags;
+	struct codec_node_fence *fence;
+
+	fence = &container_of(vdev, struct codec_node_subdev, vdev)->fence;
+	spin_lock_irqsave(&fence->lock, flags);
+	codec_fence_cnt_dqbuf(&fence->cnt);
+	spin_unlock_irqrestore(&fence->lock, flags);
+}
+
+/**
+ * @NO{S10E01C01}
+ * @ASIL{B}
+ * @brief: Get a sync_file fence which signals when a frame of codec src
+ * can be dequeued, so that the encoder polls it instead of a blocking dqbuf
+ * @retval 0: success
+ * @retval <0: fail
+ * @param[in] *vctx: vio_video_ctx
+ * @param[in] arg: user pointer of codec_dqbuf_fence_t
+ * @param[out] None
+ * @data_read None
+ * @data_updated codec_node_subdev::fence
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 codec_node_dqbuf_fence(struct vio_video_ctx *vctx, unsigned long arg)
+{
+	s32 fd;
+	u32 ready;
+	u64 copy_ret;
+	unsigned long flags;
+	struct vio_subdev *vdev;
+	struct sync_file *sync_file;
+	struct codec_fence_entry *entry;
+	struct codec_node_fence *fence;
+	struct codec_dqbuf_fence_s dq_fence;
+	struct j6_codec_node_dev *codec_node_dev = (struct j6_codec_node_dev *)vctx->device;
+
+	if ((vctx->state & BIT((s32)VIO_VIDEO_START)) == 0) {
+		vio_err("[%s]invalid dqbuf fence is requested(%llX)", __func__, vctx->state);
+		return -EFAULT;
+	}
+
+	if (vctx->dev->vid != VNODE_ID_SRC) {
+		vio_err("%s: codec node cap donot support\n", __func__);
+		return -EINVAL;
+	}
+
+	vdev = codec_node_dev->vnode[vctx->ctx_id].ich_subdev[0];
+	fence = &container_of(vdev, struct codec_node_subdev, vdev)->fence;
+
+	entry = osal_kzalloc(sizeof(struct codec_fence_entry), GFP_KERNEL);
+	if (entry == NULL)
+		return -ENOMEM;
+	fd = get_unused_fd_flags(O_CLOEXEC);
+	if (fd < 0) {
+		vio_err("[S%d]%s: get fd failed %d\n", vctx->ctx_id, __func__, fd);
+		osal_kfree(entry);
+		return fd;
+	}
+
+	/* the frame count is checked under the fence lock, the worker signals
+	 * under the same lock after the frame is queued, so none is missed.
+	 * The fences wait in order, one is signalled for each frame queued,
+	 * and a queued frame already promised to a signalled fence that has
+	 * not been dequeued yet does not signal another one.
+	 * A pending fence takes one more reference for the list. */
+	spin_lock_irqsave(&fence->lock, flags);
+	fence->seqno++;
+	dma_fence_init(&entry->base, &codec_fence_ops, &fence->lock, fence->context, fence->seqno);
+	ready = codec_fence_cnt_request(&fence->cnt, vdev->cur_fmgr->queued_count[FS_REQUEST]);
+	if (ready == 0u) {
+		(void)dma_fence_get(&entry->base);
+		osal_list_add_tail(&entry->list, &fence->list);
+	}
+	spin_unlock_irqrestore(&fence->lock, flags);
+	if (ready != 0u)
+		(void)dma_fence_signal(&entry->base);
+
+	dq_fence.fence_fd = fd;
+	dq_fence.seqno = (u32)entry->base.seqno;
+	sync_file = sync_file_create(&entry->base);
+	if (sync_file == NULL) {
+		vio_err("[S%d]%s: create sync_file failed\n", vctx->ctx_id, __func__);
+		put_unused_fd((u32)fd);
+		dma_fence_put(&entry->base);
+		return -ENOMEM;
+	}
+
+	copy_ret = osal_copy_to_app((void __user *)arg, (void *)&dq_fence, sizeof(dq_fence));
+	if (copy_ret != 0u) {
+		vio_err("%s: failed to copy to user, ret = %lld\n", __func__, copy_ret);
+		put_unused_fd((u32)fd);
+		fput(sync_file->file);
+		dma_fence_put(&entry->base);
+		return -EFAULT;
+	}
+	fd_install((u32)fd, sync_file->file);
+	dma_fence_put(&entry->base);
+
+	vio_dbg("[S%d]%s seqno %d ready %d\n", vctx->ctx_id, __func__, dq_fence.seqno, ready);
+
+	return 0;
+}
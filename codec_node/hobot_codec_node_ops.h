@@ -23,5 +23,11 @@ s32 codec_node_qbuf(struct vio_video_ctx *vctx, unsigned long arg);
 s32 codec_node_bind_flow_id(struct vio_video_ctx *vctx, unsigned long arg);
 s32 codec_node_get_buf_cfg(struct vio_video_ctx *vctx, unsigned long arg);
 s32 codec_node_querybuf(struct vio_video_ctx *vctx, unsigned long arg);
+s32 codec_node_export_buf(struct vio_video_ctx *vctx, unsigned long arg);
+s32 codec_node_dqbuf_fence(struct vio_video_ctx *vctx, unsigned long arg);
+void codec_node_fence_signal(struct vio_subdev *vdev);
+void codec_node_fence_cancel(struct vio_subdev *vdev, s32 err);
+void codec_node_fence_dqbuf(struct vio_subdev *vdev);
+void codec_node_fence_init(struct vio_subdev *vdev);
 
 #endif /*HOBOT_CODEC_NODE_OPS_API*/
\ No newline at end of file
@@ -23,6 +23,8 @@
 #define CODEC_CMD_QBUF      	2
 #define CODEC_CMD_GET_CFG   	3
 #define CODEC_CMD_QUERYBUF  	4
+#define CODEC_CMD_EXPORT_BUF	5
+#define CODEC_CMD_DQBUF_FENCE	6
 
 static struct vio_version_info g_codec_version = {
 	.major = 1,
@@ -451,11 +453,17 @@ static s32 codec_node_video_s_ctrl(struct vio_video_ctx *vctx, u32 cmd, unsigned
 	case CODEC_CMD_QUERYBUF:
 		ret = codec_node_querybuf(vctx, arg);
 		break;
+	case CODEC_CMD_EXPORT_BUF:
+		ret = codec_node_export_buf(vctx, arg);
+		break;
+	case CODEC_CMD_DQBUF_FENCE:
+		ret = codec_node_dqbuf_fence(vctx, arg);
+		break;
 	default:
 		break;
 	}
 
-	vio_info("[S%d]%s cmd[%d] done\n", vctx->ctx_id, __func__, cmd);
+	vio_dbg("[S%d]%s cmd[%d] done\n", vctx->ctx_id, __func__, cmd);
 
 	return ret;
 }
@@ -549,9 +557,11 @@ void codec_src_worker(struct vio_subdev *vdev, struct vio_frame *frame)
 		if (vdev->prev != NULL) {
 			wake_up(&vdev->vctx[0]->done_wq);
 		}
+		/* every frame queued to src, from upstream or by user qbuf */
+		codec_node_fence_signal(vdev);
 	}
 
-	vio_info("[S%d][N%d][V%d] %s \n", vnode->flow_id, vnode->id, vdev->id, __func__);
+	vio_dbg("[S%d][N%d][V%d] %s \n", vnode->flow_id, vnode->id, vdev->id, __func__);
 
 	return;
 }
@@ -593,6 +603,9 @@ s32 codec_node_device_node_init(struct j6_codec_node_dev *codec_node_dev)
 		vnode[i].ich_subdev[0]->vdev_work = codec_src_worker;
 		codec_node_dev->subdev[i][0].codec_attr.channel_idx = -1;
 		codec_node_dev->subdev[i][1].codec_attr.channel_idx = -1;
+		osal_spin_init(&codec_node_dev->subdev[i][0].stats.slock);/*PRQA S 3334*/
+		osal_spin_init(&codec_node_dev->subdev[i][1].stats.slock);/*PRQA S 3334*/
+		codec_node_fence_init(&codec_node_dev->subdev[i][0].vdev);
 	}
 
 	codec_node_dev->codec_device[0].vps_ops = &codec_node_vops;
@@ -623,6 +636,40 @@ void codec_node_device_node_deinit(struct j6_codec_node_dev *codec_node_dev)
 {
 }
 EXPORT_SYMBOL(codec_node_device_node_deinit);
+static ssize_t codec_node_stats_show(struct device *dev, struct device_attribute *attr, char* buf)
+{
+	u32 i, j, len = 0;
+	u64 flags = 0;
+	struct j6_codec_node_dev *codec_node;
+	struct codec_node_stats *stats;
+	struct codec_node_stats snap;
+	static const char *chn_name[2] = {"src", "cap"};
+
+	codec_node = (struct j6_codec_node_dev *)dev_get_drvdata(dev);
+	len += snprintf(&buf[len], PAGE_SIZE - len,
+			"ctx chn  qbuf dqbuf timeout fail wait_avg_us wait_max_us wait_last_us\n");
+	for (i = 0; i < CODEC_MAX_CHANNEL; i++) {
+		for (j = 0; j < 2u; j++) {
+			stats = &codec_node->subdev[i][j].stats;
+			vio_e_barrier_irqs(stats, flags);
+			memcpy(&snap, stats, sizeof(struct codec_node_stats));
+			vio_x_barrier_irqr(stats, flags);
+			if ((snap.qbuf + snap.wait_cnt + snap.fail) == 0u)
+				continue;
+			len += snprintf(&buf[len], PAGE_SIZE - len,
+					"%3u %s %5llu %5llu %7llu %4llu %11llu %11u %12u\n",
+					i, chn_name[j], snap.qbuf, snap.dqbuf, snap.timeout, snap.fail,
+					(snap.wait_cnt != 0u) ? (snap.wait_sum_us / snap.wait_cnt) : 0u,
+					snap.wait_max_us, snap.wait_last_us);
+			if (len >= PAGE_SIZE)
+				return PAGE_SIZE;
+		}
+	}
+
+	return len;
+}
+static DEVICE_ATTR(stats, 0444, codec_node_stats_show, NULL);/*PRQA S 4501,0636*/
+
 /**
  * @NO{S10E01C01}
  * @ASIL{B}
@@ -667,6 +714,14 @@ static s32 hobot_codec_node_probe(struct platform_device *pdev)
 		(void)test_and_clear_bit(i, codec_node->channel_idx_bitmap);
 	}
 
+	ret = device_create_file(dev, &dev_attr_stats);
+	if (ret < 0) {
+		vio_err("create stats failed (%d)\n", ret);
+		vio_unregister_device_node(&codec_node->codec_device[0]);
+		vio_unregister_device_node(&codec_node->codec_device[1]);
+		return ret;
+	}
+
 	vio_info("[FRT:D] %s(%d)\n", __func__, ret);
 
 	return 0;
@@ -701,6 +756,7 @@ static s32 hobot_codec_node_remove(struct platform_device *pdev)
 	dev = &pdev->dev;
 	codec_node = (struct j6_codec_node_dev *)platform_get_drvdata(pdev);
 
+	device_remove_file(dev, &dev_attr_stats);
 	vio_unregister_device_node(&codec_node->codec_device[0]);
 	vio_unregister_device_node(&codec_node->codec_device[1]);
 
@@ -9,11 +9,43 @@
 
 #include <linux/cdev.h>
 #include <linux/interrupt.h>
+#include <linux/dma-fence.h>
 #include "vio_config.h"
 #include "vio_framemgr.h"
 #include "vio_node_api.h"
 #include "hobot_codec_common.h"
 #include "codec_node_config.h"
+#include "hobot_codec_fence_cnt.h"
+
+/**
+ * @struct codec_node_stats
+ * @brief qbuf/dqbuf counters of one codec_node channel, wait time unit: us.
+ * @NO{S10E01C01}
+ */
+struct codec_node_stats {
+	osal_spinlock_t slock;
+	u64 qbuf;
+	u64 dqbuf;
+	u64 timeout;
+	u64 fail;
+	u64 wait_cnt;
+	u64 wait_sum_us;
+	u32 wait_max_us;
+	u32 wait_last_us;
+};
+
+/**
+ * @struct codec_node_fence
+ * @brief dqbuf fences of one codec_node src channel, one signalled per frame queued to it.
+ * @NO{S10E01C01}
+ */
+struct codec_node_fence {
+	spinlock_t lock;	/* dma_fence lock, protects list, seqno and cnt */
+	u64 context;
+	u32 seqno;
+	osal_list_head_t list;	/* unsignalled fences, oldest first */
+	struct codec_fence_cnt cnt;	/* pending as list, signalled not dequeued */
+};
 
 /**
  * @struct codec_node_subdev
@@ -48,6 +80,20 @@ struct codec_node_subdev {
       * range:N/A; default: N/A
       */
      u32 user_bind;
+
+     /**
+      * @var codec_node_subdev::stats
+      * qbuf/dqbuf counters, read by the stats sysfs.
+      * range:N/A; default: N/A
+      */
+     struct codec_node_stats stats;
+
+     /**
+      * @var codec_node_subdev::fence
+      * dqbuf fences, src channel only.
+      * range:N/A; default: N/A
+      */
+     struct codec_node_fence fence;
 };
 
 /**
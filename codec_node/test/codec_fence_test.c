@@ -0,0 +1,125 @@
+/**
+ * @file: codec_fence_test.c
+ * @brief       host test of the codec dqbuf fence accounting
+ * @details     sequences of fence requests, queued frames, dqbuf and stop
+ *              against a model of the src REQUEST queue: a frame is never
+ *              promised to two signalled fences
+ * @copyright   Copyright (C) 2023 Horizon Robotics Inc.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "hobot_codec_fence_cnt.h"
+
+#define FENCE_TEST_MAX_OPS 32u
+
+/*
+ * ops: 'f' dqbuf fence requested, 'q' frame queued by the worker,
+ * 'd' frame dequeued, 'c' channel stopped.
+ * expect per op: '1' a fence is signalled, '0' none, '-' no signal asked
+ */
+struct fence_case {
+	const char *name;
+	const char *ops;
+	const char *expect;
+};
+
+static const struct fence_case fence_cases[] = {
+	{ "two fences one frame", "qff", "010" },
+	{ "two fences one frame, then dqbuf and a frame", "qffdq", "010-1" },
+	{ "fences before frames", "ffqq", "0011" },
+	{ "frames before fences", "qqfff", "00110" },
+	{ "a frame per fence", "fqdfqdfqd", "01-01-01-" },
+	{ "blocking dqbuf without fence", "qdfq", "0-01" },
+	{ "dqbuf settles a signalled fence", "qqfdf", "001-1" },
+	{ "dqbuf with no signalled fence", "qqdff", "00-10" },
+	{ "stop cancels pending", "qffcfq", "010-01" },
+	{ "stop drops signalled", "qqffcqf", "0011-01" },
+	{ "burst", "fffqqqqfff", "0001110100" },
+};
+
+struct fence_model {
+	struct codec_fence_cnt cnt;
+	unsigned int queued;	/* frames in the REQUEST queue */
+	unsigned int waiting;	/* pending fences as the kernel fence list */
+};
+
+/* one op, returns the expect char */
+static char fence_step(struct fence_model *m, char op)
+{
+	char r = '-';
+
+	switch (op) {
+	case 'f':
+		if (codec_fence_cnt_request(&m->cnt, m->queued) != 0u) {
+			r = '1';
+		} else {
+			m->waiting++;
+			r = '0';
+		}
+		break;
+	case 'q':
+		m->queued++;
+		if (codec_fence_cnt_frame(&m->cnt) != 0u) {
+			m->waiting--;
+			r = '1';
+		} else {
+			r = '0';
+		}
+		break;
+	case 'd':
+		if (m->queued > 0u) {
+			m->queued--;
+			codec_fence_cnt_dqbuf(&m->cnt);
+		}
+		break;
+	default:
+		/* stop: pending fences fail, the queue is flushed */
+		codec_fence_cnt_cancel(&m->cnt);
+		m->waiting = 0;
+		m->queued = 0;
+		break;
+	}
+
+	return r;
+}
+
+static int fence_check(const struct fence_case *c)
+{
+	struct fence_model m;
+	char got[FENCE_TEST_MAX_OPS + 1u];
+	size_t i, n = strlen(c->ops);
+
+	(void)memset(&m, 0, sizeof(m));
+	for (i = 0; i < n && i < FENCE_TEST_MAX_OPS; i++) {
+		got[i] = fence_step(&m, c->ops[i]);
+		/* every signalled fence has its own frame, a waiter has none */
+		if (m.cnt.outstanding > m.queued || m.cnt.pending != m.waiting ||
+		    (m.cnt.pending != 0u && m.queued > m.cnt.outstanding)) {
+			printf("FAIL %s: op %zu '%c' queued %u outstanding %u pending %u\n",
+				c->name, i, c->ops[i], m.queued, m.cnt.outstanding, m.cnt.pending);
+			return -1;
+		}
+	}
+	got[i] = '\0';
+	if (strcmp(got, c->expect) != 0) {
+		printf("FAIL %s: ops %s signalled %s expect %s\n", c->name, c->ops, got, c->expect);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	uint32_t i, failed = 0;
+	uint32_t num = (uint32_t)(sizeof(fence_cases) / sizeof(fence_cases[0]));
+
+	for (i = 0; i < num; i++) {
+		if (fence_check(&fence_cases[i]) != 0)
+			failed++;
+	}
+
+	printf("codec fence: %u cases, %u failed\n", num, failed);
+	return (failed != 0u) ? 1 : 0;
+}
@@ -36,6 +36,31 @@ typedef struct gdc_ochn_attr_s {
 	uint32_t output_stride;
 } gdc_ochn_attr_t;
 
+/* gdc ext ctrl id, see video_s_ctrl/video_g_ctrl */
+#define GDC_CTRL_BATCH_ATTR	0x1u	/* gdc_batch_attr_t */
+
+#define GDC_BATCH_MAX_SLICE	8u
+
+/* one slice of a batch: input frame i is warped by its config binary into output roi i */
+typedef struct gdc_slice_attr_s {
+	int32_t binary_ion_id;  /* share id for config binary physical addr */
+	uint64_t binary_offset; /* config binary physical addr offset */
+	uint32_t config_size;
+	uint32_t roi_x;         /* output roi in the batch output frame, pixel, even */
+	uint32_t roi_y;
+	uint32_t roi_width;     /* warp output resolution of this slice, even for nv12 */
+	uint32_t roi_height;
+} gdc_slice_attr_t;
+
+/*
+ * batch mode: every slice_num input frames are processed back-to-back into
+ * one output frame, which completes once when the last slice is done.
+ */
+typedef struct gdc_batch_attr_s {
+	uint32_t slice_num;     /* 0: batch mode off */
+	gdc_slice_attr_t slice[GDC_BATCH_MAX_SLICE];
+} gdc_batch_attr_t;
+
 // each configuration addresses and size
 typedef struct gdc_config {
 	u64 config_addr;   //gdc config address
@@ -385,10 +385,17 @@ static s32 gdc_video_streamon(struct vio_video_ctx *vctx)
 	s32 ret = 0;
 	struct vio_node *vnode;
 	struct vio_subdev *vdev;
+	struct gdc_subdev *subdev;
 
 	vctx->event = 0;
 	vdev = vctx->vdev;
 	vnode = vdev->vnode;
+	if (vctx->id == VNODE_ID_SRC) {
+		subdev = container_of(vdev, struct gdc_subdev, vdev);/*PRQA S 2810,0497*/
+		ret = gdc_setting_check(&subdev->gdc_setting);
+		if (ret < 0)
+			return ret;
+	}
 	vnode->leader = 1;
 	vio_info("[%s][S%d][C%d] %s leader %d\n", vctx->name, vnode->flow_id,
 		vnode->ctx_id, __func__, vdev->leader);
@@ -417,6 +424,90 @@ static s32 gdc_video_streamoff(struct vio_video_ctx *vctx)
 	return ret;
 }
 
+/**
+* @NO{S09E03C01}
+* @ASIL{B}
+* @brief Set extra control of gdc, GDC_CTRL_BATCH_ATTR sets the batch mode
+* @param[in] *vctx: vpf contex info
+* @param[in] cmd: ctrl id
+* @param[in] arg: user pointer of the ctrl parameter
+* @retval "= 0": success
+* @retval "< 0": failure
+* @param[out] None
+* @data_read None
+* @data_updated None
+* @compatibility None
+* @callgraph
+* @callergraph
+* @design
+*/
+static s32 gdc_video_s_ctrl(struct vio_video_ctx *vctx, u32 cmd, unsigned long arg)
+{
+	s32 ret;
+	u64 copy_ret;
+	struct gdc_subdev *subdev;
+	struct vio_subdev *vdev;
+	gdc_batch_attr_t batch_attr;
+
+	vdev = vctx->vdev;
+	if (vdev->id != VNODE_ID_SRC || cmd != GDC_CTRL_BATCH_ATTR) {
+		vio_err("[%s][C%d] %s: wrong ctrl %d\n", vctx->name, vctx->ctx_id, __func__, cmd);
+		return -EINVAL;
+	}
+
+	subdev = container_of(vdev, struct gdc_subdev, vdev);/*PRQA S 2810,0497*/
+	copy_ret = osal_copy_from_app((void *)&batch_attr, (void __user *) arg, sizeof(gdc_batch_attr_t));
+	if (copy_ret != 0u) {
+		vio_err("%s: failed to copy from user, ret = %lld\n", __func__, copy_ret);
+		return -EFAULT;
+	}
+
+	ret = gdc_batch_set_attr(subdev, &batch_attr);
+
+	return ret;
+}
+
+/**
+* @NO{S09E03C01}
+* @ASIL{B}
+* @brief Get extra control of gdc, GDC_CTRL_BATCH_ATTR gets the batch mode
+* @param[in] *vctx: vpf contex info
+* @param[in] cmd: ctrl id
+* @param[in] arg: user pointer of the ctrl parameter
+* @retval "= 0": success
+* @retval "< 0": failure
+* @param[out] None
+* @data_read batch
+* @data_updated None
+* @compatibility None
+* @callgraph
+* @callergraph
+* @design
+*/
+static s32 gdc_video_g_ctrl(struct vio_video_ctx *vctx, u32 cmd, unsigned long arg)
+{
+	u64 copy_ret;
+	struct gdc_subdev *subdev;
+	struct vio_subdev *vdev;
+	gdc_batch_attr_t batch_attr;
+
+	vdev = vctx->vdev;
+	if (vdev->id != VNODE_ID_SRC || cmd != GDC_CTRL_BATCH_ATTR) {
+		vio_err("[%s][C%d] %s: wrong ctrl %d\n", vctx->name, vctx->ctx_id, __func__, cmd);
+		return -EINVAL;
+	}
+
+	subdev = container_of(vdev, struct gdc_subdev, vdev);/*PRQA S 2810,0497*/
+	gdc_batch_get_attr(subdev, &batch_attr);
+	copy_ret = osal_copy_to_app((void __user *) arg, (void *)&batch_attr, sizeof(gdc_batch_attr_t));
+	if (copy_ret != 0u) {
+		vio_err("%s: failed to copy to user, ret = %lld\n", __func__, copy_ret);
+		return -EFAULT;
+	}
+
+	return 0;
+}
+
 /**
 * @NO{S09E03C01}
 * @ASIL{B}
@@ -457,6 +548,8 @@ static struct vio_common_ops gdc_vops = {
 	.video_start = gdc_video_streamon,
 	.video_stop = gdc_video_streamoff,
 	.video_get_version = gdc_get_version,
+	.video_s_ctrl = gdc_video_s_ctrl,
+	.video_g_ctrl = gdc_video_g_ctrl,
 	.video_get_struct_size = gdc_get_struct_size,
 };
 
@@ -494,9 +587,11 @@ static s32 hobot_gdc_device_node_init(struct hobot_gdc_dev *gdc)
 		vnode[i].och_subdev[0] = &gdc->subdev[i][1].vdev;
 		vnode[i].active_och = 1;
 		gdc->subdev[i][0].vdev.vnode = &vnode[i];
+		gdc->subdev[i][0].vdev.ring_capable = 1;
 		gdc->subdev[i][0].gdc = gdc;
 		gdc->subdev[i][1].vdev.vnode = &vnode[i];
 		gdc->subdev[i][1].vdev.pingpong_ring = 1;
+		gdc->subdev[i][1].vdev.ring_capable = 1;
 		gdc->subdev[i][1].gdc = gdc;
 		vnode[i].gtask = &gdc->gtask;
 		vnode[i].allow_bind = gdc_allow_bind;
@@ -570,6 +665,48 @@ static ssize_t gdc_reg_dump(struct device *dev, struct device_attribute *attr, c
 }
 static DEVICE_ATTR(regdump, 0444, gdc_reg_dump, NULL);/*PRQA S 4501,0636*/
 
+static ssize_t gdc_footprint_show(struct device *dev, struct device_attribute *attr, char* buf)
+{
+	struct hobot_gdc_dev *gdc;
+	gdc_settings_t *setting;
+	struct gdc_ref_cfg cfg;
+	struct gdc_ref_footprint fp;
+	u32 i, err;
+	s32 len = 0;
+
+	gdc = (struct hobot_gdc_dev *)dev_get_drvdata(dev);
+	len += snprintf(&buf[len], PAGE_SIZE - len, "ctx %10s %10s %10s %10s err\n",
+			"config", "read", "write", "total");
+	for (i = 0; i < VIO_MAX_STREAM; i++) {
+		setting = &gdc->subdev[i][0].gdc_setting;
+		if (setting->gdc_config.input_width == 0u)
+			continue;
+		gdc_setting_to_ref(setting, &cfg);
+		err = gdc_ref_check(&cfg);
+		gdc_ref_footprint(&cfg, &fp);
+		len += snprintf(&buf[len], PAGE_SIZE - len, "C%-2u %10llu %10llu %10llu %10llu 0x%x\n",
+				i, fp.cfg_bytes, fp.rd_bytes, fp.wr_bytes, fp.total_bytes, err);
+	}
+
+	return len;
+}
+static DEVICE_ATTR(footprint, 0444, gdc_footprint_show, NULL);/*PRQA S 4501,0636*/
+
+static ssize_t gdc_bincache_show(struct device *dev, struct device_attribute *attr, char* buf)
+{
+	struct hobot_gdc_dev *gdc;
+	struct gdc_bin_cache_stats stats;
+
+	gdc = (struct hobot_gdc_dev *)dev_get_drvdata(dev);
+	gdc_bin_cache_get_stats(gdc, &stats);
+
+	return snprintf(buf, PAGE_SIZE,
+			"entries %u active %u resident %llu budget %llu hit %llu miss %llu evict %llu\n",
+			stats.entries, stats.active, stats.resident, stats.budget,
+			stats.hit, stats.miss, stats.evict);
+}
+static DEVICE_ATTR(bincache, 0444, gdc_bincache_show, NULL);/*PRQA S 4501,0636*/
+
 static int gdc_wrapper_init(struct platform_device *pdev)
 {
 	struct hobot_gdc_dev *gdc;
@@ -683,16 +820,35 @@ static s32 hobot_gdc_probe(struct platform_device *pdev)
 		dev_err(dev, "create regdump failed (%d)\n", ret);
 		return ret;
 	}
+	ret = device_create_file(dev, &dev_attr_footprint);
+	if(ret < 0) {
+		device_remove_file(&pdev->dev, &dev_attr_loading);
+		device_remove_file(dev, &dev_attr_regdump);
+		dev_err(dev, "create footprint failed (%d)\n", ret);
+		return ret;
+	}
+	ret = device_create_file(dev, &dev_attr_bincache);
+	if(ret < 0) {
+		device_remove_file(&pdev->dev, &dev_attr_loading);
+		device_remove_file(dev, &dev_attr_regdump);
+		device_remove_file(dev, &dev_attr_footprint);
+		dev_err(dev, "create bincache failed (%d)\n", ret);
+		return ret;
+	}
 	ret = hobot_gdc_device_node_init(gdc);
 	if (ret < 0) {
 		device_remove_file(&pdev->dev, &dev_attr_loading);
 		device_remove_file(dev, &dev_attr_regdump);
+		device_remove_file(dev, &dev_attr_footprint);
+		device_remove_file(dev, &dev_attr_bincache);
 		return ret;
 	}
 
 	platform_set_drvdata(pdev, (void *)gdc);
 	osal_spin_init(&gdc->shared_slock);/*PRQA S 3334*/
 	osal_mutex_init(&gdc->mlock);/*PRQA S 3334*/
+	osal_mutex_init(&gdc->bin_cache.mlock);/*PRQA S 3334*/
+	osal_list_head_init(&gdc->bin_cache.list);
 	g_gdc_dev[gdc->hw_id] = gdc;
 
 	gdc_wrapper_init(pdev);
@@ -731,6 +887,9 @@ static s32 hobot_gdc_remove(struct platform_device *pdev)
 	dev = &pdev->dev;
 	device_remove_file(&pdev->dev, &dev_attr_loading);
 	device_remove_file(dev, &dev_attr_regdump);
+	device_remove_file(dev, &dev_attr_footprint);
+	device_remove_file(dev, &dev_attr_bincache);
+	gdc_bin_cache_flush(gdc, gdc->vps_device[0].iommu_dev);
 	vio_unregister_device_node(&gdc->vps_device[0]);
 	vio_unregister_device_node(&gdc->vps_device[1]);
 
@@ -55,6 +55,61 @@ struct gdc_iommu_addr {
      u32 in_iommu_addr[VIO_BUFFER_MAX_PLANES];
      u32 out_iommu_addr[VIO_BUFFER_MAX_PLANES];
 };
+
+/**
+ * @struct gdc_bin_entry
+ * @brief config binary ion buffer kept mapped in gdc iommu.
+ * @NO{S09E03C01}
+ */
+struct gdc_bin_entry {
+	osal_list_head_t list;
+	s32 ion_id;
+	u32 bytes;	/* largest offset + config size used, byte */
+	u32 refcnt;	/* contexts using this binary */
+	struct vio_frame frame;
+};
+
+/**
+ * @struct gdc_bin_cache
+ * @brief config binaries of all contexts, least recently used first.
+ * @NO{S09E03C01}
+ */
+struct gdc_bin_cache {
+	osal_mutex_t mlock;
+	osal_list_head_t list;
+	u32 entries;
+	u32 active;
+	u64 resident;
+	u64 hit;
+	u64 miss;
+	u64 evict;
+};
+
+struct gdc_bin_cache_stats {
+	u32 entries;
+	u32 active;
+	u64 resident;
+	u64 budget;
+	u64 hit;
+	u64 miss;
+	u64 evict;
+};
+
+/**
+ * @struct gdc_batch
+ * @brief gdc batch job: slices processed back-to-back into one output frame.
+ * @NO{S09E03C01}
+ */
+struct gdc_batch {
+	gdc_batch_attr_t attr;
+	gdc_config_t cfg[GDC_BATCH_MAX_SLICE];		/* per slice hw geometry */
+	struct gdc_bin_entry *bin_entry[GDC_BATCH_MAX_SLICE];
+	struct gdc_iommu_addr map_addr[GDC_BATCH_MAX_SLICE];
+	u32 run;	/* a job is in hw */
+	u32 cur;	/* slice in hw */
+	u32 err;	/* a slice of the job failed */
+};
+
 /**
  * @struct gdc_subdev
  * @brief gdc sub-device definition.
@@ -80,8 +135,9 @@ struct gdc_subdev {
      */
 	gdc_settings_t gdc_setting;
 
-     struct vio_frame bin_frame;
+     struct gdc_bin_entry *bin_entry;
      struct gdc_iommu_addr map_addr;
+     struct gdc_batch batch;
 };
 
 /* same as struct cam_ctrl_device MUST */
@@ -224,6 +280,8 @@ struct hobot_gdc_dev {
 
 	struct vio_hw_loading loading;
 
+	struct gdc_bin_cache bin_cache;
+
 	struct vio_stl stl;
 };
 
@@ -16,6 +16,8 @@
 #include "hobot_gdc_ops.h"
 
 static void gdc_subdev_process(struct vio_subdev *vdev);
+static void gdc_batch_release(struct gdc_subdev *subdev);
+static void gdc_config_to_ref(const gdc_config_t *gdc_cfg, struct gdc_ref_cfg *cfg);
 /**
  * Purpose: gdc default color bar
  * Value: bit0~7: v, bit 8~15 u, bit 16~23 y.
@@ -28,6 +30,18 @@ int g_default_color = 0x008080;
 module_param(g_default_color, int, 0644);/*PRQA S 0605,0636,4501*/
 #endif
 
+/**
+ * Purpose: budget of idle config binaries kept mapped in gdc iommu
+ * Value: byte, binaries in use by contexts are never evicted
+ * Range: hobot_gdc_ops.c
+ * Attention: NA
+ */
+int g_bin_cache_size = 16 * 1024 * 1024;
+
+#ifndef HOBOT_MCU_CAMSYS
+module_param(g_bin_cache_size, int, 0644);/*PRQA S 0605,0636,4501*/
+#endif
+
 /**
  * Purpose: ko version
  * Value: NA
@@ -151,6 +165,90 @@ s32 gdc_subdev_close(struct vio_video_ctx *vctx, u32 rst_en)
 	return 0;
 }
 
+/* code review E1: internal logic function, no need error return */
+static void gdc_batch_frame_work(struct vio_node *vnode, struct gdc_subdev *subdev)
+{
+	u64 flags = 0;
+	u32 i, ready, offset, c_offset;
+	struct vio_subdev *vdev;
+	struct vio_subdev *och_vdev;
+	struct vio_framemgr *framemgr, *out_framemgr;
+	struct vio_frame *frame, *out_frame;
+	struct gdc_batch *batch;
+	const gdc_config_t *gdc_cfg;
+	const gdc_slice_attr_t *slice;
+
+	vdev = &subdev->vdev;
+	och_vdev = vnode->och_subdev[0];
+	batch = &subdev->batch;
+	gdc_cfg = &subdev->gdc_setting.gdc_config;
+	framemgr = &vdev->framemgr;
+	out_framemgr = &och_vdev->framemgr;
+
+	/* each queued input triggers once, the job starts with its last input */
+	vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
+	/* ring mode: inputs are only counted once moved into the REQUEST queue */
+	frame_ring_drain(framemgr);
+	ready = framemgr->queued_count[FS_REQUEST];
+	vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
+	if (ready < batch->attr.slice_num) {
+		vio_dbg("[S%d][C%d] %s: wait input %d/%d\n", vnode->flow_id, vnode->ctx_id,
+			__func__, ready, batch->attr.slice_num);/*PRQA S 0685,1294*/
+		vio_set_hw_free(vnode);
+		return;
+	}
+
+	vio_e_barrier_irqs(out_framemgr, flags);/*PRQA S 2996*/
+	out_frame = peek_frame(out_framemgr, FS_REQUEST);
+	if (out_frame != NULL)
+		trans_frame(out_framemgr, out_frame, FS_PROCESS);
+	vio_x_barrier_irqr(out_framemgr, flags);/*PRQA S 2996*/
+
+	for (i = 0; i < batch->attr.slice_num; i++) {
+		vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
+		frame = peek_frame(framemgr, FS_REQUEST);
+		if (frame != NULL)
+			trans_frame(framemgr, frame, FS_PROCESS);
+		vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
+		if (frame == NULL)
+			break;
+		if (i == 0u)
+			(void)memcpy(&vnode->frameid, &frame->frameinfo.frameid, sizeof(struct frame_id_desc));
+		vio_fps_calculate(&vdev->fdebug, &frame->frameinfo.frameid);
+		if (out_frame == NULL)
+			continue;
+
+		slice = &batch->attr.slice[i];
+		offset = slice->roi_y * gdc_cfg->output_stride + slice->roi_x;
+		c_offset = (slice->roi_y >> gdc_cfg->div_height) * gdc_cfg->output_stride + slice->roi_x;
+		batch->map_addr[i].in_iommu_addr[0] = frame->vbuf.iommu_paddr[0][0];
+		batch->map_addr[i].in_iommu_addr[1] = frame->vbuf.iommu_paddr[0][1];
+		batch->map_addr[i].out_iommu_addr[0] = out_frame->vbuf.iommu_paddr[0][0] + offset;
+		batch->map_addr[i].out_iommu_addr[1] = out_frame->vbuf.iommu_paddr[0][1] + c_offset;
+	}
+
+	if (out_frame == NULL || i < batch->attr.slice_num) {
+		/* drop the inputs of the job together so the slices keep their order */
+		vio_warn("[S%d][C%d] %s: no output frame or input %d/%d\n", vnode->flow_id,
+			vnode->ctx_id, __func__, i, batch->attr.slice_num);
+		framemgr_print_queues(out_framemgr);
+		while (i-- > 0u)
+			vio_frame_done(vdev);
+		if (out_frame != NULL)
+			vio_frame_ndone(och_vdev);
+		vio_set_hw_free(vnode);
+		return;
+	}
+
+	vio_dbg("[S%d][C%d] %s: slice_num %d out 0x%x, 0x%x\n",/*PRQA S 0685,1294*/
+		vnode->flow_id, vnode->ctx_id, __func__, batch->attr.slice_num,
+		out_frame->vbuf.iommu_paddr[0][0], out_frame->vbuf.iommu_paddr[0][1]);
+	batch->cur = 0;
+	batch->err = 0;
+	batch->run = 1;
+	gdc_subdev_process(vdev);
+}
+
 /**
 * @NO{S09E03C01}
 * @ASIL{B}
@@ -186,6 +284,11 @@ void gdc_frame_work(struct vio_node *vnode)
 	vio_dbg("[S%d][C%d] %s: start, rcount %d\n", vnode->flow_id, vnode->ctx_id,
 		__func__, osal_atomic_read(&vnode->rcount));/*PRQA S 0685,1294*/
 
+	if (subdev->batch.attr.slice_num > 0u) {
+		gdc_batch_frame_work(vnode, subdev);
+		return;
+	}
+
 	vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
 	frame = peek_frame(framemgr, FS_REQUEST);
 	vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
@@ -265,7 +368,6 @@ static void gdc_hw_start(struct hobot_gdc_dev *gdc)
 * @ASIL{B}
 * @brief init gdc hardware
 * @param[in] *gdc: gdc ip device
-* @param[in] *gdc_settings: gdc settings parameters
 * @retval None
 * @param[out] None
 * @data_read None
@@ -275,11 +377,8 @@ static void gdc_hw_start(struct hobot_gdc_dev *gdc)
 * @callergraph
 * @design
 */
-static void gdc_init(struct gdc_subdev *subdev)
+static void gdc_init(struct hobot_gdc_dev *gdc)
 {
-	struct hobot_gdc_dev *gdc;
-
-	gdc = subdev->gdc;
 	gdc_process_enable(gdc->base_reg, 0);
 	gdc_process_reset(gdc->base_reg, 1);
 	gdc_process_reset(gdc->base_reg, 0);
@@ -288,65 +387,393 @@ static void gdc_init(struct gdc_subdev *subdev)
 	gdc_set_default_ch3(gdc->base_reg, (u32)g_default_color & MASK_8);
 }
 
-static void gdc_config_binary(struct gdc_subdev *subdev)
+static void gdc_config_binary(struct hobot_gdc_dev *gdc, const gdc_config_t *gdc_cfg,
+			u32 bin_iommu_addr)
 {
-	struct hobot_gdc_dev *gdc;
-
-	gdc = subdev->gdc;
-	gdc_set_config_addr(gdc->base_reg, subdev->map_addr.bin_iommu_addr);
-	gdc_set_config_size(gdc->base_reg,
-		subdev->gdc_setting.gdc_config.config_size / CONFIG_SIZE_OFFSET);
+	gdc_set_config_addr(gdc->base_reg, bin_iommu_addr);
+	gdc_set_config_size(gdc->base_reg, gdc_cfg->config_size / CONFIG_SIZE_OFFSET);
 
 	vio_dbg("%s: config_addr 0x%x config_size %x\n",/*PRQA S 0685,1294*/
-		__func__,
-		subdev->map_addr.bin_iommu_addr,
-		subdev->gdc_setting.gdc_config.config_size);
+		__func__, bin_iommu_addr, gdc_cfg->config_size);
+}
+
+static void gdc_bin_cache_release(void *iommu_dev, struct gdc_bin_entry *entry)
+{
+	vio_frame_iommu_unmap(iommu_dev, &entry->frame);
+	osal_kfree(entry);
+}
+
+/* move idle binaries over budget to evict_list, oldest first, cache mlock held */
+static void gdc_bin_cache_trim(struct gdc_bin_cache *cache, u64 limit,
+			osal_list_head_t *evict_list)
+{
+	struct gdc_bin_entry *entry;
+	struct gdc_bin_entry *temp;
+
+	osal_list_for_each_entry_safe(entry, temp, &cache->list, list) {/*PRQA S 2810,2741,0497*/
+		if (cache->resident <= limit)
+			break;
+		if (entry->refcnt != 0u)
+			continue;
+		osal_list_del(&entry->list);
+		osal_list_add(&entry->list, evict_list);
+		cache->entries--;
+		cache->resident -= entry->bytes;
+		cache->evict++;
+	}
+}
+
+static void gdc_bin_cache_evict(void *iommu_dev, osal_list_head_t *evict_list)
+{
+	struct gdc_bin_entry *entry;
+	struct gdc_bin_entry *temp;
+
+	osal_list_for_each_entry_safe(entry, temp, evict_list, list) {/*PRQA S 2810,2741,0497*/
+		osal_list_del(&entry->list);
+		gdc_bin_cache_release(iommu_dev, entry);
+	}
+}
+
+/**
+* @NO{S09E03C01}
+* @ASIL{B}
+* @brief Get the mapped config binary ion buffer from cache, map it on miss
+* @param[in] *gdc: gdc device
+* @param[in] *iommu_dev: device the binary is mapped to
+* @param[in] ion_id: share id of the config binary ion buffer
+* @param[in] bytes: binary offset + config size used in the buffer
+* @retval "!= NULL": cache entry, one reference taken
+* @retval "= NULL": failure
+* @param[out] None
+* @data_read None
+* @data_updated bin_cache
+* @compatibility None
+* @callgraph
+* @callergraph
+* @design
+*/
+static struct gdc_bin_entry *gdc_bin_cache_get(struct hobot_gdc_dev *gdc, void *iommu_dev,
+			s32 ion_id, u32 bytes)
+{
+	s32 ret;
+	u64 limit;
+	osal_list_head_t evict_list;
+	struct gdc_bin_cache *cache;
+	struct gdc_bin_entry *entry;
+	struct gdc_bin_entry *found = NULL;
+
+	cache = &gdc->bin_cache;
+	limit = (g_bin_cache_size > 0) ? (u64)g_bin_cache_size : 0u;
+	osal_list_head_init(&evict_list);
+
+	osal_mutex_lock(&cache->mlock);
+	osal_list_for_each_entry(entry, &cache->list, list) {/*PRQA S 2810,0497*/
+		if (entry->ion_id == ion_id) {
+			found = entry;
+			break;
+		}
+	}
+	if (found != NULL) {
+		cache->hit++;
+		osal_list_del(&found->list);
+	} else {
+		cache->miss++;
+		found = osal_kzalloc(sizeof(struct gdc_bin_entry), GFP_KERNEL);
+		if (found == NULL) {
+			osal_mutex_unlock(&cache->mlock);
+			return NULL;
+		}
+		found->ion_id = ion_id;
+		found->frame.frameinfo.ion_id[0] = ion_id;
+		found->frame.frameinfo.is_contig = 1;
+		found->frame.vbuf.group_info.bit_map = 1;
+		ret = vio_frame_iommu_map(iommu_dev, &found->frame);
+		if (ret < 0) {
+			osal_mutex_unlock(&cache->mlock);
+			vio_frame_iommu_unmap(iommu_dev, &found->frame);
+			osal_kfree(found);
+			return NULL;
+		}
+		cache->entries++;
+	}
+	if (bytes > found->bytes) {
+		cache->resident += bytes - found->bytes;
+		found->bytes = bytes;
+	}
+	if (found->refcnt == 0u)
+		cache->active++;
+	found->refcnt++;
+	osal_list_add_tail(&found->list, &cache->list);
+	gdc_bin_cache_trim(cache, limit, &evict_list);
+	osal_mutex_unlock(&cache->mlock);
+
+	gdc_bin_cache_evict(iommu_dev, &evict_list);
+
+	return found;
+}
+
+/* code review E1: internal logic function, no need error return */
+static void gdc_bin_cache_put(struct hobot_gdc_dev *gdc, void *iommu_dev,
+			struct gdc_bin_entry *entry)
+{
+	u64 limit;
+	osal_list_head_t evict_list;
+	struct gdc_bin_cache *cache;
+
+	cache = &gdc->bin_cache;
+	limit = (g_bin_cache_size > 0) ? (u64)g_bin_cache_size : 0u;
+	osal_list_head_init(&evict_list);
+
+	osal_mutex_lock(&cache->mlock);
+	if (entry->refcnt > 0u) {
+		entry->refcnt--;
+		if (entry->refcnt == 0u)
+			cache->active--;
+	}
+	gdc_bin_cache_trim(cache, limit, &evict_list);
+	osal_mutex_unlock(&cache->mlock);
+
+	gdc_bin_cache_evict(iommu_dev, &evict_list);
+}
+
+/**
+* @NO{S09E03C01}
+* @ASIL{B}
+* @brief Release all idle config binaries in cache
+* @param[in] *gdc: gdc device
+* @param[in] *iommu_dev: device the binaries are mapped to
+* @retval None
+* @param[out] None
+* @data_read None
+* @data_updated bin_cache
+* @compatibility None
+* @callgraph
+* @callergraph
+* @design
+*/
+void gdc_bin_cache_flush(struct hobot_gdc_dev *gdc, void *iommu_dev)
+{
+	osal_list_head_t evict_list;
+	struct gdc_bin_cache *cache;
+
+	cache = &gdc->bin_cache;
+	osal_list_head_init(&evict_list);
+	osal_mutex_lock(&cache->mlock);
+	gdc_bin_cache_trim(cache, 0u, &evict_list);
+	osal_mutex_unlock(&cache->mlock);
+
+	gdc_bin_cache_evict(iommu_dev, &evict_list);
 }
 
+/**
+* @NO{S09E03C01}
+* @ASIL{B}
+* @brief Point the context to its config binary, the iommu mapping is shared
+* by all contexts using the same ion buffer and kept in cache after switched away
+* @param[in] *subdev: gdc sub-device
+* @retval "= 0": success
+* @retval "< 0": failure
+* @param[out] None
+* @data_read gdc_setting
+* @data_updated bin_entry, map_addr
+* @compatibility None
+* @callgraph
+* @callergraph
+* @design
+*/
 s32 gdc_iommu_map(struct gdc_subdev *subdev)
 {
-	s32 ret = 0;
 	gdc_settings_t *gdc_setting;
-	struct vio_subdev *vdev;
-	struct vio_frame *frame;
+	struct gdc_bin_entry *entry;
+	struct gdc_bin_entry *old;
 	struct vio_node *vnode;
 
-	vdev = &subdev->vdev;
-	vnode = vdev->vnode;
-	frame = &subdev->bin_frame;
+	vnode = subdev->vdev.vnode;
 	gdc_setting = &subdev->gdc_setting;
+	if (gdc_setting->binary_ion_id == 0)
+		return 0;
 
-	if (frame->frameinfo.ion_id[0] != gdc_setting->binary_ion_id)
-		frame->buf_shared = 0;
-	frame->frameinfo.ion_id[0] = gdc_setting->binary_ion_id;
-	frame->frameinfo.is_contig = 1;
-	frame->vbuf.group_info.bit_map = 1;
-
-	if (frame->buf_shared == 0 && gdc_setting->binary_ion_id != 0) {
-		vio_frame_iommu_unmap(vdev->iommu_dev, frame);
-		ret = vio_frame_iommu_map(vdev->iommu_dev, frame);
-		if (ret < 0) {
-			vio_err("[S%d]%s: bin_frame vio_frame_iommu_map failed\n",
-				vnode->flow_id, __func__);
-			return ret;
-		}
-		subdev->map_addr.bin_iommu_addr = frame->vbuf.iommu_paddr[0][0] +
-			gdc_setting->binary_offset;
+	entry = gdc_bin_cache_get(subdev->gdc, subdev->vdev.iommu_dev, gdc_setting->binary_ion_id,
+			(u32)gdc_setting->binary_offset + gdc_setting->gdc_config.config_size);
+	if (entry == NULL) {
+		vio_err("[S%d]%s: bin_frame vio_frame_iommu_map failed\n",
+			vnode->flow_id, __func__);
+		return -EFAULT;
 	}
+	old = subdev->bin_entry;
+	subdev->bin_entry = entry;
+	subdev->map_addr.bin_iommu_addr = entry->frame.vbuf.iommu_paddr[0][0] +
+		gdc_setting->binary_offset;
+	if (old != NULL)
+		gdc_bin_cache_put(subdev->gdc, subdev->vdev.iommu_dev, old);
 
-	return ret;
+	return 0;
 }
 
 /* code review E1: internal logic function, no need error return */
 void gdc_iommu_ummap(struct gdc_subdev *subdev)
 {
-	struct vio_subdev *vdev;
-	struct vio_frame *frame;
+	struct gdc_bin_entry *entry;
 
-	vdev = &subdev->vdev;
-	frame = &subdev->bin_frame;
-	vio_frame_iommu_unmap(vdev->iommu_dev, frame);
-	frame->buf_shared = 0;
+	gdc_batch_release(subdev);
+	entry = subdev->bin_entry;
+	if (entry == NULL)
+		return;
+	subdev->bin_entry = NULL;
+	gdc_bin_cache_put(subdev->gdc, subdev->vdev.iommu_dev, entry);
+}
+
+/* code review E1: internal logic function, no need error return */
+static void gdc_batch_release(struct gdc_subdev *subdev)
+{
+	u32 i;
+	struct gdc_batch *batch;
+
+	batch = &subdev->batch;
+	for (i = 0; i < GDC_BATCH_MAX_SLICE; i++) {
+		if (batch->bin_entry[i] == NULL)
+			continue;
+		gdc_bin_cache_put(subdev->gdc, subdev->vdev.iommu_dev, batch->bin_entry[i]);
+		batch->bin_entry[i] = NULL;
+	}
+	batch->attr.slice_num = 0;
+	batch->run = 0;
+}
+
+/* build the hw geometry of each slice and check it as a gdc frame */
+static s32 gdc_batch_check(const struct gdc_subdev *subdev, const gdc_batch_attr_t *attr,
+			gdc_config_t *slice_cfg)
+{
+	u32 i, err;
+	const gdc_config_t *gdc_cfg;
+	const gdc_slice_attr_t *slice;
+	struct gdc_ref_cfg cfg, out_cfg;
+	struct gdc_ref_roi roi;
+
+	gdc_cfg = &subdev->gdc_setting.gdc_config;
+	gdc_config_to_ref(gdc_cfg, &out_cfg);
+	if (attr->slice_num > GDC_BATCH_MAX_SLICE || subdev->gdc_setting.n_in_one > 0u) {
+		vio_err("%s: wrong slice_num %d or n_in_one %d set\n", __func__,
+			attr->slice_num, subdev->gdc_setting.n_in_one);
+		return -EINVAL;
+	}
+	/* chroma roi offset is counted for nv12 */
+	if (attr->slice_num > 0u && gdc_cfg->total_planes > YUV_PLANE_2) {
+		vio_err("%s: batch needs semi-planar output, planes %d\n", __func__,
+			gdc_cfg->total_planes);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < attr->slice_num; i++) {
+		slice = &attr->slice[i];
+		(void)memcpy(&slice_cfg[i], gdc_cfg, sizeof(gdc_config_t));
+		slice_cfg[i].config_size = slice->config_size;
+		slice_cfg[i].output_width = slice->roi_width;
+		slice_cfg[i].output_height = slice->roi_height;
+		gdc_config_to_ref(&slice_cfg[i], &cfg);
+		err = gdc_ref_check(&cfg);
+		if (err != GDC_REF_OK || slice->binary_ion_id == 0) {
+			vio_err("%s: slice%d wrong %s(0x%x), ion_id %d\n", __func__, i,
+				gdc_ref_err_name(err), err, slice->binary_ion_id);
+			return -EINVAL;
+		}
+		roi.x = slice->roi_x;
+		roi.y = slice->roi_y;
+		roi.width = slice->roi_width;
+		roi.height = slice->roi_height;
+		if (gdc_ref_roi_check(&out_cfg, &roi) != GDC_REF_OK) {
+			vio_err("%s: slice%d wrong roi(%d, %d, %d*%d) in %d*%d\n", __func__, i,
+				slice->roi_x, slice->roi_y, slice->roi_width, slice->roi_height,
+				gdc_cfg->output_width, gdc_cfg->output_height);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+/**
+* @NO{S09E03C01}
+* @ASIL{B}
+* @brief set gdc batch mode of a context, the config binaries of all slices are
+* mapped here so a job never maps in the frame path
+* @param[in] *subdev: gdc source sub-device
+* @param[in] *attr: batch attribute, slice_num 0 turns batch mode off
+* @retval "= 0": success
+* @retval "< 0": failure
+* @param[out] None
+* @data_read None
+* @data_updated batch
+* @compatibility None
+* @callgraph
+* @callergraph
+* @design
+*/
+s32 gdc_batch_set_attr(struct gdc_subdev *subdev, const gdc_batch_attr_t *attr)
+{
+	s32 ret;
+	u32 i, j;
+	struct gdc_batch *batch;
+	struct vio_node *vnode;
+	const gdc_slice_attr_t *slice;
+	gdc_config_t slice_cfg[GDC_BATCH_MAX_SLICE];
+	struct gdc_bin_entry *entry[GDC_BATCH_MAX_SLICE];
+
+	batch = &subdev->batch;
+	vnode = subdev->vdev.vnode;
+	if (osal_test_bit((s32)VIO_NODE_START, &vnode->state) != 0) {
+		vio_err("[S%d]%s: set batch in streaming\n", vnode->flow_id, __func__);
+		return -EBUSY;
+	}
+
+	ret = gdc_batch_check(subdev, attr, slice_cfg);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < attr->slice_num; i++) {
+		slice = &attr->slice[i];
+		entry[i] = gdc_bin_cache_get(subdev->gdc, subdev->vdev.iommu_dev, slice->binary_ion_id,
+				(u32)slice->binary_offset + slice->config_size);
+		if (entry[i] == NULL) {
+			vio_err("[S%d]%s: slice%d binary map failed\n", vnode->flow_id, __func__, i);
+			for (j = 0; j < i; j++)
+				gdc_bin_cache_put(subdev->gdc, subdev->vdev.iommu_dev, entry[j]);
+			return -EFAULT;
+		}
+	}
+
+	gdc_batch_release(subdev);
+	(void)memcpy(&batch->attr, attr, sizeof(gdc_batch_attr_t));
+	for (i = 0; i < attr->slice_num; i++) {
+		(void)memcpy(&batch->cfg[i], &slice_cfg[i], sizeof(gdc_config_t));
+		batch->bin_entry[i] = entry[i];
+		batch->map_addr[i].bin_iommu_addr = entry[i]->frame.vbuf.iommu_paddr[0][0] +
+			attr->slice[i].binary_offset;
+	}
+	vio_info("[S%d]%s: slice_num %d\n", vnode->flow_id, __func__, attr->slice_num);
+
+	return 0;
+}
+
+void gdc_batch_get_attr(const struct gdc_subdev *subdev, gdc_batch_attr_t *attr)
+{
+	(void)memcpy(attr, &subdev->batch.attr, sizeof(gdc_batch_attr_t));
+}
+
+void gdc_bin_cache_get_stats(struct hobot_gdc_dev *gdc, struct gdc_bin_cache_stats *stats)
+{
+	struct gdc_bin_cache *cache;
+
+	cache = &gdc->bin_cache;
+	osal_mutex_lock(&cache->mlock);
+	stats->entries = cache->entries;
+	stats->active = cache->active;
+	stats->resident = cache->resident;
+	stats->budget = (g_bin_cache_size > 0) ? (u64)g_bin_cache_size : 0u;
+	stats->hit = cache->hit;
+	stats->miss = cache->miss;
+	stats->evict = cache->evict;
+	osal_mutex_unlock(&cache->mlock);
 }
 
 void gdc_attr_trans_to_settings(gdc_attr_t *gdc_attr, gdc_ichn_attr_t *ichn_attr,
@@ -409,18 +836,13 @@ void gdc_settings_trans_to_attr(gdc_attr_t *gdc_attr, gdc_ichn_attr_t *ichn_attr
 }
 
 /* code review E1: internal logic function, no need error return */
-static void gdc_config_input(struct gdc_subdev *subdev)
+static void gdc_config_input(struct hobot_gdc_dev *gdc, const gdc_config_t *gdc_cfg,
+			const u32 *input_addr)
 {
 	u32 lineoffset, height;
 	u32 total_planes;
-	u32 *input_addr;
-	struct hobot_gdc_dev *gdc;
-	struct gdc_config *gdc_cfg;
 
-	gdc = subdev->gdc;
-	gdc_cfg = &subdev->gdc_setting.gdc_config;
 	total_planes = gdc_cfg->total_planes;
-	input_addr = subdev->map_addr.in_iommu_addr;
 	vio_dbg("%s: plane_num %d stride %d height %d div_w %d div_h %d\n",/*PRQA S 0685,1294*/
 			__func__, total_planes,
 			gdc_cfg->input_stride, gdc_cfg->input_height,
@@ -457,18 +879,13 @@ static void gdc_config_input(struct gdc_subdev *subdev)
 }
 
 /* code review E1: internal logic function, no need error return */
-static void gdc_config_output(struct gdc_subdev *subdev)
+static void gdc_config_output(struct hobot_gdc_dev *gdc, const gdc_config_t *gdc_cfg,
+			const u32 *output_addr)
 {
 	u32 lineoffset, height;
 	u32 total_planes;
-	u32 *output_addr;
-	struct hobot_gdc_dev *gdc;
-	struct gdc_config *gdc_cfg;
 
-	gdc = subdev->gdc;
-	gdc_cfg = &subdev->gdc_setting.gdc_config;
 	total_planes = gdc_cfg->total_planes;
-	output_addr = subdev->map_addr.out_iommu_addr;
 	vio_dbg("%s: plane_num %d stride %d height %d div_w %d div_h %d\n",/*PRQA S 0685,1294*/
 			__func__, total_planes,
 			gdc_cfg->output_stride, gdc_cfg->output_height,
@@ -515,7 +932,8 @@ static void gdc_config_output(struct gdc_subdev *subdev)
 * @ASIL{B}
 * @brief set gdc_settings parameters
 * @param[in] *gdc: gdc ip device
-* @param[in] *gdc_settings: gdc settings parameters
+* @param[in] *gdc_cfg: gdc geometry of the frame or batch slice
+* @param[in] *map_addr: config binary, input and output iommu addresses
 * @retval None
 * @param[out] None
 * @data_read None
@@ -525,19 +943,20 @@ static void gdc_config_output(struct gdc_subdev *subdev)
 * @callergraph
 * @design
 */
-static void gdc_hw_config(struct gdc_subdev *subdev)
+static void gdc_hw_config(struct hobot_gdc_dev *gdc, const gdc_config_t *gdc_cfg,
+			const struct gdc_iommu_addr *map_addr)
 {
 	//reset gdc hw
-	gdc_init(subdev);
+	gdc_init(gdc);
 
 	//config gdc binary
-	gdc_config_binary(subdev);
+	gdc_config_binary(gdc, gdc_cfg, map_addr->bin_iommu_addr);
 
 	//config input
-	gdc_config_input(subdev);
+	gdc_config_input(gdc, gdc_cfg, map_addr->in_iommu_addr);
 
 	//config outputs
-	gdc_config_output(subdev);
+	gdc_config_output(gdc, gdc_cfg, map_addr->out_iommu_addr);
 }
 
 static s32 gdc_check_ichn_bind_param(struct vio_subdev *vdev, struct chn_attr *chn_attr)
@@ -648,6 +1067,27 @@ static s32 gdc_check_status(u32 status)
 	return ret;
 }
 
+/* code review E1: internal logic function, no need error return */
+static void gdc_config_to_ref(const gdc_config_t *gdc_cfg, struct gdc_ref_cfg *cfg)
+{
+	cfg->config_size = gdc_cfg->config_size;
+	cfg->input_width = gdc_cfg->input_width;
+	cfg->input_height = gdc_cfg->input_height;
+	cfg->input_stride = gdc_cfg->input_stride;
+	cfg->output_width = gdc_cfg->output_width;
+	cfg->output_height = gdc_cfg->output_height;
+	cfg->output_stride = gdc_cfg->output_stride;
+	cfg->div_width = gdc_cfg->div_width;
+	cfg->div_height = gdc_cfg->div_height;
+	cfg->total_planes = gdc_cfg->total_planes;
+}
+
+/* code review E1: internal logic function, no need error return */
+void gdc_setting_to_ref(const gdc_settings_t *gdc_setting, struct gdc_ref_cfg *cfg)
+{
+	gdc_config_to_ref(&gdc_setting->gdc_config, cfg);
+}
+
 /**
 * @NO{S09E03C01}
 * @ASIL{B}
@@ -666,6 +1106,8 @@ static s32 gdc_check_status(u32 status)
 s32 gdc_setting_check(gdc_settings_t *gdc_setting)
 {
 	s32 ret = 0;
+	u32 err;
+	struct gdc_ref_cfg cfg;
 
 	if (gdc_setting->gdc_config.input_width == 0 ||
 		gdc_setting->gdc_config.input_width > GDC_MAX_WIDTH) {
@@ -693,6 +1135,16 @@ s32 gdc_setting_check(gdc_settings_t *gdc_setting)
 		ret = -EFAULT;
 	}
 
+	/* advisory only: the frame reference rules are stricter than the limits above */
+	gdc_setting_to_ref(gdc_setting, &cfg);
+	err = gdc_ref_check(&cfg);
+	if (ret == 0 && err != GDC_REF_OK)
+		vio_warn("%s: frame reference %s(0x%x), config_size %d in %d*%d/%d out %d*%d/%d planes %d div %d %d\n",
+			__func__, gdc_ref_err_name(err), err, cfg.config_size,
+			cfg.input_width, cfg.input_height, cfg.input_stride,
+			cfg.output_width, cfg.output_height, cfg.output_stride,
+			cfg.total_planes, cfg.div_width, cfg.div_height);
+
 	return ret;
 }
 
@@ -764,7 +1216,11 @@ static void gdc_subdev_process(struct vio_subdev *vdev)
 	vnode = vdev->vnode;
 	osal_atomic_set(&gdc->ctx_id, vnode->ctx_id);
 	vio_set_stat_info(vnode->flow_id, GDC_MODULE, STAT_FS, vnode->frameid.frame_id);
-	gdc_hw_config(subdev);
+	if (subdev->batch.run != 0u)
+		gdc_hw_config(gdc, &subdev->batch.cfg[subdev->batch.cur],
+			&subdev->batch.map_addr[subdev->batch.cur]);
+	else
+		gdc_hw_config(gdc, &subdev->gdc_setting.gdc_config, &subdev->map_addr);
 	gdc_hw_start(gdc);
 	vio_loading_calculate(&gdc->loading, STAT_FS);
 	gdc->state = (u32)GDC_DEV_PROCESS;
@@ -772,6 +1228,25 @@ static void gdc_subdev_process(struct vio_subdev *vdev)
 	vio_dbg("[S%d][C%d] %s done\n", vnode->flow_id, vnode->ctx_id, __func__);/*PRQA S 0685,1294*/
 }
 
+/* start the next slice back-to-back from irq, return 0 when the job is over */
+static u32 gdc_batch_next(struct hobot_gdc_dev *gdc, struct gdc_subdev *subdev, u32 gdc_status)
+{
+	struct gdc_batch *batch;
+
+	batch = &subdev->batch;
+	if (gdc_check_status(gdc_status) != 0)
+		batch->err = 1;
+	batch->cur++;
+	if (batch->err != 0u || batch->cur >= batch->attr.slice_num)
+		return 0;
+
+	gdc_hw_config(gdc, &batch->cfg[batch->cur], &batch->map_addr[batch->cur]);
+	gdc_hw_start(gdc);
+	vio_dbg("[C%d] %s: slice%d\n", osal_atomic_read(&gdc->ctx_id), __func__, batch->cur);/*PRQA S 0685,1294*/
+
+	return 1;
+}
+
 /**
 * @NO{S09E03C01}
 * @ASIL{B}
@@ -789,11 +1264,12 @@ static void gdc_subdev_process(struct vio_subdev *vdev)
 */
 void gdc_handle_interrupt(struct hobot_gdc_dev *gdc, u32 status)
 {
-	u32 ctx_id;
+	u32 i, ctx_id;
 	u32 gdc_status;
 	struct vio_node *vnode;
 	struct vio_subdev *vdev;
 	struct gdc_subdev *subdev;
+	struct gdc_batch *batch;
 	gdc_settings_t *setting;
 
 #ifdef CONFIG_HOBOT_VIO_STL
@@ -810,14 +1286,29 @@ void gdc_handle_interrupt(struct hobot_gdc_dev *gdc, u32 status)
 	gdc_status = gdc_get_status(gdc->base_reg);
 	vio_dbg("[S%d][C%d] %s: status 0x%x gdc_status = 0x%x\n", vnode->flow_id, ctx_id, __func__, status, gdc_status);
 
-	vio_frame_done(vnode->ich_subdev[0]);
-	if (gdc_check_status(gdc_status) == 0) {
-		if (osal_atomic_read(&setting->n_cur) == setting->n_in_one) {
+	batch = &subdev->batch;
+	if (batch->run != 0u) {
+		if (gdc_batch_next(gdc, subdev, gdc_status) != 0u)
+			return;
+		/* one completion of the output frame for the whole job */
+		for (i = 0; i < batch->attr.slice_num; i++)
+			vio_frame_done(vnode->ich_subdev[0]);
+		if (batch->err == 0u) {
 			vio_frame_done(vnode->och_subdev[0]);
-			osal_atomic_set(&setting->n_cur, 0);
+		} else {
+			vio_frame_ndone(vnode->och_subdev[0]);
 		}
+		batch->run = 0;
 	} else {
-		vio_frame_ndone(vnode->och_subdev[0]);
+		vio_frame_done(vnode->ich_subdev[0]);
+		if (gdc_check_status(gdc_status) == 0) {
+			if (osal_atomic_read(&setting->n_cur) == setting->n_in_one) {
+				vio_frame_done(vnode->och_subdev[0]);
+				osal_atomic_set(&setting->n_cur, 0);
+			}
+		} else {
+			vio_frame_ndone(vnode->och_subdev[0]);
+		}
 	}
 
 	vio_set_stat_info(vnode->flow_id, GDC_MODULE, STAT_FE, vnode->frameid.frame_id);
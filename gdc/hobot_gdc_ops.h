@@ -9,6 +9,8 @@
 #ifndef HOBOT_GDC_J5_OPS_API
 #define HOBOT_GDC_J5_OPS_API
 
+#include "hobot_gdc_ref.h"
+
 #define GDC_PROCESS_TIMEOUT		(100) /* < FTTI 132ms */
 #define GDC_LAYER_INDEX 37u
 
@@ -27,8 +29,8 @@
 #define YUV_PLANE_2 2u
 #define WAIT_TIMEOUT 5u
 
-#define GDC_MAX_WIDTH  3840u
-#define GDC_MAX_HEIGHT 3840u
+#define GDC_MAX_WIDTH  GDC_REF_MAX_WIDTH
+#define GDC_MAX_HEIGHT GDC_REF_MAX_HEIGHT
 
 s32 gdc_get_version(struct vio_version_info *version);
 s32 gdc_subdev_open(struct vio_video_ctx *vctx);
@@ -38,8 +40,13 @@ void gdc_handle_interrupt(struct hobot_gdc_dev *gdc, u32 gdc_status);
 void gdc_frame_work(struct vio_node *vnode);
 s32 gdc_allow_bind(struct vio_subdev *vdev, struct vio_subdev *remote_vdev, u8 online_mode);
 s32 gdc_setting_check(gdc_settings_t *gdc_cfg);
+void gdc_setting_to_ref(const gdc_settings_t *gdc_setting, struct gdc_ref_cfg *cfg);
 s32 gdc_iommu_map(struct gdc_subdev *subdev);
 void gdc_iommu_ummap(struct gdc_subdev *subdev);
+s32 gdc_batch_set_attr(struct gdc_subdev *subdev, const gdc_batch_attr_t *attr);
+void gdc_batch_get_attr(const struct gdc_subdev *subdev, gdc_batch_attr_t *attr);
+void gdc_bin_cache_flush(struct hobot_gdc_dev *gdc, void *iommu_dev);
+void gdc_bin_cache_get_stats(struct hobot_gdc_dev *gdc, struct gdc_bin_cache_stats *stats);
 void gdc_attr_trans_to_settings(gdc_attr_t *gdc_attr, gdc_ichn_attr_t *ichn_attr,
                     gdc_ochn_attr_t *ochn_attr, gdc_settings_t *gdc_setting);
 void gdc_settings_trans_to_attr(gdc_attr_t *gdc_attr, gdc_ichn_attr_t *ichn_attr,
@@ -0,0 +1,158 @@
+/**
+ * @file: hobot_gdc_ref.c
+ * @brief       gdc frame reference
+ * @details     check the settings and count the memory footprint of one gdc frame
+ * @copyright   Copyright (C) 2023 Horizon Robotics Inc.
+ * @NO{S09E03C01}
+ * @ASIL{B}
+ */
+
+#include "hobot_gdc_ref.h"
+
+static const char *g_gdc_ref_err_names[GDC_REF_E_NUM] = {
+	"config size",
+	"input size",
+	"output size",
+	"input stride",
+	"output stride",
+	"total planes",
+	"div",
+	"roi",
+};
+
+/* bytes of a plane: the div shift applies to the chroma planes only */
+static uint64_t gdc_ref_plane_bytes(uint32_t width, uint32_t height,
+			uint32_t div_w, uint32_t div_h, uint32_t plane)
+{
+	if (plane == 0u)
+		return (uint64_t)width * height;
+
+	return (uint64_t)(width >> div_w) * (height >> div_h);
+}
+
+/**
+* @NO{S09E03C01}
+* @ASIL{B}
+* @brief check the gdc frame settings as the hardware requires
+* @param[in] *cfg: gdc frame geometry
+* @retval "= 0": success
+* @retval "> 0": GDC_REF_E_* bits
+* @param[out] None
+* @data_read None
+* @data_updated None
+* @compatibility None
+* @callgraph
+* @callergraph
+* @design
+*/
+uint32_t gdc_ref_check(const struct gdc_ref_cfg *cfg)
+{
+	uint32_t err = GDC_REF_OK;
+
+	if ((cfg->config_size == 0u) || ((cfg->config_size % GDC_REF_CFG_WORD) != 0u))
+		err |= GDC_REF_E_CFG_SIZE;
+	if ((cfg->input_width == 0u) || (cfg->input_width > GDC_REF_MAX_WIDTH) ||
+	    (cfg->input_height == 0u) || (cfg->input_height > GDC_REF_MAX_HEIGHT))
+		err |= GDC_REF_E_IN_SIZE;
+	if ((cfg->output_width == 0u) || (cfg->output_width > GDC_REF_MAX_WIDTH) ||
+	    (cfg->output_height == 0u) || (cfg->output_height > GDC_REF_MAX_HEIGHT))
+		err |= GDC_REF_E_OUT_SIZE;
+	if (cfg->input_stride < cfg->input_width)
+		err |= GDC_REF_E_IN_STRIDE;
+	if (cfg->output_stride < cfg->output_width)
+		err |= GDC_REF_E_OUT_STRIDE;
+	if ((cfg->total_planes == 0u) || (cfg->total_planes > GDC_REF_MAX_PLANES))
+		err |= GDC_REF_E_PLANES;
+	if ((cfg->div_width > GDC_REF_MAX_DIV) || (cfg->div_height > GDC_REF_MAX_DIV))
+		err |= GDC_REF_E_DIV;
+
+	return err;
+}
+
+/**
+* @NO{S09E03C01}
+* @ASIL{B}
+* @brief check an output roi of a batch slice against the output of the batch frame
+* @param[in] *cfg: gdc frame geometry of the batch output, checked by gdc_ref_check
+* @param[in] *roi: output roi of the slice
+* @retval "= 0": success
+* @retval "> 0": GDC_REF_E_ROI
+* @param[out] None
+* @data_read None
+* @data_updated None
+* @compatibility None
+* @callgraph
+* @callergraph
+* @design
+*/
+uint32_t gdc_ref_roi_check(const struct gdc_ref_cfg *cfg, const struct gdc_ref_roi *roi)
+{
+	uint32_t align_w, align_h;
+
+	/* the roi starts on a chroma sample, nv12 interleaves uv in byte pairs */
+	align_w = (1u << cfg->div_width) - 1u;
+	align_h = (1u << cfg->div_height) - 1u;
+	if (cfg->total_planes == 2u)
+		align_w |= 1u;
+	if ((roi->width > cfg->output_width) || (roi->height > cfg->output_height) ||
+	    (roi->x > cfg->output_width - roi->width) ||
+	    (roi->y > cfg->output_height - roi->height) ||
+	    ((roi->x & align_w) != 0u) || ((roi->y & align_h) != 0u))
+		return GDC_REF_E_ROI;
+	/* nv12: an odd width would end the slice inside a uv pair of its neighbour */
+	if ((cfg->total_planes == 2u) && ((roi->width & 1u) != 0u))
+		return GDC_REF_E_ROI;
+
+	return GDC_REF_OK;
+}
+
+/* name of the lowest error bit */
+const char *gdc_ref_err_name(uint32_t err)
+{
+	uint32_t i;
+
+	for (i = 0u; i < GDC_REF_E_NUM; i++) {
+		if ((err & (1u << i)) != 0u)
+			return g_gdc_ref_err_names[i];
+	}
+
+	return "ok";
+}
+
+/**
+* @NO{S09E03C01}
+* @ASIL{B}
+* @brief count the memory footprint of one gdc frame
+* @param[in] *cfg: gdc frame geometry, checked by gdc_ref_check
+* @retval None
+* @param[out] *fp: memory footprint, byte
+* @data_read None
+* @data_updated None
+* @compatibility None
+* @callgraph
+* @callergraph
+* @design
+*/
+void gdc_ref_footprint(const struct gdc_ref_cfg *cfg, struct gdc_ref_footprint *fp)
+{
+	uint32_t i, planes;
+
+	planes = (cfg->total_planes < GDC_REF_MAX_PLANES) ? cfg->total_planes : GDC_REF_MAX_PLANES;
+	fp->cfg_bytes = cfg->config_size;
+	fp->rd_bytes = fp->cfg_bytes;
+	fp->wr_bytes = 0u;
+	for (i = 0u; i < GDC_REF_MAX_PLANES; i++) {
+		if (i < planes) {
+			fp->in_bytes[i] = gdc_ref_plane_bytes(cfg->input_width, cfg->input_height,
+					cfg->div_width, cfg->div_height, i);
+			fp->out_bytes[i] = gdc_ref_plane_bytes(cfg->output_width, cfg->output_height,
+					cfg->div_width, cfg->div_height, i);
+		} else {
+			fp->in_bytes[i] = 0u;
+			fp->out_bytes[i] = 0u;
+		}
+		fp->rd_bytes += fp->in_bytes[i];
+		fp->wr_bytes += fp->out_bytes[i];
+	}
+	fp->total_bytes = fp->rd_bytes + fp->wr_bytes;
+}
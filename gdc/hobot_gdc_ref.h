@@ -0,0 +1,79 @@
+/**
+ * @file: hobot_gdc_ref.h
+ * @
+ * @NO{S09E03C01}
+ * @ASIL{B}
+ * @Copyright (c) 2023 by horizon, All Rights Reserved.
+ */
+
+#ifndef HOBOT_GDC_REF_H
+#define HOBOT_GDC_REF_H
+
+/*
+ * gdc frame reference: the checks and the memory footprint of one gdc
+ * frame, pure integer without kernel dependency, so the same source
+ * may be built on host to pre-validate the settings of a config binary.
+ */
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+#define GDC_REF_MAX_WIDTH	3840u
+#define GDC_REF_MAX_HEIGHT	3840u
+#define GDC_REF_MAX_PLANES	3u
+#define GDC_REF_MAX_DIV		1u	/* nv12/yuv420 chroma shift */
+#define GDC_REF_CFG_WORD	4u	/* config binary size unit, byte */
+
+/* check error bits */
+#define GDC_REF_OK		(0u)
+#define GDC_REF_E_CFG_SIZE	(1u << 0)	/* config binary empty or not in words */
+#define GDC_REF_E_IN_SIZE	(1u << 1)	/* input resolution out of range */
+#define GDC_REF_E_OUT_SIZE	(1u << 2)	/* output resolution out of range */
+#define GDC_REF_E_IN_STRIDE	(1u << 3)	/* input stride less than width */
+#define GDC_REF_E_OUT_STRIDE	(1u << 4)	/* output stride less than width */
+#define GDC_REF_E_PLANES	(1u << 5)	/* total planes out of range */
+#define GDC_REF_E_DIV		(1u << 6)	/* chroma div out of range */
+#define GDC_REF_E_ROI		(1u << 7)	/* output roi out of frame or off the chroma grid */
+#define GDC_REF_E_NUM		(8u)
+
+/* gdc frame geometry, as gdc_config_t */
+struct gdc_ref_cfg {
+	uint32_t config_size;	/* config binary size, byte */
+	uint32_t input_width;
+	uint32_t input_height;
+	uint32_t input_stride;
+	uint32_t output_width;
+	uint32_t output_height;
+	uint32_t output_stride;
+	uint32_t div_width;
+	uint32_t div_height;
+	uint32_t total_planes;
+};
+
+/* output roi of a batch slice in the batch output frame, pixel */
+struct gdc_ref_roi {
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+};
+
+/* memory footprint of one gdc frame, byte */
+struct gdc_ref_footprint {
+	uint64_t cfg_bytes;			/* config binary fetch */
+	uint64_t in_bytes[GDC_REF_MAX_PLANES];	/* input planes read, lower bound */
+	uint64_t out_bytes[GDC_REF_MAX_PLANES];	/* output planes written */
+	uint64_t rd_bytes;			/* config + input */
+	uint64_t wr_bytes;			/* output */
+	uint64_t total_bytes;
+};
+
+uint32_t gdc_ref_check(const struct gdc_ref_cfg *cfg);
+uint32_t gdc_ref_roi_check(const struct gdc_ref_cfg *cfg, const struct gdc_ref_roi *roi);
+const char *gdc_ref_err_name(uint32_t err);
+void gdc_ref_footprint(const struct gdc_ref_cfg *cfg, struct gdc_ref_footprint *fp);
+
+#endif
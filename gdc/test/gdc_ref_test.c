@@ -0,0 +1,182 @@
+/**
+ * @file: gdc_ref_test.c
+ * @brief       host test of the gdc frame reference
+ * @details     every check rule on its edge, the footprint of the
+ *              planar layouts the driver accepts and the batch slice rois
+ * @copyright   Copyright (C) 2023 Horizon Robotics Inc.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "hobot_gdc_ref.h"
+
+struct ref_case {
+	const char *name;
+	struct gdc_ref_cfg cfg;
+	uint32_t err;		/* expected GDC_REF_E_* bits */
+	const char *err_name;	/* expected name of the lowest bit */
+	uint64_t rd_bytes;	/* expected footprint, 0: not checked */
+	uint64_t wr_bytes;
+};
+
+/* config_size, in w/h/stride, out w/h/stride, div w/h, planes */
+static const struct ref_case ref_cases[] = {
+	/* nv12: the uv plane is interleaved, so only its height is divided */
+	{ "1080p nv12", { 4096, 1920, 1080, 1920, 1920, 1080, 1920, 0, 1, 2 },
+		GDC_REF_OK, "ok", 4096u + 1920u * 1080u * 3u / 2u, 1920u * 1080u * 3u / 2u },
+	{ "1080p to 720p nv12 padded", { 8192, 1920, 1080, 2048, 1280, 720, 1280, 0, 1, 2 },
+		GDC_REF_OK, "ok", 8192u + 1920u * 1080u * 3u / 2u, 1280u * 720u * 3u / 2u },
+	{ "max 3840 yuv444", { 4, 3840, 3840, 3840, 3840, 3840, 3840, 0, 0, 3 },
+		GDC_REF_OK, "ok", 4u + 3840u * 3840u * 3u, 3840u * 3840u * 3u },
+	{ "odd size yuv420p", { 64, 1921, 1081, 1921, 1921, 1081, 1922, 1, 1, 3 },
+		GDC_REF_OK, "ok", 64u + 1921u * 1081u + 2u * 960u * 540u,
+		1921u * 1081u + 2u * 960u * 540u },
+	{ "y only", { 64, 640, 480, 640, 640, 480, 640, 1, 1, 1 },
+		GDC_REF_OK, "ok", 64u + 640u * 480u, 640u * 480u },
+	{ "no config", { 0, 1920, 1080, 1920, 1920, 1080, 1920, 1, 1, 2 },
+		GDC_REF_E_CFG_SIZE, "config size", 0, 0 },
+	{ "config not in words", { 4094, 1920, 1080, 1920, 1920, 1080, 1920, 1, 1, 2 },
+		GDC_REF_E_CFG_SIZE, "config size", 0, 0 },
+	{ "input width 0", { 4096, 0, 1080, 1920, 1920, 1080, 1920, 1, 1, 2 },
+		GDC_REF_E_IN_SIZE, "input size", 0, 0 },
+	{ "input height over", { 4096, 1920, 3841, 1920, 1920, 1080, 1920, 1, 1, 2 },
+		GDC_REF_E_IN_SIZE, "input size", 0, 0 },
+	{ "output width 0", { 4096, 1920, 1080, 1920, 0, 1080, 1920, 1, 1, 2 },
+		GDC_REF_E_OUT_SIZE, "output size", 0, 0 },
+	{ "output width over", { 4096, 1920, 1080, 1920, 3841, 1080, 3841, 1, 1, 2 },
+		GDC_REF_E_OUT_SIZE, "output size", 0, 0 },
+	{ "input stride short", { 4096, 1920, 1080, 1919, 1920, 1080, 1920, 1, 1, 2 },
+		GDC_REF_E_IN_STRIDE, "input stride", 0, 0 },
+	{ "output stride short", { 4096, 1920, 1080, 1920, 1920, 1080, 1918, 1, 1, 2 },
+		GDC_REF_E_OUT_STRIDE, "output stride", 0, 0 },
+	{ "no plane", { 4096, 1920, 1080, 1920, 1920, 1080, 1920, 1, 1, 0 },
+		GDC_REF_E_PLANES, "total planes", 0, 0 },
+	{ "4 planes", { 4096, 1920, 1080, 1920, 1920, 1080, 1920, 1, 1, 4 },
+		GDC_REF_E_PLANES, "total planes", 0, 0 },
+	{ "div 2", { 4096, 1920, 1080, 1920, 1920, 1080, 1920, 2, 1, 2 },
+		GDC_REF_E_DIV, "div", 0, 0 },
+	{ "all zero", { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+		GDC_REF_E_CFG_SIZE | GDC_REF_E_IN_SIZE | GDC_REF_E_OUT_SIZE | GDC_REF_E_PLANES,
+		"config size", 0, 0 },
+	{ "stride and div", { 4096, 1920, 1080, 1920, 1920, 1080, 1000, 1, 3, 2 },
+		GDC_REF_E_OUT_STRIDE | GDC_REF_E_DIV, "output stride", 0, 0 },
+};
+
+struct roi_case {
+	const char *name;
+	struct gdc_ref_cfg cfg;	/* batch output frame */
+	struct gdc_ref_roi roi;
+	uint32_t err;
+};
+
+/* x, y, width, height of a slice in a 1920x1080 batch output */
+static const struct roi_case roi_cases[] = {
+	{ "nv12 left half", { 4096, 960, 1080, 960, 1920, 1080, 1920, 0, 1, 2 },
+		{ 0, 0, 960, 1080 }, GDC_REF_OK },
+	{ "nv12 right bottom quarter", { 4096, 960, 540, 960, 1920, 1080, 1920, 0, 1, 2 },
+		{ 960, 540, 960, 540 }, GDC_REF_OK },
+	{ "nv12 whole frame", { 4096, 1920, 1080, 1920, 1920, 1080, 1920, 0, 1, 2 },
+		{ 0, 0, 1920, 1080 }, GDC_REF_OK },
+	/* div_width 0 for nv12, the uv pair still needs an even x and width */
+	{ "nv12 odd x", { 4096, 960, 1080, 960, 1920, 1080, 1920, 0, 1, 2 },
+		{ 959, 0, 960, 1080 }, GDC_REF_E_ROI },
+	{ "nv12 odd width", { 4096, 960, 1080, 960, 1920, 1080, 1920, 0, 1, 2 },
+		{ 0, 0, 959, 1080 }, GDC_REF_E_ROI },
+	{ "nv12 odd y", { 4096, 960, 540, 960, 1920, 1080, 1920, 0, 1, 2 },
+		{ 0, 539, 960, 540 }, GDC_REF_E_ROI },
+	{ "right edge over", { 4096, 960, 1080, 960, 1920, 1080, 1920, 0, 1, 2 },
+		{ 962, 0, 960, 1080 }, GDC_REF_E_ROI },
+	{ "bottom edge over", { 4096, 960, 540, 960, 1920, 1080, 1920, 0, 1, 2 },
+		{ 0, 542, 960, 540 }, GDC_REF_E_ROI },
+	{ "wider than frame", { 4096, 960, 1080, 960, 1920, 1080, 1920, 0, 1, 2 },
+		{ 0, 0, 1922, 1080 }, GDC_REF_E_ROI },
+	{ "x wraps", { 4096, 960, 1080, 960, 1920, 1080, 1920, 0, 1, 2 },
+		{ 0xfffffc40u, 0, 960, 1080 }, GDC_REF_E_ROI },
+	/* y only: any x and width */
+	{ "y only odd", { 64, 961, 1080, 961, 1920, 1080, 1920, 0, 0, 1 },
+		{ 959, 0, 961, 1080 }, GDC_REF_OK },
+	/* yuv420p: x on the div grid, the chroma width is rounded down as the footprint */
+	{ "yuv420p odd width", { 64, 961, 1080, 961, 1920, 1080, 1920, 1, 1, 3 },
+		{ 0, 0, 961, 1080 }, GDC_REF_OK },
+	{ "yuv420p odd x", { 64, 960, 1080, 960, 1920, 1080, 1920, 1, 1, 3 },
+		{ 1, 0, 960, 1080 }, GDC_REF_E_ROI },
+};
+
+static int roi_check(const struct roi_case *c)
+{
+	uint32_t err;
+
+	err = gdc_ref_roi_check(&c->cfg, &c->roi);
+	if (err != c->err) {
+		printf("FAIL %s: roi(%u, %u, %u*%u) err 0x%x(%s) expect 0x%x\n", c->name,
+			c->roi.x, c->roi.y, c->roi.width, c->roi.height, err,
+			gdc_ref_err_name(err), c->err);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int ref_check(const struct ref_case *c)
+{
+	uint32_t i, err;
+	uint64_t in_sum = 0, out_sum = 0;
+	struct gdc_ref_footprint fp;
+	int ret = 0;
+
+	err = gdc_ref_check(&c->cfg);
+	if (err != c->err || strcmp(gdc_ref_err_name(err), c->err_name) != 0) {
+		printf("FAIL %s: err 0x%x(%s) expect 0x%x(%s)\n", c->name, err,
+			gdc_ref_err_name(err), c->err, c->err_name);
+		ret = -1;
+	}
+
+	/* the footprint must hold together even for a rejected setting */
+	(void)memset(&fp, 0xa5, sizeof(fp));
+	gdc_ref_footprint(&c->cfg, &fp);
+	for (i = 0; i < GDC_REF_MAX_PLANES; i++) {
+		if (i >= c->cfg.total_planes && (fp.in_bytes[i] != 0u || fp.out_bytes[i] != 0u)) {
+			printf("FAIL %s: plane%u counted beyond %u planes\n", c->name, i,
+				c->cfg.total_planes);
+			ret = -1;
+		}
+		in_sum += fp.in_bytes[i];
+		out_sum += fp.out_bytes[i];
+	}
+	if (fp.cfg_bytes != c->cfg.config_size || fp.rd_bytes != fp.cfg_bytes + in_sum ||
+	    fp.wr_bytes != out_sum || fp.total_bytes != fp.rd_bytes + fp.wr_bytes) {
+		printf("FAIL %s: inconsistent footprint\n", c->name);
+		ret = -1;
+	}
+	if (c->rd_bytes != 0u && (fp.rd_bytes != c->rd_bytes || fp.wr_bytes != c->wr_bytes)) {
+		printf("FAIL %s: rd %llu wr %llu expect rd %llu wr %llu\n", c->name,
+			(unsigned long long)fp.rd_bytes, (unsigned long long)fp.wr_bytes,
+			(unsigned long long)c->rd_bytes, (unsigned long long)c->wr_bytes);
+		ret = -1;
+	}
+
+	return ret;
+}
+
+int main(void)
+{
+	uint32_t i, failed = 0, roi_failed;
+	uint32_t num = (uint32_t)(sizeof(ref_cases) / sizeof(ref_cases[0]));
+
+	for (i = 0; i < num; i++) {
+		if (ref_check(&ref_cases[i]) != 0)
+			failed++;
+	}
+
+	printf("gdc ref: %u cases, %u failed\n", num, failed);
+
+	num = (uint32_t)(sizeof(roi_cases) / sizeof(roi_cases[0]));
+	roi_failed = 0;
+	for (i = 0; i < num; i++) {
+		if (roi_check(&roi_cases[i]) != 0)
+			roi_failed++;
+	}
+	printf("gdc batch roi: %u cases, %u failed\n", num, roi_failed);
+
+	return (failed != 0u || roi_failed != 0u) ? 1 : 0;
+}
@@ -336,6 +336,19 @@ static ssize_t mipi_host_status_icnt_show(struct device *dev, /* PRQA S 3673 */
 	return ret;
 }
 
+/* sysfs show for mipi host devices' status/fstat */
+static ssize_t mipi_host_status_fstat_show(struct device *dev, /* PRQA S 3673 */ /* linux cb func */
+		struct device_attribute *attr, char *buf) /* PRQA S 3206 */ /* linux cb func */
+{
+	int ret = -EFAULT;
+	struct mipi_dhdev_s *dhdev = (struct mipi_dhdev_s *)dev_get_drvdata(dev);
+
+	if ((dhdev->ops != NULL) && (dhdev->ops->sys != NULL))
+		ret = dhdev->ops->sys(dhdev->port, MIPI_HOST_SYS_STATUS_FSTAT, MIPI_SYS_SHOW,
+			attr->attr.name, buf, PAGE_SIZE);
+	return ret;
+}
+
 /* sysfs attr for mipi host devices' status */
 /* PRQA S ALL ++ */ /* linux macro */
 static DEVICE_ATTR(clock, S_IRUGO, mipi_host_status_clock_show, NULL);
@@ -345,6 +358,7 @@ static DEVICE_ATTR(regs, S_IRUGO, mipi_host_status_regs_show, NULL);
 static DEVICE_ATTR(snrclk, S_IRUGO, mipi_host_status_snrclk_show, NULL);
 static DEVICE_ATTR(user, S_IRUGO, mipi_host_status_user_show, NULL);
 static DEVICE_ATTR(icnt, S_IRUGO, mipi_host_status_icnt_show, NULL);
+static DEVICE_ATTR(fstat, S_IRUGO, mipi_host_status_fstat_show, NULL);
 /* PRQA S ALL -- */
 
 static struct attribute *status_attr[] = {
@@ -355,6 +369,7 @@ static struct attribute *status_attr[] = {
 	&dev_attr_snrclk.attr,
 	&dev_attr_user.attr,
 	&dev_attr_icnt.attr,
+	&dev_attr_fstat.attr,
 	NULL,
 };
 
@@ -446,6 +461,88 @@ static const struct attribute_group fatal_attr_group = {
 	.attrs = fatal_attr,
 };
 
+/* sysfs show for mipi host devices' model */
+static ssize_t mipi_host_model_show(struct device *dev, /* PRQA S 3673 */ /* linux cb func */
+		struct device_attribute *attr, char *buf) /* PRQA S 3206 */ /* linux cb func */
+{
+	int ret = -EFAULT;
+	struct mipi_dhdev_s *dhdev = (struct mipi_dhdev_s *)dev_get_drvdata(dev);
+
+	if ((dhdev->ops != NULL) && (dhdev->ops->sys != NULL))
+		ret = dhdev->ops->sys(dhdev->port, MIPI_HOST_SYS_MODEL, MIPI_SYS_SHOW,
+			attr->attr.name, buf, PAGE_SIZE);
+	return ret;
+}
+
+/* sysfs store for mipi host devices' model */
+static ssize_t mipi_host_model_store(struct device *dev, /* PRQA S 3673 */ /* linux cb func */
+		struct device_attribute *attr, const char *buf, size_t count) /* PRQA S 3673 */ /* linux cb func */
+{
+	int ret = -EFAULT;
+	struct mipi_dhdev_s *dhdev = (struct mipi_dhdev_s *)dev_get_drvdata(dev);
+
+	if ((dhdev->ops != NULL) && (dhdev->ops->sys != NULL))
+		ret = dhdev->ops->sys(dhdev->port, MIPI_HOST_SYS_MODEL, MIPI_SYS_STORE,
+			attr->attr.name, (char *)buf, count);
+	return ret;
+}
+
+/* sysfs for mipi host devices' model */
+/* PRQA S ALL ++ */ /* linux macro */
+static DEVICE_ATTR(model, (S_IWUSR | S_IRUGO), mipi_host_model_show, mipi_host_model_store);
+/* PRQA S ALL -- */
+
+static struct attribute *model_attr[] = {
+	&dev_attr_model.attr,
+	NULL,
+};
+
+static const struct attribute_group model_attr_group = {
+	.name = NULL,
+	.attrs = model_attr,
+};
+
+/* sysfs show for mipi host devices' shadow */
+static ssize_t mipi_host_shadow_show(struct device *dev, /* PRQA S 3673 */ /* linux cb func */
+		struct device_attribute *attr, char *buf) /* PRQA S 3206 */ /* linux cb func */
+{
+	int ret = -EFAULT;
+	struct mipi_dhdev_s *dhdev = (struct mipi_dhdev_s *)dev_get_drvdata(dev);
+
+	if ((dhdev->ops != NULL) && (dhdev->ops->sys != NULL))
+		ret = dhdev->ops->sys(dhdev->port, MIPI_HOST_SYS_SHADOW, MIPI_SYS_SHOW,
+			attr->attr.name, buf, PAGE_SIZE);
+	return ret;
+}
+
+/* sysfs store for mipi host devices' shadow */
+static ssize_t mipi_host_shadow_store(struct device *dev, /* PRQA S 3673 */ /* linux cb func */
+		struct device_attribute *attr, const char *buf, size_t count) /* PRQA S 3673 */ /* linux cb func */
+{
+	int ret = -EFAULT;
+	struct mipi_dhdev_s *dhdev = (struct mipi_dhdev_s *)dev_get_drvdata(dev);
+
+	if ((dhdev->ops != NULL) && (dhdev->ops->sys != NULL))
+		ret = dhdev->ops->sys(dhdev->port, MIPI_HOST_SYS_SHADOW, MIPI_SYS_STORE,
+			attr->attr.name, (char *)buf, count);
+	return ret;
+}
+
+/* sysfs for mipi host devices' shadow */
+/* PRQA S ALL ++ */ /* linux macro */
+static DEVICE_ATTR(shadow, (S_IWUSR | S_IRUGO), mipi_host_shadow_show, mipi_host_shadow_store);
+/* PRQA S ALL -- */
+
+static struct attribute *shadow_attr[] = {
+	&dev_attr_shadow.attr,
+	NULL,
+};
+
+static const struct attribute_group shadow_attr_group = {
+	.name = NULL,
+	.attrs = shadow_attr,
+};
+
 #ifndef CONFIG_FAULT_INJECTION_ATTR
 /* sysfs show for mipi host devices' fault_injection */
 static ssize_t mipi_host_fault_injection_show(struct device *dev,
@@ -494,6 +591,8 @@ static const struct attribute_group *attr_groups[] = {
 	&param_attr_group,
 	&status_attr_group,
 	&fatal_attr_group,
+	&model_attr_group,
+	&shadow_attr_group,
 #ifndef CONFIG_FAULT_INJECTION_ATTR
 	&fault_injection_attr_group,
 #endif
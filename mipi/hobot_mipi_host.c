@@ -31,6 +31,7 @@
 #ifdef CONFIG_HOBOT_FUSA_DIAG
 EXPORT_SYMBOL_GPL(hobot_mipi_host_stl_setup_do); /* PRQA S 0307 */ /* EXPORT_SYMBOL_GPL macro */
 #endif
+EXPORT_SYMBOL_GPL(hobot_mipi_host_frame_event_do); /* PRQA S 0307 */ /* EXPORT_SYMBOL_GPL macro */
 
 /**
  * @NO{S10E03C01I}
@@ -242,6 +243,7 @@ static const struct mipi_sub_ops_s mipi_host_ops = {
 static irqreturn_t mipi_host_irq_func(int32_t this_irq, void *data)
 {
 	struct mipi_hdev_s *hdev = (struct mipi_hdev_s *)data;
+	int32_t pending;
 
 	if (hdev == NULL) {
 		return IRQ_NONE;
@@ -251,12 +253,43 @@ static irqreturn_t mipi_host_irq_func(int32_t this_irq, void *data)
 		disable_irq_nosync((uint32_t)this_irq);
 	}
 
-	hobot_mipi_host_irq_func_do(hdev);
+	pending = hobot_mipi_host_irq_func_do(hdev);
 
 	if (this_irq >= 0) {
 		enable_irq((uint32_t)this_irq);
 	}
 
+	return (pending != 0) ? IRQ_WAKE_THREAD : IRQ_HANDLED;
+}
+
+/**
+ * @NO{S10E03C01I}
+ * @ASIL{B}
+ * @brief mipi host(rx) device interrupt thread: print and callback
+ *
+ * @param[in] this_irq: mipi host(rx) irq number
+ * @param[in] data: mipi host(rx) device struct
+ *
+ * @return IRQ_HANDLED:Success, IRQ_NONE:Failure
+ *
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ *
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static irqreturn_t mipi_host_irq_thread(int32_t this_irq, void *data)
+{
+	struct mipi_hdev_s *hdev = (struct mipi_hdev_s *)data;
+
+	if (hdev == NULL) {
+		return IRQ_NONE;
+	}
+
+	hobot_mipi_host_irq_thread_do(hdev);
+
 	return IRQ_HANDLED;
 }
 
@@ -419,8 +452,8 @@ static int32_t hobot_mipi_host_probe_irq_init(struct platform_device *pdev, stru
 		return -ENODEV;
 	}
 
-	ret = devm_request_irq(&pdev->dev, (uint32_t)host->irq,
-				mipi_host_irq_func,
+	ret = devm_request_threaded_irq(&pdev->dev, (uint32_t)host->irq,
+				mipi_host_irq_func, mipi_host_irq_thread,
 #ifdef MIPI_HOST_J5_CIMDMA_OPTIMIZE
 				/* no thread for RT if cimdma optimize */
 				IRQF_TRIGGER_HIGH + IRQF_NO_THREAD,
@@ -141,7 +141,7 @@ typedef struct mipi_host_cfg_s {
  * @cfg_nocheck: disable config check function.
  * @drop_func:	frame drop when error function select stl/irq: Range: 0:1.
  * @drop_mask:	disable mask of error type for frame drop function.
- * @irq_cnt:	irq count limit set.
+ * @irq_cnt:	irq count limit in a second, more irqs mask the error irqs for a while.
  * @irq_debug:	irq debug print level.
  * @stl_dbg:	stl debug print level.
  * @stl_mask:	stl function mask.
@@ -289,6 +289,68 @@ typedef struct mipi_host_reg_s {
 	uint32_t value;
 } mipi_host_reg_t;
 
+#define MIPIHOST_FSTAT_VC_NUM	(16)
+#define MIPIHOST_FSTAT_HIST_NUM	(16)
+
+/**
+ * struct mipi_host_fstat_vc_s - frame timing statistics of one virtual channel
+ * @NO{S10E03C01}
+ *
+ * @fs_cnt:		count of frame start.
+ * @fe_cnt:		count of frame end.
+ * @period_us:	the last frame period, FS to FS.
+ * @period_min_us:	the min frame period.
+ * @period_max_us:	the max frame period.
+ * @period_avg_us:	the average frame period.
+ * @jitter_us:	the last frame period diff to the nominal period of fps.
+ * @jitter_max_us:	the max jitter.
+ * @active_us:	the last frame active time, FS to FE.
+ * @frame_bytes:	bytes per frame from config width, height and bpp.
+ * @bytes:		total bytes received, frame_bytes per FE.
+ * @bps:		bytes per second estimated from frame_bytes and period_avg_us.
+ * @phist:		period histogram, bucket n: [n, n+1) * nominal/8, the last: over.
+ * @jhist:		jitter histogram, bucket n: [2^n - 1, 2^(n+1) - 1) us, the last: over.
+ */
+typedef struct mipi_host_fstat_vc_s {
+	uint32_t fs_cnt;
+	uint32_t fe_cnt;
+	uint32_t period_us;
+	uint32_t period_min_us;
+	uint32_t period_max_us;
+	uint32_t period_avg_us;
+	uint32_t jitter_us;
+	uint32_t jitter_max_us;
+	uint32_t active_us;
+	uint32_t frame_bytes;
+	uint64_t bytes;
+	uint64_t bps;
+	uint32_t phist[MIPIHOST_FSTAT_HIST_NUM];
+	uint32_t jhist[MIPIHOST_FSTAT_HIST_NUM];
+} mipi_host_fstat_vc_t;
+
+/**
+ * struct mipi_host_fstat_s - frame timing statistics snapshot of mipi host
+ * @NO{S10E03C01}
+ *
+ * @vc_mask:		bit mask of vc configured by channel_sel.
+ * @nominal_us:	the nominal frame period of config fps.
+ * @link_bps:		link capacity in bytes per second of config mipiclk.
+ * @util:		link utilisation of all vc, unit: permille.
+ * @vc:			statistics of each vc.
+ */
+typedef struct mipi_host_fstat_s {
+	uint32_t vc_mask;
+	uint32_t nominal_us;
+	uint64_t link_bps;
+	uint32_t util;
+	uint32_t reserved;
+	mipi_host_fstat_vc_t vc[MIPIHOST_FSTAT_VC_NUM];
+} mipi_host_fstat_t;
+
+/* frame event of hobot_mipi_host_frame_event */
+#define MIPIHOST_FRAME_START	(0U)
+#define MIPIHOST_FRAME_END	(1U)
+
 #define MIPIHOSTIOC_MAGIC 'v'
 #define MIPIHOSTIOC_INIT             _IOW(MIPIHOSTIOC_MAGIC, 0, mipi_host_cfg_t)
 #define MIPIHOSTIOC_DEINIT           _IO(MIPIHOSTIOC_MAGIC,  1)
@@ -308,5 +370,6 @@ typedef struct mipi_host_reg_s {
 
 #define MIPIHOSTIOC_READ		     _IOWR(MIPIHOSTIOC_MAGIC, 16, mipi_host_reg_t)
 #define MIPIHOSTIOC_WRITE		     _IOW(MIPIHOSTIOC_MAGIC, 17, mipi_host_reg_t)
+#define MIPIHOSTIOC_GET_FSTAT        _IOR(MIPIHOSTIOC_MAGIC, 18, mipi_host_fstat_t)
 
 #endif /*__HOBOT_MIPI_HOST_H__*/
@@ -84,7 +84,9 @@ static irqreturn_t mipi_host_irq_func(int32_t this_irq, void *data)
 		disable_irq_nosync((uint32_t)this_irq);
 	}
 
-	hobot_mipi_host_irq_func_do(hdev);
+	if (hobot_mipi_host_irq_func_do(hdev) != 0) {
+		hobot_mipi_host_irq_thread_do(hdev);
+	}
 
 	if (this_irq >= 0) {
 		enable_irq((uint32_t)this_irq);
@@ -0,0 +1,157 @@
+/*
+ * Horizon Robotics
+ *
+ *  Copyright (C) 2020 Horizon Robotics Inc.
+ *  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+/**
+ * @file hobot_mipi_host_model.c
+ *
+ * @NO{S10E03C01}
+ * @ASIL{B}
+ */
+
+#include "hobot_mipi_host_model.h"
+
+#define MIPI_MODEL_S_TO_NS	(1000000000ULL)
+#define MIPI_MODEL_MHZ		(1000000ULL)
+#define MIPI_MODEL_PERMILLE	(1000LL)
+#define MIPI_MODEL_HSD_MAX	(4095U)
+#define MIPI_MODEL_BITS_BYTE	(8U)
+
+static uint32_t mipi_model_u32(uint64_t v)
+{
+	return (v > 0xffffffffULL) ? 0xffffffffU : (uint32_t)v;
+}
+
+static uint64_t mipi_model_min(uint64_t a, uint64_t b)
+{
+	return (a < b) ? a : b;
+}
+
+/**
+ * brief mipi_host_model_hsd : the hsd driver would select if not set
+ *
+ * the same rule as mipi_host_get_hsd: ipi line just longer than ppi line.
+ *
+ * return uint32_t
+ */
+static uint32_t mipi_host_model_hsd(const struct mipi_host_model_in_s *in,
+		uint64_t line_bytes, uint64_t link_bps)
+{
+	uint64_t ppi_cycles = line_bytes * MIPI_MODEL_BITS_BYTE * in->ipiclk / link_bps;
+	uint64_t other = (uint64_t)in->hsa + in->hbp + in->cycles;
+	uint64_t hsd = 1U;
+
+	if (ppi_cycles > other)
+		hsd = ppi_cycles - other + 1U;
+	return (uint32_t)mipi_model_min(hsd, MIPI_MODEL_HSD_MAX);
+}
+
+/**
+ * @NO{S10E03C01I}
+ * @ASIL{B}
+ * @brief predict the link bandwidth headroom, ipi fifo high-water and
+ * the max fps of a mipi host config
+ *
+ * @param[in] in: model input, see struct mipi_host_model_in_s
+ * @param[out] out: model output, see struct mipi_host_model_s
+ *
+ * @return MIPI_MODEL_OK:would not overflow, others:MIPI_MODEL_* bits
+ *
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ *
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+uint32_t mipi_host_model_calc(const struct mipi_host_model_in_s *in,
+		struct mipi_host_model_s *out)
+{
+	uint64_t link_bps, need_bps, line_bytes, frame_bytes, lines;
+	uint64_t ipi_cycles, line_ns, ppi_ns, ipi_ns, lag_ns;
+	uint64_t fps_frame, fps_line;
+	uint32_t verdict = MIPI_MODEL_OK;
+
+	if ((in == NULL) || (out == NULL))
+		return MIPI_MODEL_INVALID;
+
+	(void)memset((void *)out, 0, sizeof(*out));
+	if ((in->lane == 0U) || (in->mipiclk == 0U) || (in->width == 0U) ||
+	    (in->height == 0U) || (in->fps == 0U) || (in->bpp == 0U) ||
+	    (in->cycles == 0U) || (in->ipiclk == 0U)) {
+		out->verdict = MIPI_MODEL_INVALID;
+		return out->verdict;
+	}
+
+	/* link: LS + PH + payload + PF + LE per line, FS + FE per frame */
+	link_bps = (uint64_t)in->mipiclk * MIPI_MODEL_MHZ;
+	lines = (in->framelenth > in->height) ? in->framelenth : in->height;
+	line_bytes = ((uint64_t)in->width * in->bpp + MIPI_MODEL_BITS_BYTE - 1U) / MIPI_MODEL_BITS_BYTE +
+		in->long_pkt + ((in->lsle != 0U) ? (2U * MIPI_MODEL_SHORT_PKT_BYTES) : 0U);
+	frame_bytes = line_bytes * in->height + 2U * MIPI_MODEL_SHORT_PKT_BYTES;
+	need_bps = frame_bytes * MIPI_MODEL_BITS_BYTE * in->fps;
+	line_ns = MIPI_MODEL_S_TO_NS / ((uint64_t)in->fps * lines);
+	ppi_ns = line_bytes * MIPI_MODEL_BITS_BYTE * MIPI_MODEL_S_TO_NS / link_bps;
+
+	/* ipi: hsa + hbp + hsd + data cycles per line */
+	out->hsd = (in->hsd != 0U) ? in->hsd : mipi_host_model_hsd(in, line_bytes, link_bps);
+	ipi_cycles = (uint64_t)in->hsa + in->hbp + out->hsd + in->cycles;
+	ipi_ns = ipi_cycles * MIPI_MODEL_S_TO_NS / in->ipiclk;
+
+	/* fifo: bytes the ppi gets ahead while the ipi is still draining the line */
+	lag_ns = (ipi_ns > ppi_ns) ? (ipi_ns - ppi_ns) : 0U;
+	out->fifo_hw = mipi_model_u32(lag_ns * link_bps / MIPI_MODEL_BITS_BYTE / MIPI_MODEL_S_TO_NS);
+	out->fifo_bytes = in->fifo_bytes;
+
+	fps_frame = link_bps / (frame_bytes * MIPI_MODEL_BITS_BYTE);
+	fps_line = link_bps / (line_bytes * MIPI_MODEL_BITS_BYTE * lines);
+	out->fps_link = mipi_model_u32(mipi_model_min(fps_frame, fps_line));
+	out->fps_ipi = mipi_model_u32(in->ipiclk / (ipi_cycles * lines));
+	out->fps_max = (out->fps_link < out->fps_ipi) ? out->fps_link : out->fps_ipi;
+
+	out->link_bps = link_bps;
+	out->need_bps = need_bps;
+	out->headroom = (int32_t)(((int64_t)link_bps - (int64_t)need_bps) * MIPI_MODEL_PERMILLE /
+		(int64_t)link_bps);
+	out->line_bytes = mipi_model_u32(line_bytes);
+	out->line_ns = mipi_model_u32(line_ns);
+	out->ppi_ns = mipi_model_u32(ppi_ns);
+	out->ipi_ns = mipi_model_u32(ipi_ns);
+
+	if ((need_bps > link_bps) || (ppi_ns > line_ns))
+		verdict |= MIPI_MODEL_LINK_OVER;
+	if (ipi_ns > line_ns)
+		verdict |= MIPI_MODEL_IPI_OVER;
+	if (out->fifo_hw > in->fifo_bytes)
+		verdict |= MIPI_MODEL_FIFO_OVER;
+	out->verdict = verdict;
+
+	return verdict;
+}
+
+/**
+ * brief mipi_host_model_verdict : name of the worst model verdict bit
+ *
+ * return const char *
+ */
+const char *mipi_host_model_verdict(uint32_t verdict)
+{
+	if ((verdict & MIPI_MODEL_INVALID) != 0U)
+		return "invalid";
+	if ((verdict & MIPI_MODEL_LINK_OVER) != 0U)
+		return "link overflow";
+	if ((verdict & MIPI_MODEL_IPI_OVER) != 0U)
+		return "ipi overflow";
+	if ((verdict & MIPI_MODEL_FIFO_OVER) != 0U)
+		return "fifo overflow";
+	return "ok";
+}
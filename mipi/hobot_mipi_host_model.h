@@ -0,0 +1,91 @@
+/*
+ * Horizon Robotics
+ *
+ *  Copyright (C) 2020 Horizon Robotics Inc.
+ *  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+/**
+ * @file hobot_mipi_host_model.h
+ *
+ * @NO{S10E03C01}
+ * @ASIL{B}
+ */
+
+#ifndef __HOBOT_MIPI_HOST_MODEL_H__
+#define __HOBOT_MIPI_HOST_MODEL_H__ /* PRQA S 0603 */ /* header file macro */
+
+/*
+ * csi-2 link/ipi timing model: pure integer, no kernel dependency,
+ * so it may be built and checked on host with the same source.
+ */
+#ifdef __KERNEL__
+#include <linux/types.h>
+#include <linux/string.h>
+#else
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/* csi-2 packet overhead, unit: byte */
+#define MIPI_MODEL_SHORT_PKT_BYTES	(4U)
+#define MIPI_MODEL_LONG_PKT_BYTES	(6U)
+
+/* model verdict bits */
+#define MIPI_MODEL_OK			(0U)
+#define MIPI_MODEL_LINK_OVER		(0x1U)	/* link bandwidth exceeded */
+#define MIPI_MODEL_IPI_OVER		(0x2U)	/* ipi can not drain a line in line period */
+#define MIPI_MODEL_FIFO_OVER		(0x4U)	/* ipi fifo high-water over depth, warning */
+#define MIPI_MODEL_INVALID		(0x8U)	/* input invalid, can not predict */
+/* the verdict bits which are sure to overflow in every line and should be rejected */
+#define MIPI_MODEL_REJECT		(MIPI_MODEL_LINK_OVER | MIPI_MODEL_IPI_OVER)
+
+/* model input: the link and ipi timing of one ipi channel */
+struct mipi_host_model_in_s {
+	uint32_t lane;		/* active data lanes */
+	uint32_t mipiclk;	/* link rate of all lanes, unit: Mbps */
+	uint32_t width;		/* active pixels per line */
+	uint32_t height;	/* active lines per frame */
+	uint32_t fps;		/* frame rate */
+	uint32_t linelenth;	/* total pixels per line, 0: width */
+	uint32_t framelenth;	/* total lines per frame, 0: height */
+	uint32_t bpp;		/* bits per pixel on link */
+	uint32_t long_pkt;	/* long packet overhead, unit: byte */
+	uint32_t lsle;		/* line start/end short packets enabled */
+	uint32_t cycles;	/* ipi cycles to transmit one line */
+	uint32_t hsa;		/* ipi hsa time, unit: ipi cycle */
+	uint32_t hbp;		/* ipi hbp time, unit: ipi cycle */
+	uint32_t hsd;		/* ipi hsd time, unit: ipi cycle, 0: auto */
+	uint32_t fifo_bytes;	/* ipi fifo depth, unit: byte */
+	uint64_t ipiclk;	/* ipi pixel clock, unit: Hz */
+};
+
+/* model output */
+struct mipi_host_model_s {
+	uint64_t link_bps;	/* link capacity */
+	uint64_t need_bps;	/* link bandwidth needed by the stream */
+	int32_t  headroom;	/* link headroom, unit: permille */
+	uint32_t line_bytes;	/* bytes per line on link, with overhead */
+	uint32_t line_ns;	/* line period from fps and framelenth */
+	uint32_t ppi_ns;	/* time to receive one line from ppi */
+	uint32_t ipi_ns;	/* time to transmit one line to ipi */
+	uint32_t hsd;		/* hsd used by model */
+	uint32_t fifo_hw;	/* ipi fifo high-water, unit: byte */
+	uint32_t fifo_bytes;	/* ipi fifo depth, unit: byte */
+	uint32_t fps_link;	/* max fps limited by link */
+	uint32_t fps_ipi;	/* max fps limited by ipi */
+	uint32_t fps_max;	/* max achievable fps */
+	uint32_t verdict;	/* MIPI_MODEL_* bits */
+};
+
+extern uint32_t mipi_host_model_calc(const struct mipi_host_model_in_s *in,
+		struct mipi_host_model_s *out);
+extern const char *mipi_host_model_verdict(uint32_t verdict);
+
+#endif /*__HOBOT_MIPI_HOST_MODEL_H__*/
@@ -18,6 +18,7 @@
  */
 
 #include <linux/pinctrl/consumer.h>
+#include <linux/delay.h>
 
 #include "hobot_mipi_host_ops.h"
 #include "hobot_mipi_host_regs.h"
@@ -1689,8 +1690,99 @@ static uint32_t mhost_getreg(const struct mipi_host_s *host, uint32_t offs)
 {
 	return mipi_getreg(host->iomem, offs);
 }
+
+/**
+ * brief mhost_shadow_index : shadow index of a host config register
+ *
+ * only the plain r/w config registers are shadowed: no reset, status,
+ * interrupt, phy test or self-clearing ones.
+ *
+ * return int32_t : index, -1 if not shadowed
+ */
+static int32_t mhost_shadow_index(uint32_t offs)
+{
+	switch (offs) {
+	case REG_MIPI_HOST_N_LANES:
+	case REG_MIPI_HOST_DATA_IDS_1:
+	case REG_MIPI_HOST_DATA_IDS_2:
+	case REG_MIPI_HOST_PHY_CFG:
+	case REG_MIPI_HOST_PHY_MODE:
+	case REG_MIPI_HOST_DATA_IDS_VC1:
+	case REG_MIPI_HOST_DATA_IDS_VC2:
+	case REG_MIPI_HOST_PPI_PG_PATTERN_VRES:
+	case REG_MIPI_HOST_PPI_PG_PATTERN_HRES:
+	case REG_MIPI_HOST_PPI_PG_CONFIG:
+	case REG_MIPI_HOST_IPI_MODE:
+	case REG_MIPI_HOST_IPI_VCID:
+	case REG_MIPI_HOST_IPI_DATA_TYPE:
+	case REG_MIPI_HOST_IPI_HSA_TIME:
+	case REG_MIPI_HOST_IPI_HBP_TIME:
+	case REG_MIPI_HOST_IPI_HSD_TIME:
+	case REG_MIPI_HOST_IPI_ADV_FEATURES:
+	case REG_MIPI_HOST_VC_EXTENSION:
+	case REG_MIPI_HOST_IPI2_MODE:
+	case REG_MIPI_HOST_IPI2_VCID:
+	case REG_MIPI_HOST_IPI2_DATA_TYPE:
+	case REG_MIPI_HOST_IPI2_HSA_TIME:
+	case REG_MIPI_HOST_IPI2_HBP_TIME:
+	case REG_MIPI_HOST_IPI2_HSD_TIME:
+	case REG_MIPI_HOST_IPI2_ADV_FEATURES:
+	case REG_MIPI_HOST_IPI3_MODE:
+	case REG_MIPI_HOST_IPI3_VCID:
+	case REG_MIPI_HOST_IPI3_DATA_TYPE:
+	case REG_MIPI_HOST_IPI3_HSA_TIME:
+	case REG_MIPI_HOST_IPI3_HBP_TIME:
+	case REG_MIPI_HOST_IPI3_HSD_TIME:
+	case REG_MIPI_HOST_IPI3_ADV_FEATURES:
+	case REG_MIPI_HOST_IPI4_MODE:
+	case REG_MIPI_HOST_IPI4_VCID:
+	case REG_MIPI_HOST_IPI4_DATA_TYPE:
+	case REG_MIPI_HOST_IPI4_HSA_TIME:
+	case REG_MIPI_HOST_IPI4_HBP_TIME:
+	case REG_MIPI_HOST_IPI4_HSD_TIME:
+	case REG_MIPI_HOST_IPI4_ADV_FEATURES:
+		return (int32_t)(offs >> 2);
+	default:
+		return -1;
+	}
+}
+
+/* invalidate all of the host register shadow, may be called in irq */
+static void mhost_shadow_invalidate(struct mipi_host_s *host)
+{
+	struct mipi_host_shadow_s *shadow = &host->shadow;
+	mipi_flags_t flags;
+
+	osal_spin_lock_irqsave(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+	(void)memset((void *)shadow->valid, 0, sizeof(shadow->valid));
+	osal_spin_unlock_irqrestore(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+}
+
 static void mhost_putreg(struct mipi_host_s *host, uint32_t offs, uint32_t val)
 {
+	struct mipi_host_shadow_s *shadow = &host->shadow;
+	int32_t idx = mhost_shadow_index(offs);
+	mipi_flags_t flags;
+	uint32_t skip = 0U;
+
+	if (idx >= 0) {
+		osal_spin_lock_irqsave(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+		if (shadow->enable != 0U) {
+			shadow->writes++;
+			if ((shadow->valid[idx] != 0U) && (shadow->val[idx] == val)) {
+				/* same value as hw: skip the write and the readback compare */
+				shadow->skips++;
+				skip = 1U;
+			} else {
+				shadow->val[idx] = val;
+				shadow->valid[idx] = 1U;
+			}
+		}
+		osal_spin_unlock_irqrestore(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+		if (skip != 0U) {
+			return;
+		}
+	}
 	mipi_putreg(host->iomem, offs, val);
 #ifdef CONFIG_HOBOT_FUSA_DIAG
 	/* read & compare */
@@ -2143,6 +2235,7 @@ static int32_t mipi_host_configure_ipi(struct mipi_hdev_s *hdev, const mipi_host
 			/* reset ipi */
 			mhost_putreg(host, REG_MIPI_HOST_IPI_SOFTRSTN, ~g_mh_ipireg[index][HOST_IPI_INFO_SOFTRSTN]);
 			mhost_putreg(host, REG_MIPI_HOST_IPI_SOFTRSTN, MIPI_HOST_ALLE_SOFTRSTN);
+			mhost_shadow_invalidate(host);
 
 			/* config ipi */
 			mhost_putreg(host, g_mh_ipireg[index][HOST_IPI_INFO_VC], (uint32_t)vcid);
@@ -2320,6 +2413,37 @@ static void mipi_host_configure_ppi_pg(struct mipi_hdev_s *hdev, mipi_host_cfg_t
 	return;
 }
 
+/**
+ * brief mipi_host_poll_wait: sleep before the next state poll
+ *
+ * the sleep starts from MIPI_HOST_POLL_US_MIN and doubles to MIPI_HOST_POLL_US_MAX,
+ * so a fast state change is seen soon and a slow one does not burn the cpu.
+ *
+ * param [in] param : run params for wait_ms and notimeout
+ * param [in] start_ns : the poll begin timestamp
+ * param [in/out] sleep_us : the sleep time of this poll, doubled for next
+ *
+ * return int32_t : 0-poll again, -1-timeout
+ */
+static int32_t mipi_host_poll_wait(const struct mipi_host_param_s *param,
+		uint64_t start_ns, uint32_t *sleep_us)
+{
+	if ((param->notimeout == 0U) &&
+		((osal_time_get_ns() - start_ns) > ((uint64_t)param->wait_ms * NSEC_PER_MSEC))) {
+		return -1;
+	}
+	usleep_range(*sleep_us, *sleep_us + (*sleep_us >> 1));
+	*sleep_us = min_t(uint32_t, *sleep_us << 1, MIPI_HOST_POLL_US_MAX);
+
+	return 0;
+}
+
+/* us from start_ns to now */
+static inline uint32_t mipi_host_elapsed_us(uint64_t start_ns)
+{
+	return (uint32_t)div_u64(osal_time_get_ns() - start_ns, NSEC_PER_USEC);
+}
+
 /**
  * brief mipi_host_enable_ppi_pg: enable/disable ppi pg of mipi host
  *
@@ -2334,22 +2458,22 @@ static int32_t mipi_host_enable_ppi_pg(struct mipi_hdev_s *hdev, mipi_host_cfg_t
 	struct mipi_host_param_s *param = &host->param;
 	const struct os_dev *dev = &hdev->osdev;
 	uint32_t enable_v = (enable != 0) ? MIPI_HOST_PPI_PG_ENABLE : MIPI_HOST_PPI_PG_DISABLE;
-        uint32_t ncount = 0U;
-        uint32_t status;
+	uint32_t sleep_us = MIPI_HOST_POLL_US_MIN;
+	uint64_t start_ns;
+	uint32_t status;
 	int32_t ret = 0;
 
 	mhost_putreg(host, REG_MIPI_HOST_PPI_PG_ENABLE, enable_v);
 	mipi_info(dev, "ppi_pg: %s\n",  (enable != 0) ? "enable" : "disable");
 	if (enable == 0) {
 		/* check innactive if disable */
+		start_ns = osal_time_get_ns();
 		do {
 			status = mhost_getreg(host, REG_MIPI_HOST_PPI_PG_STATUS);
 			if (status == 0U) {
 				break;
 			}
-			osal_mdelay(1); /* PRQA S 2877,2880 */ /* osal_mdelay macro */
-			ncount++;
-		} while ((param->notimeout != 0U) || (ncount <= param->wait_ms));
+		} while (mipi_host_poll_wait(param, start_ns, &sleep_us) == 0);
 		if (status != 0U) {
 			mipi_err(dev, "ppi_pg: disable status 0x%x timeout\n", status);
 			ret = -1;
@@ -2409,47 +2533,89 @@ static int32_t mipi_host_configure_check(const struct mipi_hdev_s *hdev, const m
 	return ret;
 }
 
+/* field index of mipi_host_cfg_t as mipi_host_cfg_name */
+#define MIPI_HOST_CFG_IDX(f)	((uint32_t)(offsetof(mipi_host_cfg_t, f) / sizeof(uint16_t)))
+
+/**
+ * brief mipi_host_configure_diff: configure fields diff.
+ *
+ * compares the two configures only, not the hw: the result is for the
+ * cmp and the changed fields log, the register writes are not reduced by it.
+ *
+ * param [in] scfg dcfg: mipi host configure
+ *
+ * return uint32_t: bit i set if field mipi_host_cfg_name[i] differs
+ */
+static uint32_t mipi_host_configure_diff(const mipi_host_cfg_t *scfg, const mipi_host_cfg_t *dcfg)
+{
+	mipi_host_cfg_union_t s, d;
+	uint32_t i, diff = 0U;
+
+	(void)memcpy((void *)&s.cfg, (const void *)scfg, sizeof(mipi_host_cfg_t));
+	(void)memcpy((void *)&d.cfg, (const void *)dcfg, sizeof(mipi_host_cfg_t));
+	for (i = 0U; i < (uint32_t)MIPI_HOST_CFG_NUM; i++) { /* qacfix: conversion */
+		if (s.val[i] != d.val[i]) {
+			diff |= (0x1U << i);
+		}
+	}
+
+	return diff;
+}
+
 /**
  * brief mipi_host_configure_cmp: configure compare.
  *
+ * phy and ppi_pg are not compared, hsa/hbp/hsd of 0 in dcfg as auto
+ * and channel_sel over channel_num are ignored.
+ *
  * param [in] scfg dcfg: mipi host configure
+ * param [out] pdiff: the fields differ, may be NULL
  *
  * return int32_t: 0/-1
  */
-static int32_t mipi_host_configure_cmp(const mipi_host_cfg_t *scfg, const mipi_host_cfg_t *dcfg)
+static int32_t mipi_host_configure_cmp(const mipi_host_cfg_t *scfg, const mipi_host_cfg_t *dcfg,
+		uint32_t *pdiff)
 {
-	uint32_t i;
+	uint32_t i, diff;
 
 	if ((scfg == NULL) || (dcfg == NULL)) {
 		/* do not need report */
 		return -1;
 	}
 
-	if ((scfg->lane != dcfg->lane) ||
-		(scfg->datatype != dcfg->datatype) ||
-		(scfg->fps != dcfg->fps) ||
-		(scfg->mclk != dcfg->mclk) ||
-		(scfg->mipiclk != dcfg->mipiclk) ||
-		(scfg->width != dcfg->width) ||
-		(scfg->height != dcfg->height) ||
-		(scfg->linelenth != dcfg->linelenth) ||
-		(scfg->framelenth != dcfg->framelenth) ||
-		(scfg->settle != dcfg->settle) ||
-		((dcfg->hsaTime != 0U) && (scfg->hsaTime != dcfg->hsaTime)) ||
-		((dcfg->hbpTime != 0U) && (scfg->hbpTime != dcfg->hbpTime)) ||
-		((dcfg->hsdTime != 0U) && (scfg->hsdTime != dcfg->hsdTime)) ||
-		(scfg->channel_num != dcfg->channel_num)) {
-		/* do not need report */
-		return -1;
+	diff = mipi_host_configure_diff(scfg, dcfg);
+	diff &= ~((0x1U << MIPI_HOST_CFG_IDX(phy)) | (0x1U << MIPI_HOST_CFG_IDX(ppi_pg)));
+	if (dcfg->hsaTime == 0U)
+		diff &= ~(0x1U << MIPI_HOST_CFG_IDX(hsaTime));
+	if (dcfg->hbpTime == 0U)
+		diff &= ~(0x1U << MIPI_HOST_CFG_IDX(hbpTime));
+	if (dcfg->hsdTime == 0U)
+		diff &= ~(0x1U << MIPI_HOST_CFG_IDX(hsdTime));
+	for (i = scfg->channel_num; i < (uint32_t)MIPIHOST_CHANNEL_NUM; i++) {
+		diff &= ~(0x1U << (MIPI_HOST_CFG_IDX(channel_sel) + i));
 	}
-	for (i = 0U; (i < scfg->channel_num) && (i < (uint32_t)MIPIHOST_CHANNEL_NUM); i++) {
-		if (scfg->channel_sel[i] != dcfg->channel_sel[i]) {
-			/* do not need report */
-			return -1;
-		}
+	if (pdiff != NULL) {
+		*pdiff = diff;
 	}
 
-	return 0;
+	return (diff != 0U) ? -1 : 0;
+}
+
+/* print the field names of a configure diff */
+static void mipi_host_configure_diff_show(const struct mipi_hdev_s *hdev, uint32_t diff)
+{
+	const struct os_dev *dev = &hdev->osdev;
+	char s[MIPI_HOST_CFG_DIFF_MAX];
+	int32_t l = 0;
+	uint32_t i;
+
+	s[0] = '\0';
+	for (i = 0U; (i < (uint32_t)MIPI_HOST_CFG_NUM) && (l < (MIPI_HOST_CFG_DIFF_MAX - 1)); i++) {
+		if ((diff & (0x1U << i)) != 0U) {
+			l += snprintf(&s[l], (MIPI_HOST_CFG_DIFF_MAX - l), " %s", mipi_host_cfg_name[i]);
+		}
+	}
+	mipi_info(dev, "config diff:%s\n", s);
 }
 
 /**
@@ -2504,6 +2670,7 @@ static void mipi_host_ipi_reset_do(struct mipi_hdev_s *hdev, int32_t ipi, uint32
 		mhost_putreg(host, reg_mode, ipi_mode);
 		mhost_putreg(host, REG_MIPI_HOST_IPI_SOFTRSTN, softrstn);
 	}
+	mhost_shadow_invalidate(host);
 }
 
 /**
@@ -3312,6 +3479,118 @@ static uint16_t mipi_host_get_hsd(struct mipi_hdev_s *hdev, mipi_host_cfg_t *cfg
 	return (uint16_t)hsd;
 }
 
+/**
+ * brief mipi_host_get_ppi_width: get the ppi width of config
+ *
+ * param [in] cfg : mipi host config's setting
+ *
+ * return uint32_t: MIPI_HOST_PPI_WIDTH_8BIT/MIPI_HOST_PPI_WIDTH_16BIT
+ */
+static uint32_t mipi_host_get_ppi_width(const struct mipi_hdev_s *hdev, const mipi_host_cfg_t *cfg)
+{
+	if (MIPI_VERSION_GE(hdev->host.iomem, MIPI_IP_VERSION_1P5) == 0)
+		return MIPI_HOST_PPI_WIDTH_8BIT;
+	if ((cfg->phy != 0U) || (cfg->ppi_pg != 0U) ||
+	    (cfg->mipiclk > (cfg->lane * HOST_DPHY_CLK_PPI8_MAX)))
+		return MIPI_HOST_PPI_WIDTH_16BIT;
+	return MIPI_HOST_PPI_WIDTH_8BIT;
+}
+
+/**
+ * brief mipi_host_model_fill: fill the timing model input as the driver would config
+ *
+ * param [in] cfg : a copy of mipi host config's setting, ipi timing filled here
+ * param [out] in : the model input
+ *
+ * return void
+ */
+static void mipi_host_model_fill(struct mipi_hdev_s *hdev, mipi_host_cfg_t *cfg,
+		struct mipi_host_model_in_s *in)
+{
+	const struct mipi_host_param_s *param = &hdev->host.param;
+	uint64_t ipiclk = (hdev->ipi_clock != 0UL) ? hdev->ipi_clock : MIPI_HOST_IPICLK_DEFAULT;
+	uint32_t ppi_width = mipi_host_get_ppi_width(hdev, cfg);
+	uint32_t bytes_per_hsclk = (ppi_width == MIPI_HOST_PPI_WIDTH_16BIT) ? 2U : 1U;
+	uint32_t yuv_cycle = (param->ipi_16bit != 0U) ? (uint32_t)MIPI_IPI16_YUV_CYCLE : (uint32_t)MIPI_IPI48_YUV_CYCLE;
+	uint32_t raw_pixel = (param->ipi_16bit != 0U) ? (uint32_t)MIPI_IPI16_RAW_PIXEL : (uint32_t)MIPI_IPI48_RAW_PIXEL;
+
+	(void)memset((void *)in, 0, sizeof(*in));
+	/* the hsd/hbp calls divide by these, a what-if config may leave them 0 */
+	if ((cfg->lane == 0U) || (cfg->mipiclk == 0U) || (cfg->fps == 0U) ||
+	    ((cfg->linelenth != 0U) && (cfg->framelenth == 0U)))
+		return;
+	in->lane = cfg->lane;
+	in->mipiclk = cfg->mipiclk;
+	in->width = cfg->width;
+	in->height = cfg->height;
+	in->fps = cfg->fps;
+	in->linelenth = cfg->linelenth;
+	in->framelenth = cfg->framelenth;
+	in->bpp = mipi_host_get_bpp(hdev, cfg);
+	in->long_pkt = (cfg->phy != 0U) ? (14U * cfg->lane + 2U + 2U * (cfg->lane - 1U)) : MIPI_MODEL_LONG_PKT_BYTES;
+	in->lsle = ((param->adv_value & MIPI_HOST_ADV_EN_LINE_START) != 0U) ? 1U : 0U;
+	/* hsa/hbp/hsd by the same calls as mipi_host_init_common, with the same ipi clock */
+	if ((param->cut_through & MIPI_HOST_CUT_HSD_LEGACY) != 0U) {
+		cfg->hsaTime = (cfg->hsaTime != 0U) ? cfg->hsaTime : (uint16_t)MIPI_HOST_HSATIME;
+		cfg->hbpTime = (cfg->hbpTime != 0U) ? cfg->hbpTime : (uint16_t)MIPI_HOST_HBPTIME;
+		cfg->hsdTime = (cfg->hsdTime != 0U) ? cfg->hsdTime :
+			(((param->cut_through & MIPI_HOST_CUT_THROUGH_EN) != 0U) ?
+				mipi_host_get_hsd_cutthrough(hdev, cfg, ipiclk) :
+				mipi_host_get_hsd_legacy(hdev, cfg, ipiclk));
+		if (cfg->datatype >= (uint16_t)MIPI_CSI2_DT_RAW_8)
+			in->cycles = ((uint32_t)cfg->width + raw_pixel - 1U) / raw_pixel;
+		else
+			in->cycles = (uint32_t)cfg->width * yuv_cycle;
+	} else {
+		cfg->hsaTime = (cfg->hsaTime != 0U) ? cfg->hsaTime : (uint16_t)MIPI_HOST_HSATIME_P;
+		cfg->hbpTime = (cfg->hbpTime != 0U) ? cfg->hbpTime : mipi_host_get_hbp(hdev, cfg, ppi_width);
+		cfg->hsdTime = (cfg->hsdTime != 0U) ? cfg->hsdTime : mipi_host_get_hsd(hdev, cfg, ppi_width);
+		/* raw moves MIPI_HOST_PIXELS_RAW pixels per ipi cycle, as the ipiclk is derived */
+		if (cfg->datatype >= (uint16_t)MIPI_CSI2_DT_RAW_8)
+			in->cycles = ((uint32_t)cfg->width + MIPI_HOST_PIXELS_RAW - 1U) / MIPI_HOST_PIXELS_RAW;
+		else
+			in->cycles = cfg->width;
+		/* raw20/24 split in two as mipi_host_get_bpp halves their bpp */
+		if (in->bpp != mipi_datatype2bpp(cfg->datatype))
+			in->cycles *= 2U;
+	}
+	in->hsa = cfg->hsaTime;
+	in->hbp = cfg->hbpTime;
+	in->hsd = cfg->hsdTime;
+	/* the same fifo depth as the hsd_max of mipi_host_get_hsd */
+	in->fifo_bytes = HOST_IPI_FIFO_DEPTH * HOST_BITS_PER_BYTE / bytes_per_hsclk;
+	in->ipiclk = ipiclk;
+}
+
+/**
+ * brief mipi_host_model_check: predict the config with timing model
+ *
+ * the ipi clock selected by mipi_host_init is used, or the driver default
+ * before any init, as mipi_host_get_hbp and mipi_host_get_hsd do.
+ *
+ * param [in] cfg : mipi host config's setting
+ * param [out] model : the model output
+ *
+ * return uint32_t: MIPI_MODEL_* bits
+ */
+static uint32_t mipi_host_model_check(struct mipi_hdev_s *hdev, const mipi_host_cfg_t *cfg,
+		struct mipi_host_model_s *model)
+{
+	struct os_dev *dev = &hdev->osdev;
+	const struct mipi_host_param_s *param = &hdev->host.param;
+	struct mipi_host_model_in_s in;
+	mipi_host_cfg_t mcfg;
+	uint32_t verdict;
+
+	(void)memcpy((void *)&mcfg, (const void *)cfg, sizeof(mipi_host_cfg_t));
+	mipi_host_model_fill(hdev, &mcfg, &in);
+	verdict = mipi_host_model_calc(&in, model);
+	mipi_dbg(param, dev, "model %s: headroom %d/1000 fifo %u/%u fps %u/%u\n",
+			mipi_host_model_verdict(verdict), model->headroom,
+			model->fifo_hw, model->fifo_bytes, cfg->fps, model->fps_max);
+	return verdict;
+}
+
 #if MIPI_HOST_INT_DBG
 /**
  * brief mipi_host_irq_enable : Enale mipi host IRQ
@@ -3484,23 +3763,28 @@ static void mipi_host_ipi_overflow_handle(struct mipi_host_s *host, uint32_t ipi
 		break;
 	}
 	mhost_putreg(host, REG_MIPI_HOST_IPI_SOFTRSTN, MIPI_HOST_ALLE_SOFTRSTN);
+	mhost_shadow_invalidate(host);
 }
 
+/**
+ * brief mipi_host_subirq_func: handle one sub irq in irq context
+ *
+ * the time critical operations(drop/ipi reset/stl) are done here, the print
+ * and the callback are deferred to the irq thread by ipend.
+ *
+ * param [in] struct mipi_hdev_s *hdev: host device
+ * param [in] const struct mipi_host_ireg_s *ireg: sub irq reg
+ *
+ * return uint32_t: sub irq status
+ */
 static uint32_t mipi_host_subirq_func(struct mipi_hdev_s *hdev, const struct mipi_host_ireg_s *ireg)
 {
 	struct mipi_host_s *host = &hdev->host;
 	struct mipi_host_param_s *param = &host->param;
-	struct os_dev *dev = &hdev->osdev;
+	struct mipi_host_ipend_s *ipend = &hdev->ipend;
 	uint32_t reg = ireg->reg_st;
 	uint32_t icnt_n = ireg->icnt_n;
 	uint32_t subirq;
-#if MIPI_HOST_INT_DBG_ERRSTR
-	char err_str[MIPI_HOST_INT_DBG_ERRBUF];
-#else
-	char err_str[1] = '\0';
-#endif
-	const char *err_op = "";
-	int32_t need_ipireset = 0;
 
 #if defined MIPI_HOST_INT_USE_TIMER && defined CONFIG_ARCH_ZYNQMP
 	if ((host->ap != 0) && (reg == REG_MIPI_HOST_INT_ST_AP_GENERIC)) {
@@ -3516,30 +3800,13 @@ static uint32_t mipi_host_subirq_func(struct mipi_hdev_s *hdev, const struct mip
 	}
 
 	if (subirq != 0U) {
-#if MIPI_HOST_INT_DBG_ERRSTR
-		mipi_host_subirq_parse_errstr(param->irq_debug, subirq, ireg, err_str, sizeof(err_str));
-#endif
+		ipend->subirq[icnt_n] |= subirq;
+		ipend->mask |= (uint32_t)(0x1UL << icnt_n);
 		if ((icnt_n >= MIPI_HOST_ICNT_IPI) && (icnt_n <= MIPI_HOST_ICNT_IPIE) &&
 			((subirq & MIPI_HOST_IREG_ERR_OVERFLOW) != 0U) && (param->ipi_overst != 0U)) {
-			err_op = " --> reset";
-			need_ipireset = 1;
-		}
-		if ((param->irq_debug & MIPI_HOST_IRQ_DEBUG_PRERR) != 0U) {
-			mipi_err(dev, "  %s: 0x%x%s%s\n",
-					g_mh_icnt_names[icnt_n], subirq, err_str, err_op);
-		} else {
-			mipi_dbg(param, dev, "  %s: 0x%x%s%s\n",
-					g_mh_icnt_names[icnt_n], subirq, err_str, err_op);
-		}
-
-		if (need_ipireset != 0) {
+			ipend->reset |= (uint32_t)(0x1UL << icnt_n);
 			mipi_host_ipi_overflow_handle(&hdev->host, icnt_n - MIPI_HOST_ICNT_IPI);
 		}
-
-		/* interrupt callbcak */
-		if (hdev->cb.int_cb != NULL) {
-			hdev->cb.int_cb(hdev->port, icnt_n, subirq);
-		}
 	}
 
 #ifdef CONFIG_HOBOT_FUSA_DIAG
@@ -3563,6 +3830,8 @@ static uint32_t mipi_host_subirq_func(struct mipi_hdev_s *hdev, const struct mip
 /**
  * brief mipi_host_subirq_loop: irq bit loop
  *
+ * only the set bits of st_main are visited, see: ierr->bit2ireg.
+ *
  * param [in] struct mipi_hdev_s *hdev: host device
  * param [in] uint32_t irq: irq st_main
  *
@@ -3574,10 +3843,9 @@ static uint32_t mipi_host_subirq_loop(struct mipi_hdev_s *hdev, uint32_t irq)
 	const struct mipi_host_ireg_s *ireg;
 	struct mipi_host_icnt_s *icnt = &hdev->host.icnt;
 	uint32_t *icnt_p = &icnt->st_main;
-	uint32_t mask, icnt_n;
 	uint32_t irq_do;
 	uint32_t subirq;
-	uint32_t i, valid_bits = 0U;
+	uint32_t bit, idx, valid_bits = 0U;
 
 	if(irq == 0U) {
 		return valid_bits;
@@ -3585,30 +3853,138 @@ static uint32_t mipi_host_subirq_loop(struct mipi_hdev_s *hdev, uint32_t irq)
 
 	irq_do = irq;
 	icnt->st_main++;
-	for (i = 0U; i < ierr->num; i++) {
-		ireg = &ierr->iregs[i];
-		mask = ireg->st_mask;
-		if ((irq_do & mask) == 0U) {
+	hdev->ipend.main |= irq;
+	while (irq_do != 0U) {
+		bit = (uint32_t)__ffs((unsigned long)irq_do);
+		irq_do &= ~(uint32_t)(0x1UL << bit);
+		idx = ierr->bit2ireg[bit];
+		if (idx == MIPI_HOST_IREG_NONE) {
 			continue;
 		}
 
+		ireg = &ierr->iregs[idx];
+		irq_do &= ~ireg->st_mask;
 		subirq = mipi_host_subirq_func(hdev, ireg);
 		if (subirq == 0U) {
-			irq_do &= ~mask;
 			continue;
 		}
 
-		icnt_n = ireg->icnt_n;
-		icnt_p[icnt_n]++;
+		icnt_p[ireg->icnt_n]++;
 		valid_bits++;
-		irq_do &= ~mask;
-		if (irq_do == 0U) {
-			break;
-		}
 	}
 	return valid_bits;
 }
 
+/**
+ * brief mipi_host_irq_storm_check: mask the error irqs for a while if too many
+ *
+ * more than param->irq_cnt irqs in MIPI_HOST_IRQ_STORM_MS is a storm, the irqs
+ * (except ipi if ipi_overst) are masked and restored by storm_timer, the mask
+ * time doubles for each storm in a row and resets after a quiet window.
+ *
+ * param [in] struct mipi_hdev_s *hdev: host device
+ *
+ * return void
+ */
+static void mipi_host_irq_storm_check(struct mipi_hdev_s *hdev)
+{
+	struct mipi_host_param_s *param = &hdev->host.param;
+	struct mipi_host_istorm_s *istorm = &hdev->istorm;
+	uint64_t now_ns = osal_time_get_ns();
+
+	if ((now_ns - istorm->start_ns) > ((uint64_t)MIPI_HOST_IRQ_STORM_MS * NSEC_PER_MSEC)) {
+		if (istorm->cnt <= param->irq_cnt) {
+			istorm->backoff_ms = 0U;
+		}
+		istorm->start_ns = now_ns;
+		istorm->cnt = 0U;
+	}
+	istorm->cnt++;
+	if ((istorm->cnt <= param->irq_cnt) || (istorm->enable == 0U)) {
+		return;
+	}
+
+	istorm->backoff_ms = (istorm->backoff_ms == 0U) ? MIPI_HOST_IRQ_BACKOFF_MIN :
+		min_t(uint32_t, istorm->backoff_ms * 2U, MIPI_HOST_IRQ_BACKOFF_MAX);
+	istorm->masked++;
+	istorm->cnt = 0U;
+	if (param->ipi_overst != 0U)
+		mipi_host_irq_disable_mask(hdev, ~MIPI_HOST_ICNT_IPI_MASK);
+	else
+		mipi_host_irq_disable(hdev);
+	osal_timer_start(&hdev->storm_timer, istorm->backoff_ms);
+}
+
+/**
+ * brief mipi_host_irq_storm_func: restore the irqs masked by storm
+ *
+ * param [in] osal_timer_t *t: storm_timer
+ *
+ * return void
+ */
+static void mipi_host_irq_storm_func(osal_timer_t *t)
+{
+	struct mipi_hdev_s *hdev = from_timer(hdev, t, storm_timer);
+	mipi_flags_t flags;
+
+	osal_spin_lock_irqsave(&hdev->ilock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+	if (hdev->istorm.enable != 0U) {
+		mipi_host_irq_enable(hdev);
+		hdev->istorm.start_ns = osal_time_get_ns();
+	}
+	osal_spin_unlock_irqrestore(&hdev->ilock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+}
+
+/**
+ * brief mipi_host_irq_storm_enable: enable/disable the irq with storm check
+ *
+ * param [in] struct mipi_hdev_s *hdev: host device
+ * param [in] uint32_t enable: 1-enable, 0-disable
+ *
+ * return void
+ */
+static void mipi_host_irq_storm_enable(struct mipi_hdev_s *hdev, uint32_t enable)
+{
+	mipi_flags_t flags;
+
+	osal_spin_lock_irqsave(&hdev->ilock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+	hdev->istorm.enable = enable;
+	hdev->istorm.start_ns = osal_time_get_ns();
+	hdev->istorm.cnt = 0U;
+	hdev->istorm.backoff_ms = 0U;
+	if (enable != 0U)
+		mipi_host_irq_enable(hdev);
+	else
+		mipi_host_irq_disable(hdev);
+	osal_spin_unlock_irqrestore(&hdev->ilock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+	if (enable == 0U)
+		(void)osal_timer_stop(&hdev->storm_timer);
+}
+
+/**
+ * brief mipi_host_ierr_bit_init: build the st_main bit to ireg table
+ *
+ * param [in] struct mipi_host_ierr_s *ierr: host interrupt error struct
+ *
+ * return void
+ */
+static void mipi_host_ierr_bit_init(struct mipi_host_ierr_s *ierr)
+{
+	uint32_t i, bit, mask;
+
+	(void)memset((void *)ierr->bit2ireg, (int32_t)MIPI_HOST_IREG_NONE, sizeof(ierr->bit2ireg));
+	for (i = 0U; (i < ierr->num) && (i < MIPI_HOST_IREG_NONE); i++) {
+		mask = ierr->iregs[i].st_mask;
+		while (mask != 0U) {
+			bit = (uint32_t)__ffs((unsigned long)mask);
+			mask &= ~(uint32_t)(0x1UL << bit);
+			if (ierr->bit2ireg[bit] == MIPI_HOST_IREG_NONE) {
+				ierr->bit2ireg[bit] = (uint8_t)i;
+			}
+		}
+	}
+}
+
 /**
  * @NO{S10E03C01I}
  * @ASIL{B}
@@ -3616,6 +3992,7 @@ static uint32_t mipi_host_subirq_loop(struct mipi_hdev_s *hdev, uint32_t irq)
  *
  * @param[in] hdev: mipi host(rx) device struct
  *
+ * @return 0: nothing to do, 1: need run hobot_mipi_host_irq_thread_do
  *
  * @data_read None
  * @data_updated None
@@ -3625,48 +4002,120 @@ static uint32_t mipi_host_subirq_loop(struct mipi_hdev_s *hdev, uint32_t irq)
  * @callergraph
  * @design
  */
-void hobot_mipi_host_irq_func_do(struct mipi_hdev_s *hdev)
+int32_t hobot_mipi_host_irq_func_do(struct mipi_hdev_s *hdev)
 {
-	const struct os_dev *dev;
 	struct mipi_host_s *host;
 	struct mipi_host_ierr_s *ierr;
-	struct mipi_host_param_s *param;
-	struct mipi_host_icnt_s *icnt;
 	void __iomem *iomem;
+	mipi_flags_t flags;
 	uint32_t irq;
+	int32_t pending;
 
 	if (hdev == NULL) {
-		return;
+		return 0;
 	}
-	dev = &hdev->osdev;
 	host = &hdev->host;
 	iomem = host->iomem;
 	if (iomem == NULL) {
 		mipi_host_error_report(hdev, ESW_MipiHostIomemErr, SUB_ID_10, 0U, __LINE__);
-		return;
+		return 0;
 	}
 	ierr = &host->ierr;
-	param = &host->param;
-	icnt = &host->icnt;
 
 #ifdef MIPI_HOST_INT_USE_TIMER
 	irq = hdev->irq_st_main;
 #else
 	irq = mhost_getreg(host, ierr->st_main);
 #endif
+
+	osal_spin_lock_irqsave(&hdev->ilock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+	(void)mipi_host_subirq_loop(hdev, irq);
+	if (irq != 0U) {
+		mipi_host_irq_storm_check(hdev);
+	}
+	pending = (hdev->ipend.main != 0U) ? 1 : 0;
+	osal_spin_unlock_irqrestore(&hdev->ilock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+
+	return pending;
+}
+
+/**
+ * @NO{S10E03C01I}
+ * @ASIL{B}
+ * @brief mipi host(rx) irq thread fucntion: print and callback of the sub irqs
+ *
+ * @param[in] hdev: mipi host(rx) device struct
+ *
+ * @return void
+ *
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ *
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void hobot_mipi_host_irq_thread_do(struct mipi_hdev_s *hdev)
+{
+	const struct os_dev *dev;
+	struct mipi_host_s *host;
+	struct mipi_host_param_s *param;
+	struct mipi_host_ierr_s *ierr;
+	struct mipi_host_ipend_s ipend;
+	mipi_flags_t flags;
+	uint32_t i, icnt_n, subirq;
+#if MIPI_HOST_INT_DBG_ERRSTR
+	char err_str[MIPI_HOST_INT_DBG_ERRBUF];
+#else
+	char err_str[1] = { '\0' };
+#endif
+	const char *err_op;
+
+	if (hdev == NULL) {
+		return;
+	}
+	dev = &hdev->osdev;
+	host = &hdev->host;
+	param = &host->param;
+	ierr = &host->ierr;
+
+	osal_spin_lock_irqsave(&hdev->ilock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+	ipend = hdev->ipend;
+	(void)memset((void *)&hdev->ipend, 0, sizeof(hdev->ipend));
+	osal_spin_unlock_irqrestore(&hdev->ilock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+
+	if (ipend.main == 0U) {
+		return;
+	}
 	if ((param->irq_debug & MIPI_HOST_IRQ_DEBUG_PRERR) != 0U) {
-		mipi_err(dev, "irq%s status 0x%x\n", (host->ap != 0) ? " ap" : "", irq);
+		mipi_err(dev, "irq%s status 0x%x\n", (host->ap != 0) ? " ap" : "", ipend.main);
 	} else {
-		mipi_dbg(param, dev, "irq%s status 0x%x\n", (host->ap != 0) ? " ap" : "", irq);
+		mipi_dbg(param, dev, "irq%s status 0x%x\n", (host->ap != 0) ? " ap" : "", ipend.main);
 	}
 
-	(void)mipi_host_subirq_loop(hdev, irq);
+	for (i = 0U; i < ierr->num; i++) {
+		icnt_n = ierr->iregs[i].icnt_n;
+		if ((ipend.mask & (uint32_t)(0x1UL << icnt_n)) == 0U) {
+			continue;
+		}
+		subirq = ipend.subirq[icnt_n];
+#if MIPI_HOST_INT_DBG_ERRSTR
+		mipi_host_subirq_parse_errstr(param->irq_debug, subirq, &ierr->iregs[i], err_str, sizeof(err_str));
+#endif
+		err_op = ((ipend.reset & (uint32_t)(0x1UL << icnt_n)) != 0U) ? " --> reset" : "";
+		if ((param->irq_debug & MIPI_HOST_IRQ_DEBUG_PRERR) != 0U) {
+			mipi_err(dev, "  %s: 0x%x%s%s\n",
+					g_mh_icnt_names[icnt_n], subirq, err_str, err_op);
+		} else {
+			mipi_dbg(param, dev, "  %s: 0x%x%s%s\n",
+					g_mh_icnt_names[icnt_n], subirq, err_str, err_op);
+		}
 
-	if (icnt->st_main > param->irq_cnt) {
-		if (param->ipi_overst != 0U)
-			mipi_host_irq_disable_mask(hdev, ~MIPI_HOST_ICNT_IPI_MASK);
-		else
-			mipi_host_irq_disable(hdev);
+		/* interrupt callbcak */
+		if (hdev->cb.int_cb != NULL) {
+			hdev->cb.int_cb(hdev->port, icnt_n, subirq);
+		}
 	}
 
 	return;
@@ -3702,8 +4151,8 @@ void mipi_host_irq_timer_func(osal_timer_t *t)
 			}
 		}
 #endif
-		if (hdev->irq_st_main != 0U) {
-			mipi_host_irq_func(-1, hdev);
+		if ((hdev->irq_st_main != 0U) && (hobot_mipi_host_irq_func_do(hdev) != 0)) {
+			hobot_mipi_host_irq_thread_do(hdev);
 		}
 		osal_timer_start(&hdev->irq_timer, 10);
 	} else {
@@ -3719,7 +4168,8 @@ static int32_t mipi_host_dphy_wait_stop(struct mipi_hdev_s *hdev, const mipi_hos
 	struct mipi_host_s *host = &hdev->host;
 	struct mipi_host_param_s *param = &host->param;
 	void __iomem *iomem = host->iomem;
-	uint32_t ncount = 0U;
+	uint32_t sleep_us = MIPI_HOST_POLL_US_MIN;
+	uint64_t start_ns;
 	uint32_t stopstate;
 
 	if (iomem == NULL) {
@@ -3733,6 +4183,7 @@ static int32_t mipi_host_dphy_wait_stop(struct mipi_hdev_s *hdev, const mipi_hos
 
 	mipi_info(dev, "check phy stop state\n");
 	/*Check that data lanes are in Stop state*/
+	start_ns = osal_time_get_ns();
 	do {
 		stopstate = mhost_getreg(host, REG_MIPI_HOST_PHY_STOPSTATE);
 #ifdef X5_CHIP
@@ -3743,11 +4194,10 @@ static int32_t mipi_host_dphy_wait_stop(struct mipi_hdev_s *hdev, const mipi_hos
 #ifdef CONFIG_MIPI_CSI_STL_PILE_ENABLE
 			(void)mipi_csi_stl_phychk(&host->stl, cfg->lane, MIPI_CSI_PILE_PHYCHK);
 #endif
+			hdev->ptime.stop_us = mipi_host_elapsed_us(start_ns);
 			return 0;
 		}
-		osal_mdelay(1); /* PRQA S 2877,2880 */ /* osal_mdelay macro */
-		ncount++;
-	} while ((param->notimeout != 0U) || (ncount <= param->wait_ms));
+	} while (mipi_host_poll_wait(param, start_ns, &sleep_us) == 0);
 
 #ifdef CONFIG_HOBOT_FUSA_DIAG
 	(void)mipi_csi_stl_phychk(&host->stl, cfg->lane, 0);
@@ -3770,7 +4220,8 @@ static int32_t mipi_host_dphy_start_hs_reception(struct mipi_hdev_s *hdev)
 	struct mipi_host_s *host = &hdev->host;
 	struct mipi_host_param_s *param;
 	void __iomem *iomem = host->iomem;
-	uint16_t ncount = 0;
+	uint32_t sleep_us = MIPI_HOST_POLL_US_MIN;
+	uint64_t start_ns;
 	uint32_t state;
 	int32_t poth;
 
@@ -3794,19 +4245,22 @@ static int32_t mipi_host_dphy_start_hs_reception(struct mipi_hdev_s *hdev)
 		param = &host->param;
 	}
 	/*Check that clock lane is in HS mode*/
+	start_ns = osal_time_get_ns();
 	do {
 		state = mhost_getreg(host, REG_MIPI_HOST_PHY_RX);
 		if ((state & HOST_DPHY_RX_HS) == HOST_DPHY_RX_HS) {
-			mipi_info(dev, "entry hs reception\n");
+			hdev->ptime.hs_us = mipi_host_elapsed_us(start_ns);
+			if (hdev->ptime.init_ns != 0U) {
+				hdev->ptime.ready_us = mipi_host_elapsed_us(hdev->ptime.init_ns);
+			}
+			mipi_info(dev, "entry hs reception %uus\n", hdev->ptime.hs_us);
 #ifdef CONFIG_HOBOT_FUSA_DIAG
 			(void)mipi_csi_stl_phychk(&host->stl, host->cfg.lane,
 				(uint32_t)(host->cfg.mipiclk) / host->cfg.lane);
 #endif
 			return 0;
 		}
-		ncount++;
-		osal_mdelay(1); /* PRQA S 2877,2880 */ /* osal_mdelay macro */
-	} while ((param->notimeout != 0U) || (ncount <= param->wait_ms));
+	} while (mipi_host_poll_wait(param, start_ns, &sleep_us) == 0);
 
 #ifdef CONFIG_HOBOT_FUSA_DIAG
 	(void)mipi_csi_stl_phychk(&host->stl, host->cfg.lane, 1);
@@ -3816,6 +4270,163 @@ static int32_t mipi_host_dphy_start_hs_reception(struct mipi_hdev_s *hdev)
 	return -1;
 }
 
+/**
+ * brief mipi_host_fstat_reset : reset the frame timing statistics with config
+ *
+ * param [in] hdev : mipi host device struct
+ *
+ * return void
+ */
+static void mipi_host_fstat_reset(struct mipi_hdev_s *hdev)
+{
+	mipi_host_cfg_t *cfg = &hdev->host.cfg;
+	struct mipi_host_frame_s *frame = &hdev->frame;
+	uint32_t frame_bytes, vc_mask = 0U, i;
+	mipi_flags_t flags;
+
+	frame_bytes = (uint32_t)((uint64_t)cfg->width * cfg->height *
+			mipi_host_get_bpp(hdev, cfg) / HOST_BITS_PER_BYTE);
+	for (i = 0U; (i < cfg->channel_num) && (i < (uint32_t)MIPIHOST_CHANNEL_NUM); i++)
+		vc_mask |= (uint32_t)1U << (cfg->channel_sel[i] % (uint32_t)MIPIHOST_FSTAT_VC_NUM);
+
+	osal_spin_lock_irqsave(&hdev->flock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+	(void)memset((void *)frame, 0, sizeof(*frame));
+	frame->vc_mask = vc_mask;
+	frame->nominal_us = (cfg->fps != 0U) ? ((uint32_t)HOST_S_TO_US / cfg->fps) : 0U;
+	frame->link_bps = (uint64_t)cfg->mipiclk * MIPI_HOST_FREQ_MHZ / HOST_BITS_PER_BYTE;
+	for (i = 0U; i < (uint32_t)MIPIHOST_FSTAT_VC_NUM; i++)
+		frame->vc[i].st.frame_bytes = frame_bytes;
+	osal_spin_unlock_irqrestore(&hdev->flock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+}
+
+/**
+ * brief mipi_host_fstat_period : update period and jitter of one vc, flock held
+ *
+ * param [in] frame : frame timing statistics
+ * param [in] fvc : frame timing state of the vc
+ * param [in] us : frame period, FS to FS
+ *
+ * return void
+ */
+static void mipi_host_fstat_period(const struct mipi_host_frame_s *frame,
+		struct mipi_host_fvc_s *fvc, uint32_t us)
+{
+	mipi_host_fstat_vc_t *st = &fvc->st;
+	uint32_t nominal = frame->nominal_us;
+	uint32_t jitter = 0U;
+	uint32_t n;
+
+	st->period_us = us;
+	if ((st->period_min_us == 0U) || (us < st->period_min_us))
+		st->period_min_us = us;
+	if (us > st->period_max_us)
+		st->period_max_us = us;
+	fvc->period_sum_us += us;
+	fvc->periods++;
+
+	if (nominal != 0U) {
+		n = (uint32_t)((uint64_t)us * (MIPIHOST_FSTAT_HIST_NUM / 2U) / nominal);
+		jitter = (us > nominal) ? (us - nominal) : (nominal - us);
+	} else {
+		n = (uint32_t)fls(us);
+	}
+	st->phist[(n < MIPIHOST_FSTAT_HIST_NUM) ? n : (MIPIHOST_FSTAT_HIST_NUM - 1U)]++;
+
+	st->jitter_us = jitter;
+	if (jitter > st->jitter_max_us)
+		st->jitter_max_us = jitter;
+	n = (uint32_t)fls(jitter + 1U) - 1U;
+	st->jhist[(n < MIPIHOST_FSTAT_HIST_NUM) ? n : (MIPIHOST_FSTAT_HIST_NUM - 1U)]++;
+}
+
+/**
+ * brief mipi_host_fstat_snapshot : get a snapshot of the frame timing statistics
+ *
+ * param [in] hdev : mipi host device struct
+ * param [out] snap : the snapshot
+ *
+ * return void
+ */
+static void mipi_host_fstat_snapshot(struct mipi_hdev_s *hdev, mipi_host_fstat_t *snap)
+{
+	const struct mipi_host_frame_s *frame = &hdev->frame;
+	const struct mipi_host_fvc_s *fvc;
+	mipi_host_fstat_vc_t *st;
+	uint64_t total = 0U;
+	mipi_flags_t flags;
+	uint32_t i;
+
+	(void)memset((void *)snap, 0, sizeof(*snap));
+	osal_spin_lock_irqsave(&hdev->flock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+	snap->vc_mask = frame->vc_mask;
+	snap->nominal_us = frame->nominal_us;
+	snap->link_bps = frame->link_bps;
+	for (i = 0U; i < (uint32_t)MIPIHOST_FSTAT_VC_NUM; i++) {
+		fvc = &frame->vc[i];
+		st = &snap->vc[i];
+		(void)memcpy((void *)st, (const void *)&fvc->st, sizeof(*st));
+		if (fvc->periods != 0U)
+			st->period_avg_us = (uint32_t)(fvc->period_sum_us / fvc->periods);
+		if (st->period_avg_us != 0U)
+			st->bps = (uint64_t)st->frame_bytes * HOST_S_TO_US / st->period_avg_us;
+		total += st->bps;
+	}
+	osal_spin_unlock_irqrestore(&hdev->flock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+
+	if (snap->link_bps != 0U)
+		snap->util = (uint32_t)(total * 1000U / snap->link_bps);
+}
+
+/**
+ * @NO{S10E03C01I}
+ * @ASIL{B}
+ * @brief mipi host(rx) frame start/end event of one vc, called by vin
+ *
+ * @param[in] port: mipi host(rx) port index
+ * @param[in] vc: virtual channel of the frame, Range: 0:15
+ * @param[in] event: MIPIHOST_FRAME_START or MIPIHOST_FRAME_END
+ * @param[in] ts_ns: timestamp of the event, 0: now
+ *
+ * @return 0:Success, <0:Failure
+ *
+ * @data_read None
+ * @data_updated hdev->frame
+ * @compatibility None
+ *
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+int32_t hobot_mipi_host_frame_event_do(int32_t port, uint32_t vc, uint32_t event, uint64_t ts_ns)
+{
+	struct mipi_hdev_s *hdev = hobot_mipi_host_hdev(port);
+	struct mipi_host_fvc_s *fvc;
+	uint64_t now = (ts_ns != 0U) ? ts_ns : osal_time_get_ns();
+	mipi_flags_t flags;
+
+	if ((hdev == NULL) || (vc >= (uint32_t)MIPIHOST_FSTAT_VC_NUM) || (event > MIPIHOST_FRAME_END)) {
+		return -EINVAL;
+	}
+	fvc = &hdev->frame.vc[vc];
+
+	osal_spin_lock_irqsave(&hdev->flock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+	if (event == MIPIHOST_FRAME_START) {
+		if ((fvc->fs_ns != 0U) && (now > fvc->fs_ns))
+			mipi_host_fstat_period(&hdev->frame, fvc,
+				(uint32_t)((now - fvc->fs_ns) / HOST_US_TO_NS));
+		fvc->fs_ns = now;
+		fvc->st.fs_cnt++;
+	} else {
+		if ((fvc->fs_ns != 0U) && (now >= fvc->fs_ns))
+			fvc->st.active_us = (uint32_t)((now - fvc->fs_ns) / HOST_US_TO_NS);
+		fvc->st.fe_cnt++;
+		fvc->st.bytes += fvc->st.frame_bytes;
+	}
+	osal_spin_unlock_irqrestore(&hdev->flock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+
+	return 0;
+}
+
 /**
  * brief mipi_host_start : set mipi host start working
  *
@@ -3829,6 +4440,7 @@ static int32_t mipi_host_start(struct mipi_hdev_s *hdev)
 	struct mipi_host_s *host = &hdev->host;
 	struct mipi_host_param_s *param = &host->param;
 	void __iomem *iomem = host->iomem;
+	uint64_t start_ns = osal_time_get_ns();
 	uint32_t nocheck;
 	int32_t poth;
 
@@ -3877,9 +4489,10 @@ static int32_t mipi_host_start(struct mipi_hdev_s *hdev)
 		}
 	}
 
+	mipi_host_fstat_reset(hdev);
 #if MIPI_HOST_INT_DBG
 	if(hdev->is_ex == 0) {
-		mipi_host_irq_enable(hdev);
+		mipi_host_irq_storm_enable(hdev, 1U);
 	}
 #endif
 
@@ -3902,6 +4515,8 @@ static int32_t mipi_host_start(struct mipi_hdev_s *hdev)
 	}
 #endif
 
+	hdev->ptime.start_us = mipi_host_elapsed_us(start_ns);
+	mipi_dbg(param, dev, "start %uus\n", hdev->ptime.start_us);
 	return 0;
 }
 
@@ -3925,7 +4540,7 @@ static int32_t mipi_host_stop(struct mipi_hdev_s *hdev)
 	/*stop mipi host here?*/
 #if MIPI_HOST_INT_DBG
 	if(hdev->is_ex == 0) {
-		mipi_host_irq_disable(hdev);
+		mipi_host_irq_storm_enable(hdev, 0U);
 	}
 #endif
 
@@ -3974,6 +4589,7 @@ static void mipi_host_deinit(struct mipi_hdev_s *hdev)
 	mhost_putreg(host, REG_MIPI_HOST_PHY_SHUTDOWNZ, MIPI_HOST_CSI2_RESETN);
 	/*Release DWC_mipi_csi2_host from reset*/
 	mhost_putreg(host, REG_MIPI_HOST_CSI2_RESETN, MIPI_HOST_CSI2_RESETN);
+	mhost_shadow_invalidate(host);
 
 	if (hdev->ipi_clock != 0U) {
 		i = 0;
@@ -4038,6 +4654,7 @@ static int32_t mipi_host_init_common(struct mipi_hdev_s *hdev, mipi_host_cfg_t *
 	const char *phy_mode = "dphy";
 	uint32_t ppi_width = MIPI_HOST_PPI_WIDTH_8BIT;
 	int32_t is_1p5;
+	uint64_t start_ns;
 
 	if (iomem == NULL) {
 		return -1;
@@ -4046,6 +4663,7 @@ static int32_t mipi_host_init_common(struct mipi_hdev_s *hdev, mipi_host_cfg_t *
 
 	/*Set DWC_mipi_csi2_host reset*/
 	mhost_putreg(host, REG_MIPI_HOST_CSI2_RESETN, MIPI_HOST_CSI2_RESETN);
+	mhost_shadow_invalidate(host);
 	/*Set Synopsys D-PHY Reset*/
 	mhost_putreg(host, REG_MIPI_HOST_DPHY_RSTZ, MIPI_HOST_CSI2_RESETN);
 	mhost_putreg(host, REG_MIPI_HOST_PHY_SHUTDOWNZ, MIPI_HOST_CSI2_RESETN);
@@ -4055,20 +4673,17 @@ static int32_t mipi_host_init_common(struct mipi_hdev_s *hdev, mipi_host_cfg_t *
 		if (cfg->phy != 0U) {
 			mhost_putreg(host, REG_MIPI_HOST_PHY_MODE, MIPI_HOST_PHY_MODE_CPHY);
 			phy_mode = "cphy";
-			ppi_width = MIPI_HOST_PPI_WIDTH_16BIT;
 		} else {
 			mhost_putreg(host, REG_MIPI_HOST_PHY_MODE, MIPI_HOST_PHY_MODE_DPHY);
-			if (cfg->mipiclk > (cfg->lane * HOST_DPHY_CLK_PPI8_MAX))
-				ppi_width = MIPI_HOST_PPI_WIDTH_16BIT;
 		}
-		if (cfg->ppi_pg != 0U)
-			ppi_width = MIPI_HOST_PPI_WIDTH_16BIT;
+		ppi_width = mipi_host_get_ppi_width(hdev, cfg);
 		mhost_putreg(host, REG_MIPI_HOST_PHY_CFG, ppi_width);
 	}
 
 #ifdef CONFIG_HOBOT_MIPI_PHY
 	mipi_info(dev, "%s %dMbps/%dlane: ppi %dbit settle %d\n",
 		phy_mode, cfg->mipiclk, cfg->lane, ((ppi_width + 1) * 8), cfg->settle);
+	start_ns = osal_time_get_ns();
 	if (0 != mipi_host_dphy_initialize(cfg->mipiclk, cfg->lane, cfg->settle, iomem)) {
 		mipi_err(dev, "%s initialize error\n", phy_mode);
 		mipi_host_error_report(hdev, ESW_MipiHostDphyOpErr, SUB_ID_1, (uint8_t)cfg->lane, __LINE__);
@@ -4082,6 +4697,7 @@ static int32_t mipi_host_init_common(struct mipi_hdev_s *hdev, mipi_host_cfg_t *
 
 	(void)mipi_dphy_set_freqrange(MIPI_DPHY_TYPE_HOST, hdev->port,
 		MIPI_PHY_ENABLE_CLK, 0x1);
+	hdev->ptime.dphy_us = mipi_host_elapsed_us(start_ns);
 #endif
 
 	/*Clear Synopsys D-PHY Reset*/
@@ -4089,7 +4705,7 @@ static int32_t mipi_host_init_common(struct mipi_hdev_s *hdev, mipi_host_cfg_t *
 	mhost_putreg(host, REG_MIPI_HOST_DPHY_RSTZ, MIPI_HOST_CSI2_RAISE);
 	/*Configure the number of active lanes*/
 	mhost_putreg(host, REG_MIPI_HOST_N_LANES, (uint32_t)(cfg->lane) - 1U);
-	osal_udelay(1000); /* PRQA S 2880 */ /* osal_udelay macro */
+	usleep_range(1000, 1100);
 	/*Configure the vc&dt lines monitoring*/
 	if (param->data_ids_1 != 0U) {
 		mipi_info(dev, "data id monitor 0~3: vc=0x%x dt=0x%x\n",
@@ -4156,15 +4772,27 @@ static int32_t mipi_host_init(struct mipi_hdev_s *hdev, mipi_host_cfg_t *cfg)
 	struct mipi_host_param_s *param = &host->param;
 	void __iomem  *iomem = host->iomem;
 	uint64_t pixclk;
+	uint32_t verdict, diff, writes, skips;
 
 	if (iomem == NULL) {
 		mipi_host_error_report(hdev, ESW_MipiHostIomemErr, SUB_ID_0, 0U, __LINE__);
 		return -1;
 	}
 
+	(void)memset((void *)&hdev->ptime, 0, sizeof(hdev->ptime));
+	hdev->ptime.init_ns = osal_time_get_ns();
 	mipi_info(dev, "init begin\n");
 	mipi_info(dev, "%d lane %dx%d %dfps datatype 0x%x\n",
 			 cfg->lane, cfg->width, cfg->height, cfg->fps, cfg->datatype);
+	/* re-init: show the fields changed */
+	if ((cfg != &host->cfg) && (host->cfg.lane != 0U)) {
+		diff = mipi_host_configure_diff(&host->cfg, cfg);
+		if (diff != 0U) {
+			mipi_host_configure_diff_show(hdev, diff);
+		}
+	}
+	writes = host->shadow.writes;
+	skips = host->shadow.skips;
 	if (hdev->is_ex == 0) {
 		/* mclk clock */
 		if (mipi_host_init_mclk(hdev, cfg) != 0) {
@@ -4179,6 +4807,22 @@ static int32_t mipi_host_init(struct mipi_hdev_s *hdev, mipi_host_cfg_t *cfg)
 			return -1;
 		}
 		hdev->ipi_clock = pixclk;
+
+		/* advisory only: the model may be off for a sensor, never block the init */
+		if ((param->cfg_nocheck == 0U) && (cfg->ppi_pg == 0U)) {
+			verdict = mipi_host_model_check(hdev, cfg, &hdev->model);
+			hdev->mcfg_set = 0U;
+			if ((verdict & MIPI_MODEL_REJECT) != 0U) {
+				mipi_info(dev, "model warning %s: need %llubps of %llubps, ipi %uns of line %uns, max %ufps\n",
+						mipi_host_model_verdict(verdict), hdev->model.need_bps,
+						hdev->model.link_bps, hdev->model.ipi_ns,
+						hdev->model.line_ns, hdev->model.fps_max);
+			}
+			if ((verdict & MIPI_MODEL_FIFO_OVER) != 0U) {
+				mipi_info(dev, "model warning: ipi fifo high-water %u over %u\n",
+						hdev->model.fifo_hw, hdev->model.fifo_bytes);
+			}
+		}
 	}
 
 	if(mipi_host_init_common(hdev, cfg) != 0) {
@@ -4220,7 +4864,9 @@ static int32_t mipi_host_init(struct mipi_hdev_s *hdev, mipi_host_cfg_t *cfg)
 	(void)memset((void *)(&host->icnt), 0, sizeof(host->icnt));
 #endif
 	(void)memcpy(&host->cfg, cfg, sizeof(mipi_host_cfg_t));
-	mipi_info(dev, "init end\n");
+	hdev->ptime.init_us = mipi_host_elapsed_us(hdev->ptime.init_ns);
+	mipi_info(dev, "init end %uus, shadow skip %u of %u writes\n", hdev->ptime.init_us,
+			host->shadow.skips - skips, host->shadow.writes - writes);
 	return 0;
 }
 
@@ -4369,6 +5015,7 @@ static int32_t hobot_mipi_host_ioc_init(struct mipi_hdev_s *hdev, mipi_ioc_arg_t
 	struct mipi_host_s *host = &hdev->host;
 	struct mipi_user_s *user = &hdev->user;
 	int32_t ret = 0;
+	uint32_t diff = 0U;
 	mipi_host_cfg_t mipi_host_cfg;
 
 	if (arg == 0U) {
@@ -4404,8 +5051,9 @@ static int32_t hobot_mipi_host_ioc_init(struct mipi_hdev_s *hdev, mipi_ioc_arg_t
 			user->pre_state = MIPI_PRE_STATE_INITED;
 		}
 		host->state = MIPI_STATE_INIT;
-	} else if (mipi_host_configure_cmp(&host->cfg, &mipi_host_cfg) != 0) {
-		mipi_info(dev, "warning: init config mismatch\n");
+	} else if (mipi_host_configure_cmp(&host->cfg, &mipi_host_cfg, &diff) != 0) {
+		mipi_info(dev, "warning: init config mismatch 0x%x\n", diff);
+		mipi_host_configure_diff_show(hdev, diff);
 	} else {
 		/* init done */
 	}
@@ -4954,6 +5602,33 @@ static int32_t hobot_mipi_host_ioc_get_param(struct mipi_hdev_s *hdev, mipi_ioc_
 	return ret;
 }
 
+static int32_t hobot_mipi_host_ioc_get_fstat(struct mipi_hdev_s *hdev, mipi_ioc_arg_t arg)
+{
+	struct os_dev *dev = &hdev->osdev;
+	mipi_host_fstat_t *snap;
+	int32_t ret = 0;
+
+	if (arg == 0U) {
+		mipi_err(dev, "cmd get_fstat, arg NULL\n");
+		mipi_host_error_report(hdev, ESW_MipiHostIocCheckErr, SUB_ID_14, 0U, __LINE__);
+		return -EINVAL;
+	}
+	snap = (mipi_host_fstat_t *)osal_kmalloc(sizeof(mipi_host_fstat_t), GFP_KERNEL);
+	if (snap == NULL) {
+		return -ENOMEM;
+	}
+	mipi_host_fstat_snapshot(hdev, snap);
+	if (mipi_copy_to_app((void __user *)arg,
+				(void *)snap, sizeof(mipi_host_fstat_t)) != 0U) {
+		mipi_err(dev, "fstat get erorr, %px to user error\n", (void __user *)arg);
+		mipi_host_error_report(hdev, ESW_MipiHostIocUserErr, SUB_ID_11, 2U, __LINE__);
+		ret = -EINVAL;
+	}
+	osal_kfree((void *)snap);
+
+	return ret;
+}
+
 static int32_t hobot_mipi_host_ioc_set_param(struct mipi_hdev_s *hdev, mipi_ioc_arg_t arg)
 {
 	struct os_dev *dev = &hdev->osdev;
@@ -5108,6 +5783,9 @@ mipi_ioc_ret_t hobot_mipi_host_ioctl_do(struct mipi_hdev_s *hdev, uint32_t cmd,
 	case MIPIHOSTIOC_SET_PARAM: /* PRQA S 0591,4513 */ /* _IOR macro */
 		ret = hobot_mipi_host_ioc_set_param(hdev, arg);
 		break;
+	case MIPIHOSTIOC_GET_FSTAT: /* PRQA S 0591,4513 */ /* _IOR macro */
+		ret = hobot_mipi_host_ioc_get_fstat(hdev, arg);
+		break;
 #ifdef CONFIG_HOBOT_MIPI_REG_OPERATE
 	case MIPIHOSTIOC_READ: /* PRQA S 0591,4513 */ /* _IOR macro */
 		ret = hobot_mipi_host_ioc_read(hdev, arg);
@@ -5646,6 +6324,11 @@ static int32_t mipi_host_status_user_show_do(struct mipi_hdev_s *hdev,
 	l += snprintf(&s[l], (count - l), "%-15s: %u\n", "init", user->init_cnt);
 	l += snprintf(&s[l], (count - l), "%-15s: %u\n", "start", user->start_cnt);
 	l += snprintf(&s[l], (count - l), "%-15s: %s\n", "pre_state", g_mh_pre_state[user->pre_state]);
+	l += snprintf(&s[l], (count - l), "%-15s: %u(dphy %u stop %u)us\n", "init_time",
+			hdev->ptime.init_us, hdev->ptime.dphy_us, hdev->ptime.stop_us);
+	l += snprintf(&s[l], (count - l), "%-15s: %u(hs %u)us\n", "start_time",
+			hdev->ptime.start_us, hdev->ptime.hs_us);
+	l += snprintf(&s[l], (count - l), "%-15s: %uus\n", "ready_time", hdev->ptime.ready_us);
 
 	return l;
 }
@@ -5670,11 +6353,268 @@ static int32_t mipi_host_status_icnt_show_do(struct mipi_hdev_s *hdev,
 		l += snprintf(&s[l], (count - l), "%-15s: %u\n", g_mh_icnt_names[i],
 				((uint32_t *)(&host->icnt.st_main))[i]);
 	}
+	l += snprintf(&s[l], (count - l), "%-15s: %u(%ums)\n", "irq_storm",
+			hdev->istorm.masked, hdev->istorm.backoff_ms);
 
 	return l;
 }
 #endif
 
+/* sprintf show for mipi host devices' status/fstat */
+static int32_t mipi_host_status_fstat_show_do(struct mipi_hdev_s *hdev,
+		const char *name, char *buf, int32_t count)
+{
+	mipi_host_fstat_t *snap;
+	const mipi_host_fstat_vc_t *st;
+	char *s = buf;
+	int32_t l = 0;
+	uint32_t i, j;
+
+	if ((hdev == NULL) || (name == NULL) || (s == NULL)) {
+		/* do not need report */
+		return -EFAULT;
+	}
+	snap = (mipi_host_fstat_t *)osal_kmalloc(sizeof(mipi_host_fstat_t), GFP_KERNEL);
+	if (snap == NULL) {
+		return -ENOMEM;
+	}
+	mipi_host_fstat_snapshot(hdev, snap);
+
+	l += snprintf(&s[l], (count - l), "%-15s: %uus\n", "nominal", snap->nominal_us);
+	l += snprintf(&s[l], (count - l), "%-15s: %llu Bps\n", "link", snap->link_bps);
+	l += snprintf(&s[l], (count - l), "%-15s: %u/1000\n", "utilisation", snap->util);
+	for (i = 0U; i < (uint32_t)MIPIHOST_FSTAT_VC_NUM; i++) {
+		st = &snap->vc[i];
+		if ((((snap->vc_mask >> i) & 0x1U) == 0U) && (st->fs_cnt == 0U))
+			continue;
+		if (l >= (count - MIPI_HOST_FSTAT_LINE_MAX))
+			break;
+		l += snprintf(&s[l], (count - l), "vc%-13u: fs %u fe %u active %uus %llu Bps\n",
+				i, st->fs_cnt, st->fe_cnt, st->active_us, st->bps);
+		l += snprintf(&s[l], (count - l), "%-15s: %u(%u~%u avg %u)us jitter %u(max %u)us\n",
+				"  period", st->period_us, st->period_min_us, st->period_max_us,
+				st->period_avg_us, st->jitter_us, st->jitter_max_us);
+		l += snprintf(&s[l], (count - l), "%-15s:", "  phist");
+		for (j = 0U; j < (uint32_t)MIPIHOST_FSTAT_HIST_NUM; j++)
+			l += snprintf(&s[l], (count - l), " %u", st->phist[j]);
+		l += snprintf(&s[l], (count - l), "\n%-15s:", "  jhist");
+		for (j = 0U; j < (uint32_t)MIPIHOST_FSTAT_HIST_NUM; j++)
+			l += snprintf(&s[l], (count - l), " %u", st->jhist[j]);
+		l += snprintf(&s[l], (count - l), "\n");
+	}
+	osal_kfree((void *)snap);
+
+	return l;
+}
+
+/* sprintf show for mipi host devices' model */
+static int32_t mipi_host_model_show_do(struct mipi_hdev_s *hdev,
+		const char *name, char *buf, int32_t count)
+{
+	struct mipi_host_s *host;
+	struct mipi_user_s *user;
+	struct mipi_host_model_s *model;
+	const mipi_host_cfg_t *cfg;
+	char *s = buf;
+	int32_t l = 0;
+
+	if ((hdev == NULL) || (name == NULL) || (s == NULL)) {
+		/* do not need report */
+		return -EFAULT;
+	}
+	host = &hdev->host;
+	user = &hdev->user;
+	model = &hdev->model;
+
+	osal_mutex_lock(&user->mutex);
+	if (hdev->mcfg_set != 0U) {
+		cfg = &hdev->mcfg;
+	} else if (host->state >= MIPI_STATE_INIT) {
+		cfg = &host->cfg;
+		(void)mipi_host_model_check(hdev, cfg, model);
+	} else {
+		osal_mutex_unlock(&user->mutex);
+		l += snprintf(&s[l], (count - l), "not inited\n");
+		return l;
+	}
+
+	l += snprintf(&s[l], (count - l), "%-15s: %s %dlane %ux%u %ufps 0x%02x %uMbps\n", "cfg",
+			(hdev->mcfg_set != 0U) ? "what-if" : "init", cfg->lane, cfg->width,
+			cfg->height, cfg->fps, cfg->datatype, cfg->mipiclk);
+	l += snprintf(&s[l], (count - l), "%-15s: %s\n", "verdict",
+			mipi_host_model_verdict(model->verdict));
+	l += snprintf(&s[l], (count - l), "%-15s: %llu/%llu bps\n", "bandwidth",
+			model->need_bps, model->link_bps);
+	l += snprintf(&s[l], (count - l), "%-15s: %d/1000\n", "headroom", model->headroom);
+	l += snprintf(&s[l], (count - l), "%-15s: %u bytes\n", "line_bytes", model->line_bytes);
+	l += snprintf(&s[l], (count - l), "%-15s: ppi %uns ipi %uns of %uns\n", "line_time",
+			model->ppi_ns, model->ipi_ns, model->line_ns);
+	l += snprintf(&s[l], (count - l), "%-15s: %llu Hz\n", "ipiclk",
+			(hdev->ipi_clock != 0UL) ? hdev->ipi_clock : MIPI_HOST_IPICLK_DEFAULT);
+	l += snprintf(&s[l], (count - l), "%-15s: %u\n", "hsd", model->hsd);
+	l += snprintf(&s[l], (count - l), "%-15s: %u/%u bytes\n", "fifo_hw",
+			model->fifo_hw, model->fifo_bytes);
+	l += snprintf(&s[l], (count - l), "%-15s: %u(link %u ipi %u)\n", "fps_max",
+			model->fps_max, model->fps_link, model->fps_ipi);
+	osal_mutex_unlock(&user->mutex);
+
+	return l;
+}
+
+/* sysfs store for mipi host devices' model: what-if "name=value ..." or "clear" */
+static int32_t mipi_host_model_store_do(struct mipi_hdev_s *hdev,
+		const char *name, char *buf, int32_t count)
+{
+	struct os_dev *dev;
+	struct mipi_host_s *host;
+	struct mipi_user_s *user;
+	mipi_host_cfg_union_t cfgu;
+	char tmp[MIPI_HOST_MODEL_STORE_MAX];
+	char *p, *tok, *eq;
+	uint32_t i, verdict;
+	uint16_t val;
+	int32_t error = 0;
+
+	if ((hdev == NULL) || (name == NULL) || (buf == NULL)) {
+		/* do not need report */
+		return -EFAULT;
+	}
+	dev = &hdev->osdev;
+	host = &hdev->host;
+	user = &hdev->user;
+
+	(void)strscpy(tmp, buf, sizeof(tmp));
+	osal_mutex_lock(&user->mutex);
+	if (hdev->mcfg_set != 0U)
+		(void)memcpy((void *)&cfgu.cfg, (const void *)&hdev->mcfg, sizeof(mipi_host_cfg_t));
+	else if (host->state >= MIPI_STATE_INIT)
+		(void)memcpy((void *)&cfgu.cfg, (const void *)&host->cfg, sizeof(mipi_host_cfg_t));
+	else
+		(void)memset((void *)&cfgu.cfg, 0, sizeof(mipi_host_cfg_t));
+
+	p = tmp;
+	while ((error == 0) && ((tok = strsep(&p, " ,\n")) != NULL)) {
+		if (tok[0] == '\0')
+			continue;
+		if (strcmp(tok, "clear") == 0) {
+			hdev->mcfg_set = 0U;
+			osal_mutex_unlock(&user->mutex);
+			return count;
+		}
+		eq = strchr(tok, '=');
+		if (eq == NULL) {
+			error = -EINVAL;
+			break;
+		}
+		*eq = '\0';
+		for (i = 0U; i < MIPI_HOST_CFG_NUM; i++) {
+			if (strcmp(mipi_host_cfg_name[i], tok) == 0)
+				break;
+		}
+		if ((i >= MIPI_HOST_CFG_NUM) || (kstrtou16(&eq[1], 0, &val) != 0)) {
+			error = -EINVAL;
+			break;
+		}
+		cfgu.val[i] = val;
+	}
+	if (error != 0) {
+		osal_mutex_unlock(&user->mutex);
+		mipi_info(dev, "model what-if %s invalid\n", tok);
+		return error;
+	}
+
+	(void)memcpy((void *)&hdev->mcfg, (const void *)&cfgu.cfg, sizeof(mipi_host_cfg_t));
+	hdev->mcfg_set = 1U;
+	verdict = mipi_host_model_check(hdev, &hdev->mcfg, &hdev->model);
+	osal_mutex_unlock(&user->mutex);
+
+	/* what-if config which would overflow: reject it, the init itself only warns */
+	if ((verdict & (MIPI_MODEL_REJECT | MIPI_MODEL_INVALID)) != 0U)
+		return -ERANGE;
+	return count;
+}
+
+/* sprintf show for mipi host devices' shadow: stats and the registers differ from hw */
+static int32_t mipi_host_shadow_show_do(struct mipi_hdev_s *hdev,
+		const char *name, char *buf, int32_t count)
+{
+	struct mipi_host_s *host;
+	struct mipi_host_shadow_s *shadow;
+	uint32_t i, offs, regv, valid = 0U, differ = 0U;
+	mipi_flags_t flags;
+	char *s = buf;
+	int32_t l = 0;
+
+	if ((hdev == NULL) || (name == NULL) || (s == NULL)) {
+		/* do not need report */
+		return -EFAULT;
+	}
+	host = &hdev->host;
+	shadow = &host->shadow;
+
+	/* one snapshot against the writers and the irq resets */
+	osal_spin_lock_irqsave(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+	l += snprintf(&s[l], (count - l), "%-15s: %s\n", "shadow",
+			(shadow->enable != 0U) ? "enable" : "disable");
+	l += snprintf(&s[l], (count - l), "%-15s: %u of %u\n", "skip",
+			shadow->skips, shadow->writes);
+	for (i = 0U; i < MIPI_HOST_SHADOW_REGS; i++) {
+		if (shadow->valid[i] == 0U) {
+			continue;
+		}
+		valid++;
+		offs = i << 2;
+		regv = mipi_getreg(host->iomem, offs);
+		if (regv != shadow->val[i]) {
+			differ++;
+			l += snprintf(&s[l], (count - l), "reg 0x%03x      : 0x%08x hw 0x%08x\n",
+					offs, shadow->val[i], regv);
+		}
+	}
+	osal_spin_unlock_irqrestore(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+	l += snprintf(&s[l], (count - l), "%-15s: %u valid %u differ\n", "regs", valid, differ);
+
+	return l;
+}
+
+/* sysfs store for mipi host devices' shadow: "0"/"1" to disable/enable, "clear" to invalidate */
+static int32_t mipi_host_shadow_store_do(struct mipi_hdev_s *hdev,
+		const char *name, char *buf, int32_t count)
+{
+	struct mipi_host_shadow_s *shadow;
+	struct mipi_user_s *user;
+	mipi_flags_t flags;
+	uint32_t val;
+
+	if ((hdev == NULL) || (name == NULL) || (buf == NULL)) {
+		/* do not need report */
+		return -EFAULT;
+	}
+	shadow = &hdev->host.shadow;
+	user = &hdev->user;
+
+	osal_mutex_lock(&user->mutex);
+	if (sysfs_streq(buf, "clear")) {
+		osal_spin_lock_irqsave(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+		(void)memset((void *)shadow->valid, 0, sizeof(shadow->valid));
+		shadow->writes = 0U;
+		shadow->skips = 0U;
+		osal_spin_unlock_irqrestore(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+	} else if (kstrtouint(buf, 0, &val) == 0) {
+		/* drop the values: the writes are not tracked when disabled */
+		osal_spin_lock_irqsave(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_lock_irqsave macro */
+		(void)memset((void *)shadow->valid, 0, sizeof(shadow->valid));
+		shadow->enable = (val != 0U) ? 1U : 0U;
+		osal_spin_unlock_irqrestore(&shadow->slock, &flags); /* PRQA S 2996 */ /* osal_spin_unlock_irqrestore macro */
+	} else {
+		osal_mutex_unlock(&user->mutex);
+		return -EINVAL;
+	}
+	osal_mutex_unlock(&user->mutex);
+
+	return count;
+}
+
 #if MIPI_HOST_INT_DBG && MIPI_HOST_SYSFS_FATAL_EN
 /* get ireg of mipi host devices' ierr */
 static const struct mipi_host_ireg_s* mipi_host_get_ireg(const struct mipi_host_ierr_s *ierr, const char *name)
@@ -5856,6 +6796,9 @@ static struct mipi_host_sys_s mipi_host_sys[MIPI_HOST_SYS_NUM] = {
 	{ MIPI_HOST_SYS_STATUS_SNRCLK, { mipi_host_status_snrclk_show_do, NULL } },
 	{ MIPI_HOST_SYS_STATUS_USER, { mipi_host_status_user_show_do, NULL } },
 	{ MIPI_HOST_SYS_STATUS_ICNT, { mipi_host_status_icnt_show_do, NULL } },
+	{ MIPI_HOST_SYS_STATUS_FSTAT, { mipi_host_status_fstat_show_do, NULL } },
+	{ MIPI_HOST_SYS_MODEL, { mipi_host_model_show_do, mipi_host_model_store_do } },
+	{ MIPI_HOST_SYS_SHADOW, { mipi_host_shadow_show_do, mipi_host_shadow_store_do } },
 	{ MIPI_HOST_SYS_FATAL, { mipi_host_fatal_show_do, mipi_host_fatal_store_do } },
 #if defined CONFIG_FAULT_INJECTION_ATTR || defined CONFIG_HOBOT_FUSA_DIAG
 	{ MIPI_HOST_SYS_FAULT_INJECT, { mipi_host_fault_injection_show_do, mipi_host_fault_injection_store_do } },
@@ -5991,7 +6934,9 @@ static void hobot_mipi_host_ierrs_init(struct mipi_host_s *host)
 		host->ieap.iregs = mh_int_regs_1p4ap;
 		host->ieap.num = (uint32_t)MIPI_HOST_IREG_NUM_1P4AP;
 	}
+	mipi_host_ierr_bit_init(&host->ieap);
 #endif
+	mipi_host_ierr_bit_init(&host->ierr);
 }
 
 static void hobot_mipi_host_probe_socclk_init(struct mipi_hdev_s *hdev)
@@ -6114,6 +7059,8 @@ int32_t hobot_mipi_host_resume_do(struct mipi_hdev_s *hdev)
 
 	mipi_info(dev, "%s:%s enter resume...\n", __FILE__, __func__);
 	hobot_mipi_host_diag_report_status(hdev, 1, 0);
+	/* registers may be lost in suspend */
+	mhost_shadow_invalidate(host);
 
 	if (host->state == MIPI_STATE_START) {
 		/* if state == MIPI_STATE_START, it has been initialized. */
@@ -6238,7 +7185,13 @@ int32_t hobot_mipi_host_probe_do(struct mipi_hdev_s *hdev)
 	(void)vio_clk_enable(hdev->host.socclk.pclk);/*pclk maybe adjust by clk_owner, we only need enable it.*/
 #if MIPI_HOST_INT_DBG
 	hobot_mipi_host_ierrs_init(host);
+	osal_spin_init(&hdev->ilock); /* PRQA S 3334 */ /* osal_spin_init macro */
+	osal_timer_init(&hdev->storm_timer, mipi_host_irq_storm_func, hdev);
 #endif
+	osal_spin_init(&hdev->flock); /* PRQA S 3334 */ /* osal_spin_init macro */
+	osal_spin_init(&host->shadow.slock); /* PRQA S 3334 */ /* osal_spin_init macro */
+	mhost_shadow_invalidate(host);
+	host->shadow.enable = 1U;
 	ver = mipi_getreg(host->iomem, REG_MIPI_HOST_VERSION);
 	mipi_info(&hdev->osdev, "ver %c%c%c%c%s port%d(%d:%d)\n",
 			MIPI_BYTE3(ver), MIPI_BYTE2(ver),
@@ -6279,6 +7232,9 @@ void hobot_mipi_host_remove_do(struct mipi_hdev_s *hdev)
 
 #ifdef CONFIG_HOBOT_FUSA_DIAG
 	mipi_csi_stl_remove(&host->stl);
+#endif
+#if MIPI_HOST_INT_DBG
+	(void)osal_timer_stop(&hdev->storm_timer);
 #endif
 	hobot_mipi_host_phy_unregister(hdev);
 
@@ -29,6 +29,8 @@
 #include "hobot_mipi_osal.h"
 
 #include "hobot_mipi_host.h"
+#include "hobot_mipi_host_regs.h"
+#include "hobot_mipi_host_model.h"
 #include "hobot_mipi_utils.h"
 
 #ifdef MODULE
@@ -283,6 +285,11 @@ static inline int32_t MIPI_HOST_PORT_FOR_CIMDMA(int32_t port) {
 #define MIPI_HOST_IPILIMIT_DEFAULT (600000000U)
 #define MIPI_HOST_IPIFORCE_MIN     (10000000U)
 #define MIPI_HOST_IRQ_CNT          (10)
+#define MIPI_HOST_IRQ_STORM_MS     (1000U)
+#define MIPI_HOST_IRQ_BACKOFF_MIN  (100U)
+#define MIPI_HOST_IRQ_BACKOFF_MAX  (10000U)
+#define MIPI_HOST_POLL_US_MIN      (20U)
+#define MIPI_HOST_POLL_US_MAX      (1000U)
 #define MIPI_HOST_IRQ_DEBUG_PRERR  (0x1U)
 #define MIPI_HOST_IRQ_DEBUG_ERRSTR (0x2U)
 #define MIPI_HOST_IRQ_DEBUG        (0x1U)
@@ -317,6 +324,10 @@ static inline uint8_t HOST_DPHY_RX_HS_STA(uint32_t s) {
 #define HOST_S_TO_NS               (1000000000)
 #define HOST_DFLT_F_SYNC_TYPE      (2)
 #define HOST_IPI_FIFO_DEPTH        (64)
+#define MIPI_HOST_MODEL_STORE_MAX  (128)
+#define MIPI_HOST_FSTAT_LINE_MAX   (384)
+#define MIPI_HOST_CFG_DIFF_MAX     (256)
+#define MIPI_HOST_SHADOW_REGS      ((REG_MIPI_HOST_IPI4_ADV_FEATURES >> 2) + 1U)
 
 #define MIPI_HOST_PPIPGC_VC_MASK       (0x1FU)
 #define MIPI_HOST_PPIPGC_VC_OFFS       (3)
@@ -663,10 +674,30 @@ uint32_t mipi_host_drop_mvc2ipi(mipi_host_t *host, uint32_t vc_mask);
 #endif
 
 /* host interrupt error struct */
+#define MIPI_HOST_IREG_NONE	(0xFFU)
 struct mipi_host_ierr_s {
 	const struct mipi_host_ireg_s *iregs;
 	uint32_t num;
 	uint32_t st_main;
+	/* st_main bit -> index of iregs, MIPI_HOST_IREG_NONE if not used */
+	uint8_t bit2ireg[MIPI_HOST_INT_DBG_ERRBIT];
+};
+
+/* sub interrupts pending for the irq thread */
+struct mipi_host_ipend_s {
+	uint32_t main;
+	uint32_t mask;		/* bit of icnt_n pending */
+	uint32_t reset;		/* bit of icnt_n which ipi has been reset */
+	uint32_t subirq[MIPI_HOST_ICNT_NUM];
+};
+
+/* interrupt storm state of one port */
+struct mipi_host_istorm_s {
+	uint64_t start_ns;
+	uint32_t cnt;
+	uint32_t backoff_ms;
+	uint32_t masked;
+	uint32_t enable;
 };
 #endif
 
@@ -693,6 +724,28 @@ struct mipi_host_port_hw_mode_s {
 	uint16_t ugrp;
 };
 
+/*
+ * shadow of the host config registers, see mhost_shadow_index.
+ * a write of the same value to a valid shadowed register is skipped.
+ * the shadow is invalidated at probe, resume, deinit, by sysfs and
+ * on every csi2 or ipi reset, as the hw may not keep the value then:
+ * a re-init after deinit writes every register again, the skip only
+ * saves the repeated writes between two resets of one init.
+ */
+struct mipi_host_shadow_s {
+	/*
+	 * osal_spin_lock: slock
+	 * protect: val, valid and the stats, the ipi overflow irq resets.
+	 * init: probe, see hobot_mipi_host_probe_do.
+	 */
+	osal_spinlock_t slock;
+	uint32_t val[MIPI_HOST_SHADOW_REGS];
+	uint8_t  valid[MIPI_HOST_SHADOW_REGS];
+	uint32_t enable;
+	uint32_t writes;	/* writes to shadowed registers */
+	uint32_t skips;		/* writes skipped as same value */
+};
+
 /* mipi host info struct */
 struct mipi_host_s {
 	void __iomem             *iomem;
@@ -707,6 +760,7 @@ struct mipi_host_s {
 	struct mipi_host_snrclk_s snrclk;
 #endif
 	struct mipi_host_socclk_s socclk;
+	struct mipi_host_shadow_s shadow;
 #if MIPI_HOST_INT_DBG
 	struct mipi_host_ierr_s   ierr;
 	struct mipi_host_icnt_s   icnt;
@@ -742,6 +796,33 @@ struct mipi_user_s {
 	osal_waitqueue_t pre_wq;
 };
 
+/* phase timing of the last init/start, unit: us */
+struct mipi_host_ptime_s {
+	uint64_t init_ns;	/* init begin timestamp */
+	uint32_t init_us;	/* init total */
+	uint32_t dphy_us;	/* dphy initialize */
+	uint32_t stop_us;	/* wait lanes stop state */
+	uint32_t start_us;	/* start total */
+	uint32_t hs_us;		/* wait clock lane hs reception */
+	uint32_t ready_us;	/* from init begin to hs reception */
+};
+
+/* frame timing state of one vc */
+struct mipi_host_fvc_s {
+	uint64_t fs_ns;		/* last frame start timestamp */
+	uint64_t period_sum_us;
+	uint32_t periods;
+	mipi_host_fstat_vc_t st;
+};
+
+/* frame timing statistics, see hobot_mipi_host_frame_event_do */
+struct mipi_host_frame_s {
+	uint32_t vc_mask;
+	uint32_t nominal_us;
+	uint64_t link_bps;
+	struct mipi_host_fvc_s vc[MIPIHOST_FSTAT_VC_NUM];
+};
+
 /* mipi host device struct */
 struct mipi_hdev_s {
 	int32_t            port;
@@ -754,6 +835,34 @@ struct mipi_hdev_s {
 	struct mipi_user_s user;
 	struct mipi_cb_s   cb;
 	const struct mipi_host_port_hw_mode_s *hw_mode;
+	struct mipi_host_ptime_s ptime;
+	/*
+	 * timing model of the init config, or the what-if config if mcfg_set.
+	 * protect: user.mutex, see mipi_host_model_store_do.
+	 */
+	struct mipi_host_model_s model;
+	mipi_host_cfg_t    mcfg;
+	uint32_t           mcfg_set;
+	/*
+	 * osal_spin_lock: flock
+	 * protect: frame.
+	 * init: probe, see hobot_mipi_host_probe_do.
+	 * call: frame event from vin, see hobot_mipi_host_frame_event_do.
+	 */
+	osal_spinlock_t    flock;
+	struct mipi_host_frame_s frame;
+#if MIPI_HOST_INT_DBG
+	/*
+	 * osal_spin_lock: ilock
+	 * protect: ipend, istorm and the irq mask registers when storm.
+	 * init: probe, see hobot_mipi_host_probe_do.
+	 * call: irq/irq thread/storm timer, see hobot_mipi_host_irq_func_do.
+	 */
+	osal_spinlock_t    ilock;
+	struct mipi_host_ipend_s  ipend;
+	struct mipi_host_istorm_s istorm;
+	osal_timer_t       storm_timer;
+#endif
 #if MIPI_HOST_INT_DBG && defined MIPI_HOST_INT_USE_TIMER
 	osal_timer_t       irq_timer;
 	uint32_t           irq_timer_en;
@@ -773,12 +882,16 @@ enum {
 	MIPI_HOST_SYS_STATUS_SNRCLK,
 	MIPI_HOST_SYS_STATUS_USER,
 	MIPI_HOST_SYS_STATUS_ICNT,
+	MIPI_HOST_SYS_STATUS_FSTAT,
+	MIPI_HOST_SYS_MODEL,
+	MIPI_HOST_SYS_SHADOW,
 	MIPI_HOST_SYS_FATAL,
 	MIPI_HOST_SYS_FAULT_INJECT,
 	MIPI_HOST_SYS_NUM,
 };
 
-extern void hobot_mipi_host_irq_func_do(struct mipi_hdev_s *hdev);
+extern int32_t hobot_mipi_host_irq_func_do(struct mipi_hdev_s *hdev);
+extern void hobot_mipi_host_irq_thread_do(struct mipi_hdev_s *hdev);
 extern int32_t hobot_mipi_host_open_do(struct mipi_hdev_s *hdev);
 extern int32_t hobot_mipi_host_close_do(struct mipi_hdev_s *hdev);
 extern mipi_ioc_ret_t hobot_mipi_host_ioctl_do(struct mipi_hdev_s *hdev, uint32_t cmd, mipi_ioc_arg_t arg);
@@ -790,6 +903,7 @@ extern int32_t hobot_mipi_host_resume_do(struct mipi_hdev_s *hdev);
 
 extern int32_t hobot_mipi_host_probe_do(struct mipi_hdev_s *hdev);
 extern void hobot_mipi_host_remove_do(struct mipi_hdev_s *hdev);
+extern int32_t hobot_mipi_host_frame_event_do(int32_t port, uint32_t vc, uint32_t event, uint64_t ts_ns);
 extern int32_t hobot_mipi_host_setcb_do(struct mipi_hdev_s *hdev, MIPI_DROP_CB drop_cb, MIPI_INT_CB int_cb);
 extern struct mipi_hdev_s *hobot_mipi_host_hdev(int32_t port);
 
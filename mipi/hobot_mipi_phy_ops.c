@@ -17,6 +17,8 @@
  * @ASIL{B}
  */
 
+#include <linux/delay.h>
+
 #include "hobot_mipi_phy_ops.h"
 #include "hobot_mipi_host_regs.h"
 #include "hobot_mipi_dev_regs.h"
@@ -363,9 +365,9 @@ static void mipi_host_dphy_testdata(const struct mipi_phy_s *phy, const void __i
 	/*write test data*/
 	mipi_putreg(iomem, REG_MIPI_HOST_PHY_TEST_CTRL1, testdata); /*set test data*/
 	mipi_putreg(iomem, REG_MIPI_HOST_PHY_TEST_CTRL0, DPHY_TEST_RESETN); /*set testclk to low*/
-	osal_mdelay(1);
+	usleep_range(1000, 1100);
 	mipi_putreg(iomem, REG_MIPI_HOST_PHY_TEST_CTRL0, DPHY_TEST_CLK);    /*set testclk to high*/
-	osal_mdelay(1);
+	usleep_range(1000, 1100);
 	mipi_putreg(iomem, REG_MIPI_HOST_PHY_TEST_CTRL0, DPHY_TEST_RESETN); /*set testclk to low*/
 #else
 
@@ -419,7 +421,7 @@ uint32_t mipi_host_dphy_testdata_read(const struct mipi_phy_s *phy, const void _
 	/*read test data*/
 	mipi_putreg(iomem, REG_MIPI_HOST_PHY_TEST_CTRL1, DPHY_TEST_ENABLE); /*set testen to high*/
 	mipi_putreg(iomem, REG_MIPI_HOST_PHY_TEST_CTRL0, DPHY_TEST_CLK); /*set testclk to high*/
-	osal_mdelay(1);
+	usleep_range(1000, 1100);
 	mipi_putreg(iomem, REG_MIPI_HOST_PHY_TEST_CTRL0, DPHY_TEST_RESETN); /*set testclk to low*/
 #else
         /*write test code*/
@@ -0,0 +1,159 @@
+/*
+ * Horizon Robotics
+ *
+ *  Copyright (C) 2020 Horizon Robotics Inc.
+ *  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+/*
+ * host test of the mipi host timing model: a sweep of sensor modes with the
+ * verdict each must get, the model input is derived as mipi_host_model_fill
+ * does for the non-legacy ipi timing with the ipiclk of mipi_host_pixel_pixclk_cal
+ */
+#include <stdio.h>
+#include <stdint.h>
+
+#include "hobot_mipi_host_model.h"
+
+/* the driver constants the derivation below depends on */
+#define TEST_DT_YUV422_8	(0x1EU)
+#define TEST_DT_RAW_8		(0x2AU)
+#define TEST_DT_RAW_10		(0x2BU)
+#define TEST_DT_RAW_12		(0x2CU)
+#define TEST_PIXELS_RAW		(3U)	/* MIPI_HOST_PIXELS_RAW */
+#define TEST_HSATIME_P		(8U)	/* MIPI_HOST_HSATIME_P */
+#define TEST_HBPTIME_P		(8U)	/* mipi_host_get_hbp with one ipi */
+#define TEST_FIFO_BYTES		(64U * 8U)	/* HOST_IPI_FIFO_DEPTH, 8bit ppi */
+
+struct model_case {
+	const char *name;
+	uint32_t lane;
+	uint32_t mipiclk;	/* Mbps of all lanes */
+	uint32_t width;
+	uint32_t height;
+	uint32_t fps;
+	uint32_t linelenth;
+	uint32_t framelenth;
+	uint32_t datatype;
+	uint32_t hsd;		/* 0: model selects */
+	uint32_t verdict;	/* expected MIPI_MODEL_* bits */
+	uint32_t ipi_ns;	/* expected ipi line time, 0: not checked */
+};
+
+static const struct model_case model_cases[] = {
+	/* 1080p30 raw: ipiclk 24.75MHz, 3 pixels per cycle, 657 cycles in the 29.6us line */
+	{ "1080p30 raw12 4lane", 4, 1728, 1920, 1080, 30, 2200, 1125, TEST_DT_RAW_12, 1,
+		MIPI_MODEL_FIFO_OVER, 26545 },
+	{ "1080p30 raw12 auto hsd", 4, 1728, 1920, 1080, 30, 2200, 1125, TEST_DT_RAW_12, 0,
+		MIPI_MODEL_FIFO_OVER, 0 },
+	{ "1080p60 raw10 4lane", 4, 3200, 1920, 1080, 60, 2200, 1125, TEST_DT_RAW_10, 1,
+		MIPI_MODEL_FIFO_OVER, 0 },
+	{ "4k30 raw10 4lane 3.2g", 4, 3200, 3840, 2160, 30, 4400, 2250, TEST_DT_RAW_10, 1,
+		MIPI_MODEL_OK, 13101 },
+	{ "4k30 raw10 4lane 2.4g", 4, 2400, 3840, 2160, 30, 4400, 2250, TEST_DT_RAW_10, 1,
+		MIPI_MODEL_LINK_OVER, 0 },
+	{ "720p30 raw8 1lane", 1, 800, 1280, 720, 30, 1650, 750, TEST_DT_RAW_8, 1,
+		MIPI_MODEL_FIFO_OVER, 0 },
+	{ "720p60 yuv422 2lane", 2, 800, 1280, 720, 60, 1650, 750, TEST_DT_YUV422_8, 1,
+		MIPI_MODEL_LINK_OVER, 0 },
+	{ "720p30 yuv422 2lane", 2, 1200, 1280, 720, 30, 1650, 750, TEST_DT_YUV422_8, 1,
+		MIPI_MODEL_FIFO_OVER, 0 },
+	{ "1080p30 raw12 hsd max", 4, 1728, 1920, 1080, 30, 2200, 1125, TEST_DT_RAW_12, 4095,
+		MIPI_MODEL_IPI_OVER | MIPI_MODEL_FIFO_OVER, 0 },
+	{ "no lane", 0, 1728, 1920, 1080, 30, 2200, 1125, TEST_DT_RAW_12, 1,
+		MIPI_MODEL_INVALID, 0 },
+};
+
+static uint32_t test_bpp(uint32_t datatype)
+{
+	switch (datatype) {
+	case TEST_DT_RAW_8:
+		return 8U;
+	case TEST_DT_RAW_10:
+		return 10U;
+	case TEST_DT_RAW_12:
+		return 12U;
+	default:
+		return 16U;
+	}
+}
+
+static void model_fill(const struct model_case *c, struct mipi_host_model_in_s *in)
+{
+	uint32_t raw = (c->datatype >= TEST_DT_RAW_8) ? 1U : 0U;
+	uint64_t pixclk = (uint64_t)c->linelenth * c->framelenth * c->fps;
+
+	in->lane = c->lane;
+	in->mipiclk = c->mipiclk;
+	in->width = c->width;
+	in->height = c->height;
+	in->fps = c->fps;
+	in->linelenth = c->linelenth;
+	in->framelenth = c->framelenth;
+	in->bpp = test_bpp(c->datatype);
+	in->long_pkt = MIPI_MODEL_LONG_PKT_BYTES;
+	in->lsle = 0U;
+	in->cycles = (raw != 0U) ? ((c->width + TEST_PIXELS_RAW - 1U) / TEST_PIXELS_RAW) : c->width;
+	in->hsa = TEST_HSATIME_P;
+	in->hbp = TEST_HBPTIME_P;
+	in->hsd = c->hsd;
+	in->fifo_bytes = TEST_FIFO_BYTES;
+	in->ipiclk = (raw != 0U) ? ((pixclk + TEST_PIXELS_RAW - 1U) / TEST_PIXELS_RAW) : pixclk;
+}
+
+static int model_check(const struct model_case *c)
+{
+	struct mipi_host_model_in_s in = {0};
+	struct mipi_host_model_s out;
+	uint32_t verdict;
+	int ret = 0;
+
+	model_fill(c, &in);
+	verdict = mipi_host_model_calc(&in, &out);
+	if ((verdict != c->verdict) || (verdict != out.verdict)) {
+		printf("FAIL %s: verdict 0x%x(%s) expect 0x%x\n", c->name, verdict,
+			mipi_host_model_verdict(verdict), c->verdict);
+		ret = -1;
+	}
+	if ((c->ipi_ns != 0U) && (out.ipi_ns != c->ipi_ns)) {
+		printf("FAIL %s: ipi %uns expect %uns\n", c->name, out.ipi_ns, c->ipi_ns);
+		ret = -1;
+	}
+	if ((verdict & MIPI_MODEL_INVALID) != 0U)
+		return ret;
+
+	/* what the verdict bits claim must hold on the numbers shown to the user */
+	if ((((verdict & MIPI_MODEL_IPI_OVER) != 0U) != (out.ipi_ns > out.line_ns)) ||
+	    (((verdict & MIPI_MODEL_LINK_OVER) != 0U) !=
+		((out.need_bps > out.link_bps) || (out.ppi_ns > out.line_ns))) ||
+	    (((verdict & MIPI_MODEL_REJECT) == 0U) && (out.fps_max < c->fps)) ||
+	    ((out.headroom < 0) != (out.need_bps > out.link_bps))) {
+		printf("FAIL %s: inconsistent output\n", c->name);
+		ret = -1;
+	}
+	if (ret != 0)
+		printf("  need %llu of %llu bps, ppi %uns ipi %uns line %uns hsd %u fifo %u/%u fps %u\n",
+			(unsigned long long)out.need_bps, (unsigned long long)out.link_bps,
+			out.ppi_ns, out.ipi_ns, out.line_ns, out.hsd, out.fifo_hw,
+			out.fifo_bytes, out.fps_max);
+	return ret;
+}
+
+int main(void)
+{
+	uint32_t i, failed = 0;
+	uint32_t num = (uint32_t)(sizeof(model_cases) / sizeof(model_cases[0]));
+
+	for (i = 0; i < num; i++) {
+		if (model_check(&model_cases[i]) != 0)
+			failed++;
+	}
+
+	printf("mipi model: %u cases, %u failed\n", num, failed);
+	return (failed != 0U) ? 1 : 0;
+}
@@ -55,10 +55,16 @@
 #define OSD_IOC_STA_BIN                 _IOWR(OSD_IOC_MAGIC, 12, struct osd_sta_bin_info)
 #define OSD_IOC_COLOR_MAP               _IOWR(OSD_IOC_MAGIC, 13, struct osd_color_map)
 #define OSD_IOC_PROC_BUF                _IOW(OSD_IOC_MAGIC, 14, struct osd_proc_buf_info)
+#define OSD_IOC_STA_LUMA                _IOWR(OSD_IOC_MAGIC, 15, struct osd_sta_luma_info)
+#define OSD_IOC_STA_LEVEL_EXT           _IOW(OSD_IOC_MAGIC, 16, struct osd_sta_level_ext_info)
+#define OSD_IOC_STA_BIN_EXT             _IOWR(OSD_IOC_MAGIC, 17, struct osd_sta_bin_ext_info)
 
 #define MAX_OSD_NUM 4
 #define MAX_STA_NUM 8
 #define MAX_OSD_STA_LEVEL_NUM 3
+// sw sta of ds4 only, same as OSD_STA_NEON_LEVEL_NUM of the histogram kernels
+#define MAX_OSD_STA_EXT_LEVEL_NUM 7
+#define MAX_STA_EXT_BIN_NUM (MAX_OSD_STA_EXT_LEVEL_NUM + 1)
 #define MAX_OSD_COLOR_NUM 16
 
 struct osd_box {
@@ -230,6 +236,30 @@ struct osd_sta_bin_info {
 	uint16_t sta_value[MAX_STA_NUM][MAX_STA_BIN_NUM];
 };
 
+// sw sta of ds4 only: 1~7 levels, 0 goes back to the levels of OSD_IOC_STA;
+// while set, bins are read by OSD_IOC_STA_BIN_EXT instead of OSD_IOC_STA_BIN
+struct osd_sta_level_ext_info {
+	int32_t chn_id;
+	int32_t ctx_id;
+	uint32_t level_num;
+	uint8_t sta_level[MAX_OSD_STA_EXT_LEVEL_NUM];
+};
+
+// sw sta of ds4 only, level_num + 1 bins of each region are valid
+struct osd_sta_bin_ext_info {
+	int32_t chn_id;
+	int32_t ctx_id;
+	uint32_t level_num;
+	uint16_t sta_value[MAX_STA_NUM][MAX_STA_EXT_BIN_NUM];
+};
+
+// block average luma of sw sta regions, updated with sta bins
+struct osd_sta_luma_info {
+	int32_t chn_id;
+	int32_t ctx_id;
+	uint8_t sta_luma[MAX_STA_NUM];
+};
+
 struct osd_proc_buf_info {
 	int32_t handle_id;
 	uint8_t invert_en;
@@ -272,6 +302,11 @@ struct osd_sta {
 	uint8_t sta_level[MAX_OSD_STA_LEVEL_NUM];
 	struct osd_sta_box sta_box[MAX_STA_NUM];
 	volatile uint16_t sta_value[MAX_STA_NUM][MAX_STA_BIN_NUM];
+	// set by OSD_IOC_STA_LEVEL_EXT, 0 means sta_level/sta_value are used
+	uint32_t sta_level_num;
+	uint8_t sta_level_ext[MAX_OSD_STA_EXT_LEVEL_NUM];
+	volatile uint16_t sta_value_ext[MAX_STA_NUM][MAX_STA_EXT_BIN_NUM];
+	uint8_t sta_luma[MAX_STA_NUM];
 	struct osd_process_info sta_proc[MAX_STA_NUM];
 	struct kthread_work work;
 };
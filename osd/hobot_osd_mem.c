@@ -8,6 +8,7 @@
 #include <asm/cacheflush.h>
 #include <linux/delay.h>
 #include <linux/spinlock.h>
+#include <linux/mm.h>
 
 #include "hobot_osd_mem.h"
 #include "vio_config.h"
@@ -169,6 +170,8 @@ void osd_single_buffer_destroy(struct ion_client *client, struct osd_single_buff
 		ion_free(client, buf->ion_handle);
 		buf->ion_handle = NULL;
 	}
+	kvfree(buf->dirty.tile_hash);
+	memset(&buf->dirty, 0, sizeof(buf->dirty));
 	buf->paddr = 0;
 	buf->vaddr = NULL;
 	buf->length = 0;
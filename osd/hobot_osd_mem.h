@@ -12,6 +12,7 @@
 #include <linux/types.h>
 
 #include "osd_config.h"
+#include "hobot_osd_vga4.h"
 #include "vio_framemgr.h"
 
 #define OSD_PP_BUF 2
@@ -44,6 +45,7 @@ struct osd_single_buffer {
 	enum osd_buf_state state;
 	enum osd_pixel_format pixel_fmt;
 	atomic_t ref_count;
+	struct osd_vga4_dirty dirty;
 };
 
 struct osd_buffer {
@@ -830,11 +830,10 @@ static int32_t osd_set_buffer(struct osd_video_ctx *osd_ctx, unsigned long arg)
 
 		osd_single_buffer_flush(&handle->buffer.buf[buffer_info.index]);
 		if (handle->buffer.vga_buf[buffer_info.index].state != OSD_BUF_NULL) {
-			osd_vga4_to_sw(g_osd_color.color_map,
-					handle->buffer.buf[buffer_info.index].vaddr,
-					handle->buffer.vga_buf[buffer_info.index].vaddr,
+			osd_vga4_to_sw_dirty(g_osd_color.color_map,
+					&handle->buffer.buf[buffer_info.index],
+					&handle->buffer.vga_buf[buffer_info.index],
 					handle->buffer.size.w, handle->buffer.size.h);
-			osd_single_buffer_flush(&handle->buffer.vga_buf[buffer_info.index]);
 		}
 
 		handle_update_buffer(handle, buffer_info.index);
@@ -935,7 +934,7 @@ static int32_t osd_attach(struct osd_video_ctx *osd_ctx, unsigned long arg)
 				goto exit_free_bind;
 			}
 			vga_buf = &handle->buffer.vga_buf[buf_index];
-			osd_vga4_to_sw(g_osd_color.color_map, single_buf->vaddr, vga_buf->vaddr,
+			osd_vga4_to_sw_dirty(g_osd_color.color_map, single_buf, vga_buf,
 					handle->buffer.size.w, handle->buffer.size.h);
 			osd_single_buffer_flush(single_buf);
 		}
@@ -1169,9 +1168,8 @@ static int32_t osd_set_bind_attr(struct osd_video_ctx *osd_ctx, unsigned long ar
 				return -EFAULT;
 			}
 			vga_buf = &handle->buffer.vga_buf[buf_index];
-			osd_vga4_to_sw(g_osd_color.color_map, single_buf->vaddr, vga_buf->vaddr,
+			osd_vga4_to_sw_dirty(g_osd_color.color_map, single_buf, vga_buf,
 					handle->buffer.size.w, handle->buffer.size.h);
-			osd_single_buffer_flush(vga_buf);
 		}
 
 		mutex_lock(&bind->proc_info.proc_mutex);
@@ -1279,32 +1277,50 @@ static int32_t osd_set_sta_level(struct osd_video_ctx *osd_ctx, unsigned long ar
 	return ret;
 }
 
-static int32_t osd_get_sta_bin_value(struct osd_video_ctx *osd_ctx, unsigned long arg)
+static bool osd_sta_bin_ready(struct osd_sta *osd_sta, uint32_t index)
 {
-	int32_t ret, i;
+	uint32_t k;
+
+	if (osd_sta->sta_level_num == 0u) {
+		for (k = 0; k < MAX_STA_BIN_NUM; k++) {
+			if (osd_sta->sta_value[index][k] != 0)
+				return true;
+		}
+	} else {
+		for (k = 0; k <= osd_sta->sta_level_num; k++) {
+			if (osd_sta->sta_value_ext[index][k] != 0)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * wait for the bins of the last sta request and move them to sta_value,
+ * bin_num is MAX_STA_BIN_NUM or MAX_STA_EXT_BIN_NUM
+ */
+static int32_t osd_get_sta_bin_common(struct osd_video_ctx *osd_ctx, int32_t chn_id,
+				int32_t ctx_id, uint16_t *sta_value, uint32_t bin_num)
+{
+	int32_t ret = 0, i;
 	struct osd_dev *osd_dev;
-	struct osd_sta_bin_info sta_bin_info;
 	struct osd_subdev *subdev;
 	uint32_t enable_index;
 	struct vse_nat_instance *vse_ctx = NULL;
-
-	ret = copy_from_user((void *)&sta_bin_info, (void __user *)arg, sizeof(struct osd_sta_bin_info));
-	if (ret) {
-		osd_err("copy_from_user failed\n");
-		return ret;
-	}
+	volatile uint16_t *bin_src;
 
 	osd_dev = osd_ctx->osd_dev;
-	subdev = &osd_dev->subdev[sta_bin_info.chn_id][sta_bin_info.ctx_id];
+	subdev = &osd_dev->subdev[chn_id][ctx_id];
 	enable_index = subdev->osd_sta.enable_index;
 
 	if (subdev->osd_sta.sta_state == OSD_STA_NULL) {
 		osd_err("[CHN%d][CTX%d] need set sta first, now state:%d\n",
-			sta_bin_info.chn_id, sta_bin_info.ctx_id, subdev->osd_sta.sta_state);
+			chn_id, ctx_id, subdev->osd_sta.sta_state);
 		return -EFAULT;
 	}
 	if (enable_index == MAX_STA_NUM) {
-		osd_warn("[CHN%d][CTX%d] no enable sta\n", sta_bin_info.chn_id, sta_bin_info.ctx_id);
+		osd_warn("[CHN%d][CTX%d] no enable sta\n", chn_id, ctx_id);
 		goto exit_sta_null;
 	}
 
@@ -1312,9 +1328,9 @@ static int32_t osd_get_sta_bin_value(struct osd_video_ctx *osd_ctx, unsigned lon
 		vse_ctx = container_of(subdev->osd_hw_cfg, struct vse_nat_instance, osd_hw_cfg);
 
 	for (i = 0; i <= OSD_STA_WAIT_CNT; i++) {
-		if (sta_bin_info.chn_id != OSD_VSE_DS4) {
+		if (chn_id != OSD_VSE_DS4) {
 			if (subdev->osd_info && subdev->osd_info->get_sta_val) {
-				ret = subdev->osd_info->get_sta_val(vse_ctx, sta_bin_info.chn_id, subdev->osd_sta.sta_value);
+				ret = subdev->osd_info->get_sta_val(vse_ctx, chn_id, subdev->osd_sta.sta_value);
 				if (ret == -EBUSY) {
 					osd_debug("sta has not been updated\n");
 					msleep(10);
@@ -1332,24 +1348,24 @@ static int32_t osd_get_sta_bin_value(struct osd_video_ctx *osd_ctx, unsigned lon
 		} else {
 			kthread_flush_work(&subdev->work);
 		}
-		if ((subdev->osd_sta.sta_value[enable_index][0] != 0) ||
-			(subdev->osd_sta.sta_value[enable_index][1] != 0) ||
-			(subdev->osd_sta.sta_value[enable_index][2] != 0) ||
-			(subdev->osd_sta.sta_value[enable_index][3] != 0)) {
+		if (osd_sta_bin_ready(&subdev->osd_sta, enable_index))
 			break;
-		}
 		msleep(10);
 	}
 	if (i == OSD_STA_WAIT_CNT) {
 		osd_err("[CHN%d][CTX%d] timeout sta bin was null, now enable_index: %d\n",
-			sta_bin_info.chn_id, sta_bin_info.ctx_id, enable_index);
+			chn_id, ctx_id, enable_index);
 		ret = -ETIMEDOUT;
 		goto exit_sta_null;
 	}
 
 	mutex_lock(&subdev->sta_mutex);
-	memcpy(sta_bin_info.sta_value, (void *)subdev->osd_sta.sta_value, MAX_STA_NUM * MAX_STA_BIN_NUM * sizeof(uint16_t));
-	memset((void *)subdev->osd_sta.sta_value, 0, MAX_STA_NUM * MAX_STA_BIN_NUM * sizeof(uint16_t));
+	if (bin_num == MAX_STA_EXT_BIN_NUM)
+		bin_src = &subdev->osd_sta.sta_value_ext[0][0];
+	else
+		bin_src = &subdev->osd_sta.sta_value[0][0];
+	memcpy(sta_value, (void *)bin_src, MAX_STA_NUM * bin_num * sizeof(uint16_t));
+	memset((void *)bin_src, 0, MAX_STA_NUM * bin_num * sizeof(uint16_t));
 	subdev->osd_sta.sta_state = OSD_STA_NULL;
 	mutex_unlock(&subdev->sta_mutex);
 
@@ -1357,6 +1373,34 @@ static int32_t osd_get_sta_bin_value(struct osd_video_ctx *osd_ctx, unsigned lon
 	osd_sw_set_process_flag(subdev);
 	mutex_unlock(&subdev->bind_mutex);
 
+	return ret;
+
+exit_sta_null:
+	subdev->osd_sta.sta_state = OSD_STA_NULL;
+
+	mutex_lock(&subdev->bind_mutex);
+	osd_sw_set_process_flag(subdev);
+	mutex_unlock(&subdev->bind_mutex);
+
+	return ret;
+}
+
+static int32_t osd_get_sta_bin_value(struct osd_video_ctx *osd_ctx, unsigned long arg)
+{
+	int32_t ret;
+	struct osd_sta_bin_info sta_bin_info;
+
+	ret = copy_from_user((void *)&sta_bin_info, (void __user *)arg, sizeof(struct osd_sta_bin_info));
+	if (ret) {
+		osd_err("copy_from_user failed\n");
+		return ret;
+	}
+
+	ret = osd_get_sta_bin_common(osd_ctx, sta_bin_info.chn_id, sta_bin_info.ctx_id,
+		&sta_bin_info.sta_value[0][0], MAX_STA_BIN_NUM);
+	if (ret < 0)
+		return ret;
+
 	ret = copy_to_user((void __user *)arg, (void *)&sta_bin_info, sizeof(struct osd_sta_bin_info));
 	if (ret) {
 		osd_err("copy_to_user failed\n");
@@ -1366,13 +1410,115 @@ static int32_t osd_get_sta_bin_value(struct osd_video_ctx *osd_ctx, unsigned lon
 	osd_debug("[CHN%d][CTX%d] done\n", sta_bin_info.chn_id, sta_bin_info.ctx_id);
 
 	return ret;
+}
 
-exit_sta_null:
-	subdev->osd_sta.sta_state = OSD_STA_NULL;
+static int32_t osd_set_sta_level_ext(struct osd_video_ctx *osd_ctx, unsigned long arg)
+{
+	int32_t ret;
+	struct osd_dev *osd_dev;
+	struct osd_sta_level_ext_info level_info;
+	struct osd_subdev *subdev;
 
-	mutex_lock(&subdev->bind_mutex);
-	osd_sw_set_process_flag(subdev);
-	mutex_unlock(&subdev->bind_mutex);
+	ret = copy_from_user((void *)&level_info, (void __user *)arg, sizeof(struct osd_sta_level_ext_info));
+	if (ret) {
+		osd_err("copy_from_user failed\n");
+		return -EFAULT;
+	}
+	if ((level_info.chn_id != OSD_VSE_DS4) ||
+		(level_info.ctx_id < 0) || (level_info.ctx_id >= VIO_MAX_STREAM) ||
+		(level_info.level_num > MAX_OSD_STA_EXT_LEVEL_NUM)) {
+		osd_err("invalid chn %d ctx %d level_num %d\n", level_info.chn_id,
+			level_info.ctx_id, level_info.level_num);
+		return -EINVAL;
+	}
+
+	osd_dev = osd_ctx->osd_dev;
+	subdev = &osd_dev->subdev[level_info.chn_id][level_info.ctx_id];
+
+	mutex_lock(&subdev->sta_mutex);
+	memcpy(subdev->osd_sta.sta_level_ext, level_info.sta_level,
+		MAX_OSD_STA_EXT_LEVEL_NUM * sizeof(uint8_t));
+	subdev->osd_sta.sta_level_num = level_info.level_num;
+	mutex_unlock(&subdev->sta_mutex);
+
+	osd_debug("[CHN%d][CTX%d] level_num %d\n", level_info.chn_id, level_info.ctx_id,
+		level_info.level_num);
+
+	return ret;
+}
+
+static int32_t osd_get_sta_bin_ext(struct osd_video_ctx *osd_ctx, unsigned long arg)
+{
+	int32_t ret;
+	struct osd_sta_bin_ext_info bin_info;
+	struct osd_subdev *subdev;
+
+	ret = copy_from_user((void *)&bin_info, (void __user *)arg, sizeof(struct osd_sta_bin_ext_info));
+	if (ret) {
+		osd_err("copy_from_user failed\n");
+		return -EFAULT;
+	}
+	if ((bin_info.chn_id != OSD_VSE_DS4) ||
+		(bin_info.ctx_id < 0) || (bin_info.ctx_id >= VIO_MAX_STREAM)) {
+		osd_err("invalid chn %d ctx %d\n", bin_info.chn_id, bin_info.ctx_id);
+		return -EINVAL;
+	}
+
+	subdev = &osd_ctx->osd_dev->subdev[bin_info.chn_id][bin_info.ctx_id];
+	if (subdev->osd_sta.sta_level_num == 0u) {
+		osd_err("[CHN%d][CTX%d] need set ext level first\n", bin_info.chn_id, bin_info.ctx_id);
+		return -EINVAL;
+	}
+	bin_info.level_num = subdev->osd_sta.sta_level_num;
+
+	ret = osd_get_sta_bin_common(osd_ctx, bin_info.chn_id, bin_info.ctx_id,
+		&bin_info.sta_value[0][0], MAX_STA_EXT_BIN_NUM);
+	if (ret < 0)
+		return ret;
+
+	ret = copy_to_user((void __user *)arg, (void *)&bin_info, sizeof(struct osd_sta_bin_ext_info));
+	if (ret) {
+		osd_err("copy_to_user failed\n");
+		return -EFAULT;
+	}
+
+	osd_debug("[CHN%d][CTX%d] done\n", bin_info.chn_id, bin_info.ctx_id);
+
+	return ret;
+}
+
+static int32_t osd_get_sta_luma(struct osd_video_ctx *osd_ctx, unsigned long arg)
+{
+	int32_t ret;
+	struct osd_dev *osd_dev;
+	struct osd_sta_luma_info sta_luma_info;
+	struct osd_subdev *subdev;
+
+	ret = copy_from_user((void *)&sta_luma_info, (void __user *)arg, sizeof(struct osd_sta_luma_info));
+	if (ret) {
+		osd_err("copy_from_user failed\n");
+		return -EFAULT;
+	}
+	if ((sta_luma_info.chn_id < 0) || (sta_luma_info.chn_id >= OSD_CHN_MAX) ||
+		(sta_luma_info.ctx_id < 0) || (sta_luma_info.ctx_id >= VIO_MAX_STREAM)) {
+		osd_err("invalid chn %d ctx %d\n", sta_luma_info.chn_id, sta_luma_info.ctx_id);
+		return -EINVAL;
+	}
+
+	osd_dev = osd_ctx->osd_dev;
+	subdev = &osd_dev->subdev[sta_luma_info.chn_id][sta_luma_info.ctx_id];
+
+	mutex_lock(&subdev->sta_mutex);
+	memcpy(sta_luma_info.sta_luma, subdev->osd_sta.sta_luma, MAX_STA_NUM * sizeof(uint8_t));
+	mutex_unlock(&subdev->sta_mutex);
+
+	ret = copy_to_user((void __user *)arg, (void *)&sta_luma_info, sizeof(struct osd_sta_luma_info));
+	if (ret) {
+		osd_err("copy_to_user failed\n");
+		return -EFAULT;
+	}
+
+	osd_debug("[CHN%d][CTX%d] done\n", sta_luma_info.chn_id, sta_luma_info.ctx_id);
 
 	return ret;
 }
@@ -1504,9 +1650,8 @@ static int32_t osd_proc_buf(struct osd_video_ctx *osd_ctx, unsigned long arg)
 					goto exit;
 				}
 				vga_buf = &handle->buffer.vga_buf[buf_index];
-				osd_vga4_to_sw(g_osd_color.color_map, single_buf->vaddr, vga_buf->vaddr,
+				osd_vga4_to_sw_dirty(g_osd_color.color_map, single_buf, vga_buf,
 						handle->buffer.size.w, handle->buffer.size.h);
-				osd_single_buffer_flush(vga_buf);
 			}
 		}
 
@@ -1623,6 +1768,15 @@ long hb_osd_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 	case OSD_IOC_STA_BIN:
 		ret = osd_get_sta_bin_value(osd_ctx, arg);
 		break;
+	case OSD_IOC_STA_LUMA:
+		ret = osd_get_sta_luma(osd_ctx, arg);
+		break;
+	case OSD_IOC_STA_LEVEL_EXT:
+		ret = osd_set_sta_level_ext(osd_ctx, arg);
+		break;
+	case OSD_IOC_STA_BIN_EXT:
+		ret = osd_get_sta_bin_ext(osd_ctx, arg);
+		break;
 	case OSD_IOC_COLOR_MAP:
 		ret = osd_set_color_map(osd_ctx, arg);
 		break;
@@ -1718,6 +1872,8 @@ static void osd_frame_process_workfunc(struct kthread_work *work)
 	struct osd_dev *osd_dev;
 	struct vio_frame *vio_frame;
 	struct osd_process_info *process_info;
+	struct osd_process_info *sta_list[MAX_STA_NUM];
+	uint32_t sta_num = 0;
 
 	subdev = container_of(work, struct osd_subdev, work);
 	osd_dev = subdev->osd_dev;
@@ -1734,10 +1890,12 @@ static void osd_frame_process_workfunc(struct kthread_work *work)
 	mutex_lock(&subdev->sta_mutex);
 	if (subdev->osd_sta.sta_state == OSD_STA_REQUEST) {
 		subdev->osd_sta.sta_state = OSD_STA_PROCESS;
+		sta_num = 0;
 		for (i = 0; i < MAX_STA_NUM; i++) {
 			if (osd_dev->task_state == OSD_TASK_REQUEST_STOP ||
 				osd_dev->task_state == OSD_TASK_STOP) {
 				osd_debug("task request stop, exit\n");
+				sta_num = 0;
 				break;
 			}
 			if (subdev->osd_sta.sta_box[i].sta_en) {
@@ -1748,8 +1906,16 @@ static void osd_frame_process_workfunc(struct kthread_work *work)
 				process_info->height = subdev->osd_sta.sta_box[i].height;
 				process_info->start_x = subdev->osd_sta.sta_box[i].start_x;
 				process_info->start_y = subdev->osd_sta.sta_box[i].start_y;
-				process_info->sta_level = subdev->osd_sta.sta_level;
-				process_info->sta_bin_value = (uint16_t *)subdev->osd_sta.sta_value[i];
+				if (subdev->osd_sta.sta_level_num != 0u) {
+					process_info->sta_level = subdev->osd_sta.sta_level_ext;
+					process_info->sta_level_num = subdev->osd_sta.sta_level_num;
+					process_info->sta_bin_value = (uint16_t *)subdev->osd_sta.sta_value_ext[i];
+				} else {
+					process_info->sta_level = subdev->osd_sta.sta_level;
+					process_info->sta_level_num = MAX_OSD_STA_LEVEL_NUM;
+					process_info->sta_bin_value = (uint16_t *)subdev->osd_sta.sta_value[i];
+				}
+				process_info->sta_luma = &subdev->osd_sta.sta_luma[i];
 
 				process_info->frame_id = vio_frame->frameinfo.frameid.frame_id;
 				process_info->buffer_index = vio_frame->frameinfo.bufferindex;
@@ -1759,10 +1925,12 @@ static void osd_frame_process_workfunc(struct kthread_work *work)
 				process_info->tar_uv_addr = __va(vio_frame->vbuf.group_info.info[0].paddr[1]);
 				process_info->proc_type = OSD_PROC_STA;
 
-				osd_run_process(process_info);
+				sta_list[sta_num++] = process_info;
 			}
 			subdev->osd_sta.sta_state = OSD_STA_DONE;
 		}
+		// all regions in one pass over the frame
+		osd_process_sta_multi(sta_list, sta_num);
 		memset(subdev->osd_sta.sta_box, 0, MAX_STA_NUM * sizeof(struct osd_sta_box));
 	}
 	mutex_unlock(&subdev->sta_mutex);
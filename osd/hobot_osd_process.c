@@ -8,9 +8,11 @@
 #include <linux/slab.h>
 #include <asm/neon.h>
 #include <linux/time.h>
+#include <linux/mm.h>
 
 #include "osd_config.h"
 #include "hobot_osd_process.h"
+#include "hobot_osd_mem.h"
 #include "hobot_osd_dev.h"
 
 extern struct osd_color_map g_osd_color;
@@ -35,86 +37,24 @@ extern struct osd_alpha_map g_osd_alpha;
 #define OSD_FILL_FF00 0xff00u
 
 /*
- * vga4:    alhpa0  color0  alpha1  color2
- *          |---1byte----|  |---1byte----|
- *
- * yuv420:y:pixel0  pixel1  pixel2  pixel3
- *          |1byte| |1byte| |1byte| |1byte|
- *          ...
- *        uv:pixel0  pixel1  pixel2  pixel3
- *          pixel4  pixel5  pixel6  pixel7
- *          |---2byte----|  |---2byte----|
- *          ...
- *
- * [or] use for alpha
+ * vga4 -> yuv420 of the whole buffer, see osd_vga4_conv_ref for the layout
  */
 int32_t osd_vga4_to_sw(uint32_t *color_map, uint8_t *src_addr,
 			uint8_t *tar_addr, uint32_t width, uint32_t height)
 {
-	uint8_t *vga_addr;
-	uint8_t color_alpha_index, color_index, alpha_index;
-	uint8_t *addr_y, *addr_y_or;
-	uint8_t *addr_uv, *addr_uv_or;
-	uint8_t *addr_y_offset, *addr_y_offset_or;
-	uint8_t *addr_uv_offset, *addr_uv_offset_or;
-	uint16_t color_vu;
 	osal_time_t time_now = { 0 };
 	osal_time_t time_next = { 0 };
 	uint64_t time_us;
-	uint32_t h, w, base_offset;
-	uint32_t *color_map_tmp = NULL;
 
 	osal_time_get(&time_now);
 
-	vga_addr = src_addr;
-	addr_y = tar_addr;
-	addr_uv = &addr_y[width * height];
-	addr_y_or = &addr_uv[(width * height) >> 1];
-	addr_uv_or = &addr_y_or[width * height];
-
-	if (color_map == NULL) {
-		color_map_tmp = g_osd_color.color_map;
-	} else {
-		color_map_tmp = color_map;
-	}
+	if (color_map == NULL)
+		color_map = g_osd_color.color_map;
 
 	osd_debug("vga4-->yuv420 width: %d, height: %d, vga4 addr: %p, yuv420 addr: %p\n",
 		width, height, src_addr, tar_addr);
 
-	memset((void *)addr_y, 0x00, (size_t)width * (size_t)height);
-	memset((void *)addr_uv, 0x00, ((size_t)width * (size_t)height) >> 1u);
-	memset((void *)addr_y_or, 0x00, (size_t)width * (size_t)height);
-	memset((void *)addr_uv_or, 0x00, ((size_t)width * (size_t)height) >> 1u);
-
-	for (h = 0; h < height; h++) {
-		base_offset = h * width;
-		for (w = 0; w < width; w += 1) {
-			color_alpha_index = vga_addr[base_offset + w];
-			color_index = color_alpha_index & OSD_FILL_0F;
-			alpha_index = color_alpha_index >> 4;
-
-			addr_y_offset = &addr_y[base_offset + w];
-			addr_uv_offset = &addr_uv[((h >> 1u) * width) + w];
-			addr_y_offset_or = &addr_y_or[base_offset + w];
-			addr_uv_offset_or = &addr_uv_or[((h >> 1u) * width) + w];
-
-			// todo: remove it
-			if (alpha_index == 0xF)
-				alpha_index = 0xFF;
-			else
-				alpha_index = 0;
-
-			addr_y_offset[0] = (uint8_t)(color_map_tmp[color_index] & OSD_FILL_FF);
-			addr_y_offset_or[0] = alpha_index;
-
-			if (w % 2 == 0) {
-				color_vu = (uint16_t)(color_map_tmp[color_index] >> 8);
-				*(uint16_t *)addr_uv_offset = color_vu;
-				addr_uv_offset_or[0] = alpha_index;
-				addr_uv_offset_or[1] = alpha_index;
-			}
-		}
-	}
+	osd_vga4_conv_ref(color_map, src_addr, tar_addr, width, height);
 
 	osal_time_get(&time_next);
 	time_us = (((time_next.tv_sec * 1000 * 1000) + time_next.tv_nsec / 1000) -
@@ -125,6 +65,94 @@ int32_t osd_vga4_to_sw(uint32_t *color_map, uint8_t *src_addr,
 	return 0;
 }
 
+/*
+ * vga4: write back the converted rectangle of all four planes
+ */
+static void osd_vga4_flush_rect(void *priv, uint32_t width, uint32_t height,
+			uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+	struct osd_single_buffer *tar_buf = (struct osd_single_buffer *)priv;
+	uint64_t y_base, uv_base, y_or_base, uv_or_base;
+	uint32_t row, uv_first, uv_last;
+
+	y_base = tar_buf->paddr;
+	uv_base = y_base + (uint64_t)width * height;
+	y_or_base = uv_base + (((uint64_t)width * height) >> 1);
+	uv_or_base = y_or_base + (uint64_t)width * height;
+	uv_first = y >> 1u;
+	uv_last = (y + h - 1u) >> 1u;
+
+	if ((x == 0u) && (w == width)) {
+		ion_dcache_flush(y_base + (uint64_t)y * width, (size_t)h * width);
+		ion_dcache_flush(y_or_base + (uint64_t)y * width, (size_t)h * width);
+		ion_dcache_flush(uv_base + (uint64_t)uv_first * width,
+			(size_t)(uv_last - uv_first + 1u) * width);
+		ion_dcache_flush(uv_or_base + (uint64_t)uv_first * width,
+			(size_t)(uv_last - uv_first + 1u) * width);
+		return;
+	}
+
+	for (row = y; row < y + h; row++) {
+		ion_dcache_flush(y_base + (uint64_t)row * width + x, w);
+		ion_dcache_flush(y_or_base + (uint64_t)row * width + x, w);
+	}
+	for (row = uv_first; row <= uv_last; row++) {
+		ion_dcache_flush(uv_base + (uint64_t)row * width + x, w);
+		ion_dcache_flush(uv_or_base + (uint64_t)row * width + x, w);
+	}
+}
+
+/*
+ * vga4: incremental conversion, only the tiles whose source changed since
+ * the last conversion into tar_buf are converted and written back;
+ * a color map or size change converts the whole buffer.
+ * return the number of converted tiles
+ */
+int32_t osd_vga4_to_sw_dirty(uint32_t *color_map, struct osd_single_buffer *src_buf,
+			struct osd_single_buffer *tar_buf, uint32_t width, uint32_t height)
+{
+	struct osd_vga4_dirty *dirty = &tar_buf->dirty;
+	uint8_t tab[OSD_VGA4_TAB_SIZE];
+	uint64_t *tile_hash;
+	uint32_t ty;
+	int32_t tiles = 0;
+
+	if (color_map == NULL)
+		color_map = g_osd_color.color_map;
+	if ((src_buf->vaddr == NULL) || (tar_buf->vaddr == NULL) ||
+		(width == 0u) || (height == 0u))
+		return -EINVAL;
+
+	if (osd_vga4_dirty_stale(dirty, width, height)) {
+		kvfree(dirty->tile_hash);
+		dirty->tile_hash = NULL;
+		tile_hash = kvcalloc((size_t)OSD_VGA4_TILES_X(width) * OSD_VGA4_TILES_Y(height),
+					sizeof(uint64_t), GFP_KERNEL);
+		if (tile_hash == NULL) {
+			osd_err("vga4 dirty map alloc failed, full conversion\n");
+			memset(dirty, 0, sizeof(*dirty));
+			osd_vga4_to_sw(color_map, src_buf->vaddr, tar_buf->vaddr, width, height);
+			osd_single_buffer_flush(tar_buf);
+			return (int32_t)(OSD_VGA4_TILES_X(width) * OSD_VGA4_TILES_Y(height));
+		}
+		osd_vga4_dirty_init(dirty, tile_hash, width, height);
+	}
+
+	osd_vga4_dirty_prepare(dirty, color_map, tab);
+	for (ty = 0; ty < dirty->tiles_y; ty++) {
+		kernel_neon_begin();
+		tiles += (int32_t)osd_vga4_dirty_row(dirty, color_map, tab, src_buf->vaddr,
+			tar_buf->vaddr, ty, osd_vga4_flush_rect, tar_buf);
+		kernel_neon_end();
+	}
+	dirty->valid = 1;
+
+	osd_debug("vga4-->yuv420 %ux%u, %d/%u tiles converted\n",
+		width, height, tiles, dirty->tiles_x * dirty->tiles_y);
+
+	return tiles;
+}
+
 static int32_t osd_process_info_check(struct osd_process_info *proc_info,
 				uint32_t *crop_width, uint32_t *crop_height)
 {
@@ -915,74 +943,126 @@ void osd_process_mosaic_workfunc(struct osd_process_info *proc_info)
 		proc_info->height, cache_y_addr, cache_uv_addr, time_us);
 }
 
-void osd_process_sta_workfunc(struct osd_process_info *proc_info)
+static uint32_t osd_sta_level_num(const struct osd_process_info *proc_info)
 {
-	uint8_t *y_addr, *y_addr_temp;
-	uint32_t h, w;
-	osal_time_t time_now = {0};
-	osal_time_t time_next = {0};
-	uint64_t time_us;
-	uint32_t crop_width, crop_height;
+	if (proc_info->sta_level_num == 0u)
+		return MAX_OSD_STA_LEVEL_NUM;
+	if (proc_info->sta_level_num >= OSD_STA_MAX_BIN_NUM)
+		return OSD_STA_MAX_BIN_NUM - 1u;
 
-	if ((proc_info->subdev != NULL) &&
-		(proc_info->subdev->osd_dev->task_state >= OSD_TASK_REQUEST_STOP)) {
-		return;
-	}
-	if (proc_info->tar_y_addr == NULL) {
-		osd_err("process type:%d tar_addr y null error\n", proc_info->proc_type);
-		return;
-	}
+	return proc_info->sta_level_num;
+}
 
+static void osd_sta_crop(struct osd_process_info *proc_info,
+			uint32_t *crop_width, uint32_t *crop_height)
+{
 	if (proc_info->image_height > (proc_info->start_y + proc_info->height)) {
-		crop_height = proc_info->height;
+		*crop_height = proc_info->height;
 	} else if (proc_info->image_height > proc_info->start_y) {
-		crop_height = proc_info->image_height - proc_info->start_y;
+		*crop_height = proc_info->image_height - proc_info->start_y;
 	} else {
-		crop_height = 0;
+		*crop_height = 0;
 	}
 	if (proc_info->image_width > (proc_info->start_x + proc_info->width)) {
-		crop_width = proc_info->width;
+		*crop_width = proc_info->width;
 	} else if (proc_info->image_width > proc_info->start_x) {
-		crop_width = proc_info->image_width - proc_info->start_x;
+		*crop_width = proc_info->image_width - proc_info->start_x;
 	} else {
-		crop_width = 0;
+		*crop_width = 0;
+	}
+}
+
+/*
+ * sta: all regions of one frame in a single top-down pass, so that rows shared
+ * by several regions are only brought into cache once
+ */
+void osd_process_sta_multi(struct osd_process_info **proc_info, uint32_t num)
+{
+	uint32_t i, k, y, level_num;
+	uint32_t y_start = U32_MAX, y_end = 0;
+	uint32_t crop_width[MAX_STA_NUM], crop_height[MAX_STA_NUM];
+	struct osd_sta_hist hist[MAX_STA_NUM];
+	struct osd_sta_result *result;
+	struct osd_process_info *info;
+	osal_time_t time_now = {0};
+	osal_time_t time_next = {0};
+	uint64_t time_us;
+
+	if (num == 0u || num > MAX_STA_NUM)
+		return;
+
+	if ((proc_info[0]->subdev != NULL) &&
+		(proc_info[0]->subdev->osd_dev->task_state >= OSD_TASK_REQUEST_STOP)) {
+		return;
 	}
 
 	osal_time_get(&time_now);
 
-	y_addr = proc_info->tar_y_addr +
-		proc_info->start_y * proc_info->image_width + proc_info->start_x;
+	for (i = 0; i < num; i++) {
+		info = proc_info[i];
+		// level table is prepared once per region, not per row
+		osd_sta_hist_init(&hist[i], info->sta_level, osd_sta_level_num(info));
+		crop_width[i] = 0;
+		crop_height[i] = 0;
+		if (info->tar_y_addr == NULL) {
+			osd_err("process type:%d tar_addr y null error\n", info->proc_type);
+			continue;
+		}
+		osd_sta_crop(info, &crop_width[i], &crop_height[i]);
+		if (crop_width[i] == 0u || crop_height[i] == 0u)
+			continue;
+		if (info->start_y < y_start)
+			y_start = info->start_y;
+		if (info->start_y + crop_height[i] > y_end)
+			y_end = info->start_y + crop_height[i];
+	}
 
-	memset(proc_info->sta_bin_value, 0x00, MAX_STA_BIN_NUM * sizeof(uint16_t));
-	for (h = 0; h < crop_height; h++) {
-		y_addr_temp = y_addr;
-		for (w = 0; w < crop_width; w++) {
-			if (*y_addr_temp > proc_info->sta_level[2]) {
-				proc_info->sta_bin_value[3]++;
-			} else if (*y_addr_temp > proc_info->sta_level[1]) {
-				proc_info->sta_bin_value[2]++;
-			} else if (*y_addr_temp > proc_info->sta_level[0]) {
-				proc_info->sta_bin_value[1]++;
-			} else {
-				proc_info->sta_bin_value[0]++;
-			}
-			y_addr_temp++;
+	kernel_neon_begin();
+	for (y = y_start; y < y_end; y++) {
+		for (i = 0; i < num; i++) {
+			info = proc_info[i];
+			if (crop_width[i] == 0u || y < info->start_y ||
+				y >= info->start_y + crop_height[i])
+				continue;
+			osd_sta_hist_rows(&hist[i], info->tar_y_addr + y * info->image_width + info->start_x,
+				info->image_width, crop_width[i], 1);
 		}
-		y_addr += proc_info->image_width;
+	}
+	kernel_neon_end();
+
+	for (i = 0; i < num; i++) {
+		info = proc_info[i];
+		osd_sta_hist_finish(&hist[i]);
+		result = &hist[i].result;
+		level_num = hist[i].level_num;
+		for (k = 0; k <= level_num; k++)
+			info->sta_bin_value[k] = (uint16_t)result->bin[k];
+		if (info->sta_luma != NULL)
+			*info->sta_luma = (result->count != 0u) ?
+				(uint8_t)(result->sum / result->count) : 0u;
 	}
 
 	osal_time_get(&time_next);
 	time_us = (((time_next.tv_sec * 1000 * 1000) + time_next.tv_nsec / 1000) -
 		((time_now.tv_sec * 1000 * 1000) + time_now.tv_nsec / 1000));
 
-	osd_debug("sta process, x:%d y:%d w:%d h:%d y_addr:%p "
-		"sta_level: %d %d %d bin_value: %d %d %d %d, cost %lldus\n",
-		proc_info->start_x, proc_info->start_y, proc_info->width,
-		proc_info->height, y_addr,
-		proc_info->sta_level[0], proc_info->sta_level[1],
-		proc_info->sta_level[2], proc_info->sta_bin_value[0],
-		proc_info->sta_bin_value[1], proc_info->sta_bin_value[2],
-		proc_info->sta_bin_value[3], time_us);
+	for (i = 0; i < num; i++) {
+		info = proc_info[i];
+		osd_debug("sta process, x:%d y:%d w:%d h:%d "
+			"sta_level: %d %d %d bin_value: %d %d %d %d luma: %llu, cost %lldus\n",
+			info->start_x, info->start_y, info->width, info->height,
+			info->sta_level[0], info->sta_level[1],
+			info->sta_level[2], info->sta_bin_value[0],
+			info->sta_bin_value[1], info->sta_bin_value[2],
+			info->sta_bin_value[3],
+			(hist[i].result.count != 0u) ? hist[i].result.sum / hist[i].result.count : 0,
+			time_us);
+	}
+}
+
+void osd_process_sta_workfunc(struct osd_process_info *proc_info)
+{
+	osd_process_sta_multi(&proc_info, 1);
 }
 
 void osd_process_null_workfunc(struct osd_process_info *proc_info)
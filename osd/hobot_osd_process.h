@@ -10,6 +10,9 @@
 #include <linux/kthread.h>
 
 #include "osd_config.h"
+#include "hobot_osd_sta.h"
+
+struct osd_single_buffer;
 
 enum osd_process_type {
 	OSD_PROC_HW_VGA8 = 0,
@@ -36,7 +39,11 @@ struct osd_process_info {
 	uint8_t *src_vga_addr;
 	uint64_t src_paddr;
 	uint8_t *sta_level;
+	// 0 means MAX_OSD_STA_LEVEL_NUM, sta_bin_value holds sta_level_num + 1 bins
+	uint32_t sta_level_num;
 	uint16_t *sta_bin_value;
+	// block average luma, may be NULL
+	uint8_t *sta_luma;
 
 	uint32_t frame_id;
 	int32_t buffer_index;
@@ -59,6 +66,8 @@ struct osd_process_info {
 
 int32_t osd_vga4_to_sw(uint32_t *color_map, uint8_t *src_addr,
 			uint8_t *tar_addr, uint32_t width, uint32_t height);
+int32_t osd_vga4_to_sw_dirty(uint32_t *color_map, struct osd_single_buffer *src_buf,
+			struct osd_single_buffer *tar_buf, uint32_t width, uint32_t height);
 // int32_t osd_polygon_analyse(struct osd_polygon *polygon, struct osd_size *size);
 // void osd_process_vga4_workfunc(struct osd_process_info *proc_info);
 // void osd_process_nv12_workfunc(struct osd_process_info *proc_info);
@@ -67,6 +76,7 @@ int32_t osd_vga4_to_sw(uint32_t *color_map, uint8_t *src_addr,
 // void osd_process_mosaic_workfunc(struct osd_process_info *proc_info);
 // void osd_process_sta_workfunc(struct osd_process_info *proc_info);
 // void osd_process_null_workfunc(struct osd_process_info *proc_info);
+void osd_process_sta_multi(struct osd_process_info **proc_info, uint32_t num);
 void osd_run_process(struct osd_process_info *process_info);
 
 #endif // __HOBOT_OSD_PROCESS_H__
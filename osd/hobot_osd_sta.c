@@ -0,0 +1,209 @@
+/***************************************************************************
+ *                      COPYRIGHT NOTICE
+ *             Copyright 2019 Horizon Robotics, Inc.
+ *                     All rights reserved.
+ ***************************************************************************/
+
+/*
+ * sta histogram kernels, kept free of kernel-only headers so that the same
+ * file builds into osd/test for the host correctness test and benchmark
+ */
+#include "hobot_osd_sta.h"
+
+#define OSD_STA_LANES 16u
+/* sta: 255 blocks at most before the u8 per-lane counters wrap */
+#define OSD_STA_MAX_BLOCKS 255u
+#define OSD_STA_LEVEL_PAD 0xffu
+
+/*
+ * sta: reference histogram, pixel goes to bin k + 1 where k is the highest
+ * level it is greater than, or bin 0; results are accumulated
+ */
+void osd_sta_hist_ref(const uint8_t *y_addr, uint32_t stride, uint32_t width,
+			uint32_t height, const uint8_t *level, uint32_t level_num,
+			struct osd_sta_result *result)
+{
+	uint32_t h, w, k;
+	uint8_t pixel;
+
+	for (h = 0; h < height; h++) {
+		for (w = 0; w < width; w++) {
+			pixel = y_addr[w];
+			for (k = level_num; k > 0u; k--) {
+				if (pixel > level[k - 1u])
+					break;
+			}
+			result->bin[k]++;
+			result->sum += pixel;
+		}
+		result->count += width;
+		y_addr += stride;
+	}
+}
+
+/*
+ * sta: the vector path counts pixels greater than each level, the levels are
+ * made non-decreasing by suffix min so that bins are differences of the counts
+ * and match the reference for any level order; done once per region
+ */
+void osd_sta_hist_init(struct osd_sta_hist *hist, const uint8_t *level, uint32_t level_num)
+{
+	int32_t k;
+	uint8_t min_level = OSD_STA_LEVEL_PAD;
+
+	if (level_num > OSD_STA_NEON_LEVEL_NUM)
+		level_num = OSD_STA_NEON_LEVEL_NUM;
+
+	for (k = (int32_t)OSD_STA_MAX_BIN_NUM - 1; k >= 0; k--) {
+		if ((uint32_t)k < level_num && level[k] < min_level)
+			min_level = level[k];
+		hist->eff_level[k] = ((uint32_t)k < level_num) ? min_level : OSD_STA_LEVEL_PAD;
+		if ((uint32_t)k < OSD_STA_NEON_LEVEL_NUM)
+			hist->gt_cnt[k] = 0;
+	}
+	hist->level_num = level_num;
+	hist->pixels = 0;
+	hist->result = (struct osd_sta_result){0};
+}
+
+#ifdef __aarch64__
+/*
+ * sta: one row segment of blocks * 16 pixels, blocks <= OSD_STA_MAX_BLOCKS
+ * so that the u8 per-lane counters can't overflow; in the kernel it must be
+ * called between kernel_neon_begin and kernel_neon_end
+ */
+static void osd_sta_row_vec(const uint8_t *src, uint32_t blocks,
+			const uint8_t *eff_level, uint32_t *gt_cnt, uint64_t *sum)
+{
+	uint8_t acc[OSD_STA_NEON_LEVEL_NUM + 1u][OSD_STA_LANES];
+	uint32_t sum4[OSD_STA_LANES / 4u];
+	uint32_t k, lane;
+	uint8_t *acc_addr = &acc[0][0];
+
+	asm volatile (
+	"LD1    {v31.8B}, [%[level]]                            \n"
+	"DUP    v16.16B, v31.B[0]                               \n"
+	"DUP    v17.16B, v31.B[1]                               \n"
+	"DUP    v18.16B, v31.B[2]                               \n"
+	"DUP    v19.16B, v31.B[3]                               \n"
+	"DUP    v20.16B, v31.B[4]                               \n"
+	"DUP    v21.16B, v31.B[5]                               \n"
+	"DUP    v22.16B, v31.B[6]                               \n"
+	"MOVI   v0.16B, #0                                      \n"
+	"MOVI   v1.16B, #0                                      \n"
+	"MOVI   v2.16B, #0                                      \n"
+	"MOVI   v3.16B, #0                                      \n"
+	"MOVI   v4.16B, #0                                      \n"
+	"MOVI   v5.16B, #0                                      \n"
+	"MOVI   v6.16B, #0                                      \n"
+	"MOVI   v7.16B, #0                                      \n"
+	"CBZ    %w[blocks], 2f                                  \n"
+
+	"1:                                                     \n"
+	// neon process 16 bytes once, mask is 0xff when pixel > level
+	"LD1    {v23.16B}, [%[src]], #16                        \n"
+	"CMHI   v24.16B, v23.16B, v16.16B                       \n"
+	"CMHI   v25.16B, v23.16B, v17.16B                       \n"
+	"CMHI   v26.16B, v23.16B, v18.16B                       \n"
+	"CMHI   v27.16B, v23.16B, v19.16B                       \n"
+	"SUB    v0.16B, v0.16B, v24.16B                         \n"
+	"SUB    v1.16B, v1.16B, v25.16B                         \n"
+	"SUB    v2.16B, v2.16B, v26.16B                         \n"
+	"SUB    v3.16B, v3.16B, v27.16B                         \n"
+	"CMHI   v24.16B, v23.16B, v20.16B                       \n"
+	"CMHI   v25.16B, v23.16B, v21.16B                       \n"
+	"CMHI   v26.16B, v23.16B, v22.16B                       \n"
+	"SUB    v4.16B, v4.16B, v24.16B                         \n"
+	"SUB    v5.16B, v5.16B, v25.16B                         \n"
+	"SUB    v6.16B, v6.16B, v26.16B                         \n"
+	// luma sum, u8 -> u16 pairs -> u32 pairs
+	"UADDLP v27.8H, v23.16B                                 \n"
+	"UADALP v7.4S, v27.8H                                   \n"
+	"SUBS   %w[blocks], %w[blocks], #1                      \n"
+	"B.NE   1b                                              \n"
+
+	"2:                                                     \n"
+	"ST1    {v0.16B, v1.16B, v2.16B, v3.16B}, [%[acc]], #64 \n"
+	"ST1    {v4.16B, v5.16B, v6.16B}, [%[acc]]              \n"
+	"ST1    {v7.4S}, [%[sum4]]                              \n"
+	: [src]"+r"(src),
+		[blocks]"+r"(blocks),
+		[acc]"+r"(acc_addr)
+	: [level]"r"(eff_level),
+		[sum4]"r"(sum4)
+	: "cc", "memory", "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7",
+		"v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23",
+		"v24", "v25", "v26", "v27", "v31"    // Clobber List
+	);
+
+	for (k = 0; k < OSD_STA_NEON_LEVEL_NUM; k++) {
+		for (lane = 0; lane < OSD_STA_LANES; lane++)
+			gt_cnt[k] += acc[k][lane];
+	}
+	for (lane = 0; lane < OSD_STA_LANES / 4u; lane++)
+		*sum += sum4[lane];
+}
+#else
+/* sta: portable counterpart of the neon row segment, same counters */
+static void osd_sta_row_vec(const uint8_t *src, uint32_t blocks,
+			const uint8_t *eff_level, uint32_t *gt_cnt, uint64_t *sum)
+{
+	uint32_t i, k;
+
+	for (i = 0; i < blocks * OSD_STA_LANES; i++) {
+		for (k = 0; k < OSD_STA_NEON_LEVEL_NUM; k++)
+			gt_cnt[k] += (src[i] > eff_level[k]) ? 1u : 0u;
+		*sum += src[i];
+	}
+}
+#endif
+
+/*
+ * sta: accumulate rows of one region, 16 pixels once by the vector path and
+ * the tail of each row by scalar compares against the same level table
+ */
+void osd_sta_hist_rows(struct osd_sta_hist *hist, const uint8_t *y_addr, uint32_t stride,
+			uint32_t width, uint32_t height)
+{
+	uint32_t h, w, k, blocks, chunk, tail;
+	const uint8_t *src;
+
+	blocks = width / OSD_STA_LANES;
+	tail = width % OSD_STA_LANES;
+	for (h = 0; h < height; h++) {
+		src = y_addr;
+		for (k = blocks; k > 0u; k -= chunk) {
+			chunk = (k > OSD_STA_MAX_BLOCKS) ? OSD_STA_MAX_BLOCKS : k;
+			osd_sta_row_vec(src, chunk, hist->eff_level, hist->gt_cnt, &hist->result.sum);
+			src += chunk * OSD_STA_LANES;
+		}
+		for (w = 0; w < tail; w++) {
+			for (k = 0; k < hist->level_num; k++)
+				hist->gt_cnt[k] += (src[w] > hist->eff_level[k]) ? 1u : 0u;
+			hist->result.sum += src[w];
+		}
+		y_addr += stride;
+	}
+	hist->pixels += width * height;
+}
+
+/* sta: fold the level counters into bins of hist->result */
+void osd_sta_hist_finish(struct osd_sta_hist *hist)
+{
+	uint32_t k, level_num;
+	struct osd_sta_result *result = &hist->result;
+
+	level_num = hist->level_num;
+	if (level_num == 0u) {
+		result->bin[0] += hist->pixels;
+	} else {
+		result->bin[0] += hist->pixels - hist->gt_cnt[0];
+		for (k = 1; k < level_num; k++)
+			result->bin[k] += hist->gt_cnt[k - 1u] - hist->gt_cnt[k];
+		result->bin[level_num] += hist->gt_cnt[level_num - 1u];
+	}
+	result->count += hist->pixels;
+	for (k = 0; k < OSD_STA_NEON_LEVEL_NUM; k++)
+		hist->gt_cnt[k] = 0;
+	hist->pixels = 0;
+}
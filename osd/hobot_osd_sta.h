@@ -0,0 +1,44 @@
+/***************************************************************************
+ *                      COPYRIGHT NOTICE
+ *             Copyright 2019 Horizon Robotics, Inc.
+ *                     All rights reserved.
+ ***************************************************************************/
+
+#ifndef __HOBOT_OSD_STA_H__
+#define __HOBOT_OSD_STA_H__
+
+#include <linux/types.h>
+
+/* sta: levels/bins supported by the histogram kernels */
+#define OSD_STA_NEON_LEVEL_NUM 7u
+#define OSD_STA_MAX_BIN_NUM (OSD_STA_NEON_LEVEL_NUM + 1u)
+
+struct osd_sta_result {
+	uint32_t bin[OSD_STA_MAX_BIN_NUM];
+	uint64_t sum;
+	uint32_t count;
+};
+
+/*
+ * sta: histogram of one region accumulated row by row, the level table is
+ * prepared once by osd_sta_hist_init and bins are folded by osd_sta_hist_finish
+ */
+struct osd_sta_hist {
+	// levels made non-decreasing by suffix min, padded to 8 for the neon load
+	uint8_t eff_level[OSD_STA_MAX_BIN_NUM];
+	uint32_t level_num;
+	// pixels greater than eff_level[k]
+	uint32_t gt_cnt[OSD_STA_NEON_LEVEL_NUM];
+	uint32_t pixels;
+	struct osd_sta_result result;
+};
+
+void osd_sta_hist_ref(const uint8_t *y_addr, uint32_t stride, uint32_t width,
+			uint32_t height, const uint8_t *level, uint32_t level_num,
+			struct osd_sta_result *result);
+void osd_sta_hist_init(struct osd_sta_hist *hist, const uint8_t *level, uint32_t level_num);
+void osd_sta_hist_rows(struct osd_sta_hist *hist, const uint8_t *y_addr, uint32_t stride,
+			uint32_t width, uint32_t height);
+void osd_sta_hist_finish(struct osd_sta_hist *hist);
+
+#endif // __HOBOT_OSD_STA_H__
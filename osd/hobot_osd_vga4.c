@@ -0,0 +1,337 @@
+/***************************************************************************
+ *                      COPYRIGHT NOTICE
+ *             Copyright 2019 Horizon Robotics, Inc.
+ *                     All rights reserved.
+ ***************************************************************************/
+
+/*
+ * vga4 -> yuv420 conversion kernels, kept free of kernel-only headers so
+ * that the same file builds into osd/test for the host correctness test
+ * and benchmark
+ */
+#include <linux/string.h>
+#include <linux/xxhash.h>
+
+#include "hobot_osd_vga4.h"
+
+#define OSD_VGA4_LANES 16u
+#define OSD_VGA4_ALPHA_MIN 0xf0u
+#define OSD_VGA4_MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+/*
+ * vga4:    alhpa0  color0  alpha1  color2
+ *          |---1byte----|  |---1byte----|
+ *
+ * yuv420:y:pixel0  pixel1  pixel2  pixel3
+ *          |1byte| |1byte| |1byte| |1byte|
+ *          ...
+ *        uv:pixel0  pixel1  pixel2  pixel3
+ *          pixel4  pixel5  pixel6  pixel7
+ *          |---2byte----|  |---2byte----|
+ *          ...
+ *
+ * [or] use for alpha
+ */
+void osd_vga4_conv_ref(const uint32_t *color_map, const uint8_t *src_addr,
+			uint8_t *tar_addr, uint32_t width, uint32_t height)
+{
+	const uint8_t *vga_addr;
+	uint8_t color_alpha_index, color_index, alpha_index;
+	uint8_t *addr_y, *addr_y_or;
+	uint8_t *addr_uv, *addr_uv_or;
+	uint8_t *addr_y_offset, *addr_y_offset_or;
+	uint8_t *addr_uv_offset, *addr_uv_offset_or;
+	uint16_t color_vu;
+	uint32_t h, w, base_offset;
+
+	vga_addr = src_addr;
+	addr_y = tar_addr;
+	addr_uv = &addr_y[width * height];
+	addr_y_or = &addr_uv[(width * height) >> 1];
+	addr_uv_or = &addr_y_or[width * height];
+
+	memset((void *)addr_y, 0x00, (size_t)width * (size_t)height);
+	memset((void *)addr_uv, 0x00, ((size_t)width * (size_t)height) >> 1u);
+	memset((void *)addr_y_or, 0x00, (size_t)width * (size_t)height);
+	memset((void *)addr_uv_or, 0x00, ((size_t)width * (size_t)height) >> 1u);
+
+	for (h = 0; h < height; h++) {
+		base_offset = h * width;
+		for (w = 0; w < width; w += 1) {
+			color_alpha_index = vga_addr[base_offset + w];
+			color_index = color_alpha_index & 0x0fu;
+			alpha_index = color_alpha_index >> 4;
+
+			addr_y_offset = &addr_y[base_offset + w];
+			addr_uv_offset = &addr_uv[((h >> 1u) * width) + w];
+			addr_y_offset_or = &addr_y_or[base_offset + w];
+			addr_uv_offset_or = &addr_uv_or[((h >> 1u) * width) + w];
+
+			// todo: remove it
+			if (alpha_index == 0xF)
+				alpha_index = 0xFF;
+			else
+				alpha_index = 0;
+
+			addr_y_offset[0] = (uint8_t)(color_map[color_index] & 0xffu);
+			addr_y_offset_or[0] = alpha_index;
+
+			if (w % 2 == 0) {
+				color_vu = (uint16_t)(color_map[color_index] >> 8);
+				*(uint16_t *)addr_uv_offset = color_vu;
+				addr_uv_offset_or[0] = alpha_index;
+				addr_uv_offset_or[1] = alpha_index;
+			}
+		}
+	}
+}
+
+/*
+ * vga4: scalar conversion of the rectangle (x, y, w, h), same layout as osd_vga4_conv_ref
+ */
+static void osd_vga4_rect_sw(const uint32_t *color_map, const uint8_t *src_addr,
+			uint8_t *tar_addr, uint32_t width, uint32_t height,
+			uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+	uint8_t *addr_y, *addr_y_or;
+	uint8_t *addr_uv, *addr_uv_or;
+	uint8_t color_index, alpha;
+	uint32_t row, col, base_offset, uv_offset;
+
+	addr_y = tar_addr;
+	addr_uv = &addr_y[width * height];
+	addr_y_or = &addr_uv[(width * height) >> 1];
+	addr_uv_or = &addr_y_or[width * height];
+
+	for (row = y; row < y + h; row++) {
+		base_offset = row * width;
+		uv_offset = (row >> 1u) * width;
+		for (col = x; col < x + w; col++) {
+			color_index = src_addr[base_offset + col] & 0x0fu;
+			alpha = ((src_addr[base_offset + col] >> 4) == 0xFu) ? 0xFFu : 0u;
+
+			addr_y[base_offset + col] = (uint8_t)(color_map[color_index] & 0xffu);
+			addr_y_or[base_offset + col] = alpha;
+			if (col % 2u == 0u) {
+				*(uint16_t *)&addr_uv[uv_offset + col] =
+					(uint16_t)(color_map[color_index] >> 8);
+				addr_uv_or[uv_offset + col] = alpha;
+				addr_uv_or[uv_offset + col + 1u] = alpha;
+			}
+		}
+	}
+}
+
+static void osd_vga4_make_tab(const uint32_t *color_map, uint8_t *tab)
+{
+	uint32_t i;
+
+	for (i = 0; i < OSD_VGA4_COLOR_NUM; i++) {
+		tab[i] = (uint8_t)(color_map[i] & 0xffu);
+		tab[OSD_VGA4_LANES + i] = (uint8_t)((color_map[i] >> 8) & 0xffu);
+		tab[(2u * OSD_VGA4_LANES) + i] = (uint8_t)((color_map[i] >> 16) & 0xffu);
+	}
+}
+
+#ifdef __aarch64__
+/*
+ * vga4: convert blocks * 16 pixels of one row, in the kernel it must be
+ * called between kernel_neon_begin and kernel_neon_end
+ * y = ytab[idx], y_or = (src >= 0xf0) ? 0xff : 0
+ * uv is only written on the row which finally owns it (odd row or last row),
+ * vu pair = {vtab[idx], utab[idx]} of the even pixel, built with one tbl
+ */
+static void osd_vga4_row_vec(const uint8_t *src, uint8_t *y, uint8_t *y_or,
+			uint8_t *uv, uint8_t *uv_or, uint32_t blocks,
+			const uint8_t *tab, uint32_t do_uv)
+{
+	if (blocks == 0u)
+		return;
+
+	asm volatile(
+		"LD1 {v16.16B, v17.16B, v18.16B}, [%[tab]]	\n"
+		"MOVI v19.16B, #0x0f				\n"
+		"MOVI v20.16B, #0xf0				\n"
+		"MOVI v21.8H, #0x10, LSL #8			\n"
+		"1:						\n"
+		"LD1 {v0.16B}, [%[src]], #16			\n"
+		"AND v1.16B, v0.16B, v19.16B			\n"
+		"CMHS v2.16B, v0.16B, v20.16B			\n"
+		"TBL v3.16B, {v16.16B}, v1.16B			\n"
+		"ST1 {v3.16B}, [%[y]], #16			\n"
+		"ST1 {v2.16B}, [%[y_or]], #16			\n"
+		"CBZ %w[do_uv], 2f				\n"
+		"TRN1 v4.16B, v1.16B, v1.16B			\n"
+		"ORR v4.16B, v4.16B, v21.16B			\n"
+		"TBL v5.16B, {v17.16B, v18.16B}, v4.16B		\n"
+		"TRN1 v6.16B, v2.16B, v2.16B			\n"
+		"ST1 {v5.16B}, [%[uv]], #16			\n"
+		"ST1 {v6.16B}, [%[uv_or]], #16			\n"
+		"2:						\n"
+		"SUBS %w[blocks], %w[blocks], #1		\n"
+		"B.NE 1b					\n"
+		: [src] "+r"(src), [y] "+r"(y), [y_or] "+r"(y_or),
+		  [uv] "+r"(uv), [uv_or] "+r"(uv_or), [blocks] "+r"(blocks)
+		: [tab] "r"(tab), [do_uv] "r"(do_uv)
+		: "cc", "memory", "v0", "v1", "v2", "v3", "v4", "v5", "v6",
+		  "v16", "v17", "v18", "v19", "v20", "v21");
+}
+#else
+/* vga4: portable counterpart of the neon row, lane for lane the same stores */
+static void osd_vga4_row_vec(const uint8_t *src, uint8_t *y, uint8_t *y_or,
+			uint8_t *uv, uint8_t *uv_or, uint32_t blocks,
+			const uint8_t *tab, uint32_t do_uv)
+{
+	uint32_t i, idx, even;
+
+	for (i = 0; i < blocks * OSD_VGA4_LANES; i++) {
+		idx = src[i] & 0x0fu;
+		y[i] = tab[idx];
+		y_or[i] = (src[i] >= OSD_VGA4_ALPHA_MIN) ? 0xffu : 0u;
+		if (do_uv == 0u)
+			continue;
+		/* trn1 copies the even lane into the odd one, odd lanes read utab */
+		even = i & ~1u;
+		idx = src[even] & 0x0fu;
+		uv[i] = tab[(((i & 1u) + 1u) * OSD_VGA4_LANES) + idx];
+		uv_or[i] = (src[even] >= OSD_VGA4_ALPHA_MIN) ? 0xffu : 0u;
+	}
+}
+#endif
+
+/*
+ * vga4: vectorized conversion of the rectangle, x must be even,
+ * in the kernel it must be called in neon section
+ */
+static void osd_vga4_rect_vec(const uint32_t *color_map, const uint8_t *tab,
+			const uint8_t *src_addr, uint8_t *tar_addr,
+			uint32_t width, uint32_t height,
+			uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+	uint8_t *addr_y, *addr_y_or;
+	uint8_t *addr_uv, *addr_uv_or;
+	uint32_t row, base_offset, uv_offset, blocks, tail, do_uv;
+
+	addr_y = tar_addr;
+	addr_uv = &addr_y[width * height];
+	addr_y_or = &addr_uv[(width * height) >> 1];
+	addr_uv_or = &addr_y_or[width * height];
+	blocks = w / OSD_VGA4_LANES;
+	tail = w % OSD_VGA4_LANES;
+
+	for (row = y; row < y + h; row++) {
+		base_offset = row * width + x;
+		uv_offset = (row >> 1u) * width + x;
+		do_uv = (((row & 1u) != 0u) || (row + 1u == height)) ? 1u : 0u;
+		osd_vga4_row_vec(&src_addr[base_offset], &addr_y[base_offset],
+			&addr_y_or[base_offset], &addr_uv[uv_offset],
+			&addr_uv_or[uv_offset], blocks, tab, do_uv);
+		if (tail != 0u)
+			osd_vga4_rect_sw(color_map, src_addr, tar_addr, width, height,
+				x + (blocks * OSD_VGA4_LANES), row, tail, 1u);
+	}
+}
+
+static uint64_t osd_vga4_tile_hash(const uint8_t *src_addr, uint32_t width,
+			uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+	uint64_t hash = 0;
+	uint32_t row;
+
+	for (row = y; row < y + h; row++)
+		hash = xxh64(&src_addr[row * width + x], w, hash);
+
+	return hash;
+}
+
+/*
+ * vga4: the tile map does not fit the size, the caller has to allocate a
+ * new one and hand it to osd_vga4_dirty_init
+ */
+bool osd_vga4_dirty_stale(const struct osd_vga4_dirty *dirty, uint32_t width, uint32_t height)
+{
+	return (dirty->tile_hash == NULL) || (dirty->width != width) ||
+		(dirty->height != height);
+}
+
+/* vga4: take a zeroed map of OSD_VGA4_TILES_X * OSD_VGA4_TILES_Y hashes */
+void osd_vga4_dirty_init(struct osd_vga4_dirty *dirty, uint64_t *tile_hash,
+			uint32_t width, uint32_t height)
+{
+	memset(dirty, 0, sizeof(*dirty));
+	dirty->tile_hash = tile_hash;
+	dirty->width = width;
+	dirty->height = height;
+	dirty->tiles_x = OSD_VGA4_TILES_X(width);
+	dirty->tiles_y = OSD_VGA4_TILES_Y(height);
+}
+
+/*
+ * vga4: a color map change invalidates every tile; builds the lookup
+ * table of OSD_VGA4_TAB_SIZE bytes for osd_vga4_dirty_row
+ */
+void osd_vga4_dirty_prepare(struct osd_vga4_dirty *dirty, const uint32_t *color_map,
+			uint8_t *tab)
+{
+	uint64_t color_hash;
+
+	color_hash = xxh64(color_map, OSD_VGA4_COLOR_NUM * sizeof(uint32_t), 0);
+	if (color_hash != dirty->color_hash) {
+		dirty->color_hash = color_hash;
+		dirty->valid = 0;
+	}
+	osd_vga4_make_tab(color_map, tab);
+}
+
+/*
+ * vga4: convert the tiles of tile row ty whose source changed since the
+ * last conversion, runs of adjacent dirty tiles are converted and handed
+ * to flush at once; the caller sets dirty->valid after the last row.
+ * return the number of converted tiles
+ */
+uint32_t osd_vga4_dirty_row(struct osd_vga4_dirty *dirty, const uint32_t *color_map,
+			const uint8_t *tab, const uint8_t *src_addr, uint8_t *tar_addr,
+			uint32_t ty, osd_vga4_flush_t flush, void *priv)
+{
+	uint32_t width = dirty->width, height = dirty->height;
+	uint32_t tiles_x = dirty->tiles_x;
+	uint32_t tx, run_start, x, y, w, h;
+	uint32_t tiles = 0;
+	uint64_t hash;
+	bool changed;
+
+	y = ty * OSD_VGA4_TILE_H;
+	h = OSD_VGA4_MIN(OSD_VGA4_TILE_H, height - y);
+	run_start = tiles_x;
+
+	for (tx = 0; tx <= tiles_x; tx++) {
+		changed = false;
+		if (tx < tiles_x) {
+			x = tx * OSD_VGA4_TILE_W;
+			w = OSD_VGA4_MIN(OSD_VGA4_TILE_W, width - x);
+			hash = osd_vga4_tile_hash(src_addr, width, x, y, w, h);
+			changed = (dirty->valid == 0u) ||
+				(dirty->tile_hash[ty * tiles_x + tx] != hash);
+			dirty->tile_hash[ty * tiles_x + tx] = hash;
+		}
+		if (changed) {
+			if (run_start == tiles_x)
+				run_start = tx;
+			tiles++;
+			continue;
+		}
+		if (run_start == tiles_x)
+			continue;
+
+		/* convert and write back one run of adjacent dirty tiles */
+		x = run_start * OSD_VGA4_TILE_W;
+		w = OSD_VGA4_MIN(tx * OSD_VGA4_TILE_W, width) - x;
+		osd_vga4_rect_vec(color_map, tab, src_addr, tar_addr,
+			width, height, x, y, w, h);
+		if (flush != NULL)
+			flush(priv, width, height, x, y, w, h);
+		run_start = tiles_x;
+	}
+
+	return tiles;
+}
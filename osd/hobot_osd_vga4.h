@@ -0,0 +1,50 @@
+/***************************************************************************
+ *                      COPYRIGHT NOTICE
+ *             Copyright 2019 Horizon Robotics, Inc.
+ *                     All rights reserved.
+ ***************************************************************************/
+
+#ifndef __HOBOT_OSD_VGA4_H__
+#define __HOBOT_OSD_VGA4_H__
+
+#include <linux/types.h>
+
+#define OSD_VGA4_COLOR_NUM 16u
+/* vga4: dirty tracking granularity, height kept even for the uv row pairs */
+#define OSD_VGA4_TILE_W 128u
+#define OSD_VGA4_TILE_H 16u
+#define OSD_VGA4_TILES_X(width) (((width) + OSD_VGA4_TILE_W - 1u) / OSD_VGA4_TILE_W)
+#define OSD_VGA4_TILES_Y(height) (((height) + OSD_VGA4_TILE_H - 1u) / OSD_VGA4_TILE_H)
+/* vga4: y, v(uv byte0), u(uv byte1) lookup tables of 16 entries each */
+#define OSD_VGA4_TAB_SIZE (3u * OSD_VGA4_COLOR_NUM)
+
+/*
+ * vga4: source hash of every tile of the last conversion into one target
+ * buffer, tile_hash holds tiles_x * tiles_y entries and is owned by the caller
+ */
+struct osd_vga4_dirty {
+	uint64_t *tile_hash;
+	uint64_t color_hash;
+	uint32_t width;
+	uint32_t height;
+	uint32_t tiles_x;
+	uint32_t tiles_y;
+	uint8_t valid;
+};
+
+/* write back of one converted rectangle, in pixels of the vga4 source */
+typedef void (*osd_vga4_flush_t)(void *priv, uint32_t width, uint32_t height,
+			uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+
+void osd_vga4_conv_ref(const uint32_t *color_map, const uint8_t *src_addr,
+			uint8_t *tar_addr, uint32_t width, uint32_t height);
+bool osd_vga4_dirty_stale(const struct osd_vga4_dirty *dirty, uint32_t width, uint32_t height);
+void osd_vga4_dirty_init(struct osd_vga4_dirty *dirty, uint64_t *tile_hash,
+			uint32_t width, uint32_t height);
+void osd_vga4_dirty_prepare(struct osd_vga4_dirty *dirty, const uint32_t *color_map,
+			uint8_t *tab);
+uint32_t osd_vga4_dirty_row(struct osd_vga4_dirty *dirty, const uint32_t *color_map,
+			const uint8_t *tab, const uint8_t *src_addr, uint8_t *tar_addr,
+			uint32_t ty, osd_vga4_flush_t flush, void *priv);
+
+#endif // __HOBOT_OSD_VGA4_H__
@@ -0,0 +1,7 @@
+/* host build of the osd kernels: stand-in for the kernel string header */
+#ifndef __OSD_TEST_LINUX_STRING_H__
+#define __OSD_TEST_LINUX_STRING_H__
+
+#include <string.h>
+
+#endif
@@ -0,0 +1,9 @@
+/* host build of the osd sta kernels: stand-in for the kernel types header */
+#ifndef __OSD_TEST_LINUX_TYPES_H__
+#define __OSD_TEST_LINUX_TYPES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#endif
@@ -0,0 +1,102 @@
+/* host build of the osd kernels: xxh64 as in lib/xxhash.c */
+#ifndef __OSD_TEST_LINUX_XXHASH_H__
+#define __OSD_TEST_LINUX_XXHASH_H__
+
+#include <linux/types.h>
+#include <string.h>
+
+#define XXH_P64_1 11400714785074694791ULL
+#define XXH_P64_2 14029467366897019727ULL
+#define XXH_P64_3 1609587929392839161ULL
+#define XXH_P64_4 9650029242287828579ULL
+#define XXH_P64_5 2870177450012600261ULL
+
+static inline uint64_t xxh_rotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxh_get64(const uint8_t *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t xxh_get32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+	acc += input * XXH_P64_2;
+	acc = xxh_rotl64(acc, 31);
+	return acc * XXH_P64_1;
+}
+
+static inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t val)
+{
+	acc ^= xxh64_round(0, val);
+	return acc * XXH_P64_1 + XXH_P64_4;
+}
+
+static inline uint64_t xxh64(const void *input, size_t len, uint64_t seed)
+{
+	const uint8_t *p = (const uint8_t *)input;
+	const uint8_t *end = p + len;
+	uint64_t h64, v1, v2, v3, v4;
+
+	if (len >= 32) {
+		v1 = seed + XXH_P64_1 + XXH_P64_2;
+		v2 = seed + XXH_P64_2;
+		v3 = seed;
+		v4 = seed - XXH_P64_1;
+		do {
+			v1 = xxh64_round(v1, xxh_get64(p));
+			v2 = xxh64_round(v2, xxh_get64(p + 8));
+			v3 = xxh64_round(v3, xxh_get64(p + 16));
+			v4 = xxh64_round(v4, xxh_get64(p + 24));
+			p += 32;
+		} while (p + 32 <= end);
+		h64 = xxh_rotl64(v1, 1) + xxh_rotl64(v2, 7) +
+			xxh_rotl64(v3, 12) + xxh_rotl64(v4, 18);
+		h64 = xxh64_merge_round(h64, v1);
+		h64 = xxh64_merge_round(h64, v2);
+		h64 = xxh64_merge_round(h64, v3);
+		h64 = xxh64_merge_round(h64, v4);
+	} else {
+		h64 = seed + XXH_P64_5;
+	}
+	h64 += (uint64_t)len;
+
+	while (p + 8 <= end) {
+		h64 ^= xxh64_round(0, xxh_get64(p));
+		h64 = xxh_rotl64(h64, 27) * XXH_P64_1 + XXH_P64_4;
+		p += 8;
+	}
+	if (p + 4 <= end) {
+		h64 ^= (uint64_t)xxh_get32(p) * XXH_P64_1;
+		h64 = xxh_rotl64(h64, 23) * XXH_P64_2 + XXH_P64_3;
+		p += 4;
+	}
+	while (p < end) {
+		h64 ^= (*p) * XXH_P64_5;
+		h64 = xxh_rotl64(h64, 11) * XXH_P64_1;
+		p++;
+	}
+
+	h64 ^= h64 >> 33;
+	h64 *= XXH_P64_2;
+	h64 ^= h64 >> 29;
+	h64 *= XXH_P64_3;
+	h64 ^= h64 >> 32;
+
+	return h64;
+}
+
+#endif
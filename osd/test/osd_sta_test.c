@@ -0,0 +1,188 @@
+/***************************************************************************
+ *                      COPYRIGHT NOTICE
+ *             Copyright 2019 Horizon Robotics, Inc.
+ *                     All rights reserved.
+ ***************************************************************************/
+
+/*
+ * host test of the osd sta histogram: the row kernel (neon on aarch64, the
+ * portable path elsewhere) must give the same bins, sum and count as
+ * osd_sta_hist_ref; "-b" also times both on a 1080p region
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hobot_osd_sta.h"
+
+#define STA_TEST_SEED 0x5eedu
+#define STA_TEST_RANDOM 2000u
+#define STA_BENCH_W 1920u
+#define STA_BENCH_H 1080u
+#define STA_BENCH_LOOPS 20u
+
+struct sta_case {
+	const char *name;
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride;
+	uint32_t level_num;
+	uint8_t level[OSD_STA_NEON_LEVEL_NUM];
+};
+
+static const struct sta_case sta_cases[] = {
+	{ "legacy 3 levels", 64, 8, 64, 3, { 64, 128, 192 } },
+	{ "no level", 48, 4, 48, 0, { 0 } },
+	{ "one level", 33, 3, 40, 1, { 100 } },
+	{ "7 levels sorted", 160, 16, 160, 7, { 16, 48, 80, 112, 144, 176, 208 } },
+	{ "7 levels unsorted", 160, 16, 176, 7, { 200, 10, 90, 90, 30, 255, 0 } },
+	{ "levels 0 and 255", 17, 5, 17, 2, { 0, 255 } },
+	{ "tail only", 15, 7, 32, 4, { 20, 40, 60, 80 } },
+	{ "one pixel", 1, 1, 1, 3, { 1, 2, 3 } },
+	{ "u8 counter chunking", 255u * 16u + 21u, 2, 4200, 5, { 30, 60, 90, 120, 150 } },
+	{ "two chunks exact", 510u * 16u, 1, 510u * 16u, 6, { 5, 50, 100, 150, 200, 250 } },
+};
+
+static uint32_t sta_rand_state = STA_TEST_SEED;
+
+static uint32_t sta_rand(void)
+{
+	sta_rand_state = sta_rand_state * 1103515245u + 12345u;
+	return sta_rand_state >> 8;
+}
+
+static void sta_fill(uint8_t *buf, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		buf[i] = (uint8_t)sta_rand();
+}
+
+/* the driver feeds one row at a time, the kernel must not care */
+static void sta_hist_by_rows(const uint8_t *img, const struct sta_case *c,
+			struct osd_sta_result *result)
+{
+	uint32_t h;
+	struct osd_sta_hist hist;
+
+	osd_sta_hist_init(&hist, c->level, c->level_num);
+	for (h = 0; h < c->height; h++)
+		osd_sta_hist_rows(&hist, img + (size_t)h * c->stride, c->stride, c->width, 1);
+	osd_sta_hist_finish(&hist);
+	*result = hist.result;
+}
+
+static int sta_check(const struct sta_case *c)
+{
+	uint32_t k;
+	uint8_t *img;
+	struct osd_sta_result ref = {0};
+	struct osd_sta_result vec = {0};
+	struct osd_sta_hist hist;
+
+	img = malloc((size_t)c->stride * c->height);
+	if (img == NULL)
+		return -1;
+	sta_fill(img, (size_t)c->stride * c->height);
+
+	osd_sta_hist_ref(img, c->stride, c->width, c->height, c->level, c->level_num, &ref);
+	sta_hist_by_rows(img, c, &vec);
+	/* and in one call over the whole region */
+	osd_sta_hist_init(&hist, c->level, c->level_num);
+	osd_sta_hist_rows(&hist, img, c->stride, c->width, c->height);
+	osd_sta_hist_finish(&hist);
+	free(img);
+
+	if (memcmp(&ref, &vec, sizeof(ref)) != 0 || memcmp(&ref, &hist.result, sizeof(ref)) != 0) {
+		printf("FAIL %s: %ux%u stride %u levels %u\n", c->name, c->width, c->height,
+			c->stride, c->level_num);
+		for (k = 0; k <= c->level_num; k++)
+			printf("  bin%u ref %u rows %u region %u\n", k, ref.bin[k], vec.bin[k],
+				hist.result.bin[k]);
+		printf("  sum ref %llu rows %llu, count ref %u rows %u\n",
+			(unsigned long long)ref.sum, (unsigned long long)vec.sum, ref.count, vec.count);
+		return -1;
+	}
+
+	return 0;
+}
+
+static double sta_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void sta_bench(void)
+{
+	uint32_t i;
+	uint8_t *img;
+	double start, ref_ns, vec_ns;
+	const uint8_t level[OSD_STA_NEON_LEVEL_NUM] = { 16, 48, 80, 112, 144, 176, 208 };
+	struct osd_sta_result ref = {0};
+	struct osd_sta_hist hist;
+
+	img = malloc((size_t)STA_BENCH_W * STA_BENCH_H);
+	if (img == NULL)
+		return;
+	sta_fill(img, (size_t)STA_BENCH_W * STA_BENCH_H);
+
+	start = sta_now_ns();
+	for (i = 0; i < STA_BENCH_LOOPS; i++)
+		osd_sta_hist_ref(img, STA_BENCH_W, STA_BENCH_W, STA_BENCH_H, level,
+			OSD_STA_NEON_LEVEL_NUM, &ref);
+	ref_ns = (sta_now_ns() - start) / STA_BENCH_LOOPS;
+
+	start = sta_now_ns();
+	for (i = 0; i < STA_BENCH_LOOPS; i++) {
+		osd_sta_hist_init(&hist, level, OSD_STA_NEON_LEVEL_NUM);
+		osd_sta_hist_rows(&hist, img, STA_BENCH_W, STA_BENCH_W, STA_BENCH_H);
+		osd_sta_hist_finish(&hist);
+	}
+	vec_ns = (sta_now_ns() - start) / STA_BENCH_LOOPS;
+	free(img);
+
+	printf("bench %ux%u, %u levels: ref %.0f us, %s %.0f us, %.2fx\n",
+		STA_BENCH_W, STA_BENCH_H, OSD_STA_NEON_LEVEL_NUM, ref_ns / 1000.0,
+#ifdef __aarch64__
+		"neon",
+#else
+		"portable",
+#endif
+		vec_ns / 1000.0, ref_ns / vec_ns);
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t i, k, failed = 0;
+	struct sta_case c;
+
+	for (i = 0; i < sizeof(sta_cases) / sizeof(sta_cases[0]); i++) {
+		if (sta_check(&sta_cases[i]) != 0)
+			failed++;
+	}
+
+	for (i = 0; i < STA_TEST_RANDOM; i++) {
+		c.name = "random";
+		c.width = 1u + sta_rand() % 300u;
+		c.height = 1u + sta_rand() % 8u;
+		c.stride = c.width + sta_rand() % 32u;
+		c.level_num = sta_rand() % (OSD_STA_NEON_LEVEL_NUM + 1u);
+		for (k = 0; k < OSD_STA_NEON_LEVEL_NUM; k++)
+			c.level[k] = (uint8_t)sta_rand();
+		if (sta_check(&c) != 0)
+			failed++;
+	}
+
+	printf("osd sta: %u cases, %u random, %u failed\n",
+		(uint32_t)(sizeof(sta_cases) / sizeof(sta_cases[0])), STA_TEST_RANDOM, failed);
+
+	if (argc > 1 && strcmp(argv[1], "-b") == 0)
+		sta_bench();
+
+	return (failed != 0u) ? 1 : 0;
+}
@@ -0,0 +1,313 @@
+/***************************************************************************
+ *                      COPYRIGHT NOTICE
+ *             Copyright 2019 Horizon Robotics, Inc.
+ *                     All rights reserved.
+ ***************************************************************************/
+
+/*
+ * host test of the incremental vga4 conversion: after every pass through
+ * osd_vga4_dirty_row (neon row on aarch64, the portable path elsewhere) the
+ * target must equal a full osd_vga4_conv_ref of the current source, starting
+ * from a garbage target, and exactly the tiles that changed must be
+ * converted and flushed; "-b" also times full vs incremental at 1080p and 4K
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hobot_osd_vga4.h"
+
+#define VGA4_TEST_SEED 0x5eedu
+#define VGA4_TEST_GARBAGE 0xa5u
+#define VGA4_TEST_CHANGES 6u
+#define VGA4_BENCH_LOOPS 20u
+
+struct vga4_case {
+	const char *name;
+	uint32_t width;
+	uint32_t height;
+};
+
+static const struct vga4_case vga4_cases[] = {
+	{ "one tile row, tail only", 24, 6 },
+	{ "two rows", 64, 2 },
+	{ "one full tile", 128, 16 },
+	{ "edge tiles both ways", 130, 18 },
+	{ "tail in edge tile", 1000, 250 },
+	{ "1080p", 1920, 1080 },
+	{ "one full tile again", 128, 16 },
+};
+
+/* tiles handed to the flush callback by the last pass */
+struct vga4_flush_log {
+	uint8_t *tile;
+	uint32_t tiles_x;
+	uint32_t bad_rect;
+};
+
+static uint32_t vga4_rand_state = VGA4_TEST_SEED;
+
+static uint32_t vga4_rand(void)
+{
+	vga4_rand_state = vga4_rand_state * 1103515245u + 12345u;
+	return vga4_rand_state >> 8;
+}
+
+static void vga4_fill(uint8_t *buf, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		buf[i] = (uint8_t)vga4_rand();
+}
+
+static void vga4_rand_map(uint32_t *color_map)
+{
+	uint32_t i;
+
+	for (i = 0; i < OSD_VGA4_COLOR_NUM; i++)
+		color_map[i] = vga4_rand() & 0xffffffu;
+}
+
+static void vga4_flush(void *priv, uint32_t width, uint32_t height,
+			uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+	struct vga4_flush_log *log = (struct vga4_flush_log *)priv;
+	uint32_t tx, ty;
+
+	/* a run starts on a tile and ends on a tile or on the buffer edge */
+	if ((x % OSD_VGA4_TILE_W) != 0u || (y % OSD_VGA4_TILE_H) != 0u ||
+		(((x + w) % OSD_VGA4_TILE_W) != 0u && (x + w) != width) ||
+		(h != OSD_VGA4_TILE_H && (y + h) != height) || (x + w) > width) {
+		log->bad_rect++;
+		return;
+	}
+	for (tx = x / OSD_VGA4_TILE_W; tx < OSD_VGA4_TILES_X(x + w); tx++) {
+		ty = y / OSD_VGA4_TILE_H;
+		log->tile[ty * log->tiles_x + tx]++;
+	}
+}
+
+/* what the kernel osd_vga4_to_sw_dirty does, with calloc for kvcalloc */
+static uint32_t vga4_run(struct osd_vga4_dirty *dirty, const uint32_t *color_map,
+			const uint8_t *src, uint8_t *tar, uint32_t width, uint32_t height,
+			struct vga4_flush_log *log)
+{
+	uint8_t tab[OSD_VGA4_TAB_SIZE];
+	uint64_t *tile_hash;
+	uint32_t ty, tiles = 0;
+
+	if (osd_vga4_dirty_stale(dirty, width, height)) {
+		free(dirty->tile_hash);
+		tile_hash = calloc((size_t)OSD_VGA4_TILES_X(width) * OSD_VGA4_TILES_Y(height),
+				sizeof(uint64_t));
+		if (tile_hash == NULL)
+			return 0;
+		osd_vga4_dirty_init(dirty, tile_hash, width, height);
+	}
+	if (log != NULL) {
+		log->tiles_x = dirty->tiles_x;
+		log->bad_rect = 0;
+		memset(log->tile, 0, (size_t)dirty->tiles_x * dirty->tiles_y);
+	}
+
+	osd_vga4_dirty_prepare(dirty, color_map, tab);
+	for (ty = 0; ty < dirty->tiles_y; ty++)
+		tiles += osd_vga4_dirty_row(dirty, color_map, tab, src, tar, ty,
+			(log != NULL) ? vga4_flush : NULL, log);
+	dirty->valid = 1;
+
+	return tiles;
+}
+
+/* tiles in expect are converted and flushed once, the target is the reference */
+static int32_t vga4_verify(const char *name, const char *step, uint32_t tiles,
+			const uint8_t *expect, const struct vga4_flush_log *log,
+			uint32_t tile_num, const uint8_t *tar, const uint8_t *ref, size_t size)
+{
+	uint32_t i, want = 0;
+	size_t k;
+
+	for (i = 0; i < tile_num; i++) {
+		want += expect[i];
+		if (log->tile[i] != expect[i]) {
+			printf("FAIL %s, %s: tile %u flushed %u times, want %u\n",
+				name, step, i, log->tile[i], expect[i]);
+			return -1;
+		}
+	}
+	if (tiles != want || log->bad_rect != 0u) {
+		printf("FAIL %s, %s: %u tiles converted, want %u, %u bad flush rects\n",
+			name, step, tiles, want, log->bad_rect);
+		return -1;
+	}
+	for (k = 0; k < size; k++) {
+		if (tar[k] != ref[k]) {
+			printf("FAIL %s, %s: byte %zu is 0x%02x, ref 0x%02x\n",
+				name, step, k, tar[k], ref[k]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int32_t vga4_check(const struct vga4_case *c, struct osd_vga4_dirty *dirty)
+{
+	uint32_t map[OSD_VGA4_COLOR_NUM], map2[OSD_VGA4_COLOR_NUM];
+	uint32_t tiles_x = OSD_VGA4_TILES_X(c->width), tiles_y = OSD_VGA4_TILES_Y(c->height);
+	uint32_t tile_num = tiles_x * tiles_y;
+	uint32_t i, x, y, tiles;
+	size_t pixels = (size_t)c->width * c->height, size = 3u * pixels;
+	uint8_t *src, *tar, *ref, *expect;
+	struct vga4_flush_log log;
+	int32_t ret = -1;
+
+	src = malloc(pixels);
+	tar = malloc(size);
+	ref = malloc(size);
+	expect = malloc(tile_num);
+	log.tile = malloc(tile_num);
+	if (src == NULL || tar == NULL || ref == NULL || expect == NULL || log.tile == NULL)
+		goto out;
+	vga4_rand_map(map);
+	vga4_rand_map(map2);
+	vga4_fill(src, pixels);
+	/* the incremental path has no full-plane memset, every byte must be written */
+	memset(tar, VGA4_TEST_GARBAGE, size);
+
+	/* new size: every tile, whatever the map held for the last size */
+	tiles = vga4_run(dirty, map, src, tar, c->width, c->height, &log);
+	osd_vga4_conv_ref(map, src, ref, c->width, c->height);
+	memset(expect, 1, tile_num);
+	if (vga4_verify(c->name, "first pass", tiles, expect, &log, tile_num, tar, ref, size) != 0)
+		goto out;
+
+	tiles = vga4_run(dirty, map, src, tar, c->width, c->height, &log);
+	memset(expect, 0, tile_num);
+	if (vga4_verify(c->name, "unchanged", tiles, expect, &log, tile_num, tar, ref, size) != 0)
+		goto out;
+
+	/* first pixel, last pixel (bottom right edge tile) and a few random ones */
+	for (i = 0; i < VGA4_TEST_CHANGES; i++) {
+		if (i == 0u) {
+			x = 0;
+			y = 0;
+		} else if (i == 1u) {
+			x = c->width - 1u;
+			y = c->height - 1u;
+		} else {
+			x = vga4_rand() % c->width;
+			y = vga4_rand() % c->height;
+		}
+		src[y * c->width + x] ^= (uint8_t)(1u + vga4_rand() % 0xffu);
+		expect[(y / OSD_VGA4_TILE_H) * tiles_x + x / OSD_VGA4_TILE_W] = 1;
+	}
+	tiles = vga4_run(dirty, map, src, tar, c->width, c->height, &log);
+	osd_vga4_conv_ref(map, src, ref, c->width, c->height);
+	if (vga4_verify(c->name, "pixels changed", tiles, expect, &log, tile_num, tar, ref, size) != 0)
+		goto out;
+
+	tiles = vga4_run(dirty, map2, src, tar, c->width, c->height, &log);
+	osd_vga4_conv_ref(map2, src, ref, c->width, c->height);
+	memset(expect, 1, tile_num);
+	if (vga4_verify(c->name, "color map changed", tiles, expect, &log, tile_num, tar, ref, size) != 0)
+		goto out;
+	ret = 0;
+
+out:
+	free(src);
+	free(tar);
+	free(ref);
+	free(expect);
+	free(log.tile);
+
+	return ret;
+}
+
+static double vga4_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void vga4_bench_size(uint32_t width, uint32_t height)
+{
+	struct osd_vga4_dirty dirty = { 0 };
+	uint32_t map[OSD_VGA4_COLOR_NUM];
+	size_t pixels = (size_t)width * height;
+	double start, ref_ns, full_ns, clean_ns, tile_ns;
+	uint8_t *src, *tar;
+	uint32_t i;
+
+	src = malloc(pixels);
+	tar = malloc(3u * pixels);
+	if (src == NULL || tar == NULL)
+		goto out;
+	vga4_rand_map(map);
+	vga4_fill(src, pixels);
+
+	start = vga4_now_ns();
+	for (i = 0; i < VGA4_BENCH_LOOPS; i++)
+		osd_vga4_conv_ref(map, src, tar, width, height);
+	ref_ns = (vga4_now_ns() - start) / VGA4_BENCH_LOOPS;
+
+	start = vga4_now_ns();
+	for (i = 0; i < VGA4_BENCH_LOOPS; i++) {
+		dirty.valid = 0;
+		(void)vga4_run(&dirty, map, src, tar, width, height, NULL);
+	}
+	full_ns = (vga4_now_ns() - start) / VGA4_BENCH_LOOPS;
+
+	start = vga4_now_ns();
+	for (i = 0; i < VGA4_BENCH_LOOPS; i++)
+		(void)vga4_run(&dirty, map, src, tar, width, height, NULL);
+	clean_ns = (vga4_now_ns() - start) / VGA4_BENCH_LOOPS;
+
+	start = vga4_now_ns();
+	for (i = 0; i < VGA4_BENCH_LOOPS; i++) {
+		src[(height / 2u) * width + width / 2u]++;
+		(void)vga4_run(&dirty, map, src, tar, width, height, NULL);
+	}
+	tile_ns = (vga4_now_ns() - start) / VGA4_BENCH_LOOPS;
+
+	printf("bench %ux%u: ref %.0f us, %s full %.0f us, unchanged %.0f us, one tile %.0f us\n",
+		width, height, ref_ns / 1000.0,
+#ifdef __aarch64__
+		"neon",
+#else
+		"portable",
+#endif
+		full_ns / 1000.0, clean_ns / 1000.0, tile_ns / 1000.0);
+
+out:
+	free(dirty.tile_hash);
+	free(src);
+	free(tar);
+}
+
+int main(int argc, char **argv)
+{
+	struct osd_vga4_dirty dirty = { 0 };
+	uint32_t i, failed = 0;
+
+	/* one dirty state through all cases, so every case is a size change */
+	for (i = 0; i < sizeof(vga4_cases) / sizeof(vga4_cases[0]); i++) {
+		if (vga4_check(&vga4_cases[i], &dirty) != 0)
+			failed++;
+	}
+	free(dirty.tile_hash);
+
+	printf("osd vga4: %u cases, %u failed\n",
+		(uint32_t)(sizeof(vga4_cases) / sizeof(vga4_cases[0])), failed);
+
+	if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+		vga4_bench_size(1920, 1080);
+		vga4_bench_size(3840, 2160);
+	}
+
+	return (failed != 0u) ? 1 : 0;
+}
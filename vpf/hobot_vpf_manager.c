@@ -19,6 +19,8 @@
 #include <linux/sched.h>
 #include <uapi/linux/sched/types.h>
 #include <linux/poll.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
 #include <linux/platform_device.h>
 
 #include "hobot_vpf_manager.h"
@@ -37,6 +39,28 @@
 int vio_mp_en = 0;
 module_param(vio_mp_en, int, 0644);/*PRQA S 0605,0636,4501*/
 
+/**
+ * Purpose: lock-free QBUF/DQBUF handoff for single user subdev; User set this
+ * sys paramater before streamon to use REQUEST/COMPLETE rings or not;
+ * Value: 0~1
+ * Range: hobot_vpf_manager.c
+ * Attention: only for subdev which is not bound to previous or next subdev and
+ * whose IP marks it ring_capable (never reads the COMPLETE queue directly)
+ */
+int vio_ring_mode = 0;
+module_param(vio_ring_mode, int, 0644);/*PRQA S 0605,0636,4501*/
+
+/**
+ * Purpose: size in MB of the pool which keeps driver-allocated buffers and their
+ * iommu mappings across reqbufs/close, so the same layout is not allocated and mapped again;
+ * Value: 0 means disabled
+ * Range: hobot_vpf_manager.c
+ * Attention: the oldest buffers are released when the pool is full, a buffer is only
+ * reused by the process which released it
+ */
+int vio_buf_pool_size = 0;
+module_param(vio_buf_pool_size, int, 0644);/*PRQA S 0605,0636,4501*/
+
 /**
  * Purpose: point to hobot_vpf_dev struct, for extern interface
  * Range: hobot_vpf_manager.c
@@ -171,7 +195,7 @@ static u32 hobot_vpf_manager_poll(struct file *file, struct poll_table_struct *w
 	framemgr = vctx->framemgr;
 	done_list = &framemgr->queued_list[FS_COMPLETE];
 	vio_e_barrier_irqs(framemgr, flags);
-	if (osal_list_empty(done_list) == 0) {
+	if (osal_list_empty(done_list) == 0 || frame_ring_count(&framemgr->done_ring) != 0u) {
 		vio_x_barrier_irqr(framemgr, flags);
 		return POLLIN;
 	}
@@ -224,6 +248,63 @@ static s32 hobot_vpf_manager_close(struct inode *inode, struct file *file)
 	return ret;
 }
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Map metadata ring of the bound flow to user space read-only;
+ * layout is struct vio_metadata_ctrl followed by CMN_META_NUM slots;
+ * @param[in] *file: point to struct file instance;
+ * @param[in] *vma: point to struct vm_area_struct instance;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static s32 hobot_vpf_manager_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	s32 ret;
+	u64 size;
+	struct vio_video_ctx *vctx;
+	struct vio_chain *vchain;
+
+	vctx = (struct vio_video_ctx *)file->private_data;
+	if (vctx == NULL) {
+		vio_err("%s: vctx = NULL\n", __func__);
+		return -EFAULT;
+	}
+
+	if ((vma->vm_flags & VM_WRITE) != 0) {
+		vio_err("[S%d] %s: metadata can only be mapped read-only\n", vctx->flow_id, __func__);
+		return -EPERM;
+	}
+
+	vchain = vio_get_chain(vctx->flow_id);
+	if (vchain == NULL || vchain->meta_mgr.base == NULL) {
+		vio_err("[S%d] %s: flow is not bound\n", vctx->flow_id, __func__);
+		return -EINVAL;
+	}
+
+	size = vma->vm_end - vma->vm_start;
+	if (size + (vma->vm_pgoff << PAGE_SHIFT) > METADATA_REGION_SIZE) {
+		vio_err("[S%d] %s: wrong size 0x%llx, pgoff %ld\n", vctx->flow_id, __func__,
+			size, vma->vm_pgoff);
+		return -EINVAL;
+	}
+
+	/* mprotect must not be able to turn the mapping writable or executable later */
+	vma->vm_flags &= ~(VM_MAYWRITE | VM_MAYEXEC);
+	ret = remap_vmalloc_range(vma, vchain->meta_mgr.base, vma->vm_pgoff);
+	if (ret < 0)
+		vio_err("[S%d] %s: remap failed, ret %d\n", vctx->flow_id, __func__, ret);
+
+	return ret;
+}
+
 /**
  * Purpose: vflow file operation functions
  * Value: NA
@@ -234,6 +315,7 @@ static struct file_operations hobot_vpf_manager_fops = {
 	.owner = THIS_MODULE,
 	.open = hobot_vpf_manager_open,
 	.poll = hobot_vpf_manager_poll,
+	.mmap = hobot_vpf_manager_mmap,
 	.release = hobot_vpf_manager_close,
 	.unlocked_ioctl = hobot_vpf_manager_ioctl,
 	.compat_ioctl = hobot_vpf_manager_ioctl,
@@ -399,6 +481,9 @@ cleanup:
 	if (vpf_device->cdev)
 		cdev_del(vpf_device->cdev);
 
+	if (vpf_device->iommu_dev != NULL)
+		vio_buf_pool_flush(vpf_device->iommu_dev);
+
 	vpf_free_minor_number(vpf_dev, vpf_device->minor);
 	vpf_dev->vpf_device[vpf_device->minor] = NULL;
 err:
@@ -607,6 +692,7 @@ s32 hobot_vpf_manager_probe(void)
 	osal_mutex_init(&vpf_dev->mlock);
 	osal_mutex_init(&vpf_dev->iscore.mlock);
 	osal_atomic_set(&vpf_dev->open_cnt, 0);
+	vio_hw_util_init();
 	vpf_set_drvdata(vpf_dev);
 	vio_get_callback_ops(&g_cim_cops, VIN_MODULE, COPS_0);
 	vio_get_callback_ops(&g_dbg_cops, DPU_MODULE, COPS_0);	//vtrace tmp using ipu module id
@@ -618,9 +704,12 @@ s32 hobot_vpf_manager_probe(void)
 
 void hobot_vpf_manager_remove(void)
 {
+	u32 i;
 	struct hobot_vpf_dev *vpf_dev;
 
 	vpf_dev = vpf_get_drvdata();
+	for (i = 0; i < VIO_MAX_STREAM; i++)
+		vio_chain_release(&vpf_dev->iscore.vchain[i]);
 	vpf_destroy_debug_file(vpf_dev);
 	vio_debug_destroy(vpf_dev->dev);
 	device_destroy(vpf_dev->class, vpf_dev->devno);
@@ -66,8 +66,12 @@ struct hobot_vpf_dev {
 	/* debug sys */
 	struct dentry *debug_root;
 	struct dentry *debug_file_fmgr_stats;
+	struct dentry *debug_file_buf_pool;
 };
 
+extern int vio_ring_mode;
+extern int vio_buf_pool_size;
+
 void vpf_set_drvdata(struct hobot_vpf_dev *vpf_dev);
 struct hobot_vpf_dev *vpf_get_drvdata(void);
 
@@ -11,6 +11,7 @@
  *             Copyright 2019 Horizon Robotics, Inc.
  *                     All rights reserved.
  ***************************************************************************/
+#include <linux/vmalloc.h>
 #include "vio_config.h"
 #define pr_fmt(fmt)    "[VPF ops]:" fmt
 
@@ -57,6 +58,10 @@ static void vpf_free_buffer(struct vio_framemgr *framemgr, void *iommu_dev)
 
 	for (i = 0; i < framemgr->num_frames; i++) {
 		frame = &framemgr->frames[i];
+		if (frame->internal_buf != 0u && vio_buf_pool_size > 0 &&
+			vio_buf_pool_put(&frame->vbuf, iommu_dev, (size_t)vio_buf_pool_size << 20) == 0)
+			continue;
+
 		if (iommu_dev != NULL && frame->vbuf.iommu_map != 0)
 			vio_frame_iommu_unmap(iommu_dev, frame);
 
@@ -1336,14 +1341,23 @@ static s32 vpf_alloc_buffer(struct vio_framemgr *framemgr, void *iommu_dev,
 			frame->vbuf.group_info.is_contig = group_attr->is_contig;
 			frame->frameinfo.is_contig = group_attr->is_contig;
 			frame->frameinfo.num_planes = group_attr->info[0].buf_attr.planecount;
-			ret = vio_ion_alloc(&frame->vbuf);
+			ret = -ENOENT;
+			if (vio_buf_pool_size > 0)
+				ret = vio_buf_pool_get(&frame->vbuf,
+					(group_attr->is_alloc == BUF_ALLOC_AND_MAP) ? iommu_dev : NULL);
+			if (ret < 0)
+				ret = vio_ion_alloc(&frame->vbuf);
 			if (ret < 0)
 				return ret;
 
 			frame->internal_buf = 1;
+			frame->vbuf.cpu_access = vio_ion_cpu_access(group_attr->flags);
+			frame->vbuf.cpu_owned = 1;
+			frame->vbuf.roi_y = 0;
+			frame->vbuf.roi_height = 0;
 			(void)memcpy(frame->frameinfo.ion_id, frame->vbuf.group_info.info[0].share_id,
 				sizeof(u32) * VIO_BUFFER_MAX_PLANES);
-			if (group_attr->is_alloc == BUF_ALLOC_AND_MAP) {
+			if (group_attr->is_alloc == BUF_ALLOC_AND_MAP && frame->vbuf.iommu_map == 0u) {
 				ret = vio_frame_iommu_map(iommu_dev, frame);
 				if (ret < 0) {
 					vio_err("[Fmgr%d][F%d] %s: iommu map failed\n", framemgr->id, i, __func__);
@@ -1538,6 +1552,7 @@ static s32 vpf_video_stop(struct vio_video_ctx *vctx)
 
 	if (vdev->reqbuf_flag == 1u) {
 		frame_manager_flush(vdev->cur_fmgr);
+		frame_ring_disable(vdev->cur_fmgr);
 		osal_atomic_set(&vnode->rcount, 0);
 		vctx->event = 0;
 	}
@@ -1562,7 +1577,7 @@ static void vpf_fdebug_init(struct vio_subdev *vdev)
 
 	vnode = vdev->vnode;
 	fdebug = &vdev->fdebug;
-	(void)memset(&vdev->fdebug, 0, sizeof(struct frame_debug));
+	vio_fdebug_init(fdebug);
 	fdebug->idset.flow_id = vnode->flow_id;
 	fdebug->idset.module_id = vnode->id;
 	fdebug->idset.hw_id = vnode->id;
@@ -1614,6 +1629,12 @@ static s32 vpf_video_start(struct vio_video_ctx *vctx)
 	if (osal_atomic_inc_return(&vnode->start_cnt) == 1)
 		osal_set_bit((s32)VIO_NODE_START, &vnode->state);
 
+	if (vio_ring_mode != 0 && vdev->ring_capable == 1u && vdev->reqbuf_flag == 1u &&
+			vdev->multi_process == 0u && vdev->prev == NULL && vdev->next == NULL) {
+		if (frame_ring_enable(vdev->cur_fmgr) == 0)
+			vio_info("[%s][C%d] %s: ring mode\n", vctx->name, vctx->ctx_id, __func__);
+	}
+
 	if (vdev->id >= VNODE_ID_CAP) {
 		ret = vpf_prepare_buffers(vctx->vdev);
 		if (ret < 0)
@@ -1874,6 +1895,61 @@ static s32 vpf_video_qbuf(struct vio_video_ctx *vctx, unsigned long arg)
 	return ret;
 }
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Queue several frame buffers into request queue in one call;
+ * @param[in] *vctx: point to struct vio_video_ctx instance;
+ * @param[in] arg: user pointer of struct vio_qbuf_batch;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static s32 vpf_video_qbuf_batch(struct vio_video_ctx *vctx, unsigned long arg)
+{
+	s32 ret;
+	u64 copy_ret;
+	struct vio_qbuf_batch batch;
+	struct vio_subdev *vdev;
+
+	if ((vctx->state & (BIT(VIO_VIDEO_START) | BIT(VIO_VIDEO_CHN_ATTR) |
+		BIT(VIO_VIDEO_REBUFS) | BIT(VIO_VIDEO_STOP))) == 0) {
+		vio_err("[%s][C%d] %s: invalid qbuf is requested(0x%llX)", vctx->name,
+			vctx->ctx_id, __func__, vctx->state);
+		return -EFAULT;
+	}
+
+	vdev = vctx->vdev;
+	if (vdev->id == VNODE_ID_SRC && osal_test_bit((s32)VIO_SUBDEV_BIND_DONE, &vdev->state) != 0) {
+		vio_err("[%s][C%d] %s: src node already bind, can't send again",
+			vctx->name, vctx->ctx_id, __func__);
+		return -EFAULT;
+	}
+
+	copy_ret = osal_copy_from_app((void *)&batch, (void __user *)arg, sizeof(struct vio_qbuf_batch));
+	if (copy_ret != 0u) {
+		vio_err("[%s] %s: failed to copy from user, ret = %lld\n", vctx->name, __func__, copy_ret);
+		return -EFAULT;
+	}
+
+	ret = vio_subdev_qbuf_batch(vdev, batch.frameinfo, batch.count, &batch.queued);
+
+	copy_ret = osal_copy_to_app((void __user *)arg, (void *)&batch, sizeof(struct vio_qbuf_batch));
+	if (copy_ret != 0u) {
+		vio_err("[%s] %s: failed to copy to user, ret = %lld\n", vctx->name, __func__, copy_ret);
+		return -EFAULT;
+	}
+	vio_dbg("[%s][S%d] %s: done\n", vctx->name, vctx->flow_id, __func__);
+
+	return ret;
+}
+
 /**
  * @NO{S09E05C01}
  * @ASIL{B}
@@ -2220,6 +2296,221 @@ static u32 vpf_get_hw_tasks_cnt(struct vio_group_task * gtask)
 	return task_cnt;
 }
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Set the scheduling attribute of the group the bound vio node belongs to;
+ * @param[in] *vctx: point to struct vio_video_ctx instance;
+ * @param[in] arg: user pointer of struct vio_sched_attr;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static s32 vpf_video_set_sched_attr(struct vio_video_ctx *vctx, unsigned long arg)
+{
+	s32 ret;
+	s64 copy_ret;
+	struct vio_subdev *vdev;
+	struct vio_sched_attr attr;
+
+	vdev = vctx->vdev;
+	if (vdev == NULL || vdev->vnode == NULL) {
+		vio_err("[%s][C%d] %s: ctx is not bound\n", vctx->name, vctx->ctx_id, __func__);
+		return -EINVAL;
+	}
+
+	copy_ret = osal_copy_from_app((void *)&attr, (void __user *)arg, sizeof(struct vio_sched_attr));
+	if (copy_ret != 0) {
+		vio_err("[%s] %s: failed to copy from user, ret = %lld\n", vctx->name, __func__, copy_ret);
+		return -EFAULT;
+	}
+
+	ret = vio_group_set_sched(vdev->vnode, &attr);
+
+	return ret;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Update CPU access declaration and sync roi of driver-allocated buffers,
+ * user calls it when it maps or stops touching buffers by cpu;
+ * @param[in] *vctx: point to struct vio_video_ctx instance;
+ * @param[in] arg: user pointer of struct vio_cache_attr;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static s32 vpf_video_set_cache_attr(struct vio_video_ctx *vctx, unsigned long arg)
+{
+	u32 i;
+	u64 flags = 0;
+	s64 copy_ret;
+	struct vio_subdev *vdev;
+	struct vio_framemgr *framemgr;
+	struct vio_frame *frame;
+	struct vio_cache_attr attr;
+
+	vdev = vctx->vdev;
+	if (vdev == NULL || vdev->reqbuf_flag == 0u) {
+		vio_err("[%s][C%d] %s: buffers are not requested\n", vctx->name, vctx->ctx_id, __func__);
+		return -EINVAL;
+	}
+
+	copy_ret = osal_copy_from_app((void *)&attr, (void __user *)arg, sizeof(struct vio_cache_attr));
+	if (copy_ret != 0) {
+		vio_err("[%s] %s: failed to copy from user, ret = %lld\n", vctx->name, __func__, copy_ret);
+		return -EFAULT;
+	}
+
+	framemgr = vdev->cur_fmgr;
+	if ((attr.cpu_access & ~VIO_CPU_ACCESS_MASK) != 0u ||
+		(attr.bufferindex >= 0 && (u32)attr.bufferindex >= framemgr->num_frames)) {
+		vio_err("[%s] %s: invalid cpu_access 0x%x or bufferindex %d\n", vctx->name, __func__,
+			attr.cpu_access, attr.bufferindex);
+		return -EINVAL;
+	}
+
+	vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
+	for (i = 0; i < framemgr->num_frames; i++) {
+		if (attr.bufferindex >= 0 && i != (u32)attr.bufferindex)
+			continue;
+		frame = &framemgr->frames[i];
+		if (frame->internal_buf == 0u)
+			continue;
+		frame->vbuf.cpu_access = (u8)attr.cpu_access;
+		frame->vbuf.roi_y = attr.roi_y;
+		frame->vbuf.roi_height = attr.roi_height;
+		/* buffers held by user now may be touched before next qbuf */
+		if (attr.cpu_access != VIO_CPU_ACCESS_NONE &&
+			(frame->state == FS_FREE || frame->state == FS_USED))
+			frame->vbuf.cpu_owned = 1;
+	}
+	vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
+
+	return 0;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Get fps/drop/delay/frame queue statistics of all started channels in one call;
+ * @param[in] *vctx: point to struct vio_video_ctx instance;
+ * @param[in] arg: user pointer of struct vio_stats_bulk;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static s32 vpf_video_get_stats_bulk(struct vio_video_ctx *vctx, unsigned long arg)
+{
+	s32 ret;
+	s64 copy_ret;
+	u64 user_stats;
+	struct vio_chn_stat *stats;
+	struct vio_stats_bulk bulk;
+
+	copy_ret = osal_copy_from_app((void *)&bulk, (void __user *)arg, sizeof(struct vio_stats_bulk));
+	if (copy_ret != 0) {
+		vio_err("[%s] %s: failed to copy from user, ret = %lld\n", vctx->name, __func__, copy_ret);
+		return -EFAULT;
+	}
+	if (bulk.max_num == 0u || bulk.stats == 0u)
+		return -EINVAL;
+	bulk.max_num = min_t(u32, bulk.max_num, VIO_STAT_BULK_MAX);
+
+	stats = vzalloc((size_t)bulk.max_num * sizeof(struct vio_chn_stat));
+	if (stats == NULL)
+		return -ENOMEM;
+
+	user_stats = bulk.stats;
+	bulk.stats = (u64)(uintptr_t)stats;
+	ret = vio_stats_bulk(&bulk);
+	bulk.stats = user_stats;
+	if (ret < 0)
+		goto exit;
+
+	copy_ret = osal_copy_to_app((void __user *)(uintptr_t)user_stats, (void *)stats,
+		(size_t)bulk.num * sizeof(struct vio_chn_stat));
+	if (copy_ret == 0)
+		copy_ret = osal_copy_to_app((void __user *)arg, (void *)&bulk, sizeof(struct vio_stats_bulk));
+	if (copy_ret != 0) {
+		vio_err("[%s] %s: copy_to_user failed, ret(%lld)\n", vctx->name, __func__, copy_ret);
+		ret = -EFAULT;
+	}
+exit:
+	vfree(stats);
+	return ret;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Get per-stage latency histograms of one module in one flow;
+ * @param[in] *vctx: point to struct vio_video_ctx instance;
+ * @param[in] arg: user pointer of struct vio_lat_info;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static s32 vpf_video_get_lat_hist(struct vio_video_ctx *vctx, unsigned long arg)
+{
+	s32 ret;
+	s64 copy_ret;
+	struct vio_lat_info *info;
+
+	info = osal_kzalloc(sizeof(struct vio_lat_info), GFP_KERNEL);
+	if (info == NULL)
+		return -ENOMEM;
+
+	/* only flow_id and module are input, the histograms are output */
+	copy_ret = osal_copy_from_app((void *)info, (void __user *)arg,
+				      offsetof(struct vio_lat_info, stage));
+	if (copy_ret != 0) {
+		vio_err("[%s] %s: failed to copy from user, ret = %lld\n", vctx->name, __func__, copy_ret);
+		ret = -EFAULT;
+		goto exit;
+	}
+
+	ret = vio_lat_get_info(info);
+	if (ret < 0) {
+		vio_err("[%s] %s: no latency info of flow %d module %d\n", vctx->name, __func__,
+			info->flow_id, info->module);
+		goto exit;
+	}
+
+	copy_ret = osal_copy_to_app((void __user *)arg, (void *)info, sizeof(struct vio_lat_info));
+	if (copy_ret != 0) {
+		vio_err("[%s] %s: copy_to_user failed, ret(%lld)", vctx->name, __func__, copy_ret);
+		ret = -EFAULT;
+	}
+exit:
+	osal_kfree(info);
+	return ret;
+}
 
 static s32 vpf_video_get_hw_status(struct vio_video_ctx *vctx, unsigned long arg)
 {
@@ -2298,6 +2589,12 @@ static s32 vpf_flush_com_frame(struct vio_video_ctx *vctx)
 		if ((vnode->leader == 1u) && (vctx->vdev->leader == 1u))
 			vio_group_start_trigger(vnode, frame);
 	}
+	while ((frame = frame_ring_dqbuf(framemgr)) != NULL) {
+		vio_drop_calculate(&vctx->vdev->fdebug, USER_DROP, &frame->frameinfo.frameid);
+		trans_frame(framemgr, frame, FS_REQUEST);
+		if ((vnode->leader == 1u) && (vctx->vdev->leader == 1u))
+			vio_group_start_trigger(vnode, frame);
+	}
 	vctx->event = 0;
 	vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
 
@@ -2356,6 +2653,9 @@ s32 vpf_manager_ioctl(struct vio_video_ctx *vctx, u32 cmd, unsigned long arg)
 		case VIO_IOC_QBUF:
 			ret = vpf_video_qbuf(vctx, arg);
 			break;
+		case VIO_IOC_QBUF_BATCH:
+			ret = vpf_video_qbuf_batch(vctx, arg);
+			break;
 		case VIO_IOC_SET_CTRL:
 			ret = vpf_video_s_ctrl(vctx, arg);
 			break;
@@ -2396,6 +2696,18 @@ s32 vpf_manager_ioctl(struct vio_video_ctx *vctx, u32 cmd, unsigned long arg)
 		case VIO_IOC_GET_HW_STATUS:
 			ret = vpf_video_get_hw_status(vctx, arg);
 			break;
+		case VIO_IOC_SET_SCHED_ATTR:
+			ret = vpf_video_set_sched_attr(vctx, arg);
+			break;
+		case VIO_IOC_SET_CACHE_ATTR:
+			ret = vpf_video_set_cache_attr(vctx, arg);
+			break;
+		case VIO_IOC_GET_LAT_HIST:
+			ret = vpf_video_get_lat_hist(vctx, arg);
+			break;
+		case VIO_IOC_GET_STATS_BULK:
+			ret = vpf_video_get_stats_bulk(vctx, arg);
+			break;
 		default:
 			vio_err("%s wrong command 0x%x\n", __func__, cmd);
 			ret = -EFAULT;
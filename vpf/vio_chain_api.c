@@ -12,36 +12,108 @@
  *                     All rights reserved.
  ***************************************************************************/
 #define pr_fmt(fmt)    "[VPF chain]:" fmt
+#include <linux/vmalloc.h>
 #include "vio_config.h"
 #include "vio_chain_api.h"
 #include "vio_node_api.h"
 #include "hobot_vpf_manager.h"
 
+static size_t vio_drop_window_size(u32 window)
+{
+	return 2u * BITS_TO_LONGS(window) * sizeof(unsigned long) + window * sizeof(u32);
+}
+
+/* bitmaps come first in the chunk so valid_map is also the pointer to free */
+static void vio_drop_window_bind(struct vio_drop_mgr *drop_mgr, void *buf, u32 window)
+{
+	drop_mgr->valid_map = (unsigned long *)buf;
+	drop_mgr->hit_map = drop_mgr->valid_map + BITS_TO_LONGS(window);
+	drop_mgr->gen = (u32 *)(drop_mgr->hit_map + BITS_TO_LONGS(window));
+	drop_mgr->window = window;
+	drop_mgr->shift = (u32)ilog2(window);
+}
+
+/* called with drop_mgr->slock held */
+static void vio_drop_window_insert(struct vio_drop_mgr *drop_mgr, u32 frame_id, u8 hit)
+{
+	u32 slot, gen;
+
+	slot = frame_id & (drop_mgr->window - 1u);
+	gen = frame_id >> drop_mgr->shift;
+	if (osal_test_bit((s32)slot, drop_mgr->valid_map) != 0) {
+		if (drop_mgr->gen[slot] > gen) {
+			drop_mgr->overflow_cnt++;
+			return;
+		}
+		if (osal_test_bit((s32)slot, drop_mgr->hit_map) == 0)
+			drop_mgr->overflow_cnt++;
+	}
+
+	drop_mgr->gen[slot] = gen;
+	osal_set_bit((s32)slot, drop_mgr->valid_map);
+	if (hit != 0u)
+		osal_set_bit((s32)slot, drop_mgr->hit_map);
+	else
+		osal_clear_bit((s32)slot, drop_mgr->hit_map);
+	if (frame_id > drop_mgr->last_set_frameid)
+		drop_mgr->last_set_frameid = frame_id;
+}
+
+/* called with drop_mgr->slock held, forget every id after the frame id restarted */
+static void vio_drop_window_reset(struct vio_drop_mgr *drop_mgr)
+{
+	(void)memset(drop_mgr->valid_map, 0, 2u * BITS_TO_LONGS(drop_mgr->window) * sizeof(unsigned long));
+	drop_mgr->last_set_frameid = 0;
+	drop_mgr->reset_cnt++;
+}
+
 s32 vio_chain_init(struct vio_chain *vchain, u32 id)
 {
 	s32 i;
+	void *buf;
 	struct vio_metadata_mgr *meta_mgr;
 	struct vio_node_mgr *vnode_mgr;
     struct vio_drop_mgr *drop_mgr;
 
     vchain->id = id;
 	meta_mgr = &vchain->meta_mgr;
-	osal_spin_init(&meta_mgr->slock);
 	meta_mgr->max_frameid = 0;
-	(void)memset(meta_mgr->frameid, 0, sizeof(meta_mgr->frameid));
-	if (meta_mgr->metadata == NULL) {
+	osal_atomic_set(&meta_mgr->overflow_cnt, 0);
+	if (meta_mgr->base == NULL) {
 		meta_mgr->metadata_size = METADATA_SIZE;
-		meta_mgr->metadata = osal_kzalloc(METADATA_SIZE * CMN_META_NUM, GFP_ATOMIC);
-        if (meta_mgr->metadata == NULL) {
+		/* vmalloc_user memory is zeroed and can be mapped by hobot_vpf_manager_mmap */
+		meta_mgr->base = vmalloc_user(METADATA_REGION_SIZE);
+        if (meta_mgr->base == NULL) {
             vio_err("%s: metadata alloc failed\n", __func__);
             return -ENOMEM;
         }
+		meta_mgr->ctrl = (struct vio_metadata_ctrl *)meta_mgr->base;
+		meta_mgr->metadata = meta_mgr->base + METADATA_CTRL_SIZE;
 	} else {
-        (void)memset(meta_mgr->metadata, 0, METADATA_SIZE * CMN_META_NUM);
+        (void)memset(meta_mgr->base, 0, METADATA_REGION_SIZE);
     }
+	meta_mgr->ctrl->slot_num = CMN_META_NUM;
+	meta_mgr->ctrl->slot_size = METADATA_SIZE;
+	meta_mgr->ctrl->data_offset = METADATA_CTRL_SIZE;
 
     drop_mgr = &vchain->drop_mgr;
-    (void)memset(drop_mgr, 0, sizeof(struct vio_drop_mgr));
+	if (drop_mgr->valid_map == NULL) {
+		buf = osal_kzalloc(vio_drop_window_size(DROP_WINDOW_DEFAULT), GFP_ATOMIC);
+		if (buf == NULL) {
+			vio_err("%s: drop window alloc failed\n", __func__);
+			return -ENOMEM;
+		}
+		vio_drop_window_bind(drop_mgr, buf, DROP_WINDOW_DEFAULT);
+	} else {
+		/* keep the window size configured by vio_chain_set_drop_window */
+		(void)memset(drop_mgr->valid_map, 0, vio_drop_window_size(drop_mgr->window));
+	}
+	drop_mgr->last_drop_frameid = 0;
+	drop_mgr->last_set_frameid = 0;
+	drop_mgr->set_cnt = 0;
+	drop_mgr->hit_cnt = 0;
+	drop_mgr->overflow_cnt = 0;
+	drop_mgr->reset_cnt = 0;
 	osal_spin_init(&drop_mgr->slock);
 
 	for (i = 0; i < MODULE_NUM; i++) {
@@ -53,6 +125,14 @@ s32 vio_chain_init(struct vio_chain *vchain, u32 id)
 
 	(void)memset(vchain->mstat, 0, sizeof(vchain->mstat));
 	(void)memset(vchain->info_idx, 0, sizeof(vchain->info_idx));
+	if (vchain->lat == NULL) {
+		/* latency histograms are optional, the chain works without them */
+		vchain->lat = vzalloc(VIO_LAT_SIZE * nr_cpu_ids);
+		if (vchain->lat == NULL)
+			vio_err("%s: latency histogram alloc failed\n", __func__);
+	} else {
+		(void)memset(vchain->lat, 0, VIO_LAT_SIZE * nr_cpu_ids);
+	}
 
     (void)memset(vchain->path, 0, sizeof(vchain->path));
     vchain->path_print = 0;
@@ -60,6 +140,139 @@ s32 vio_chain_init(struct vio_chain *vchain, u32 id)
     return 0;
 }
 
+void vio_chain_release(struct vio_chain *vchain)
+{
+	struct vio_drop_mgr *drop_mgr;
+	struct vio_metadata_mgr *meta_mgr;
+
+	drop_mgr = &vchain->drop_mgr;
+	if (drop_mgr->valid_map != NULL) {
+		osal_kfree(drop_mgr->valid_map);
+		drop_mgr->valid_map = NULL;
+		drop_mgr->hit_map = NULL;
+		drop_mgr->gen = NULL;
+	}
+
+	meta_mgr = &vchain->meta_mgr;
+	if (meta_mgr->base != NULL) {
+		vfree(meta_mgr->base);
+		meta_mgr->base = NULL;
+		meta_mgr->ctrl = NULL;
+		meta_mgr->metadata = NULL;
+	}
+
+	if (vchain->lat != NULL) {
+		vfree(vchain->lat);
+		vchain->lat = NULL;
+	}
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Resize drop frame window of one chain, pending drop entries are kept;
+ * @param[in] *vchain: point to struct vio_chain instance;
+ * @param[in] window: number of frame id slots, power of two;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_chain_set_drop_window(struct vio_chain *vchain, u32 window)
+{
+	u32 slot, old_window, old_shift;
+	u64 flags = 0;
+	void *buf;
+	u32 *old_gen;
+	unsigned long *old_valid, *old_hit;
+	struct vio_drop_mgr *drop_mgr;
+
+	if (window < DROP_WINDOW_MIN || window > DROP_WINDOW_MAX || is_power_of_2(window) == 0) {
+		vio_err("[S%d] %s: invalid window %d\n", vchain->id, __func__, window);
+		return -EINVAL;
+	}
+
+	buf = osal_kzalloc(vio_drop_window_size(window), GFP_KERNEL);
+	if (buf == NULL) {
+		vio_err("[S%d] %s: drop window alloc failed\n", vchain->id, __func__);
+		return -ENOMEM;
+	}
+
+	drop_mgr = &vchain->drop_mgr;
+	if (drop_mgr->valid_map == NULL) {
+		/* chain never initialized, vio_chain_init keeps this window */
+		vio_drop_window_bind(drop_mgr, buf, window);
+		return 0;
+	}
+
+	vio_e_barrier_irqs(drop_mgr, flags);
+	old_window = drop_mgr->window;
+	old_shift = drop_mgr->shift;
+	old_gen = drop_mgr->gen;
+	old_valid = drop_mgr->valid_map;
+	old_hit = drop_mgr->hit_map;
+	vio_drop_window_bind(drop_mgr, buf, window);
+	for (slot = 0; slot < old_window; slot++) {
+		if (osal_test_bit((s32)slot, old_valid) != 0)
+			vio_drop_window_insert(drop_mgr, old_gen[slot] << old_shift | slot,
+				(u8)osal_test_bit((s32)slot, old_hit));
+	}
+	vio_x_barrier_irqr(drop_mgr, flags);
+
+	osal_kfree(old_valid);
+	vio_info("[S%d] %s: window %d -> %d\n", vchain->id, __func__, old_window, window);
+
+	return 0;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Print the latest DROP_INFO_NUM drop frame ids of one chain;
+ * @param[in] *vchain: point to struct vio_chain instance;
+ * @param[in] size: size of buf;
+ * @retval length of string
+ * @param[out] *buf: store information string;
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+u32 vio_drop_info_dump(struct vio_chain *vchain, char *buf, u32 size)
+{
+	u32 i, n = 0, slot, frame_id;
+	u32 len, offset = 0;
+	u64 flags = 0;
+	struct vio_drop_mgr *drop_mgr;
+
+	drop_mgr = &vchain->drop_mgr;
+	if (drop_mgr->valid_map == NULL)
+		return offset;
+
+	vio_e_barrier_irqs(drop_mgr, flags);
+	frame_id = drop_mgr->last_set_frameid;
+	for (i = 0; i < drop_mgr->window && n < DROP_INFO_NUM && offset < size; i++) {
+		slot = frame_id & (drop_mgr->window - 1u);
+		if (osal_test_bit((s32)slot, drop_mgr->valid_map) != 0 &&
+			drop_mgr->gen[slot] == frame_id >> drop_mgr->shift) {
+			len = snprintf(&buf[offset], size - offset, "[F%08d] ", frame_id);
+			offset += len;
+			n++;
+		}
+		frame_id--;
+	}
+	vio_x_barrier_irqr(drop_mgr, flags);
+
+	return offset;
+}
+
 struct vio_chain *vio_get_chain(u32 flow_id)
 {
 	struct vio_chain *vchain = NULL;
@@ -288,7 +501,7 @@ EXPORT_SYMBOL(vio_get_vnode);/*PRQA S 0605,0307*/
  */
 s32 vio_check_drop_info(u32 flow_id, u32 frame_id)
 {
-	u32 i, index;
+	u32 slot;
 	s32 drop_flag = 0;
 	u64 flags = 0;
 	struct vio_chain *vchain;
@@ -305,23 +518,18 @@ s32 vio_check_drop_info(u32 flow_id, u32 frame_id)
 
 	drop_mgr = &vchain->drop_mgr;
 	vio_e_barrier_irqs(drop_mgr, flags);
-	index = drop_mgr->head_index;
-	for (i = 0; i < DROP_INFO_NUM; i++) {
-		if (frame_id > drop_mgr->drop_frameid[index])
-			break;
-
-		if (frame_id == drop_mgr->drop_frameid[index]) {
-			drop_flag = 1;
-			drop_mgr->last_drop_frameid = frame_id;
-			vio_warn("[S%d] %s: frame id %d, drop_flag %d\n", flow_id, __func__, frame_id, drop_flag);
-			break;
-		}
-		index = (index + DROP_INFO_NUM - 1) % DROP_INFO_NUM;
+	slot = frame_id & (drop_mgr->window - 1u);
+	if (osal_test_bit((s32)slot, drop_mgr->valid_map) != 0 &&
+		drop_mgr->gen[slot] == frame_id >> drop_mgr->shift) {
+		drop_flag = 1;
+		if (osal_test_and_set_bit((s32)slot, drop_mgr->hit_map) == 0)
+			drop_mgr->hit_cnt++;
+		drop_mgr->last_drop_frameid = frame_id;
 	}
 	vio_x_barrier_irqr(drop_mgr, flags);
 
-	if (i == DROP_INFO_NUM)
-		vio_warn("[S%d] %s: frame id %d < all drop info, please check!\n", flow_id, __func__, frame_id);
+	if (drop_flag != 0)
+		vio_warn("[S%d] %s: frame id %d, drop_flag %d\n", flow_id, __func__, frame_id, drop_flag);
 
 	return drop_flag;
 }
@@ -344,8 +552,9 @@ EXPORT_SYMBOL(vio_check_drop_info);/*PRQA S 0605,0307*/
  */
 void vio_set_drop_info(u32 flow_id, u32 frame_id)
 {
-	u32 next_index, cur_index, prev_index;
+	u32 slot;
 	u64 flags = 0;
+	u64 overflow_cnt;
 	struct vio_drop_mgr *drop_mgr;
 	struct vio_chain *vchain;
 	struct frame_id_desc frameid;
@@ -359,46 +568,50 @@ void vio_set_drop_info(u32 flow_id, u32 frame_id)
 		return;
 	}
 
-	if (frame_id == 0xffffffff) {
+	if (frame_id == DROP_FRAMEID_CUR) {
 		vio_get_frame_id_by_flowid(flow_id, &frameid);
 		frame_id = frameid.frame_id;
+		/* no frame captured yet, never let the marker become last_set_frameid */
+		if (frame_id == DROP_FRAMEID_CUR) {
+			vio_warn("[S%d] %s: no current frame id\n", flow_id, __func__);
+			return;
+		}
 	}
 
 	drop_mgr = &vchain->drop_mgr;
 	vio_e_barrier_irqs(drop_mgr, flags);
-	cur_index = drop_mgr->head_index;
-	next_index = (cur_index + 1) % DROP_INFO_NUM;
-	prev_index = (cur_index - 1) % DROP_INFO_NUM;
-	if(drop_mgr->drop_frameid[cur_index] == frame_id ||
-		drop_mgr->drop_frameid[prev_index] == frame_id) {
+	if (frame_id < drop_mgr->last_set_frameid &&
+		drop_mgr->last_set_frameid - frame_id >= drop_mgr->window * DROP_RESET_WINDOWS) {
+		vio_warn("[S%d] %s: frame id %d -> %d, drop window reset\n", flow_id, __func__,
+			drop_mgr->last_set_frameid, frame_id);
+		vio_drop_window_reset(drop_mgr);
+	}
+	slot = frame_id & (drop_mgr->window - 1u);
+	if (osal_test_bit((s32)slot, drop_mgr->valid_map) != 0 &&
+		drop_mgr->gen[slot] == frame_id >> drop_mgr->shift) {
 		vio_dbg("%s: drop frame %d already exists\n", __func__, frame_id);
 		vio_x_barrier_irqr(drop_mgr, flags);
 		return;
 	}
 
-	if (drop_mgr->last_drop_frameid < drop_mgr->drop_frameid[next_index])
-		vio_warn("%s: drop pool is overflow, drop frame id %d\n", __func__,
-            drop_mgr->drop_frameid[next_index]);
-
-	if (drop_mgr->drop_frameid[cur_index] < frame_id) {
-		drop_mgr->drop_frameid[next_index] = frame_id;
-	} else {
-		drop_mgr->drop_frameid[next_index] = drop_mgr->drop_frameid[cur_index];
-		drop_mgr->drop_frameid[cur_index] = frame_id;
-	}
-	drop_mgr->head_index = next_index;
-
+	overflow_cnt = drop_mgr->overflow_cnt;
+	vio_drop_window_insert(drop_mgr, frame_id, 0);
+	drop_mgr->set_cnt++;
 	vio_x_barrier_irqr(drop_mgr, flags);
 
+	if (overflow_cnt != drop_mgr->overflow_cnt)
+		vio_warn("[S%d] %s: drop window is overflow, frame id %d\n", flow_id, __func__, frame_id);
 	vio_warn("[S%d] %s: frame id %d\n", flow_id, __func__, frame_id);
 }
 EXPORT_SYMBOL(vio_set_drop_info);/*PRQA S 0605,0307*/
 
 void *vio_get_metadata(u32 flow_id, u32 frame_id)
 {
-	s32 cur_index;
-	u64 flags = 0;
-	void *metadata = NULL;
+	u32 index, seq, max_frameid;
+	s64 word;
+	unsigned long flags;
+	void *metadata;
+	atomic64_t *slot_word;
 	struct vio_metadata_mgr *meta_mgr;
 	struct vio_chain *vchain;
 
@@ -412,27 +625,212 @@ void *vio_get_metadata(u32 flow_id, u32 frame_id)
 	}
 
 	meta_mgr = &vchain->meta_mgr;
-	vio_e_barrier_irqs(meta_mgr, flags);
-	if (meta_mgr->max_frameid <= frame_id) {
-		meta_mgr->max_frameid = frame_id;
+	/* max_frameid only feeds the early warning, a racy update is fine */
+	max_frameid = READ_ONCE(meta_mgr->max_frameid);
+	if (max_frameid <= frame_id) {
+		WRITE_ONCE(meta_mgr->max_frameid, frame_id);
 	} else {
-		if ((meta_mgr->max_frameid - frame_id) >= META_OVERFLOW_EWARN)
+		if ((max_frameid - frame_id) >= META_OVERFLOW_EWARN)
 			vio_warn("%s: overflow early warning, max frameid %d, frame id %d, please check!\n",
-				__func__, meta_mgr->max_frameid, frame_id);
+				__func__, max_frameid, frame_id);
 	}
 
-	cur_index = frame_id % CMN_META_NUM;
-	if (meta_mgr->frameid[cur_index] < frame_id) {
-		meta_mgr->frameid[cur_index] = frame_id;
-		metadata = meta_mgr->metadata + cur_index * METADATA_SIZE;
-		vio_init_metadata(flow_id, metadata, frame_id);
-	} else if (meta_mgr->frameid[cur_index] == frame_id) {
-		metadata = meta_mgr->metadata + cur_index * METADATA_SIZE;
-	} else {
-		vio_warn("%s: frame id %d not match\n", __func__, frame_id);
+	index = frame_id % CMN_META_NUM;
+	metadata = meta_mgr->metadata + index * METADATA_SIZE;
+	slot_word = META_SLOT_WORD(meta_mgr, index);
+
+	/* irq off so that a claimer is never spun on by an irq on its own cpu */
+	local_irq_save(flags);
+	word = atomic64_read_acquire(slot_word);
+	for (;;) {
+		seq = META_WORD_SEQ(word);
+		if ((seq & 1u) != 0u) {
+			/* header of this slot is being initialized on another cpu */
+			cpu_relax();
+			word = atomic64_read_acquire(slot_word);
+			continue;
+		}
+
+		if (seq != 0u && META_WORD_FRAMEID(word) == frame_id) {
+			local_irq_restore(flags);
+			return metadata;
+		}
+
+		if (seq != 0u && META_WORD_FRAMEID(word) > frame_id) {
+			local_irq_restore(flags);
+			osal_atomic_inc(&meta_mgr->overflow_cnt);
+			vio_warn("%s: frame id %d not match\n", __func__, frame_id);
+			return NULL;
+		}
+
+		/* a new frame id restarts the sequence, publishes never get near a wrap */
+		if (atomic64_try_cmpxchg(slot_word, &word, META_WORD(frame_id, 1u)))
+			break;
 	}
-	vio_x_barrier_irqr(meta_mgr, flags);
+
+	/* items of the old frame must not pass for published ones of the new frame */
+	(void)memset(metadata, 0, METADATA_SIZE);
+	(void)vio_init_metadata(flow_id, metadata, frame_id);
+	atomic64_set_release(slot_word, META_WORD(frame_id, 2u));
+	local_irq_restore(flags);
 
 	return metadata;
 }
 EXPORT_SYMBOL(vio_get_metadata);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Check that a metadata slot still belongs to the frame it was got for
+ * before an item is written into it, nothing is locked and nobody spins;
+ * @param[in] flow_id: pipe id;
+ * @param[in] *metadata: slot returned by vio_get_metadata;
+ * @retval "= 0": success
+ * @retval "-EINVAL": slot is not part of the ring
+ * @retval "-ENOENT": slot was reclaimed by a newer frame
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_metadata_write_begin(u32 flow_id, void *metadata)
+{
+	u32 index, frame_id;
+	s64 cur;
+	struct vio_metadata_mgr *meta_mgr;
+	struct vio_chain *vchain;
+
+	vchain = vio_get_chain(flow_id);
+	if (vchain == NULL)
+		return -EINVAL;
+
+	meta_mgr = &vchain->meta_mgr;
+	if (metadata < meta_mgr->metadata ||
+		metadata >= meta_mgr->metadata + METADATA_SIZE * CMN_META_NUM)
+		return -EINVAL;
+
+	index = (u32)((metadata - meta_mgr->metadata) / METADATA_SIZE);
+	frame_id = ((struct metadata_header_s *)metadata)->frame_id;
+	cur = atomic64_read_acquire(META_SLOT_WORD(meta_mgr, index));
+	/* odd: the slot is being reclaimed for a newer frame right now */
+	if ((META_WORD_SEQ(cur) & 1u) != 0u || META_WORD_SEQ(cur) == 0u ||
+		META_WORD_FRAMEID(cur) != frame_id)
+		return -ENOENT;
+
+	return 0;
+}
+EXPORT_SYMBOL(vio_metadata_write_begin);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Move the slot sequence on after an item was published by the
+ * release store of its magic, so that slot readers see the change;
+ * @param[in] flow_id: pipe id;
+ * @param[in] *metadata: slot returned by vio_get_metadata;
+ * @retval None
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void vio_metadata_write_end(u32 flow_id, void *metadata)
+{
+	u32 index;
+	struct vio_metadata_mgr *meta_mgr;
+	struct vio_chain *vchain;
+
+	vchain = vio_get_chain(flow_id);
+	if (vchain == NULL)
+		return;
+
+	meta_mgr = &vchain->meta_mgr;
+	index = (u32)((metadata - meta_mgr->metadata) / METADATA_SIZE);
+	/*
+	 * an add and not a store: items of one frame can be filled on several cpus
+	 * at once, and the add never touches the frame id bits, so it can not undo
+	 * a reclaim that happened meanwhile.
+	 */
+	(void)atomic64_add_return_release(2, META_SLOT_WORD(meta_mgr, index));
+}
+EXPORT_SYMBOL(vio_metadata_write_end);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Copy a consistent snapshot of one frame's metadata, only items
+ * whose magic is published are copied, the copy is retried if the slot is
+ * reclaimed by a newer frame meanwhile;
+ * @param[in] flow_id: pipe id;
+ * @param[in] frame_id: frame id;
+ * @param[out] *dst: buffer of METADATA_SIZE bytes;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_copy_metadata(u32 flow_id, u32 frame_id, void *dst)
+{
+	u32 i, index, seq, offset, end, size;
+	s64 word;
+	void *metadata;
+	atomic64_t *slot_word;
+	struct item_header_s *item_header;
+	struct metadata_header_s *meta_header;
+	struct vio_chain *vchain;
+
+	vchain = vio_get_chain(flow_id);
+	if (vchain == NULL || dst == NULL)
+		return -EINVAL;
+
+	index = frame_id % CMN_META_NUM;
+	metadata = vchain->meta_mgr.metadata + index * METADATA_SIZE;
+	meta_header = (struct metadata_header_s *)metadata;
+	slot_word = META_SLOT_WORD(&vchain->meta_mgr, index);
+	for (i = 0; i < META_READ_RETRY; i++) {
+		word = atomic64_read_acquire(slot_word);
+		seq = META_WORD_SEQ(word);
+		if (seq == 0u || META_WORD_FRAMEID(word) != frame_id)
+			return -ENOENT;
+		if ((seq & 1u) != 0u) {
+			cpu_relax();
+			continue;
+		}
+
+		(void)memcpy(dst, metadata, sizeof(struct metadata_header_s));
+		offset = sizeof(struct metadata_header_s);
+		end = (u32)osal_atomic_read(&meta_header->offset);
+		while (offset + sizeof(struct item_header_s) <= end) {
+			item_header = (struct item_header_s *)(metadata + offset);
+			/* the magic is stored last by vio_fill_metadata, an item without it is still being written */
+			if (smp_load_acquire(&item_header->magic) != METADATA_ITEM_MAGIC)
+				break;
+			size = item_header->size;
+			if (size < sizeof(struct item_header_s) || offset + size > METADATA_SIZE)
+				break;
+			(void)memcpy(dst + offset, item_header, size);
+			offset += size;
+		}
+		(void)memset(dst + offset, 0, METADATA_SIZE - offset);
+		osal_atomic_set(&((struct metadata_header_s *)dst)->offset, offset);
+		smp_rmb();
+		/* new items only move the sequence on, a reclaim changes the frame id */
+		word = atomic64_read(slot_word);
+		if (META_WORD_FRAMEID(word) == frame_id && (META_WORD_SEQ(word) & 1u) == 0u)
+			return 0;
+	}
+
+	vio_warn("[S%d] %s: frame id %d, slot keeps changing\n", flow_id, __func__, frame_id);
+
+	return -EBUSY;
+}
+EXPORT_SYMBOL(vio_copy_metadata);/*PRQA S 0605,0307*/
@@ -15,30 +15,61 @@
 #define VIO_CHAIN_API_H
 
 #include "vio_node_api.h"
+#include "vio_metadata_uapi.h"
 
-#define DROP_INFO_NUM 6u
-#define CMN_META_NUM 10u
+#define DROP_INFO_NUM 6u /* drop entries shown by drop_info */
+#define DROP_WINDOW_DEFAULT 64u
+#define DROP_WINDOW_MIN 8u
+#define DROP_WINDOW_MAX 4096u
+#define DROP_FRAMEID_CUR 0xffffffffu /* vio_set_drop_info: drop the current VIN frame */
+#define DROP_RESET_WINDOWS 4u /* a set this many windows behind the newest one restarts the window */
+#define CMN_META_NUM ((u32)VIO_METADATA_SLOT_NUM)
 #define META_OVERFLOW_EWARN (CMN_META_NUM - 2u)
 #define METADATA_SIZE (4 * 1024) //4KB
 
 #define PATH_SIZE 128
+#define VIO_LAT_SIZE (sizeof(struct vio_lat_stage) * MODULE_NUM * VIO_LAT_STAGE_NUM)
 /**
  * @struct vio_drop_mgr
- * @brief Define the descriptor of frame drop information manager and manager vio_dropinfo.
+ * @brief Define the descriptor of frame drop information manager.
+ * Drop frame ids are kept in a direct-mapped window indexed by
+ * frame_id % window, gen[] holds frame_id / window of the slot owner.
  * @NO{S09E05C01}
  */
 struct vio_drop_mgr {
 	osal_spinlock_t slock;
-	u32	drop_frameid[DROP_INFO_NUM];
-	u32	head_index;
+	u32 window; /* power of two */
+	u32 shift; /* log2(window) */
+	u32 *gen;
+	unsigned long *valid_map;
+	unsigned long *hit_map; /* slot was matched by vio_check_drop_info */
 	u32 last_drop_frameid;
+	u32 last_set_frameid;
+	u64 set_cnt;
+	u64 hit_cnt;
+	u64 overflow_cnt; /* too old to fit, or evicted before being checked */
+	u64 reset_cnt; /* frame id jumped back, e.g. sensor restart */
 };
 
+#define META_READ_RETRY 4u
+/* the uapi slot word is a plain s64, the kernel side works on it as atomic64_t */
+#define META_SLOT_WORD(meta_mgr, index) ((atomic64_t *)&(meta_mgr)->ctrl->slot_word[index])
+
+#define METADATA_CTRL_SIZE PAGE_SIZE
+#define METADATA_REGION_SIZE (METADATA_CTRL_SIZE + METADATA_SIZE * CMN_META_NUM)
+
+/**
+ * @struct vio_metadata_mgr
+ * @brief Lock-free metadata ring, slots are claimed by cmpxchg on slot word
+ * and items are published by a release store, see vio_metadata_uapi.h.
+ * @NO{S09E05C01}
+ */
 struct vio_metadata_mgr {
-	osal_spinlock_t slock;
-	u32 frameid[CMN_META_NUM];
 	u32 max_frameid;
 	u32 metadata_size;
+	osal_atomic_t overflow_cnt;
+	void *base; /* control page + slots */
+	struct vio_metadata_ctrl *ctrl;
 	void *metadata;
 };
 
@@ -62,6 +93,7 @@ struct vio_chain {
     struct vio_metadata_mgr meta_mgr;
 	struct module_stat mstat[MODULE_NUM][MAX_DELAY_FRAMES];
 	u32 info_idx[MODULE_NUM][STAT_NUM];
+	struct vio_lat_stage *lat; /* [nr_cpu_ids][MODULE_NUM][VIO_LAT_STAGE_NUM], one copy per cpu */
     u8 path[PATH_SIZE];
     u8 path_print;
 };
@@ -78,6 +110,9 @@ struct vio_core {
 };
 
 s32 vio_chain_init(struct vio_chain *vchain, u32 id);
+void vio_chain_release(struct vio_chain *vchain);
+s32 vio_chain_set_drop_window(struct vio_chain *vchain, u32 window);
+u32 vio_drop_info_dump(struct vio_chain *vchain, char *buf, u32 size);
 char *vchain_get_module_name(u32 vnode_id);
 s32 vnode_mgr_add_member(struct vio_node_mgr *vnode_mgr, struct vio_node *vnode);
 struct vio_node *vnode_mgr_find_member(struct vio_node_mgr *vnode_mgr, u32 vnode_id, u32 ctx_id);
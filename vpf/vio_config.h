@@ -174,6 +174,114 @@ struct vpf_ext_ctrl {
 	void *arg;
 };
 
+/**
+ * @struct vio_sched_attr
+ * @brief Scheduling attribute of one context on a shared hardware instance.
+ * fps is used to derive the per-frame deadline, 0 means no deadline.
+ * @NO{S09E05C01}
+ */
+struct vio_sched_attr {
+	u32 sched_mode; /* GTASK_FIFO_SCHED/GTASK_ROLL_SCHED/GTASK_DEADLINE_SCHED */
+	u32 priority; /* 0 ~ GTASK_PRIO_NUM - 1, 0 is the highest */
+	u32 fps;
+};
+
+#define VIO_CPU_ACCESS_NONE 0u
+#define VIO_CPU_ACCESS_READ 1u
+#define VIO_CPU_ACCESS_WRITE 2u
+#define VIO_CPU_ACCESS_MASK (VIO_CPU_ACCESS_READ | VIO_CPU_ACCESS_WRITE)
+
+/**
+ * @struct vio_cache_attr
+ * @brief CPU access declaration of driver-allocated buffers; cache maintenance
+ * is only done for the declared direction and only in rows
+ * [roi_y, roi_y + roi_height) of every plane, roi_height 0 means whole plane.
+ * @NO{S09E05C01}
+ */
+struct vio_cache_attr {
+	s32 bufferindex; /* -1 means all buffers */
+	u32 cpu_access; /* VIO_CPU_ACCESS_* */
+	u32 roi_y;
+	u32 roi_height;
+};
+
+#define VIO_LAT_STAGE_TRIG_FS 0u /* sensor trigger -> sif frame start */
+#define VIO_LAT_STAGE_FS_FE 1u /* frame start -> frame end of one module */
+#define VIO_LAT_STAGE_FE_QB 2u /* upstream frame end -> qbuf of this module */
+#define VIO_LAT_STAGE_QB_DQ 3u /* qbuf -> dqbuf of one module */
+#define VIO_LAT_STAGE_NUM 4u
+#define VIO_LAT_SUB_BITS 2u /* 4 buckets per power of 2 */
+#define VIO_LAT_BUCKET_NUM 96u /* 1us ~ 33s */
+
+/**
+ * @struct vio_lat_stage
+ * @brief Log-bucketed latency histogram of one stage, bucket i < 4 holds i us,
+ * bucket i >= 4 holds [(4 + i % 4) << (i / 4 - 1), (5 + i % 4) << (i / 4 - 1)) us.
+ * p50/p99/p999 are the upper bounds of the buckets holding the percentiles.
+ * @NO{S09E05C01}
+ */
+struct vio_lat_stage {
+	u64 count;
+	u64 sum_us;
+	u32 max_us;
+	u32 p50_us;
+	u32 p99_us;
+	u32 p999_us;
+	u32 bucket[VIO_LAT_BUCKET_NUM];
+};
+
+/**
+ * @struct vio_lat_info
+ * @brief Latency histograms of one module in one flow, for VIO_IOC_GET_LAT_HIST.
+ * @NO{S09E05C01}
+ */
+struct vio_lat_info {
+	u32 flow_id; /* input */
+	u32 module; /* input, VIN_MODULE ~ CODEC_MODULE */
+	struct vio_lat_stage stage[VIO_LAT_STAGE_NUM];
+};
+
+#define VIO_STAT_DROP_TYPE_NUM 3u /* hw drop, sw drop, user drop */
+#define VIO_STAT_FRAME_STATE_NUM 5u /* FS_FREE ~ FS_USED */
+#define VIO_STAT_BULK_MAX 1024u
+
+/**
+ * @struct vio_chn_stat
+ * @brief Consistent snapshot of fps/drop/delay/frame queue statistics of one channel.
+ * @NO{S09E05C01}
+ */
+struct vio_chn_stat {
+	u32 flow_id;
+	u32 module;
+	u32 ctx_id;
+	u32 chn; /* 0 ~ 7 ich, 8 ~ 15 och */
+	u32 frame_id;
+	u32 fcount;
+	u32 avg_fps; /* fps * 1000 since stream on */
+	u32 cur_fps; /* fps * 1000 of the last frame interval */
+	u32 last_sec_frames; /* frames in the last whole second, 0 if stale */
+	u32 cur_delay_us;
+	u32 min_delay_us;
+	u32 max_delay_us;
+	u32 avg_delay_us;
+	u32 drop_count[VIO_STAT_DROP_TYPE_NUM];
+	u32 last_drop_id[VIO_STAT_DROP_TYPE_NUM];
+	u32 queued_count[VIO_STAT_FRAME_STATE_NUM];
+};
+
+/**
+ * @struct vio_stats_bulk
+ * @brief Read statistics of all started channels of the flows in one call.
+ * @NO{S09E05C01}
+ */
+struct vio_stats_bulk {
+	u32 flowid_mask; /* input */
+	u32 max_num; /* input, entries of stats, at most VIO_STAT_BULK_MAX */
+	u32 num; /* output, entries filled */
+	u32 reserved;
+	u64 stats; /* input, user pointer of struct vio_chn_stat array */
+};
+
 #define MAGIC_NUMBER	0x12345678u
 #define VIO_IOC_MAGIC 'p'
 
@@ -207,6 +315,11 @@ struct vpf_ext_ctrl {
 #define VIO_IOC_ADD_NODE         _IOW(VIO_IOC_MAGIC, 32, int)
 #define VIO_IOC_SET_CALLBACK     _IOR(VIO_IOC_MAGIC, 33, int)
 #define VIO_IOC_GET_HW_STATUS      _IOR(VIO_IOC_MAGIC, 34, int)
+#define VIO_IOC_SET_SCHED_ATTR   _IOW(VIO_IOC_MAGIC, 35, int)
+#define VIO_IOC_QBUF_BATCH       _IOWR(VIO_IOC_MAGIC, 36, int)
+#define VIO_IOC_SET_CACHE_ATTR   _IOW(VIO_IOC_MAGIC, 37, int)
+#define VIO_IOC_GET_LAT_HIST     _IOWR(VIO_IOC_MAGIC, 38, int)
+#define VIO_IOC_GET_STATS_BULK   _IOWR(VIO_IOC_MAGIC, 39, int)
 
 #define VIO_IOC_DBG_CTRL     	 _IOWR(VIO_IOC_MAGIC, 50, int)
 #endif /* HOBOT_VIO_CONFIG_H */
@@ -15,6 +15,22 @@
 #include "vio_chain_api.h"
 #include "vio_debug_api.h"
 
+/**
+ * Purpose: module name of the latency and utilisation prints, as in vps_stat_name
+ * Value: NA
+ * Range: vio_debug_api.c
+ * Attention: NA
+ */
+static const char *vio_dbg_module_name[MODULE_NUM] = {
+	"sif",
+	"isp",
+	"vse",
+	"gdc",
+	"n2d",
+	"ipu",
+	"codec",
+};
+
 static void frame_delay_calcalate(struct frame_delay *fdelay, struct frame_id_desc *frameid)
 {
 	u64 timestamps;
@@ -27,13 +43,350 @@ static void frame_delay_calcalate(struct frame_delay *fdelay, struct frame_id_de
 	if (fdelay->max_delay_ns == 0 || fdelay->max_delay_ns < fdelay->cur_delay_ns)
 		fdelay->max_delay_ns = fdelay->cur_delay_ns;
 
-	if (fdelay->avg_delay_ns == 0)
-		fdelay->avg_delay_ns = fdelay->cur_delay_ns;
-	else
-		fdelay->avg_delay_ns = (fdelay->avg_delay_ns * fdelay->fcount + fdelay->cur_delay_ns) /
-			(fdelay->fcount + 1);
-
+	/* average from the running sum, avg * fcount rounding drifted */
+	fdelay->total_delay_ns += fdelay->cur_delay_ns;
 	fdelay->fcount++;
+	fdelay->avg_delay_ns = div_u64(fdelay->total_delay_ns, fdelay->fcount);
+}
+
+/*
+ * Bucket of a latency in us, 4 buckets per power of 2:
+ * [0, 4) one bucket per us, then (msb - 1) * 4 + next 2 bits below msb.
+ */
+static u32 vio_lat_bucket(u64 us)
+{
+	u32 msb, idx;
+
+	if (us < (1u << VIO_LAT_SUB_BITS))
+		return (u32)us;
+
+	msb = (u32)fls64(us) - 1u;
+	idx = ((msb - VIO_LAT_SUB_BITS + 1u) << VIO_LAT_SUB_BITS) +
+		(u32)((us >> (msb - VIO_LAT_SUB_BITS)) & ((1u << VIO_LAT_SUB_BITS) - 1u));
+
+	return min(idx, VIO_LAT_BUCKET_NUM - 1u);
+}
+
+/* largest latency in us that falls into bucket idx */
+static u32 vio_lat_bucket_upper(u32 idx)
+{
+	u32 sub, shift;
+
+	if (idx < (1u << VIO_LAT_SUB_BITS))
+		return idx;
+
+	sub = idx & ((1u << VIO_LAT_SUB_BITS) - 1u);
+	shift = (idx >> VIO_LAT_SUB_BITS) - 1u;
+
+	return (((1u << VIO_LAT_SUB_BITS) + sub + 1u) << shift) - 1u;
+}
+
+static struct vio_lat_stage *vio_lat_cpu(struct vio_chain *chain, u32 cpu, u32 module, u32 stage)
+{
+	return &chain->lat[(cpu * MODULE_NUM + module) * VIO_LAT_STAGE_NUM + stage];
+}
+
+/* fold the per-cpu copies of one stage, percentiles are left to the caller */
+static void vio_lat_sum(struct vio_chain *chain, u32 module, u32 stage, struct vio_lat_stage *out)
+{
+	u32 i, cpu;
+	const struct vio_lat_stage *lstage;
+
+	(void)memset(out, 0, sizeof(struct vio_lat_stage));
+	for_each_possible_cpu(cpu) {/*PRQA S 2810,1840,4461,0497*/
+		lstage = vio_lat_cpu(chain, cpu, module, stage);
+		out->count += READ_ONCE(lstage->count);
+		out->sum_us += READ_ONCE(lstage->sum_us);
+		out->max_us = max(out->max_us, READ_ONCE(lstage->max_us));
+		for (i = 0; i < VIO_LAT_BUCKET_NUM; i++)
+			out->bucket[i] += READ_ONCE(lstage->bucket[i]);
+	}
+}
+
+/* permille: 500 for p50, 990 for p99, 999 for p99.9 */
+static u32 vio_lat_percentile(const struct vio_lat_stage *lstage, u32 permille)
+{
+	u32 i;
+	u64 target, sum = 0;
+
+	if (lstage->count == 0u)
+		return 0;
+
+	target = div_u64(lstage->count * permille + 999u, 1000u);
+	for (i = 0; i < VIO_LAT_BUCKET_NUM; i++) {
+		sum += lstage->bucket[i];
+		if (sum >= target)
+			return min(vio_lat_bucket_upper(i), lstage->max_us);
+	}
+
+	return lstage->max_us;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Add one latency sample of a stage to the histogram of the module;
+ * @param[in] flow_id: pipeline id;
+ * @param[in] module: module id;
+ * @param[in] stage: VIO_LAT_STAGE_*;
+ * @param[in] delta_us: latency in us;
+ * @retval None
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void vio_lat_record(u32 flow_id, u32 module, u32 stage, u64 delta_us)
+{
+	unsigned long flags;
+	struct vio_chain *chain;
+	struct vio_lat_stage *lstage;
+
+	if (module >= MODULE_NUM || stage >= VIO_LAT_STAGE_NUM)
+		return;
+
+	chain = vio_get_chain(flow_id);
+	if (chain == NULL || chain->lat == NULL)
+		return;
+
+	/*
+	 * samples come from irq and ioctl paths of several hw instances at once,
+	 * each cpu updates its own copy with irqs off and readers sum the copies
+	 */
+	local_irq_save(flags);
+	lstage = vio_lat_cpu(chain, smp_processor_id(), module, stage);
+	lstage->bucket[vio_lat_bucket(delta_us)]++;
+	lstage->count++;
+	lstage->sum_us += delta_us;
+	if (delta_us > lstage->max_us)
+		lstage->max_us = (u32)min_t(u64, delta_us, U32_MAX);
+	local_irq_restore(flags);
+}
+EXPORT_SYMBOL(vio_lat_record);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Snapshot latency histograms of one module with percentiles;
+ * @param[in] *info: flow_id and module are input, stage[] is output;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_lat_get_info(struct vio_lat_info *info)
+{
+	u32 i;
+	struct vio_chain *chain;
+	struct vio_lat_stage *lstage;
+
+	if (info->flow_id >= VIO_MAX_STREAM || info->module >= MODULE_NUM)
+		return -EINVAL;
+
+	chain = vio_get_chain(info->flow_id);
+	if (chain == NULL || chain->lat == NULL)
+		return -ENODEV;
+
+	for (i = 0; i < VIO_LAT_STAGE_NUM; i++) {
+		lstage = &info->stage[i];
+		vio_lat_sum(chain, info->module, i, lstage);
+		lstage->p50_us = vio_lat_percentile(lstage, 500u);
+		lstage->p99_us = vio_lat_percentile(lstage, 990u);
+		lstage->p999_us = vio_lat_percentile(lstage, 999u);
+	}
+
+	return 0;
+}
+
+/**
+ * Purpose: busy time sampler of every hardware instance
+ * Value: NA
+ * Range: vio_debug_api.c
+ * Attention: NA
+ */
+static struct vio_hw_util g_hw_util[MODULE_NUM][VIO_UTIL_HW_MAX];
+
+void vio_hw_util_init(void)
+{
+	u32 i, j;
+
+	for (i = 0; i < MODULE_NUM; i++) {
+		for (j = 0; j < VIO_UTIL_HW_MAX; j++) {
+			(void)memset(&g_hw_util[i][j], 0, sizeof(struct vio_hw_util));
+			osal_spin_init(&g_hw_util[i][j].slock);
+		}
+	}
+}
+
+/* close every 100ms slot that ended before now, caller holds util->slock */
+static void vio_hw_util_advance(struct vio_hw_util *util, u64 now)
+{
+	u32 n = 0;
+	u64 busy, slot_end, skip;
+	u64 slot_ns = (u64)VIO_UTIL_SLOT_MS * NSEC_PER_MSEC;
+
+	if (util->win_start_ns == 0u) {
+		util->win_start_ns = now;
+		return;
+	}
+
+	while (now >= util->win_start_ns + slot_ns) {
+		slot_end = util->win_start_ns + slot_ns;
+		busy = util->win_busy_ns;
+		if (util->inflight != 0u) {
+			busy += slot_end - util->busy_mark_ns;
+			util->busy_mark_ns = slot_end;
+		}
+		util->slot_util[util->slot_idx] = (u16)div64_u64(min(busy, slot_ns) * 10000u, slot_ns);
+		util->slot_idx = (util->slot_idx + 1u) % VIO_UTIL_SLOT_NUM;
+		if (util->slot_cnt < VIO_UTIL_SLOT_NUM)
+			util->slot_cnt++;
+		util->win_start_ns = slot_end;
+		util->win_busy_ns = 0;
+
+		/* every slot is rewritten, the rest have the same value */
+		if (++n >= VIO_UTIL_SLOT_NUM) {
+			skip = div64_u64(now - util->win_start_ns, slot_ns) * slot_ns;
+			util->win_start_ns += skip;
+			if (util->inflight != 0u)
+				util->busy_mark_ns = util->win_start_ns;
+			break;
+		}
+	}
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Account hardware busy/idle transition of one hardware instance;
+ * @param[in] module: module id;
+ * @param[in] hw_id: hardware instance id;
+ * @param[in] src: event source, enum vio_util_src;
+ * @param[in] busy: 1 when hardware starts one frame, 0 when it is done;
+ * @retval None
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void vio_hw_util_event(u32 module, u32 hw_id, enum vio_util_src src, u32 busy)
+{
+	u64 flags = 0;
+	u64 now;
+	struct vio_hw_util *util;
+
+	if (module >= MODULE_NUM || hw_id >= VIO_UTIL_HW_MAX)
+		return;
+
+	util = &g_hw_util[module][hw_id];
+	now = osal_time_get_ns();
+	vio_e_barrier_irqs(util, flags);/*PRQA S 2996*/
+	if (util->src != (u32)src) {
+		/* FS switches the instance to FS/FE events for good, gtask only fills in */
+		if ((src != VIO_UTIL_SRC_STAT || busy == 0u) &&
+			(src != VIO_UTIL_SRC_GTASK || util->src != (u32)VIO_UTIL_SRC_NONE)) {
+			vio_x_barrier_irqr(util, flags);/*PRQA S 2996*/
+			return;
+		}
+		vio_hw_util_advance(util, now);
+		if (util->inflight != 0u)
+			util->win_busy_ns += now - util->busy_mark_ns;
+		util->inflight = 0;
+		util->src = (u32)src;
+	}
+
+	vio_hw_util_advance(util, now);
+	if (busy != 0u) {
+		/* a missed FE must not keep sif/isp busy forever */
+		if (util->inflight == 0u)
+			util->busy_mark_ns = now;
+		if (src == VIO_UTIL_SRC_GTASK || util->inflight == 0u)
+			util->inflight++;
+	} else if (util->inflight != 0u) {
+		util->inflight--;
+		if (util->inflight == 0u)
+			util->win_busy_ns += now - util->busy_mark_ns;
+	}
+	vio_x_barrier_irqr(util, flags);/*PRQA S 2996*/
+}
+EXPORT_SYMBOL(vio_hw_util_event);/*PRQA S 0605,0307*/
+
+/* average of the last num closed slots, xx.xx% */
+static u32 vio_hw_util_avg(const struct vio_hw_util *util, u32 num)
+{
+	u32 i, idx;
+	u32 sum = 0;
+
+	num = min(num, util->slot_cnt);
+	if (num == 0u)
+		return 0;
+
+	idx = util->slot_idx;
+	for (i = 0; i < num; i++) {
+		idx = (idx + VIO_UTIL_SLOT_NUM - 1u) % VIO_UTIL_SLOT_NUM;
+		sum += util->slot_util[idx];
+	}
+
+	return sum / num;
+}
+
+u32 vio_hw_util_stats(char* buf, u32 size)
+{
+	u32 i, j;
+	u32 len;
+	u32 offset = 0;
+	u64 flags = 0;
+	u32 util_val[3];
+	struct vio_hw_util *util;
+
+	len = snprintf(&buf[offset], size - offset,
+				"------------------------------------------------------------------------------\n");
+	offset += len;
+	len = snprintf(&buf[offset], size - offset, "%-10s%-10s%-10s%14s%14s%14s\n",
+				"module", "hw_id", "source", "util_100ms", "util_1s", "util_10s");
+	offset += len;
+	len = snprintf(&buf[offset], size - offset,
+				"------------------------------------------------------------------------------\n");
+	offset += len;
+
+	for (i = 0; i < MODULE_NUM; i++) {
+		for (j = 0; j < VIO_UTIL_HW_MAX; j++) {
+			util = &g_hw_util[i][j];
+			if (util->src == (u32)VIO_UTIL_SRC_NONE)
+				continue;
+
+			vio_e_barrier_irqs(util, flags);/*PRQA S 2996*/
+			vio_hw_util_advance(util, osal_time_get_ns());
+			util_val[0] = vio_hw_util_avg(util, 1u);
+			util_val[1] = vio_hw_util_avg(util, 1000u / VIO_UTIL_SLOT_MS);
+			util_val[2] = vio_hw_util_avg(util, VIO_UTIL_SLOT_NUM);
+			vio_x_barrier_irqr(util, flags);/*PRQA S 2996*/
+
+			if (size <= offset)
+				return offset;
+			len = snprintf(&buf[offset], size - offset,
+					"%-10s%-10d%-10s%11d.%02d%%%11d.%02d%%%11d.%02d%%\n",
+					vio_dbg_module_name[i], j,
+					util->src == (u32)VIO_UTIL_SRC_STAT ? "fs/fe" : "gtask",
+					util_val[0] / 100u, util_val[0] % 100u,
+					util_val[1] / 100u, util_val[1] % 100u,
+					util_val[2] / 100u, util_val[2] % 100u);
+			offset += len;
+		}
+	}
+
+	return offset;
 }
 
 void vio_loading_calculate(struct vio_hw_loading* loading, enum vio_stat_type stype)
@@ -89,6 +442,8 @@ EXPORT_SYMBOL(vio_loading_calculate);
 void vio_fps_calculate(struct frame_debug *fdebug, struct frame_id_desc *frameid)
 {
 	u32 type;
+	u64 trig_us, fs_us;
+	unsigned long flags;
 	osal_time_t ts;
 	struct id_set *idset;
 
@@ -102,7 +457,10 @@ void vio_fps_calculate(struct frame_debug *fdebug, struct frame_id_desc *frameid
 		frameid->tv_sec = ts.tv_sec;
 	}
 
+	write_seqlock_irqsave(&fdebug->lock, flags);
 	fdebug->fps.cur_frame_count++;
+	fdebug->fps.last_timestamps = fdebug->fps.cur_timestamps;
+	fdebug->fps.cur_timestamps = osal_time_get_ns();
 	if (frameid->tv_sec < fdebug->fps.last_time) {
 		// vio_warn("%s: cur sec < last sec, timestamps abnormal\n", __func__);
 		fdebug->fps.last_time = frameid->tv_sec;
@@ -112,17 +470,25 @@ void vio_fps_calculate(struct frame_debug *fdebug, struct frame_id_desc *frameid
 		fdebug->fps.last_frame_count = fdebug->fps.cur_frame_count;
 		fdebug->fps.last_time = frameid->tv_sec;
 		fdebug->fps.cur_frame_count = 0;
-		fdebug->fps.last_update = 1;
 	}
 	fdebug->fcount++;
 	fdebug->frame_id = frameid->frame_id;
 
 	if (fdebug->init_timestamps == 0)
-		fdebug->init_timestamps = osal_time_get_ns();
+		fdebug->init_timestamps = fdebug->fps.cur_timestamps;
 
 	frame_delay_calcalate(&fdebug->fdelay, frameid);
+	write_sequnlock_irqrestore(&fdebug->lock, flags);
 
 	idset = &fdebug->idset;
+	/* readout time is taken at sif frame start */
+	if (idset->module_id == VIN_MODULE && idset->chn_id < VNODE_ID_CAP &&
+		frameid->trig_tv_sec != 0u) {
+		trig_us = frameid->trig_tv_sec * USEC_PER_SEC + frameid->trig_tv_usec;
+		fs_us = frameid->tv_sec * USEC_PER_SEC + frameid->tv_usec;
+		if (fs_us >= trig_us)
+			vio_lat_record(idset->flow_id, VIN_MODULE, VIO_LAT_STAGE_TRIG_FS, fs_us - trig_us);
+	}
 #ifdef HOBOT_MCU_CAMSYS
 #else
 	if (idset->chn_id < VNODE_ID_CAP)
@@ -139,6 +505,7 @@ EXPORT_SYMBOL(vio_fps_calculate);
 void vio_drop_calculate(struct frame_debug *fdebug, enum vio_drop_type drop_type,
 	struct frame_id_desc *frameid)
 {
+	unsigned long flags;
 	struct frame_drop_stats *drop_stats;
 	struct id_set *idset;
 
@@ -153,10 +520,12 @@ void vio_drop_calculate(struct frame_debug *fdebug, enum vio_drop_type drop_type
 	}
 
 	drop_stats = &fdebug->drop_stats[drop_type];
+	write_seqlock_irqsave(&fdebug->lock, flags);
 	drop_stats->drop_count++;
 	drop_stats->last_drop_id = frameid->frame_id;
 	drop_stats->last_timestamps = drop_stats->cur_timestamps;
 	drop_stats->cur_timestamps = osal_time_get_ns();
+	write_sequnlock_irqrestore(&fdebug->lock, flags);
 
 	idset = &fdebug->idset;
 #ifdef HOBOT_MCU_CAMSYS
@@ -167,6 +536,66 @@ void vio_drop_calculate(struct frame_debug *fdebug, enum vio_drop_type drop_type
 }
 EXPORT_SYMBOL(vio_drop_calculate);
 
+/* hardware instance of the module in this chain */
+static u32 vio_chain_hw_id(struct vio_chain *chain, u32 module)
+{
+	u32 i;
+	struct vio_node *vnode;
+
+	for (i = 0; i < MAX_VNODE_NUM; i++) {
+		vnode = chain->vnode_mgr[module].vnode[i];
+		if (vnode != NULL)
+			return vnode->hw_id;
+	}
+
+	return 0;
+}
+
+static inline u64 vio_statinfo_us(const struct statinfo *sinfo)
+{
+	return sinfo->tv_sec * USEC_PER_SEC + sinfo->tv_usec;
+}
+
+/*
+ * Latency of the stage ended by stype, from the stat info of the same frame id:
+ * FE from FS of this module, QB from FE of the nearest upstream module,
+ * DQ from QB of this module.
+ */
+static void vio_lat_stat_update(struct vio_chain *chain, u32 module,
+	enum vio_stat_type stype, u32 frameid)
+{
+	s32 up;
+	u32 index, stage;
+	const struct statinfo *end, *start = NULL;
+
+	index = frameid % MAX_DELAY_FRAMES;
+	end = &chain->mstat[module][index].sinfo[stype];
+	if (stype == STAT_FE) {
+		start = &chain->mstat[module][index].sinfo[STAT_FS];
+		stage = VIO_LAT_STAGE_FS_FE;
+	} else if (stype == STAT_QB) {
+		for (up = (s32)module - 1; up >= 0; up--) {
+			if (chain->mstat[up][index].sinfo[STAT_FE].frameid == frameid &&
+				chain->mstat[up][index].sinfo[STAT_FE].tv_sec != 0u) {
+				start = &chain->mstat[up][index].sinfo[STAT_FE];
+				break;
+			}
+		}
+		stage = VIO_LAT_STAGE_FE_QB;
+	} else if (stype == STAT_DQ) {
+		start = &chain->mstat[module][index].sinfo[STAT_QB];
+		stage = VIO_LAT_STAGE_QB_DQ;
+	} else {
+		return;
+	}
+
+	if (start == NULL || start->frameid != frameid || start->tv_sec == 0u ||
+		vio_statinfo_us(end) < vio_statinfo_us(start))
+		return;
+
+	vio_lat_record(chain->id, module, stage, vio_statinfo_us(end) - vio_statinfo_us(start));
+}
+
 /**
  * @NO{S09E05C01}
  * @ASIL{B}
@@ -199,6 +628,10 @@ void vio_set_stat_info(u32 flow_id, u32 module, enum vio_stat_type stype, u32 fr
 		return;
 	}
 
+	if (stype == STAT_FS || stype == STAT_FE)
+		vio_hw_util_event(module, vio_chain_hw_id(chain, module), VIO_UTIL_SRC_STAT,
+			stype == STAT_FS ? 1u : 0u);
+
 	if (frameid == 0) {
 		chain->info_idx[module][stype]++;
 		index = chain->info_idx[module][stype] % MAX_DELAY_FRAMES;
@@ -222,6 +655,9 @@ void vio_set_stat_info(u32 flow_id, u32 module, enum vio_stat_type stype, u32 fr
 	osal_time_get(&ts);
 	mstat->sinfo[stype].tv_sec = ts.tv_sec;
 	mstat->sinfo[stype].tv_usec = ts.tv_nsec / 1000;
+
+	if (frameid != 0u)
+		vio_lat_stat_update(chain, module, stype, frameid);
 }
 EXPORT_SYMBOL(vio_set_stat_info);/*PRQA S 0605,0307*/
 
@@ -250,6 +686,149 @@ struct module_stat* vio_get_stat_info(u32 flow_id)
 	return &chain->mstat[0][0];
 }
 
+void vio_fdebug_init(struct frame_debug *fdebug)
+{
+	(void)memset(fdebug, 0, sizeof(struct frame_debug));
+	seqlock_init(&fdebug->lock);
+}
+EXPORT_SYMBOL(vio_fdebug_init);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Take a consistent snapshot of fps/drop/delay statistics of one channel
+ * without blocking the irq writers, derived rates are computed here;
+ * @param[in] *fdebug: point to struct frame_debug instance;
+ * @param[out] *st: fps/drop/delay fields of the snapshot;
+ * @retval None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void vio_fdebug_snapshot(struct frame_debug *fdebug, struct vio_chn_stat *st)
+{
+	u32 i, seq;
+	u64 now_ns, init_ns, cur_ns, last_ns;
+
+	do {
+		seq = read_seqbegin(&fdebug->lock);
+		st->frame_id = fdebug->frame_id;
+		st->fcount = fdebug->fcount;
+		st->last_sec_frames = fdebug->fps.last_frame_count;
+		init_ns = fdebug->init_timestamps;
+		cur_ns = fdebug->fps.cur_timestamps;
+		last_ns = fdebug->fps.last_timestamps;
+		st->cur_delay_us = fdebug->fdelay.cur_delay_ns / NSEC_PER_USEC;
+		st->min_delay_us = fdebug->fdelay.min_delay_ns / NSEC_PER_USEC;
+		st->max_delay_us = fdebug->fdelay.max_delay_ns / NSEC_PER_USEC;
+		st->avg_delay_us = (u32)div_u64(fdebug->fdelay.avg_delay_ns, NSEC_PER_USEC);
+		for (i = 0; i < VIO_STAT_DROP_TYPE_NUM; i++) {
+			st->drop_count[i] = fdebug->drop_stats[i].drop_count;
+			st->last_drop_id[i] = fdebug->drop_stats[i].last_drop_id;
+		}
+	} while (read_seqretry(&fdebug->lock, seq) != 0);
+
+	now_ns = osal_time_get_ns();
+	st->avg_fps = 0;
+	if (init_ns != 0u && now_ns > init_ns)
+		st->avg_fps = (u32)div64_u64((u64)st->fcount * 1000000000000UL, now_ns - init_ns);
+	st->cur_fps = 0;
+	if (last_ns != 0u && cur_ns > last_ns)
+		st->cur_fps = (u32)div64_u64(1000000000000UL, cur_ns - last_ns);
+
+	/*
+	 * fps.last_time is in the frame timebase of the ip, staleness is checked
+	 * against the monotonic arrival time of the last frame instead
+	 */
+	if (cur_ns == 0u || now_ns - cur_ns > NSEC_PER_SEC)
+		st->last_sec_frames = 0;
+}
+EXPORT_SYMBOL(vio_fdebug_snapshot);/*PRQA S 0605,0307*/
+
+/* subdev of channel k, 0 ~ 7 ich and 8 ~ 15 och, NULL if not active */
+static struct vio_subdev *vio_stat_subdev(struct vio_node *vnode, u32 k)
+{
+	if (k < MAXIMUM_CHN) {
+		if ((vnode->active_ich & 1 << k) == 0)
+			return NULL;
+		return vnode->ich_subdev[k];
+	}
+	if ((vnode->active_och & 1 << (k - MAXIMUM_CHN)) == 0)
+		return NULL;
+	return vnode->och_subdev[k - MAXIMUM_CHN];
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Fill snapshots of all started channels of the flows in bulk->flowid_mask;
+ * @param[in] *bulk: request, bulk->stats is a kernel buffer of bulk->max_num entries here;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_stats_bulk(struct vio_stats_bulk *bulk)
+{
+	u32 i, j, k, s;
+	u32 flow_id;
+	u64 flags = 0;
+	struct vio_node *vnode;
+	struct vio_chain *vchain;
+	struct vio_subdev *vdev;
+	struct vio_framemgr *framemgr;
+	struct vio_chn_stat *st;
+	struct vio_chn_stat *stats = (struct vio_chn_stat *)(uintptr_t)bulk->stats;
+
+	bulk->num = 0;
+	for (flow_id = 0; flow_id < VIO_MAX_STREAM; flow_id++) {
+		if ((1 << flow_id & bulk->flowid_mask) == 0)
+			continue;
+		vchain = vio_get_chain(flow_id);
+		if (vchain == NULL)
+			continue;
+
+		for (i = 0; i < MODULE_NUM; i++) {
+			for (j = 0; j < MAX_VNODE_NUM; j++) {
+				vnode = vchain->vnode_mgr[i].vnode[j];
+				if (vnode == NULL || osal_test_bit(VIO_NODE_START, &vnode->state) == 0)
+					continue;
+				for (k = 0; k < 2u * MAXIMUM_CHN; k++) {
+					vdev = vio_stat_subdev(vnode, k);
+					if (vdev == NULL)
+						continue;
+					if (bulk->num >= bulk->max_num)
+						return 0;
+
+					st = &stats[bulk->num];
+					(void)memset(st, 0, sizeof(struct vio_chn_stat));
+					st->flow_id = flow_id;
+					st->module = vnode->id;
+					st->ctx_id = vnode->ctx_id;
+					st->chn = k;
+					vio_fdebug_snapshot(&vdev->fdebug, st);
+					framemgr = &vdev->framemgr;
+					vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
+					for (s = 0; s < VIO_STAT_FRAME_STATE_NUM; s++)
+						st->queued_count[s] = framemgr->queued_count[s];
+					vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
+					bulk->num++;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
 u32 vio_fps_snapshot(char* buf, u32 size, u32 flowid_mask)
 {
 	u32 i, j, k;
@@ -259,7 +838,7 @@ u32 vio_fps_snapshot(char* buf, u32 size, u32 flowid_mask)
 	struct vio_node *vnode;
 	struct vio_node_mgr *vnode_mgr;
 	struct vio_chain *vchain;
-	struct frame_debug *fdebug;
+	struct vio_chn_stat st;
 
 	for (flow_id = 0; flow_id < VIO_MAX_STREAM; flow_id++) {
 		if ((1 << flow_id & flowid_mask) == 0)
@@ -293,30 +872,24 @@ u32 vio_fps_snapshot(char* buf, u32 size, u32 flowid_mask)
 				for (k = 0; k < MAXIMUM_CHN; k++) {
 					if ((vnode->active_ich & 1 << k) == 0)
 						continue;
-					fdebug = &vnode->ich_subdev[k]->fdebug;
+					vio_fdebug_snapshot(&vnode->ich_subdev[k]->fdebug, &st);
 
 					if (size <= offset)
 						break;
 					len = snprintf(&buf[offset], size - (size_t)offset,
-								"| ich%d %3d | ", k, fdebug->fps.last_frame_count);
+								"| ich%d %3d | ", k, st.last_sec_frames);
 					offset += len;
-					if (fdebug->fps.last_update == 0)
-						fdebug->fps.last_frame_count = 0;
-					fdebug->fps.last_update = 0;
 				}
 				for (k = 0; k < MAXIMUM_CHN; k++) {
 					if ((vnode->active_och & 1 << k) == 0)
 						continue;
-					fdebug = &vnode->och_subdev[k]->fdebug;
+					vio_fdebug_snapshot(&vnode->och_subdev[k]->fdebug, &st);
 
 					if (size <= offset)
 						break;
 					len = snprintf(&buf[offset], size - (size_t)offset,
-								"och%d %3d | ", k, fdebug->fps.last_frame_count);
+								"och%d %3d | ", k, st.last_sec_frames);
 					offset += len;
-					if (fdebug->fps.last_update == 0)
-						fdebug->fps.last_frame_count = 0;
-					fdebug->fps.last_update = 0;
 				}
 
 				if (size <= offset)
@@ -334,14 +907,13 @@ u32 vio_fps_stats(char* buf, u32 size, u32 flowid_mask)
 {
 	u32 i, j, k;
 	u32 flow_id;
-	u32 avg_fps = 0, cur_fps = 0;
-	u64 cur_timestamps, dura_timestamps;
 	u32 len;
 	u32 offset = 0;
 	struct vio_node *vnode;
 	struct vio_node_mgr *vnode_mgr;
 	struct vio_chain *vchain;
-	struct frame_debug *fdebug;
+	struct vio_subdev *vdev;
+	struct vio_chn_stat st;
 
 	len = snprintf(&buf[offset], size - offset,
 				"-------------------------------------------------------------------\n");
@@ -354,7 +926,6 @@ u32 vio_fps_stats(char* buf, u32 size, u32 flowid_mask)
 				"-------------------------------------------------------------------\n");
 	offset += len;
 
-	cur_timestamps = osal_time_get_ns();
 	for (flow_id = 0; flow_id < VIO_MAX_STREAM; flow_id++) {
 		if ((1 << flow_id & flowid_mask) == 0)
 			continue;
@@ -375,15 +946,10 @@ u32 vio_fps_stats(char* buf, u32 size, u32 flowid_mask)
 							"%-10d%-10s%-10d\n", flow_id, vnode->name, vnode->ctx_id);
 				offset += len;
 				for (k = 0; k < 16; k++) {
-					if (k < MAXIMUM_CHN) {
-						if ((vnode->active_ich & 1 << k) == 0)
-							continue;
-						fdebug = &vnode->ich_subdev[k]->fdebug;
-					} else {
-						if ((vnode->active_och & 1 << (k - MAXIMUM_CHN)) == 0)
-							continue;
-						fdebug = &vnode->och_subdev[k - MAXIMUM_CHN]->fdebug;
-					}
+					vdev = vio_stat_subdev(vnode, k);
+					if (vdev == NULL)
+						continue;
+					vio_fdebug_snapshot(&vdev->fdebug, &st);
 
 					if (size <= offset)
 						break;
@@ -391,19 +957,12 @@ u32 vio_fps_stats(char* buf, u32 size, u32 flowid_mask)
 								"%-10s%-10s%-10s", " ", " ", " ");
 					offset += len;
 
-					dura_timestamps = cur_timestamps - fdebug->init_timestamps;
-					if (dura_timestamps != 0)
-						avg_fps = (u64)fdebug->fcount * 1000000000000UL / dura_timestamps;
-
-					dura_timestamps = fdebug->fps.cur_timestamps - fdebug->fps.last_timestamps;
-					if (dura_timestamps != 0)
-						cur_fps = (u64)1000000000000UL / dura_timestamps;
-
 					if (size <= offset)
 						break;
 					len = snprintf(&buf[offset], size - offset,
-								"%-5d%10d%6d.%03d%6d.%03d\n", k, fdebug->fcount,
-								avg_fps / 1000, avg_fps % 1000, cur_fps / 1000, cur_fps % 1000);
+								"%-5d%10d%6d.%03d%6d.%03d\n", k, st.fcount,
+								st.avg_fps / 1000, st.avg_fps % 1000,
+								st.cur_fps / 1000, st.cur_fps % 1000);
 					offset += len;
 				}
 
@@ -418,6 +977,37 @@ u32 vio_fps_stats(char* buf, u32 size, u32 flowid_mask)
 	return offset;
 }
 
+static u32 vio_lat_stats(struct vio_chain *vchain, char *buf, u32 size)
+{
+	u32 i, j;
+	u32 len;
+	u32 offset = 0;
+	struct vio_lat_stage lstage;
+	static const char *stage_name[VIO_LAT_STAGE_NUM] = {"trig->fs", "fs->fe", "fe->qbuf", "qbuf->dqbuf"};
+
+	if (vchain->lat == NULL)
+		return 0;
+
+	for (i = 0; i < MODULE_NUM; i++) {
+		for (j = 0; j < VIO_LAT_STAGE_NUM; j++) {
+			vio_lat_sum(vchain, i, j, &lstage);
+			if (lstage.count == 0u)
+				continue;
+			if (size <= offset)
+				return offset;
+			len = snprintf(&buf[offset], size - offset,
+					"%-10d%-10s%-12s cnt %llu avg_us %llu p50_us %u p99_us %u p999_us %u max_us %u\n",
+					vchain->id, vio_dbg_module_name[i], stage_name[j], lstage.count,
+					div64_u64(lstage.sum_us, lstage.count),
+					vio_lat_percentile(&lstage, 500u), vio_lat_percentile(&lstage, 990u),
+					vio_lat_percentile(&lstage, 999u), lstage.max_us);
+			offset += len;
+		}
+	}
+
+	return offset;
+}
+
 u32 vio_delay_stats(char* buf, u32 size, u32 flowid_mask)
 {
 	u32 i, j, k;
@@ -497,6 +1087,9 @@ u32 vio_delay_stats(char* buf, u32 size, u32 flowid_mask)
 				offset += len;
 			}
 		}
+
+		if (size > offset)
+			offset += vio_lat_stats(vchain, &buf[offset], size - offset);
 	}
 
 	return offset;
@@ -515,6 +1108,9 @@ u32 vio_drop_stats(char* buf, u32 size, u32 flowid_mask)
 	struct vio_node_mgr *vnode_mgr;
 	struct vio_chain *vchain;
 	struct frame_debug *fdebug;
+	struct frame_drop_stats drop[DROP_TYPE_NUM];
+	u64 init_timestamps;
+	u32 seq;
 
 	len = snprintf(&buf[offset], size - offset,
 				"------------------------------------------------------------------------------\n");
@@ -534,6 +1130,15 @@ u32 vio_drop_stats(char* buf, u32 size, u32 flowid_mask)
 		if (vchain == NULL)
 			continue;
 
+		if (size <= offset)
+			break;
+		len = snprintf(&buf[offset], size - offset,
+					"%-10d%-10s window %d set %llu hit %llu overflow %llu meta_overflow %d\n",
+					flow_id, "drop_win", vchain->drop_mgr.window, vchain->drop_mgr.set_cnt,
+					vchain->drop_mgr.hit_cnt, vchain->drop_mgr.overflow_cnt,
+					osal_atomic_read(&vchain->meta_mgr.overflow_cnt));
+		offset += len;
+
 		for (i = 0; i < MODULE_NUM; i++) {
 			vnode_mgr = &vchain->vnode_mgr[i];
 			for (j = 0; j < MAX_VNODE_NUM; j++) {
@@ -550,6 +1155,11 @@ u32 vio_drop_stats(char* buf, u32 size, u32 flowid_mask)
 					if ((vnode->active_och & 1 << chn) == 0)
 						continue;
 					fdebug = &vnode->och_subdev[chn]->fdebug;
+					do {
+						seq = read_seqbegin(&fdebug->lock);
+						(void)memcpy(drop, fdebug->drop_stats, sizeof(drop));
+						init_timestamps = fdebug->init_timestamps;
+					} while (read_seqretry(&fdebug->lock, seq) != 0);
 
 					for (k = 0; k < DROP_TYPE_NUM; k++) {
 						if (size <= offset)
@@ -558,11 +1168,11 @@ u32 vio_drop_stats(char* buf, u32 size, u32 flowid_mask)
 									"%-10s%-10s%-10s", " ", " ", " ");
 						offset += len;
 
-						dura_timestamps = cur_timestamps - fdebug->init_timestamps;
+						dura_timestamps = cur_timestamps - init_timestamps;
 						if (dura_timestamps != 0)
-							avg_fps = (u64)fdebug->drop_stats[k].drop_count * 1000000000000UL / dura_timestamps;
+							avg_fps = (u64)drop[k].drop_count * 1000000000000UL / dura_timestamps;
 
-						dura_timestamps = fdebug->drop_stats[k].cur_timestamps - fdebug->drop_stats[k].last_timestamps;
+						dura_timestamps = drop[k].cur_timestamps - drop[k].last_timestamps;
 						if (dura_timestamps != 0)
 							cur_fps = (u64)1000000000000UL / dura_timestamps;
 
@@ -570,7 +1180,7 @@ u32 vio_drop_stats(char* buf, u32 size, u32 flowid_mask)
 							break;
 						len = snprintf(&buf[offset], size - offset,
 									"%-5d%-10s%10d%6d.%03d%6d.%03d\n", k, drop_name[k],
-									fdebug->drop_stats[k].drop_count, avg_fps / 1000, avg_fps % 1000,
+									drop[k].drop_count, avg_fps / 1000, avg_fps % 1000,
 									cur_fps / 1000, cur_fps % 1000);
 						offset += len;
 						cur_fps = 0;
@@ -677,6 +1287,55 @@ u32 vio_fmgr_stats(char* buf, u32 size, u32 head_index, u32 flowid_mask)
 	return offset;
 }
 
+u32 vio_cache_stats(char* buf, u32 size, u32 flowid_mask)
+{
+	u32 i, j;
+	u32 flow_id;
+	u32 len;
+	u32 offset = 0;
+	struct vio_node *vnode;
+	struct vio_node_mgr *vnode_mgr;
+	struct vio_chain *vchain;
+
+	len = snprintf(&buf[offset], size - offset,
+				"------------------------------------------------------------------------------\n");
+	offset += len;
+	len = snprintf(&buf[offset], size - offset,
+				"%-10s%-10s%-10s%20s%20s\n",
+				"flowid", "module", "ctx_id", "flush_bytes", "skip_bytes");
+	offset += len;
+	len = snprintf(&buf[offset], size - offset,
+				"------------------------------------------------------------------------------\n");
+	offset += len;
+
+	for (flow_id = 0; flow_id < VIO_MAX_STREAM; flow_id++) {
+		if ((1 << flow_id & flowid_mask) == 0)
+			continue;
+		vchain = vio_get_chain(flow_id);
+		if (vchain == NULL)
+			continue;
+
+		for (i = 0; i < MODULE_NUM; i++) {
+			vnode_mgr = &vchain->vnode_mgr[i];
+			for (j = 0; j < MAX_VNODE_NUM; j++) {
+				vnode = vnode_mgr->vnode[j];
+				if (vnode == NULL || osal_test_bit(VIO_NODE_START, &vnode->state) == 0)
+					continue;
+
+				if (size <= offset)
+					break;
+				len = snprintf(&buf[offset], size - offset,
+							"%-10d%-10s%-10d%20lld%20lld\n", flow_id, vnode->name, vnode->ctx_id,
+							atomic64_read(&vnode->cache_flush_bytes),
+							atomic64_read(&vnode->cache_skip_bytes));
+				offset += len;
+			}
+		}
+	}
+
+	return offset;
+}
+
 static s32 vpf_dbg_query_active_ctx(struct vio_video_ctx *vctx, unsigned long arg)
 {
 	u32 i, dump_bitmap = 0;
@@ -755,7 +1414,7 @@ static s32 vpf_dbg_vctx_bind_vdev(struct vio_video_ctx *vctx, unsigned long arg)
 	return ret;
 }
 
-static u32 vpf_gtask_dbg_info(struct vio_chain *vchain, s8 *buf)
+static u32 vpf_gtask_dbg_info(struct vio_chain *vchain, s8 *buf, u32 size)
 {
 	s32 i, j;
 	u32 offset = 0;
@@ -773,23 +1432,34 @@ static u32 vpf_gtask_dbg_info(struct vio_chain *vchain, s8 *buf)
 
             if (vnode->leader == 1) {
 				gtask = vnode->gtask;
-				len = snprintf(&buf[offset], DEBUG_SIZE, "gtask-%s: res %d rcnt %d ",
-					gtask->name, gtask->hw_resource_en, gtask->rcount);
+				if (size <= offset)
+					break;
+				len = snprintf(&buf[offset], size - offset, "gtask-%s: res %d rcnt %d mode %d ",
+					gtask->name, gtask->hw_resource_en, gtask->rcount, gtask->sched_mode);
+				offset += len;
+				if (size <= offset)
+					break;
+				len = snprintf(&buf[offset], size - offset, "prio %d sched %llu miss %llu ",
+					vnode->sched_prio, vnode->sstats.sched_count, vnode->sstats.miss_count);
 				offset += len;
 				tmp_vnode = vnode;
 				do {
-					len = snprintf(&buf[offset], DEBUG_SIZE, "[%s:%d]",
+					if (size <= offset)
+						break;
+					len = snprintf(&buf[offset], size - offset, "[%s:%d]",
 						tmp_vnode->name, tmp_vnode->frame_done_flag);
 					offset += len;
 					tmp_vnode = tmp_vnode->next;
 				} while (tmp_vnode != NULL && tmp_vnode->leader == 0);
 			}
-			len = snprintf(&buf[offset], DEBUG_SIZE, "\n");
+			if (size <= offset)
+				break;
+			len = snprintf(&buf[offset], size - offset, "\n");
 			offset += len;
 		}
     }
 
-	return offset;
+	return (offset > size) ? size : offset;
 }
 static s32 vpf_dbg_get_fmgr_stats(struct vio_video_ctx *vctx, unsigned long arg)
 {
@@ -804,13 +1474,17 @@ static s32 vpf_dbg_get_fmgr_stats(struct vio_video_ctx *vctx, unsigned long arg)
 	if (vchain != NULL) {
 		len = snprintf(&buf[offset], DEBUG_SIZE, "%s", vchain->path);
 		offset += len;
-		len = vpf_gtask_dbg_info(vchain, &buf[offset]);
-		offset += len;
+		if (offset < DEBUG_SIZE) {
+			len = vpf_gtask_dbg_info(vchain, &buf[offset], DEBUG_SIZE - offset);
+			offset += len;
+		}
 	}
 
 	flowid_mask = 1 << vctx->flow_id;
-	len = vio_fmgr_stats(&buf[offset], DEBUG_SIZE - offset, 0, flowid_mask);
-	offset += len;
+	if (offset < DEBUG_SIZE) {
+		len = vio_fmgr_stats(&buf[offset], DEBUG_SIZE - offset, 0, flowid_mask);
+		offset += len;
+	}
 	if (offset > DEBUG_SIZE)
 		offset = DEBUG_SIZE;
 
@@ -849,6 +1523,28 @@ static s32 vpf_dbg_check_dma_output(struct vio_video_ctx *vctx, unsigned long ar
 	return ret;
 }
 
+static s32 vpf_dbg_get_sched_stats(struct vio_video_ctx *vctx, unsigned long arg)
+{
+	s64 copy_ret = 0;
+	struct vio_subdev *vdev;
+	struct vio_sched_stats sstats;
+
+	vdev = vctx->vdev;
+	if (vdev == NULL || vdev->vnode == NULL || vdev->vnode->gtask == NULL) {
+		vio_err("[%s][C%d] %s: no gtask bound\n", vctx->name, vctx->ctx_id, __func__);
+		return -EFAULT;
+	}
+
+	vio_group_get_sched_stats(vdev->vnode, &sstats);
+	copy_ret = osal_copy_to_app((void __user *)arg, (void *)&sstats, sizeof(struct vio_sched_stats));
+	if (copy_ret != 0u) {
+		vio_err("%s: failed to copy to user, ret = %lld\n", __func__, copy_ret);
+		return -EFAULT;
+	}
+
+	return 0;
+}
+
 s32 vio_debug_ctrl(struct vio_video_ctx *vctx, u32 cmd, unsigned long arg)
 {
 	s32 ret = 0;
@@ -866,6 +1562,9 @@ s32 vio_debug_ctrl(struct vio_video_ctx *vctx, u32 cmd, unsigned long arg)
 		case VIO_DBG_CHK_DMA_OUT:
 			ret = vpf_dbg_check_dma_output(vctx, arg);
 			break;
+		case VIO_DBG_GET_SCHED_STATS:
+			ret = vpf_dbg_get_sched_stats(vctx, arg);
+			break;
 		default:
 			vio_err("%s: wrong cmd(0x%x)\n", __func__, cmd);
 			ret = -EFAULT;
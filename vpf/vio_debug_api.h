@@ -14,12 +14,15 @@
 #ifndef VIO_DEBUG_API_H
 #define VIO_DEBUG_API_H
 
+#include <linux/seqlock.h>
+
 /* debug sys */
 #define VIO_DBG_GET_FMGR_STATS   0xf500001
 #define VIO_DBG_GET_ACTIVE_CTX   0xf500002
 #define VIO_DBG_SET_CTX_ID   	 0xf500003
 #define VIO_DBG_GET_BUF_NUM		 0xf500004
 #define VIO_DBG_CHK_DMA_OUT   	 0xf500005
+#define VIO_DBG_GET_SCHED_STATS  0xf500006
 
 #define DEBUG_SIZE 1536
 
@@ -53,6 +56,35 @@ struct vio_hw_loading {
 	osal_atomic_t enable_loading;
 };
 
+#define VIO_UTIL_HW_MAX 4u
+#define VIO_UTIL_SLOT_MS 100u
+#define VIO_UTIL_SLOT_NUM 100u /* 100ms slots of the 10s window */
+
+enum vio_util_src {
+	VIO_UTIL_SRC_NONE,
+	VIO_UTIL_SRC_STAT, /* sif/isp/gdc... FS and FE events */
+	VIO_UTIL_SRC_GTASK, /* frame configured to hardware and hardware free, codec src dqbuf and qbuf */
+};
+
+/**
+ * @struct vio_hw_util
+ * @brief Busy time sampler of one hardware instance; busy time is accumulated
+ * into 100ms slots, 100ms/1s/10s utilisation are averages of the last 1/10/100 slots.
+ * FS/FE events are preferred, gtask events are only used by ip without FS event.
+ * @NO{S09E05C01}
+ */
+struct vio_hw_util {
+	osal_spinlock_t slock;
+	u32 src;
+	u32 inflight;
+	u64 busy_mark_ns; /* start of the busy time not added to win_busy_ns yet */
+	u64 win_start_ns;
+	u64 win_busy_ns;
+	u32 slot_idx;
+	u32 slot_cnt;
+	u16 slot_util[VIO_UTIL_SLOT_NUM]; /* xx.xx% */
+};
+
 #define VPF_LOADING_SHOW_MACRO(_name, _private_struct, _member) \
 	static ssize_t _name##_loading_show(struct device *dev, struct device_attribute *attr, char* buf) \
 	{ \
@@ -92,7 +124,7 @@ struct fps_stats {
 	u64 last_time;
 	u32 last_frame_count;
 	u32 cur_frame_count;
-	u32 last_update;
+	/* monotonic arrival of the last two frames, cur_fps is 1 / their interval */
     u64 last_timestamps;
     u64 cur_timestamps;
 };
@@ -102,6 +134,7 @@ struct frame_delay {
     u32 min_delay_ns;
     u32 max_delay_ns;
     u64 avg_delay_ns;
+    u64 total_delay_ns;
     u32 fcount;
 };
 
@@ -112,6 +145,24 @@ struct frame_drop_stats {
     u64 cur_timestamps;
 };
 
+/**
+ * @struct vio_sched_stats
+ * @brief Per-context gtask scheduling statistics, queueing latency is the
+ * time from vio_group_start_trigger to the frame being configured to hardware.
+ * @NO{S09E05C01}
+ */
+struct vio_sched_stats {
+	u32 sched_mode;
+	u32 priority;
+	u32 fps;
+	u32 reserved;
+	u64 sched_count;
+	u64 miss_count; /* frames configured after their deadline */
+	u64 total_wait_ns;
+	u64 max_wait_ns;
+	u64 last_wait_ns;
+};
+
 struct id_set {
     u32 flow_id;
     u32 module_id;
@@ -120,7 +171,16 @@ struct id_set {
     u32 chn_id;
 };
 
+/*
+ * lock: writers in irq/ioctl context take it with irq saved, sysfs and ioctl
+ * readers only retry on the sequence, see vio_fdebug_snapshot. A seqlock rather
+ * than per-cpu counters: the writers of one channel are its frame done irq and
+ * its drop path, serialized by the hw and taking the lock uncontended, and
+ * last/min/max, timestamps and the fps window can not be summed from per-cpu
+ * slices, so readers would need a lock to merge them consistently anyway
+ */
 struct frame_debug {
+    seqlock_t lock;
     u32 frame_id;
     u32 fcount;
     u64 init_timestamps;
@@ -144,6 +204,10 @@ struct module_stat {
 	struct statinfo sinfo[STAT_NUM];
 };
 
+struct vio_lat_info;
+struct vio_chn_stat;
+struct vio_stats_bulk;
+
 void vio_fps_calculate(struct frame_debug *fdebug, struct frame_id_desc *frameid);
 void vio_set_stat_info(u32 flow_id, u32 module, enum vio_stat_type stype, u32 frameid);
 void vio_drop_calculate(struct frame_debug *fdebug, enum vio_drop_type drop_type,
@@ -153,5 +217,14 @@ u32 vio_fmgr_stats(char* buf, u32 size, u32 head_index, u32 flowid_mask);
 u32 vio_fps_stats(char* buf, u32 size, u32 flowid_mask);
 u32 vio_drop_stats(char* buf, u32 size, u32 flowid_mask);
 u32 vio_delay_stats(char* buf, u32 size, u32 flowid_mask);
+u32 vio_cache_stats(char* buf, u32 size, u32 flowid_mask);
+void vio_lat_record(u32 flow_id, u32 module, u32 stage, u64 delta_us);
+void vio_fdebug_init(struct frame_debug *fdebug);
+void vio_fdebug_snapshot(struct frame_debug *fdebug, struct vio_chn_stat *st);
+s32 vio_stats_bulk(struct vio_stats_bulk *bulk);
+void vio_hw_util_init(void);
+void vio_hw_util_event(u32 module, u32 hw_id, enum vio_util_src src, u32 busy);
+u32 vio_hw_util_stats(char* buf, u32 size);
+s32 vio_lat_get_info(struct vio_lat_info *info);
 void vio_loading_calculate(struct vio_hw_loading* loading, enum vio_stat_type stype);
 #endif//VIO_DEBUG_API_H
\ No newline at end of file
@@ -270,14 +270,13 @@ static DEVICE_ATTR(vio_delay, 0660, vio_delay_show, vio_delay_store);/*PRQA S 45
 static ssize_t vio_drop_info_show(struct device *dev,
 				struct device_attribute *attr, char* buf)
 {
-	u32 i, j, index;
+	u32 i;
 	ssize_t len;
 	ssize_t offset = 0;
 	struct vpf_device *vpf_device;
 	struct hobot_vpf_dev *vpf_dev;
 	struct vio_core *iscore;
 	struct vio_chain *vchain;
-	struct vio_drop_mgr *drop_mgr;
 
 	vpf_device = (struct vpf_device *)dev_get_drvdata(dev);
 	vpf_dev = (struct hobot_vpf_dev *)vpf_device->ip_dev;
@@ -290,14 +289,8 @@ static ssize_t vio_drop_info_show(struct device *dev,
 					"pipe%2d: ", i);
 		offset += len;
 
-		drop_mgr = &vchain->drop_mgr;
-		index = drop_mgr->head_index;
-		for (j = 0; j < DROP_INFO_NUM; j++) {
-			len = snprintf(&buf[offset], PAGE_SIZE - (size_t)offset,
-						"[F%08d] ", drop_mgr->drop_frameid[index]);
-			offset += len;
-			index = (index + DROP_INFO_NUM - 1) % DROP_INFO_NUM;
-		}
+		len = vio_drop_info_dump(vchain, &buf[offset], PAGE_SIZE - (u32)offset);
+		offset += len;
 		len = snprintf(&buf[offset], PAGE_SIZE - (size_t)offset, "\n");
 		offset += len;
 	}
@@ -329,12 +322,95 @@ static ssize_t vio_drop_info_store(struct device *dev,
 	u32 flow_id;
 
 	flow_id = (u32)simple_strtoul(buf, NULL, 0);
-	vio_set_drop_info(flow_id, 0xffffffff);
+	vio_set_drop_info(flow_id, DROP_FRAMEID_CUR);
 
 	return (ssize_t)len;
 }
 static DEVICE_ATTR(drop_info, 0660, vio_drop_info_show, vio_drop_info_store);/*PRQA S 4501,0636*/
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Debug interface that show drop window size and counters of every pipeline;
+ * @param[in] *dev: point to struct device instance;
+ * @param[in] *attr: point to struct device_attribute instance;
+ * @retval "= 0": failure
+ * @retval "> 0": success
+ * @param[out] *buf: store information string;
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static ssize_t vio_drop_window_show(struct device *dev,
+				struct device_attribute *attr, char* buf)
+{
+	u32 i;
+	ssize_t len;
+	ssize_t offset = 0;
+	struct vpf_device *vpf_device;
+	struct hobot_vpf_dev *vpf_dev;
+	struct vio_chain *vchain;
+	struct vio_drop_mgr *drop_mgr;
+
+	vpf_device = (struct vpf_device *)dev_get_drvdata(dev);
+	vpf_dev = (struct hobot_vpf_dev *)vpf_device->ip_dev;
+	for (i = 0; i < VIO_MAX_STREAM; i++) {
+		vchain = &vpf_dev->iscore.vchain[i];
+		drop_mgr = &vchain->drop_mgr;
+		if (drop_mgr->valid_map == NULL)
+			continue;
+		len = snprintf(&buf[offset], PAGE_SIZE - (size_t)offset,
+					"pipe%2d: window %d set %llu hit %llu overflow %llu reset %llu\n", i,
+					drop_mgr->window, drop_mgr->set_cnt, drop_mgr->hit_cnt,
+					drop_mgr->overflow_cnt, drop_mgr->reset_cnt);
+		offset += len;
+	}
+
+	return offset;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Debug interface that resize drop window, format "flow_id window";
+ * @param[in] *dev: point to struct device instance;
+ * @param[in] *attr: point to struct device_attribute instance;
+ * @param[in] buf: store information string;
+ * @param[in] buf: information string length;
+ * @retval "> 0": success
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static ssize_t vio_drop_window_store(struct device *dev,
+					struct device_attribute *attr,
+					const char *buf, size_t len)
+{
+	s32 ret;
+	u32 flow_id, window;
+	struct vpf_device *vpf_device;
+	struct hobot_vpf_dev *vpf_dev;
+
+	if (sscanf(buf, "%u %u", &flow_id, &window) != 2 || flow_id >= VIO_MAX_STREAM)
+		return -EINVAL;
+
+	vpf_device = (struct vpf_device *)dev_get_drvdata(dev);
+	vpf_dev = (struct hobot_vpf_dev *)vpf_device->ip_dev;
+	ret = vio_chain_set_drop_window(&vpf_dev->iscore.vchain[flow_id], window);
+	if (ret < 0)
+		return ret;
+
+	return (ssize_t)len;
+}
+static DEVICE_ATTR(drop_window, 0660, vio_drop_window_show, vio_drop_window_store);/*PRQA S 4501,0636*/
+
 /**
  * @NO{S09E05C01}
  * @ASIL{B}
@@ -397,6 +473,37 @@ static ssize_t vio_fmgr_stats_show(struct device *dev, struct device_attribute *
 }
 static DEVICE_ATTR(fmgr_stats, 0440, vio_fmgr_stats_show, NULL);/*PRQA S 4501,0636*/
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Debug interface that show flushed and elided cache maintenance bytes of every ip;
+ * @param[in] *dev: point to struct device instance;
+ * @param[in] *attr: point to struct device_attribute instance;
+ * @retval "= 0": failure
+ * @retval "> 0": success
+ * @param[out] *buf: store information string;
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static ssize_t vio_cache_stats_show(struct device *dev, struct device_attribute *attr, char* buf)
+{
+	ssize_t offset = 0;
+	struct vpf_device *vpf_device;
+	struct hobot_vpf_dev *vpf_dev;
+
+	vpf_device = (struct vpf_device *)dev_get_drvdata(dev);
+	vpf_dev = (struct hobot_vpf_dev *)vpf_device->ip_dev;
+
+	offset = vio_cache_stats(buf, PAGE_SIZE, vpf_dev->flowid_mask);
+
+	return offset;
+}
+static DEVICE_ATTR(cache_stats, 0440, vio_cache_stats_show, NULL);/*PRQA S 4501,0636*/
+
 /**
  * @NO{S09E05C01}
  * @ASIL{B}
@@ -427,6 +534,28 @@ static ssize_t vpf_delay_stats_show(struct device *dev, struct device_attribute
 }
 static DEVICE_ATTR(delay_stats, 0440, vpf_delay_stats_show, NULL);/*PRQA S 4501,0636*/
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Debug interface that show 100ms/1s/10s utilisation of every hardware instance;
+ * @param[in] *dev: point to struct device instance;
+ * @param[in] *attr: point to struct device_attribute instance;
+ * @retval "= 0": failure
+ * @retval "> 0": success
+ * @param[out] *buf: store information string;
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+static ssize_t vio_hw_util_show(struct device *dev, struct device_attribute *attr, char* buf)
+{
+	return vio_hw_util_stats(buf, PAGE_SIZE);
+}
+static DEVICE_ATTR(hw_util, 0440, vio_hw_util_show, NULL);/*PRQA S 4501,0636*/
+
 static ssize_t vio_path_stat_show(struct device *dev, struct device_attribute *attr, char* buf)
 {
 	u32 i;
@@ -465,10 +594,13 @@ static DEVICE_ATTR(path_stat, 0440, vio_path_stat_show, NULL);/*PRQA S 4501,0636
 static struct attribute *debug_attributes[] = {
 	&dev_attr_fps.attr,
 	&dev_attr_drop_info.attr,
+	&dev_attr_drop_window.attr,
 	&dev_attr_fps_stats.attr,
 	&dev_attr_drop_stats.attr,
 	&dev_attr_delay_stats.attr,
 	&dev_attr_fmgr_stats.attr,
+	&dev_attr_cache_stats.attr,
+	&dev_attr_hw_util.attr,
 	&dev_attr_vio_delay.attr,
 	&dev_attr_path_stat.attr,
 	NULL,
@@ -530,6 +662,31 @@ static const struct file_operations fmgr_stats_fops = {
 	.release = single_release,
 };
 
+static int32_t vpf_buf_pool_show(struct seq_file *s, void *unused) /* PRQA S 3206 */
+{
+	struct vio_buf_pool_stats stats;
+
+	vio_buf_pool_get_stats(&stats);
+	seq_printf(s, "limit %dMB entries %u resident %zu bytes\n",
+		vio_buf_pool_size, stats.entries, stats.resident);
+	seq_printf(s, "hit %llu miss %llu evict %llu\n",
+		stats.hit, stats.miss, stats.evict);
+
+	return 0;
+}
+
+static int32_t vpf_buf_pool_open(struct inode *inode, struct file *file) /* PRQA S 3673 */
+{
+	return single_open(file, vpf_buf_pool_show, inode->i_private);
+}
+
+static const struct file_operations buf_pool_fops = {
+	.open = vpf_buf_pool_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 s32 vpf_create_debug_file(struct hobot_vpf_dev *vpf_dev)
 {
 	s32 ret = 0;
@@ -548,11 +705,20 @@ s32 vpf_create_debug_file(struct hobot_vpf_dev *vpf_dev)
 		return PTR_ERR(vpf_dev->debug_file_fmgr_stats);
 	}
 
+	vpf_dev->debug_file_buf_pool = debugfs_create_file("buf_pool", 0444, /* PRQA S 0339,3120 */
+						vpf_dev->debug_root,
+						(void *)vpf_dev, &buf_pool_fops);
+	if (IS_ERR(vpf_dev->debug_file_buf_pool)) {
+		debugfs_remove_recursive(vpf_dev->debug_root);
+		return PTR_ERR(vpf_dev->debug_file_buf_pool);
+	}
+
 	return ret;
 }
 
 void vpf_destroy_debug_file(struct hobot_vpf_dev *vpf_dev)
 {
 	debugfs_remove_recursive(vpf_dev->debug_file_fmgr_stats);
+	debugfs_remove_recursive(vpf_dev->debug_file_buf_pool);
 	debugfs_remove_recursive(vpf_dev->debug_root);
 }
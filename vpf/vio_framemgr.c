@@ -11,6 +11,8 @@
  *                     All rights reserved.
  ***************************************************************************/
 #define pr_fmt(fmt)    "[VIO fmgr]:" fmt
+#include <linux/bitmap.h>
+#include <linux/log2.h>
 #include "vio_framemgr.h"
 #include "vio_node_api.h"
 /**
@@ -56,6 +58,7 @@ static s32 put_frame(struct vio_framemgr *this, struct vio_frame *frame,
 	frame->state = state;
 	osal_list_add_tail(&frame->list, &this->queued_list[state]);
 	this->queued_count[state]++;
+	__set_bit(frame->index, this->state_map[state]);
 
 	return 0;
 }
@@ -89,6 +92,7 @@ struct vio_frame *get_frame(struct vio_framemgr *this, enum vio_frame_state stat
 	frame = osal_list_first_entry(&this->queued_list[state], struct vio_frame, list);/*PRQA S 2810,0497*/
 	osal_list_del(&frame->list);
 	this->queued_count[state]--;
+	__clear_bit(frame->index, this->state_map[state]);
 	frame->state = FS_INVALID;
 
 	return frame;
@@ -127,13 +131,25 @@ s32 trans_frame(struct vio_framemgr *this, struct vio_frame *frame,
 	if ((frame->state == FS_INVALID) || (state == FS_INVALID))
 		return -EINVAL;
 
+	if (frame->ring_owned != 0u) {
+		frame->ring_owned = 0;
+		return put_frame(this, frame, state);
+	}
+
 	if (this->queued_count[frame->state] == 0u) {
 		vio_err("%s: frame queue is empty (0x%08x)", frame_state_name[frame->state], this->id);
 		return -EINVAL;
 	}
 
+	if (test_bit(frame->index, this->state_map[frame->state]) == 0) {
+		vio_err("%s: F%d is not queued (0x%08x)", frame_state_name[frame->state],
+			frame->index, this->id);
+		return -EINVAL;
+	}
+
 	osal_list_del(&frame->list);
 	this->queued_count[frame->state]--;
+	__clear_bit(frame->index, this->state_map[frame->state]);
 
 	return put_frame(this, frame, state);
 }
@@ -155,7 +171,7 @@ EXPORT_SYMBOL(trans_frame);/*PRQA S 0605,0307*/
  * @callergraph
  * @design
  */
-struct vio_frame *peek_frame(const struct vio_framemgr *this,
+struct vio_frame *peek_frame(struct vio_framemgr *this,
 			enum vio_frame_state state)
 {
 	if (this == NULL) {
@@ -166,6 +182,9 @@ struct vio_frame *peek_frame(const struct vio_framemgr *this,
 	if (state == FS_INVALID)
 		return NULL;
 
+	if (state == FS_REQUEST)
+		frame_ring_drain(this);
+
 	if (this->queued_count[state] == 0u)
 		return NULL;
 
@@ -207,48 +226,48 @@ struct vio_frame *peek_frame_tail(const struct vio_framemgr *this,
 }
 EXPORT_SYMBOL(peek_frame_tail);/*PRQA S 0605,0307*/
 
-/**
- * @NO{S09E05C01}
- * @ASIL{B}
- * @brief: Find frame with frame count form state queue;
- * @param[in] *this: point to struct vio_framemgr instance;
- * @param[in] state: frame state;
- * @param[in] fcount: frame count;
- * @retval "!NULL": success
- * @retval "NULL": failure
- * @param[out] None
- * @data_read None
- * @data_updated None
- * @compatibility None
- * @callgraph
- * @callergraph
- * @design
- */
-struct vio_frame *find_frame(const struct vio_framemgr *this,
-			     enum vio_frame_state state, u32 fcount)
+static void frame_manager_free_index(struct vio_framemgr *this)
 {
-	struct vio_frame *frame;
+	u32 i;
 
-	if (this == NULL) {
-		vio_err("%s: framemgr is NULL", __func__);
-		return NULL;
-	}
+	if (this->state_map[0] != NULL)
+		osal_kfree((void *)this->state_map[0]);
+	for (i = 0; i < (u32)NR_FRAME_STATE; i++)
+		this->state_map[i] = NULL;
 
-	if (state == FS_INVALID)
-		return NULL;
+	this->ring_mode = 0;
+	if (this->req_ring.slot != NULL)
+		osal_kfree((void *)this->req_ring.slot);
+	(void)memset(&this->req_ring, 0, sizeof(this->req_ring));
+	(void)memset(&this->done_ring, 0, sizeof(this->done_ring));
+}
 
-	if (this->queued_count[state] == 0u) {
-		vio_err("%s: frame queue is empty (0x%08x)",
-			frame_state_name[state], this->id);
-		return NULL;
-	}
+static s32 frame_manager_alloc_index(struct vio_framemgr *this, u32 buffers)
+{
+	u32 i;
+	u32 longs;
+	u32 slots;
+	unsigned long *map;
 
-	osal_list_for_each_entry(frame, &this->queued_list[state], list) {/*PRQA S 2810,0497*/
-		if (frame->fcount == fcount)
-			return frame;
+	longs = BITS_TO_LONGS(buffers);
+	map = (unsigned long *)osal_kzalloc(sizeof(unsigned long) * longs * NR_FRAME_STATE, GFP_ATOMIC);
+	if (map == NULL)
+		return -ENOMEM;
+	for (i = 0; i < (u32)NR_FRAME_STATE; i++)
+		this->state_map[i] = &map[i * longs];
+
+	/* every frame sits at most once in each ring, so it never gets full */
+	slots = roundup_pow_of_two(buffers);
+	this->req_ring.slot = (u16 *)osal_kzalloc(sizeof(u16) * slots * 2u, GFP_ATOMIC);
+	if (this->req_ring.slot == NULL) {
+		frame_manager_free_index(this);
+		return -ENOMEM;
 	}
+	this->done_ring.slot = &this->req_ring.slot[slots];
+	this->req_ring.mask = slots - 1u;
+	this->done_ring.mask = slots - 1u;
 
-	return NULL;
+	return 0;
 }
 
 /**
@@ -281,6 +300,7 @@ s32 frame_manager_open(struct vio_framemgr *this, u32 buffers)
 	 */
 	if (this->frames != NULL)
 		osal_kfree((void *)this->frames);
+	frame_manager_free_index(this);
 
 	this->frames = (struct vio_frame *)osal_kzalloc(sizeof(struct vio_frame) * buffers, GFP_ATOMIC);
 	if (this->frames == NULL) {
@@ -288,6 +308,14 @@ s32 frame_manager_open(struct vio_framemgr *this, u32 buffers)
 		return -ENOMEM;
 	}
 
+	ret = frame_manager_alloc_index(this, buffers);
+	if (ret < 0) {
+		vio_err("%s: failed to allocate frame index", __func__);
+		osal_kfree((void *)this->frames);
+		this->frames = NULL;
+		return ret;
+	}
+
 	vio_e_barrier_irqs(this, flags);/*PRQA S 2996*/
 	this->num_frames = buffers;
 	for (i = 0; i < (u32)NR_FRAME_STATE; i++) {
@@ -341,6 +369,7 @@ void frame_manager_close(struct vio_framemgr *this)
 		osal_kfree((void *)this->frames);
 		this->frames = NULL;
 	}
+	frame_manager_free_index(this);
 }
 EXPORT_SYMBOL(frame_manager_close);/*PRQA S 0605,0307*/
 /**
@@ -371,6 +400,19 @@ s32 frame_manager_flush(struct vio_framemgr *this)
 	}
 
 	vio_e_barrier_irqs(this, flags);/*PRQA S 2996*/
+	if (this->ring_mode != 0u) {
+		frame_ring_drain(this);
+		while (frame_ring_dqbuf(this) != NULL)
+			continue;
+		for (i = 0; i < this->num_frames; i++) {
+			frame = &this->frames[i];
+			frame->ring_pending = 0;
+			if (frame->ring_owned != 0u) {
+				frame->dispatch_cnt = 0;
+				ret = trans_frame(this, frame, FS_FREE);
+			}
+		}
+	}
 	for (i = (u32)FS_REQUEST; i < (u32)FS_INVALID; i++) {
 		osal_list_for_each_entry_safe(frame, temp, &this->queued_list[i], list) {/*PRQA S 2810,2741,0497*/
 			frame->dispatch_cnt = 0;
@@ -416,6 +458,240 @@ void framemgr_print_queues(const struct vio_framemgr *framemgr)
 }
 EXPORT_SYMBOL(framemgr_print_queues);/*PRQA S 0605,0307*/
 
+static s32 frame_ring_push(struct vio_frame_ring *ring, u32 index)
+{
+	u32 head;
+
+	head = ring->head;
+	if (head - smp_load_acquire(&ring->tail) > ring->mask)
+		return -ENOSPC;
+
+	ring->slot[head & ring->mask] = (u16)index;
+	smp_store_release(&ring->head, head + 1u);
+
+	return 0;
+}
+
+static s32 frame_ring_pop(struct vio_frame_ring *ring, u32 *index)
+{
+	u32 tail;
+
+	tail = ring->tail;
+	if (smp_load_acquire(&ring->head) == tail)
+		return -ENOENT;
+
+	*index = ring->slot[tail & ring->mask];
+	smp_store_release(&ring->tail, tail + 1u);
+
+	return 0;
+}
+
+u32 frame_ring_count(const struct vio_frame_ring *ring)
+{
+	return READ_ONCE(ring->head) - READ_ONCE(ring->tail);
+}
+EXPORT_SYMBOL(frame_ring_count);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Switch REQUEST and COMPLETE handoff of framemgr to lock-free rings,
+ * only valid with one user thread as producer of QBUF and consumer of DQBUF;
+ * @param[in] *this: point to struct vio_framemgr instance;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 frame_ring_enable(struct vio_framemgr *this)
+{
+	u64 flags = 0;
+
+	if (this == NULL || this->frames == NULL || this->req_ring.slot == NULL)
+		return -EINVAL;
+
+	vio_e_barrier_irqs(this, flags);/*PRQA S 2996*/
+	this->req_ring.head = 0;
+	this->req_ring.tail = 0;
+	this->done_ring.head = 0;
+	this->done_ring.tail = 0;
+	this->ring_mode = 1;
+	vio_x_barrier_irqr(this, flags);/*PRQA S 2996*/
+
+	return 0;
+}
+EXPORT_SYMBOL(frame_ring_enable);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Switch framemgr back to locked queues, call after frame_manager_flush;
+ * @param[in] *this: point to struct vio_framemgr instance;
+ * @retval None
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void frame_ring_disable(struct vio_framemgr *this)
+{
+	u64 flags = 0;
+
+	if (this == NULL)
+		return;
+
+	vio_e_barrier_irqs(this, flags);/*PRQA S 2996*/
+	this->ring_mode = 0;
+	vio_x_barrier_irqr(this, flags);/*PRQA S 2996*/
+}
+EXPORT_SYMBOL(frame_ring_disable);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Producer side of REQUEST ring, hand a FREE/USED frame over without slock;
+ * @param[in] *this: point to struct vio_framemgr instance;
+ * @param[in] *frame: point to struct vio_frame instance;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 frame_ring_qbuf(struct vio_framemgr *this, struct vio_frame *frame)
+{
+	s32 ret;
+
+	if (READ_ONCE(frame->ring_pending) != 0u)
+		return -EBUSY;
+
+	WRITE_ONCE(frame->ring_pending, 1);
+	ret = frame_ring_push(&this->req_ring, frame->index);
+	if (ret < 0) {
+		WRITE_ONCE(frame->ring_pending, 0);
+		vio_err("[%s][F%d] %s: request ring is full\n", (char *)this->name, frame->index, __func__);
+	}
+
+	return ret;
+}
+EXPORT_SYMBOL(frame_ring_qbuf);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Consumer side of REQUEST ring, move handed over frames into REQUEST queue,
+ * caller holds slock;
+ * @param[in] *this: point to struct vio_framemgr instance;
+ * @retval None
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void frame_ring_drain(struct vio_framemgr *this)
+{
+	u32 index;
+	struct vio_frame *frame;
+
+	if (this->ring_mode == 0u)
+		return;
+
+	while (frame_ring_pop(&this->req_ring, &index) == 0) {
+		frame = &this->frames[index];
+		if (trans_frame(this, frame, FS_REQUEST) < 0)
+			vio_err("[%s][F%d] %s: invalid frame state(%d)\n",
+				(char *)this->name, index, __func__, frame->state);
+		WRITE_ONCE(frame->ring_pending, 0);
+	}
+}
+EXPORT_SYMBOL(frame_ring_drain);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Producer side of COMPLETE ring, unlink a PROCESS frame and hand it over,
+ * caller holds slock;
+ * @param[in] *this: point to struct vio_framemgr instance;
+ * @param[in] *frame: point to struct vio_frame instance;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 frame_ring_complete(struct vio_framemgr *this, struct vio_frame *frame)
+{
+	if (frame->ring_owned != 0u || frame->state == FS_INVALID ||
+	    test_bit(frame->index, this->state_map[frame->state]) == 0)
+		return -EINVAL;
+
+	osal_list_del(&frame->list);
+	this->queued_count[frame->state]--;
+	__clear_bit(frame->index, this->state_map[frame->state]);
+	frame->state = FS_COMPLETE;
+	frame->ring_owned = 1;
+
+	if (frame_ring_push(&this->done_ring, frame->index) < 0) {
+		frame->ring_owned = 0;
+		return put_frame(this, frame, FS_COMPLETE);
+	}
+
+	return 0;
+}
+EXPORT_SYMBOL(frame_ring_complete);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Consumer side of COMPLETE ring, take the oldest done frame as USED without slock;
+ * @param[in] *this: point to struct vio_framemgr instance;
+ * @retval "!NULL": success
+ * @retval "NULL": ring is empty
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+struct vio_frame *frame_ring_dqbuf(struct vio_framemgr *this)
+{
+	u32 index;
+	struct vio_frame *frame;
+
+	if (this->ring_mode == 0u)
+		return NULL;
+
+	if (frame_ring_pop(&this->done_ring, &index) < 0)
+		return NULL;
+
+	frame = &this->frames[index];
+	frame->state = FS_USED;
+
+	return frame;
+}
+EXPORT_SYMBOL(frame_ring_dqbuf);/*PRQA S 0605,0307*/
+
 s32 vio_framemgr_share_buf(struct vio_framemgr *src_framemgr,
 	struct vio_framemgr *dst_framemgr, void *dst_iommu_dev)
 {
@@ -535,9 +811,11 @@ EXPORT_SYMBOL(vio_frame_iommu_unmap);
  * @callergraph
  * @design
  */
-void vio_frame_sync_for_device(const struct vio_frame *frame)
+void vio_frame_sync_for_device(struct vio_frame *frame)
 {
-	const struct vio_buffer *vbuf;
+	size_t bytes;
+	struct vio_buffer *vbuf;
+	struct vio_node *vnode;
 
 	vbuf = &frame->vbuf;
 	if (frame->internal_buf != 0u) {
@@ -549,7 +827,18 @@ void vio_frame_sync_for_device(const struct vio_frame *frame)
 		if (vbuf->ion_cached == 0u)
 			return;
 
-		vio_ion_sync_for_device(vbuf);
+		vnode = (struct vio_node *)frame->vnode;
+		/* only lines the cpu may have dirtied since the last dqbuf need cleaning */
+		if (vbuf->cpu_owned == 0u || (vbuf->cpu_access & VIO_CPU_ACCESS_WRITE) == 0u) {
+			bytes = vio_ion_sync_size(vbuf);
+			if (vnode != NULL)
+				atomic64_add((s64)bytes, &vnode->cache_skip_bytes);
+		} else {
+			bytes = vio_ion_sync_for_device(vbuf);
+			if (vnode != NULL)
+				atomic64_add((s64)bytes, &vnode->cache_flush_bytes);
+		}
+		vbuf->cpu_owned = 0;
 	}
 }
 
@@ -567,9 +856,11 @@ void vio_frame_sync_for_device(const struct vio_frame *frame)
  * @callergraph
  * @design
  */
-void vio_frame_sync_for_cpu(const struct vio_frame *frame)
+void vio_frame_sync_for_cpu(struct vio_frame *frame)
 {
-	const struct vio_buffer *vbuf;
+	size_t bytes;
+	struct vio_buffer *vbuf;
+	struct vio_node *vnode;
 
 	vbuf = &frame->vbuf;
 	if (frame->internal_buf != 0u) {
@@ -581,6 +872,18 @@ void vio_frame_sync_for_cpu(const struct vio_frame *frame)
 		if (vbuf->ion_cached == 0u)
 			return;
 
-		vio_ion_sync_for_cpu(vbuf);
+		vnode = (struct vio_node *)frame->vnode;
+		/* invalidate once per device->cpu transition and only if the cpu reads it */
+		if (vbuf->cpu_owned != 0u || (vbuf->cpu_access & VIO_CPU_ACCESS_READ) == 0u) {
+			bytes = vio_ion_sync_size(vbuf);
+			if (vnode != NULL)
+				atomic64_add((s64)bytes, &vnode->cache_skip_bytes);
+		} else {
+			bytes = vio_ion_sync_for_cpu(vbuf);
+			if (vnode != NULL)
+				atomic64_add((s64)bytes, &vnode->cache_flush_bytes);
+		}
+		if (vbuf->cpu_access != VIO_CPU_ACCESS_NONE)
+			vbuf->cpu_owned = 1;
 	}
 }
@@ -69,6 +69,18 @@ struct frame_info {
 	u32 crc_value[VIO_BUFFER_MAX_PLANES];
 };
 
+#define VIO_QBUF_BATCH_MAX 8u
+/**
+ * @struct vio_qbuf_batch
+ * @brief Argument of VIO_IOC_QBUF_BATCH, queue several buffers of one context at once.
+ * @NO{S09E05C01}
+ */
+struct vio_qbuf_batch {
+	u32 count;
+	u32 queued; /* out: number of entries accepted */
+	struct frame_info frameinfo[VIO_QBUF_BATCH_MAX];
+};
+
 /**
  * @struct vio_frame
  * @brief Define the descriptor of frame.
@@ -78,6 +90,9 @@ struct vio_frame {
 	osal_list_head_t list;
 	osal_list_head_t work_list;
 	u8 work_queued;
+	u8 sched_prio;
+	u64 queue_ns; /* time the frame entered the gtask work queue */
+	u64 deadline_ns;
 
 	void *vnode;
 	/* common use */
@@ -92,9 +107,23 @@ struct vio_frame {
 	u16	dispatch_cnt;
 	u8 internal_buf;
 	u8 buf_shared;
+	u8 ring_owned; /* held by ring handoff, not linked in any state queue */
+	u8 ring_pending; /* pushed into request ring, not drained yet */
 	void *ext_data;
 };
 
+/**
+ * @struct vio_frame_ring
+ * @brief Define the single-producer/single-consumer ring of frame index.
+ * @NO{S09E05C01}
+ */
+struct vio_frame_ring {
+	u32 head; /* written by producer only */
+	u32 tail; /* written by consumer only */
+	u32 mask;
+	u16 *slot;
+};
+
 /**
  * @struct vio_framemgr
  * @brief Define the descriptor of frame manager.
@@ -111,26 +140,39 @@ struct vio_framemgr {
 
 	u32	queued_count[NR_FRAME_STATE];
 	osal_list_head_t queued_list[NR_FRAME_STATE];
+
+	/* per-state occupancy bitmap indexed by frame index */
+	unsigned long *state_map[NR_FRAME_STATE];
+
+	/* lock-free handoff: REQUEST (ioctl -> isr) and COMPLETE (isr -> ioctl) */
+	u8 ring_mode;
+	struct vio_frame_ring req_ring;
+	struct vio_frame_ring done_ring;
 };
 
 s32 trans_frame(struct vio_framemgr *this, struct vio_frame *frame,
 		enum vio_frame_state state);
-struct vio_frame *peek_frame(const struct vio_framemgr *this,
+struct vio_frame *peek_frame(struct vio_framemgr *this,
 		enum vio_frame_state state);
 struct vio_frame *peek_frame_tail(const struct vio_framemgr *this,
 		enum vio_frame_state state);
-struct vio_frame *find_frame(const struct vio_framemgr *this,
-		enum vio_frame_state state, u32 fcount);
 s32 frame_manager_open(struct vio_framemgr *this, u32 buffers);
 void frame_manager_close(struct vio_framemgr *this);
 s32 frame_manager_flush(struct vio_framemgr *this);
 void framemgr_print_queues(const struct vio_framemgr *this);
+s32 frame_ring_enable(struct vio_framemgr *this);
+void frame_ring_disable(struct vio_framemgr *this);
+s32 frame_ring_qbuf(struct vio_framemgr *this, struct vio_frame *frame);
+void frame_ring_drain(struct vio_framemgr *this);
+s32 frame_ring_complete(struct vio_framemgr *this, struct vio_frame *frame);
+struct vio_frame *frame_ring_dqbuf(struct vio_framemgr *this);
+u32 frame_ring_count(const struct vio_frame_ring *ring);
 s32 vio_frame_iommu_map(void *iommu_dev,
 		struct vio_frame *frame);
 void vio_frame_iommu_unmap(void *iommu_dev,
 		struct vio_frame *frame);
-void vio_frame_sync_for_device(const struct vio_frame *frame);
-void vio_frame_sync_for_cpu(const struct vio_frame *frame);
+void vio_frame_sync_for_device(struct vio_frame *frame);
+void vio_frame_sync_for_cpu(struct vio_frame *frame);
 s32 vio_framemgr_share_buf(struct vio_framemgr *src_framemgr,
 	struct vio_framemgr *dts_framemgr, void *dst_iommu_dev);
 #endif
@@ -0,0 +1,283 @@
+/**
+ * @file: vio_framemgr_kunit.c
+ * @
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @Copyright (c) 2023 by horizon, All Rights Reserved.
+ */
+/***************************************************************************
+ *                      COPYRIGHT NOTICE
+ *             Copyright 2023 Horizon Robotics, Inc.
+ *                     All rights reserved.
+ ***************************************************************************/
+#include <kunit/test.h>
+#include <linux/jiffies.h>
+#include <linux/kthread.h>
+#include <linux/ktime.h>
+#include "vio_framemgr.h"
+#include "vio_node_api.h"
+
+#define FMGR_TEST_FRAMES 8u
+#define FMGR_BENCH_LOOPS 100000u
+#define FMGR_RING_FRAMES 200000u
+#define FMGR_RING_BATCH 4u
+
+static s32 fmgr_test_init(struct kunit *test)
+{
+	struct vio_framemgr *framemgr;
+
+	framemgr = kunit_kzalloc(test, sizeof(*framemgr), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, framemgr);
+	framemgr->name = "kunit";
+	KUNIT_ASSERT_EQ(test, frame_manager_open(framemgr, FMGR_TEST_FRAMES), 0);
+	test->priv = framemgr;
+
+	return 0;
+}
+
+static void fmgr_test_exit(struct kunit *test)
+{
+	frame_manager_close((struct vio_framemgr *)test->priv);
+}
+
+/* every frame starts in FREE, in index order */
+static void fmgr_test_open(struct kunit *test)
+{
+	u32 i;
+	struct vio_framemgr *framemgr = test->priv;
+
+	KUNIT_EXPECT_EQ(test, framemgr->num_frames, FMGR_TEST_FRAMES);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_FREE], FMGR_TEST_FRAMES);
+	for (i = 0; i < FMGR_TEST_FRAMES; i++) {
+		KUNIT_EXPECT_EQ(test, framemgr->frames[i].index, i);
+		KUNIT_EXPECT_EQ(test, (u32)framemgr->frames[i].state, (u32)FS_FREE);
+		KUNIT_EXPECT_TRUE(test, test_bit(i, framemgr->state_map[FS_FREE]));
+	}
+}
+
+/* peek returns the queue head, trans keeps FIFO order and the counts */
+static void fmgr_test_trans_fifo(struct kunit *test)
+{
+	u32 i;
+	struct vio_frame *frame;
+	struct vio_framemgr *framemgr = test->priv;
+
+	for (i = 0; i < FMGR_TEST_FRAMES; i++) {
+		frame = peek_frame(framemgr, FS_FREE);
+		KUNIT_ASSERT_NOT_NULL(test, frame);
+		KUNIT_EXPECT_EQ(test, frame->index, i);
+		KUNIT_EXPECT_EQ(test, trans_frame(framemgr, frame, FS_REQUEST), 0);
+	}
+	KUNIT_EXPECT_NULL(test, peek_frame(framemgr, FS_FREE));
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_FREE], 0u);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_REQUEST], FMGR_TEST_FRAMES);
+
+	frame = peek_frame_tail(framemgr, FS_REQUEST);
+	KUNIT_ASSERT_NOT_NULL(test, frame);
+	KUNIT_EXPECT_EQ(test, frame->index, FMGR_TEST_FRAMES - 1u);
+
+	for (i = 0; i < FMGR_TEST_FRAMES; i++) {
+		frame = peek_frame(framemgr, FS_REQUEST);
+		KUNIT_ASSERT_NOT_NULL(test, frame);
+		KUNIT_EXPECT_EQ(test, frame->index, i);
+		KUNIT_EXPECT_EQ(test, trans_frame(framemgr, frame, FS_PROCESS), 0);
+		KUNIT_EXPECT_FALSE(test, test_bit(i, framemgr->state_map[FS_REQUEST]));
+		KUNIT_EXPECT_TRUE(test, test_bit(i, framemgr->state_map[FS_PROCESS]));
+	}
+}
+
+/* a frame whose state does not match its queue must not be transferred */
+static void fmgr_test_trans_unqueued(struct kunit *test)
+{
+	struct vio_frame *frame;
+	struct vio_framemgr *framemgr = test->priv;
+
+	frame = peek_frame(framemgr, FS_FREE);
+	KUNIT_ASSERT_NOT_NULL(test, frame);
+	KUNIT_ASSERT_EQ(test, trans_frame(framemgr, frame, FS_REQUEST), 0);
+	frame->state = FS_FREE;
+	KUNIT_EXPECT_LT(test, trans_frame(framemgr, frame, FS_PROCESS), 0);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_FREE], FMGR_TEST_FRAMES - 1u);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_REQUEST], 1u);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_PROCESS], 0u);
+	frame->state = FS_REQUEST;
+	KUNIT_EXPECT_LT(test, trans_frame(framemgr, frame, FS_INVALID), 0);
+}
+
+/* flush returns REQUEST/PROCESS/COMPLETE frames to FREE */
+static void fmgr_test_flush(struct kunit *test)
+{
+	struct vio_frame *frame;
+	struct vio_framemgr *framemgr = test->priv;
+
+	frame = peek_frame(framemgr, FS_FREE);
+	KUNIT_ASSERT_EQ(test, trans_frame(framemgr, frame, FS_REQUEST), 0);
+	frame = peek_frame(framemgr, FS_FREE);
+	KUNIT_ASSERT_EQ(test, trans_frame(framemgr, frame, FS_PROCESS), 0);
+	frame = peek_frame(framemgr, FS_FREE);
+	KUNIT_ASSERT_EQ(test, trans_frame(framemgr, frame, FS_COMPLETE), 0);
+
+	KUNIT_EXPECT_EQ(test, frame_manager_flush(framemgr), 0);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_FREE], FMGR_TEST_FRAMES);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_REQUEST], 0u);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_PROCESS], 0u);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_COMPLETE], 0u);
+}
+
+/* irq side of the ring stress: drain REQUEST ring, process, push to COMPLETE ring */
+static s32 fmgr_ring_irq_thread(void *data)
+{
+	u64 flags = 0;
+	u32 fcount = 0;
+	struct vio_frame *frame;
+	struct vio_framemgr *framemgr = data;
+
+	while (!kthread_should_stop()) {
+		vio_e_barrier_irqs(framemgr, flags);
+		frame = peek_frame(framemgr, FS_REQUEST);
+		if (frame != NULL) {
+			(void)trans_frame(framemgr, frame, FS_PROCESS);
+			frame->fcount = fcount++;
+			(void)frame_ring_complete(framemgr, frame);
+		}
+		vio_x_barrier_irqr(framemgr, flags);
+		if (frame == NULL)
+			cond_resched();
+	}
+
+	return 0;
+}
+
+/*
+ * irq side of a batch job on the ring, as gdc_batch_frame_work: drain the
+ * REQUEST ring before counting, start only once a full batch is queued
+ */
+static s32 fmgr_ring_batch_irq_thread(void *data)
+{
+	u64 flags = 0;
+	u32 i, ready, fcount = 0;
+	struct vio_frame *frame;
+	struct vio_framemgr *framemgr = data;
+
+	while (!kthread_should_stop()) {
+		vio_e_barrier_irqs(framemgr, flags);
+		frame_ring_drain(framemgr);
+		ready = framemgr->queued_count[FS_REQUEST];
+		for (i = 0; ready >= FMGR_RING_BATCH && i < FMGR_RING_BATCH; i++) {
+			frame = peek_frame(framemgr, FS_REQUEST);
+			(void)trans_frame(framemgr, frame, FS_PROCESS);
+		}
+		for (i = 0; ready >= FMGR_RING_BATCH && i < FMGR_RING_BATCH; i++) {
+			frame = peek_frame(framemgr, FS_PROCESS);
+			frame->fcount = fcount++;
+			(void)frame_ring_complete(framemgr, frame);
+		}
+		vio_x_barrier_irqr(framemgr, flags);
+		if (ready < FMGR_RING_BATCH)
+			cond_resched();
+	}
+
+	return 0;
+}
+
+/* user side: every frame comes back exactly once and in order, nothing is lost on flush */
+static void fmgr_ring_run(struct kunit *test, s32 (*irq_fn)(void *data))
+{
+	u32 i, done = 0;
+	unsigned long timeout;
+	struct task_struct *irq;
+	struct vio_frame *frame;
+	struct vio_framemgr *framemgr = test->priv;
+
+	KUNIT_ASSERT_EQ(test, frame_ring_enable(framemgr), 0);
+	for (i = 0; i < FMGR_TEST_FRAMES; i++)
+		KUNIT_ASSERT_EQ(test, frame_ring_qbuf(framemgr, &framemgr->frames[i]), 0);
+
+	irq = kthread_run(irq_fn, framemgr, "fmgr_ring_irq");
+	KUNIT_ASSERT_FALSE(test, IS_ERR(irq));
+
+	timeout = jiffies + msecs_to_jiffies(10000);
+	while (done < FMGR_RING_FRAMES && time_before(jiffies, timeout)) {
+		frame = frame_ring_dqbuf(framemgr);
+		if (frame == NULL) {
+			cond_resched();
+			continue;
+		}
+		if (frame->fcount != done || frame->state != FS_USED)
+			break;
+		done++;
+		if (frame_ring_qbuf(framemgr, frame) < 0)
+			break;
+	}
+	(void)kthread_stop(irq);
+
+	KUNIT_EXPECT_EQ(test, done, FMGR_RING_FRAMES);
+	KUNIT_EXPECT_EQ(test, frame_manager_flush(framemgr), 0);
+	frame_ring_disable(framemgr);
+	KUNIT_EXPECT_EQ(test, framemgr->queued_count[FS_FREE], FMGR_TEST_FRAMES);
+	for (i = 0; i < FMGR_TEST_FRAMES; i++) {
+		KUNIT_EXPECT_EQ(test, (u32)framemgr->frames[i].ring_owned, 0u);
+		KUNIT_EXPECT_EQ(test, (u32)framemgr->frames[i].ring_pending, 0u);
+	}
+}
+
+/* user side in the test thread against a concurrent irq thread, one frame per job */
+static void fmgr_test_ring_stress(struct kunit *test)
+{
+	fmgr_ring_run(test, fmgr_ring_irq_thread);
+}
+
+/* same with FMGR_RING_BATCH inputs per job, the frames never reach REQUEST without a drain */
+static void fmgr_test_ring_batch(struct kunit *test)
+{
+	fmgr_ring_run(test, fmgr_ring_batch_irq_thread);
+}
+
+/* cost of one qbuf -> process -> done -> dqbuf cycle; reported, not asserted */
+static void fmgr_test_bench(struct kunit *test)
+{
+	u32 i;
+	u64 flags = 0;
+	ktime_t start;
+	s64 cycle_ns;
+	struct vio_frame *frame;
+	struct vio_framemgr *framemgr = test->priv;
+
+	start = ktime_get();
+	for (i = 0; i < FMGR_BENCH_LOOPS; i++) {
+		vio_e_barrier_irqs(framemgr, flags);
+		frame = peek_frame(framemgr, FS_FREE);
+		(void)trans_frame(framemgr, frame, FS_REQUEST);
+		frame = peek_frame(framemgr, FS_REQUEST);
+		(void)trans_frame(framemgr, frame, FS_PROCESS);
+		frame = peek_frame(framemgr, FS_PROCESS);
+		frame->fcount = i;
+		(void)trans_frame(framemgr, frame, FS_COMPLETE);
+		frame = peek_frame(framemgr, FS_COMPLETE);
+		(void)trans_frame(framemgr, frame, FS_FREE);
+		vio_x_barrier_irqr(framemgr, flags);
+	}
+	cycle_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	kunit_info(test, "%u frames: cycle %lld ns\n", FMGR_TEST_FRAMES,
+		   div_s64(cycle_ns, FMGR_BENCH_LOOPS));
+}
+
+static struct kunit_case vio_framemgr_test_cases[] = {
+	KUNIT_CASE(fmgr_test_open),
+	KUNIT_CASE(fmgr_test_trans_fifo),
+	KUNIT_CASE(fmgr_test_trans_unqueued),
+	KUNIT_CASE(fmgr_test_flush),
+	KUNIT_CASE(fmgr_test_ring_stress),
+	KUNIT_CASE(fmgr_test_ring_batch),
+	KUNIT_CASE(fmgr_test_bench),
+	{}
+};
+
+static struct kunit_suite vio_framemgr_test_suite = {
+	.name = "vio_framemgr",
+	.init = fmgr_test_init,
+	.exit = fmgr_test_exit,
+	.test_cases = vio_framemgr_test_cases,
+};
+kunit_test_suite(vio_framemgr_test_suite);
@@ -11,6 +11,8 @@
  *                     All rights reserved.
  ***************************************************************************/
 #define pr_fmt(fmt)    "[VIO mem]:" fmt
+#include <linux/pid.h>
+#include <linux/sched.h>
 #include <asm/cacheflush.h>
 #include "osal.h"
 #include "vio_mem.h"
@@ -31,6 +33,33 @@ struct vio_ion_priv {
 	struct ion_dma_buf_data ion_data[HBN_LAYER_MAXIMUM][VIO_BUFFER_MAX_PLANES];
 };
 
+struct vio_buf_pool_entry {
+	osal_list_head_t list;
+	void *iommu_dev;
+	struct pid *owner; /* process which parked it, share ids were handed out to it */
+	size_t size;
+	struct vio_buffer vbuf;
+};
+
+struct vio_buf_pool {
+	osal_mutex_t mlock;
+	osal_list_head_t list;
+	u32 inited;
+	u32 entries;
+	size_t resident;
+	u64 hit;
+	u64 miss;
+	u64 evict;
+};
+
+/**
+ * Purpose: driver-allocated buffers parked between REQBUFS cycles, oldest first
+ * Value: NA
+ * Range: vio_mem.c
+ * Attention: NA
+ */
+static struct vio_buf_pool g_buf_pool;
+
 #ifndef CONFIG_PCIE_HOBOT_EP_AI
 struct ion_client *vio_get_ion_client(s32 dev_num)
 {
@@ -62,6 +91,12 @@ s32 vio_ion_create(void)
 		ret = -EFAULT;
 	}
 
+	if (g_buf_pool.inited == 0u) {
+		osal_mutex_init(&g_buf_pool.mlock);/*PRQA S 3334*/
+		osal_list_head_init(&g_buf_pool.list);
+		g_buf_pool.inited = 1;
+	}
+
 	if (g_ion_client == NULL) {
 		g_ion_client = ion_client_create(hb_ion_dev, "vio_driver_ion");
 		if (IS_ERR((void *)g_ion_client)) {
@@ -75,6 +110,7 @@ s32 vio_ion_create(void)
 
 void vio_ion_destroy(void)
 {
+	vio_buf_pool_flush(NULL);
 	ion_client_destroy(g_ion_client);
 	g_ion_client = NULL;
 }
@@ -280,6 +316,10 @@ s32 vio_ion_alloc(struct vio_buffer *vbuf)
 		vio_dbg("[F%d] %s: [L%d] done", group_info->index, __func__, i);/*PRQA S 0685,1294*/
 	}
 
+	if ((m_ionFlags & ION_FLAG_CACHED) != 0u) {
+		vbuf->ion_cached = 1;
+		vbuf->ion_cachesync = 1;
+	}
 	vbuf->ion_alloced = 1;
 	vio_dbg("%s: m_ionFlags = 0x%x", __func__, m_ionFlags);/*PRQA S 0685,1294*/
 
@@ -290,9 +330,12 @@ EXPORT_SYMBOL(vio_ion_alloc);/*PRQA S 0605,0307*/
 /**
  * @NO{S09E05C01}
  * @ASIL{B}
- * @brief: Sync cache data to ddr;
+ * @brief: Walk the planes of all layers limited to the roi rows and optionally do cache maintenance;
+ * For contig buffers paddr of each plane is consecutive, so all planes are walked as well;
  * @param[in] *buffer: point to struct vio_buffer instance;
- * @retval None
+ * @param[in] dir: DMA_TO_DEVICE to clean, DMA_FROM_DEVICE to invalidate;
+ * @param[in] sync: 0 only counts the bytes;
+ * @retval bytes covered
  * @param[out] None
  * @data_read None
  * @data_updated None
@@ -301,32 +344,70 @@ EXPORT_SYMBOL(vio_ion_alloc);/*PRQA S 0605,0307*/
  * @callergraph
  * @design
  */
-void vio_ion_sync_for_device(const struct vio_buffer *vbuf)
+static size_t vio_ion_sync_planes(const struct vio_buffer *vbuf,
+	enum dma_data_direction dir, u32 sync)
 {
 	s32 i, j;
 	u64 paddr;
-	u32 plane_count;
-	size_t length;
+	size_t offset, length, plane_size;
+	size_t bytes = 0;
 	const struct vbuf_group_info *group_info;
 	struct device dev = {0};
 
 	group_info = &vbuf->group_info;
-	if (vbuf->ion_cachesync == 1u) {
-		for (i = 0; i < HBN_LAYER_MAXIMUM; i++) {
-			if ((1 << i & group_info->bit_map) == 0)
-				continue;
-			plane_count = group_info->info[i].buf_attr.planecount;
-			if (group_info->is_contig)
-				plane_count = 1;
-
-			for (j = 0; j < plane_count; j++) {
-				paddr = group_info->info[i].paddr[j];
-				length =group_info->info[i].planeSize[j];
-				dma_sync_single_for_device(&dev, paddr, length, DMA_TO_DEVICE);
+	for (i = 0; i < HBN_LAYER_MAXIMUM; i++) {
+		if ((1 << i & group_info->bit_map) == 0)
+			continue;
+
+		for (j = 0; j < group_info->info[i].buf_attr.planecount; j++) {
+			plane_size = group_info->info[i].planeSize[j];
+			offset = 0;
+			length = plane_size;
+			if (vbuf->roi_height != 0u && group_info->info[i].buf_attr.vstride != 0u) {
+				offset = plane_size * vbuf->roi_y / group_info->info[i].buf_attr.vstride;
+				length = DIV_ROUND_UP(plane_size * vbuf->roi_height,
+						group_info->info[i].buf_attr.vstride);
+				if (offset >= plane_size)
+					continue;
+				if (length > plane_size - offset)
+					length = plane_size - offset;
 			}
-			vio_dbg("%s\n", __func__);/*PRQA S 0685,1294*/
+
+			if (sync != 0u) {
+				paddr = group_info->info[i].paddr[j] + offset;
+				dma_sync_single_for_device(&dev, paddr, length, dir);
+			}
+			bytes += length;
 		}
 	}
+
+	return bytes;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Sync cache data to ddr;
+ * @param[in] *buffer: point to struct vio_buffer instance;
+ * @retval bytes flushed
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+size_t vio_ion_sync_for_device(const struct vio_buffer *vbuf)
+{
+	size_t bytes = 0;
+
+	if (vbuf->ion_cachesync == 1u) {
+		bytes = vio_ion_sync_planes(vbuf, DMA_TO_DEVICE, 1);
+		vio_dbg("%s: %zu bytes\n", __func__, bytes);/*PRQA S 0685,1294*/
+	}
+
+	return bytes;
 }
 
 /**
@@ -334,7 +415,7 @@ void vio_ion_sync_for_device(const struct vio_buffer *vbuf)
  * @ASIL{B}
  * @brief: Sync ddr data to cache;
  * @param[in] *buffer: point to struct vio_buffer instance;
- * @retval None
+ * @retval bytes invalidated
  * @param[out] None
  * @data_read None
  * @data_updated None
@@ -343,32 +424,47 @@ void vio_ion_sync_for_device(const struct vio_buffer *vbuf)
  * @callergraph
  * @design
  */
-void vio_ion_sync_for_cpu(const struct vio_buffer *vbuf)
+size_t vio_ion_sync_for_cpu(const struct vio_buffer *vbuf)
 {
-	s32 i, j;
-	u64 paddr;
-	u32 plane_count;
-	size_t length;
-	const struct vbuf_group_info *group_info;
-	struct device dev = {0};
+	size_t bytes = 0;
 
-	group_info = &vbuf->group_info;
 	if (vbuf->ion_cachesync == 1u) {
-		for (i = 0; i < HBN_LAYER_MAXIMUM; i++) {
-			if ((1 << i & group_info->bit_map) == 0)
-				continue;
-			plane_count = group_info->info[i].buf_attr.planecount;
-			if (group_info->is_contig)
-				plane_count = 1;
-
-			for (j = 0; j < group_info->info[i].buf_attr.planecount; j++) {
-				paddr = group_info->info[i].paddr[j];
-				length =group_info->info[i].planeSize[j];
-				dma_sync_single_for_device(&dev, paddr, length, DMA_FROM_DEVICE);
-			}
-			vio_dbg("%s\n", __func__);/*PRQA S 0685,1294*/
-		}
+		bytes = vio_ion_sync_planes(vbuf, DMA_FROM_DEVICE, 1);
+		vio_dbg("%s: %zu bytes\n", __func__, bytes);/*PRQA S 0685,1294*/
 	}
+
+	return bytes;
+}
+
+size_t vio_ion_sync_size(const struct vio_buffer *vbuf)
+{
+	return vio_ion_sync_planes(vbuf, DMA_NONE, 0);
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Translate hbmem usage flags to CPU access declaration of a buffer;
+ * @param[in] flags: hbmem usage flags;
+ * @retval VIO_CPU_ACCESS_*
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+u8 vio_ion_cpu_access(s64 flags)
+{
+	u8 cpu_access = VIO_CPU_ACCESS_NONE;
+
+	if ((flags & HB_MEM_USAGE_CPU_READ_MASK) != 0)
+		cpu_access |= VIO_CPU_ACCESS_READ;
+	if ((flags & HB_MEM_USAGE_CPU_WRITE_MASK) != 0)
+		cpu_access |= VIO_CPU_ACCESS_WRITE;
+
+	return cpu_access;
 }
 
 /**
@@ -411,6 +507,45 @@ static s32 vio_ion_handle_by_id(struct ion_client *ion_client,
 	return ret;
 }
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Get the dma-buf of one ion buffer for exporting to another process;
+ * @param[in] dev_num: ion device number of the buffer;
+ * @param[in] share_id: ion share id;
+ * @retval "!= ERR_PTR": dma-buf with one reference held for the caller
+ * @retval "ERR_PTR": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+struct dma_buf *vio_ion_export_dmabuf(u32 dev_num, s32 share_id)
+{
+	struct dma_buf *dmabuf;
+	struct ion_client *ion_client;
+	struct ion_handle *ion_handle;
+
+	ion_client = vio_get_ion_client((s32)dev_num);
+	ion_handle = ion_import_dma_buf_with_shareid(ion_client, share_id);
+	if (IS_ERR(ion_handle)) {
+		vio_err("%s failed share_id %d\n", __func__, share_id);
+		return ERR_PTR(-EFAULT);
+	}
+
+	/* the dma-buf holds its own reference, the handle is only for lookup */
+	dmabuf = ion_share_dma_buf(ion_client, ion_handle);
+	ion_free(ion_client, ion_handle);
+	if (IS_ERR(dmabuf))
+		vio_err("%s share_id %d share failed %ld\n", __func__, share_id, PTR_ERR(dmabuf));
+
+	return dmabuf;
+}
+EXPORT_SYMBOL(vio_ion_export_dmabuf);/*PRQA S 0605,0307*/
+
 /**
  * @NO{S09E05C01}
  * @ASIL{B}
@@ -569,6 +704,7 @@ void vio_ion_free(struct vio_buffer *vbuf)
 	vbuf->ion_priv = NULL;
 	vbuf->ion_alloced = 0;
 	vbuf->ion_cached = 0;
+	vbuf->ion_cachesync = 0;
 	vbuf->ion_mmap = 0;
 	vio_dbg("[F%d] %s: done\n", group_info->index,  __func__);/*PRQA S 0685,1294*/
 }
@@ -723,4 +859,275 @@ void vio_iommu_unmap(void *iommu_dev, struct vio_buffer *vbuf)
 	}
 	vbuf->iommu_map = 0;
 }
-EXPORT_SYMBOL(vio_iommu_unmap);/*PRQA S 0605,0307*/
\ No newline at end of file
+EXPORT_SYMBOL(vio_iommu_unmap);/*PRQA S 0605,0307*/
+
+static size_t vio_buf_pool_bytes(const struct vbuf_group_info *group_info)
+{
+	u32 i, j;
+	size_t size = 0;
+
+	for (i = 0; i < HBN_LAYER_MAXIMUM; i++) {
+		if ((1 << i & group_info->bit_map) == 0)
+			continue;
+		for (j = 0; j < VIO_BUFFER_MAX_PLANES; j++)
+			size += group_info->info[i].planeSize[j];
+	}
+
+	return size;
+}
+
+static bool vio_buf_pool_match(const struct vio_buf_pool_entry *entry,
+	const struct vio_buffer *vbuf, const void *iommu_dev)
+{
+	u32 i, j;
+	const struct vbuf_group_info *cached;
+	const struct vbuf_group_info *wanted;
+
+	cached = &entry->vbuf.group_info;
+	wanted = &vbuf->group_info;
+	if (entry->owner != task_tgid(current) ||
+		entry->iommu_dev != iommu_dev || cached->bit_map != wanted->bit_map ||
+		cached->is_contig != wanted->is_contig || cached->flags != wanted->flags ||
+		cached->vbuf_type_mask != wanted->vbuf_type_mask ||
+		cached->metadata_en != wanted->metadata_en || cached->dev_num != wanted->dev_num ||
+		(vbuf->ion_cached == 1u && entry->vbuf.ion_cached == 0u) ||
+		entry->vbuf.ion_mmap != vbuf->ion_mmap)
+		return false;
+
+	for (i = 0; i < HBN_LAYER_MAXIMUM; i++) {
+		if ((1 << i & wanted->bit_map) == 0)
+			continue;
+		if (cached->info[i].buf_attr.planecount != wanted->info[i].buf_attr.planecount)
+			return false;
+		for (j = 0; j < wanted->info[i].buf_attr.planecount; j++) {
+			if (cached->info[i].planeSize[j] != wanted->info[i].planeSize[j])
+				return false;
+		}
+		/* metadata plane size is rounded up by ion_phys */
+		if ((cached->info[i].planeSize[VIO_META_PLANE] == 0) !=
+			(wanted->info[i].planeSize[VIO_META_PLANE] == 0) ||
+			cached->info[i].planeSize[VIO_META_PLANE] <
+			wanted->info[i].planeSize[VIO_META_PLANE])
+			return false;
+	}
+
+	return true;
+}
+
+static void vio_buf_pool_release(struct vio_buf_pool_entry *entry)
+{
+	if (entry->iommu_dev != NULL)
+		vio_iommu_unmap(entry->iommu_dev, &entry->vbuf);
+	vio_ion_free(&entry->vbuf);
+	put_pid(entry->owner);
+	osal_kfree(entry);
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Take a parked buffer whose layout matches vbuf out of the pool, only buffers
+ * parked by the calling process are reused so that share ids never move to another process;
+ * @param[in] *vbuf: point to struct vio_buffer instance with group_info filled;
+ * @param[in] *iommu_dev: device the buffer must already be mapped to, NULL for unmapped;
+ * @retval "= 0": success, vbuf owns ion handles (and iommu mapping if iommu_dev set)
+ * @retval "< 0": no matching buffer, caller should alloc by itself
+ * @param[out] None
+ * @data_read g_buf_pool
+ * @data_updated g_buf_pool
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_buf_pool_get(struct vio_buffer *vbuf, void *iommu_dev)
+{
+	u32 i;
+	struct vio_buf_pool_entry *entry;
+	struct vio_buf_pool_entry *found = NULL;
+	struct vbuf_group_info *group_info;
+
+	if (vbuf == NULL || vbuf->ion_alloced == 1u || g_buf_pool.inited == 0u)
+		return -EINVAL;
+
+	osal_mutex_lock(&g_buf_pool.mlock);
+	osal_list_for_each_entry(entry, &g_buf_pool.list, list) {/*PRQA S 2810,0497*/
+		if (vio_buf_pool_match(entry, vbuf, iommu_dev) == true) {
+			found = entry;
+			break;
+		}
+	}
+	if (found == NULL) {
+		g_buf_pool.miss++;
+		osal_mutex_unlock(&g_buf_pool.mlock);
+		return -ENOENT;
+	}
+	osal_list_del(&found->list);
+	g_buf_pool.entries--;
+	g_buf_pool.resident -= found->size;
+	g_buf_pool.hit++;
+	osal_mutex_unlock(&g_buf_pool.mlock);
+
+	group_info = &vbuf->group_info;
+	for (i = 0; i < HBN_LAYER_MAXIMUM; i++) {
+		if ((1 << i & group_info->bit_map) == 0)
+			continue;
+		(void)memcpy(group_info->info[i].share_id, found->vbuf.group_info.info[i].share_id,
+			sizeof(group_info->info[i].share_id));
+		(void)memcpy(group_info->info[i].paddr, found->vbuf.group_info.info[i].paddr,
+			sizeof(group_info->info[i].paddr));
+		(void)memcpy(group_info->info[i].addr, found->vbuf.group_info.info[i].addr,
+			sizeof(group_info->info[i].addr));
+		group_info->info[i].planeSize[VIO_META_PLANE] =
+			found->vbuf.group_info.info[i].planeSize[VIO_META_PLANE];
+		if (group_info->metadata_en == 1 && vbuf->metadata == NULL)
+			vbuf->metadata = group_info->info[i].addr[VIO_META_PLANE];
+	}
+	(void)memcpy(vbuf->iommu_paddr, found->vbuf.iommu_paddr, sizeof(vbuf->iommu_paddr));
+	vbuf->ion_priv = found->vbuf.ion_priv;
+	vbuf->iommu_map = found->vbuf.iommu_map;
+	vbuf->ion_cached = found->vbuf.ion_cached;
+	vbuf->ion_cachesync = found->vbuf.ion_cachesync;
+	vbuf->ion_alloced = 1;
+	put_pid(found->owner);
+	osal_kfree(found);
+	vio_dbg("[F%d] %s: reuse buffer\n", group_info->index, __func__);/*PRQA S 0685,1294*/
+
+	return 0;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Park a driver-allocated buffer and its iommu mapping in the pool instead of freeing it,
+ * the oldest buffers are released first until the new one fits in limit;
+ * @param[in] *vbuf: point to struct vio_buffer instance;
+ * @param[in] *iommu_dev: device vbuf is mapped to;
+ * @param[in] limit: maximum resident bytes of the pool;
+ * @retval "= 0": success, vbuf is emptied
+ * @retval "< 0": buffer is not taken, caller should free it by itself
+ * @param[out] None
+ * @data_read g_buf_pool
+ * @data_updated g_buf_pool
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_buf_pool_put(struct vio_buffer *vbuf, void *iommu_dev, size_t limit)
+{
+	s32 ret = 0;
+	size_t size;
+	osal_list_head_t evict_list;
+	struct vio_buf_pool_entry *entry;
+	struct vio_buf_pool_entry *temp;
+
+	if (vbuf == NULL || vbuf->ion_alloced == 0u || vbuf->ion_priv == NULL ||
+		g_buf_pool.inited == 0u)
+		return -EINVAL;
+
+	if (vbuf->iommu_map != 0u && iommu_dev == NULL)
+		return -EINVAL;
+
+	size = vio_buf_pool_bytes(&vbuf->group_info);
+	if (size > limit)
+		return -ENOSPC;
+
+	osal_list_head_init(&evict_list);
+	osal_mutex_lock(&g_buf_pool.mlock);
+	while (g_buf_pool.resident + size > limit && osal_list_empty(&g_buf_pool.list) == 0) {
+		temp = osal_list_first_entry(&g_buf_pool.list, struct vio_buf_pool_entry, list);/*PRQA S 2810,0497*/
+		osal_list_del(&temp->list);
+		osal_list_add(&temp->list, &evict_list);
+		g_buf_pool.entries--;
+		g_buf_pool.resident -= temp->size;
+		g_buf_pool.evict++;
+	}
+	entry = osal_kzalloc(sizeof(struct vio_buf_pool_entry), GFP_KERNEL);
+	if (entry == NULL) {
+		ret = -ENOMEM;
+	} else {
+		(void)memcpy(&entry->vbuf, vbuf, sizeof(struct vio_buffer));
+		entry->iommu_dev = (vbuf->iommu_map != 0u) ? iommu_dev : NULL;
+		entry->owner = get_pid(task_tgid(current));
+		entry->size = size;
+		osal_list_add_tail(&entry->list, &g_buf_pool.list);
+		g_buf_pool.entries++;
+		g_buf_pool.resident += size;
+	}
+	osal_mutex_unlock(&g_buf_pool.mlock);
+
+	osal_list_for_each_entry_safe(entry, temp, &evict_list, list) {/*PRQA S 2810,2741,0497*/
+		osal_list_del(&entry->list);
+		vio_buf_pool_release(entry);
+	}
+
+	if (ret == 0) {
+		vbuf->ion_priv = NULL;
+		vbuf->metadata = NULL;
+		vbuf->iommu_map = 0;
+		vbuf->ion_alloced = 0;
+		vbuf->ion_cached = 0;
+		vbuf->ion_cachesync = 0;
+		vbuf->ion_mmap = 0;
+	}
+
+	return ret;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Release parked buffers mapped to iommu_dev, or all buffers when iommu_dev is NULL;
+ * @param[in] *iommu_dev: point to struct device instance;
+ * @retval None
+ * @param[out] None
+ * @data_read g_buf_pool
+ * @data_updated g_buf_pool
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void vio_buf_pool_flush(void *iommu_dev)
+{
+	osal_list_head_t evict_list;
+	struct vio_buf_pool_entry *entry;
+	struct vio_buf_pool_entry *temp;
+
+	if (g_buf_pool.inited == 0u)
+		return;
+
+	osal_list_head_init(&evict_list);
+	osal_mutex_lock(&g_buf_pool.mlock);
+	osal_list_for_each_entry_safe(entry, temp, &g_buf_pool.list, list) {/*PRQA S 2810,2741,0497*/
+		if (iommu_dev != NULL && entry->iommu_dev != iommu_dev)
+			continue;
+		osal_list_del(&entry->list);
+		osal_list_add(&entry->list, &evict_list);
+		g_buf_pool.entries--;
+		g_buf_pool.resident -= entry->size;
+	}
+	osal_mutex_unlock(&g_buf_pool.mlock);
+
+	osal_list_for_each_entry_safe(entry, temp, &evict_list, list) {/*PRQA S 2810,2741,0497*/
+		osal_list_del(&entry->list);
+		vio_buf_pool_release(entry);
+	}
+}
+
+void vio_buf_pool_get_stats(struct vio_buf_pool_stats *stats)
+{
+	if (g_buf_pool.inited == 0u) {
+		(void)memset(stats, 0, sizeof(struct vio_buf_pool_stats));
+		return;
+	}
+
+	osal_mutex_lock(&g_buf_pool.mlock);
+	stats->hit = g_buf_pool.hit;
+	stats->miss = g_buf_pool.miss;
+	stats->evict = g_buf_pool.evict;
+	stats->entries = g_buf_pool.entries;
+	stats->resident = g_buf_pool.resident;
+	osal_mutex_unlock(&g_buf_pool.mlock);
+}
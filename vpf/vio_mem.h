@@ -86,20 +86,39 @@ struct vio_buffer {
 	u8 ion_cachesync;
 	u8 ion_mmap;
 	u8 iommu_map;
+	u8 cpu_access; /* VIO_CPU_ACCESS_* */
+	u8 cpu_owned; /* cpu may hold dirty or stale cache lines */
+	u32 roi_y;
+	u32 roi_height;
 	struct vbuf_group_info group_info;
 	u32 iommu_paddr[HBN_LAYER_MAXIMUM][VIO_BUFFER_MAX_PLANES];
 	void *metadata;
 	void *ion_priv;
 };
 
+struct vio_buf_pool_stats {
+	u64 hit;
+	u64 miss;
+	u64 evict;
+	u32 entries;
+	size_t resident;
+};
+
 s32 vio_ion_create(void);
 void vio_ion_destroy(void);
 s32 vio_ion_alloc(struct vio_buffer *vbuf);
 void vio_ion_free(struct vio_buffer *vbuf);
-void vio_ion_sync_for_device(const struct vio_buffer *vbuf);
-void vio_ion_sync_for_cpu(const struct vio_buffer *vbuf);
+size_t vio_ion_sync_for_device(const struct vio_buffer *vbuf);
+size_t vio_ion_sync_for_cpu(const struct vio_buffer *vbuf);
+size_t vio_ion_sync_size(const struct vio_buffer *vbuf);
+u8 vio_ion_cpu_access(s64 flags);
 s32 vio_iommu_map(void *iommu_dev, struct vio_buffer *vbuf);
 void vio_iommu_unmap(void *iommu_dev, struct vio_buffer *vbuf);
 s32 vio_handle_ext_buffer(struct vio_buffer *vbuf, s32 *ion_id);
+struct dma_buf *vio_ion_export_dmabuf(u32 dev_num, s32 share_id);
+s32 vio_buf_pool_get(struct vio_buffer *vbuf, void *iommu_dev);
+s32 vio_buf_pool_put(struct vio_buffer *vbuf, void *iommu_dev, size_t limit);
+void vio_buf_pool_flush(void *iommu_dev);
+void vio_buf_pool_get_stats(struct vio_buf_pool_stats *stats);
 
 #endif
@@ -38,6 +38,7 @@
 s32 vio_fill_metadata(u32 flow_id, void *metadata, void *itemdata, u32 size, u8 tag, u8 idx)
 {
 	s32 ret = 0;
+	s32 published;
 	u32 new_offset = 0;
 	const u32 alignment_size = 4;
 	u32 temp_offset = 0;
@@ -53,22 +54,31 @@ s32 vio_fill_metadata(u32 flow_id, void *metadata, void *itemdata, u32 size, u8
 
 	// alignment 4
 	temp_size = (size + alignment_size - 1) & (~(alignment_size - 1));
+	/* slots of the mapped ring are published through the slot sequence */
+	published = vio_metadata_write_begin(flow_id, metadata);
+	if (published == -ENOENT) {
+		vio_warn("S%d %s: frame id %d, slot is reclaimed\n", flow_id, __func__, meta_header->frame_id);
+		return published;
+	}
 	temp_offset = osal_atomic_read(&meta_header->offset);
 	#ifndef HOBOT_MCU_CAMSYS
 	do {
 		new_offset = temp_offset + temp_size + sizeof(struct item_header_s);
-		if (new_offset >= METADATA_SIZE) {
+		if (new_offset >= METADATA_SIZE)
 			return -EINVAL;
-		}
 	} while(!atomic_try_cmpxchg(&meta_header->offset, &temp_offset, new_offset));
 	#endif
 	item_header = (struct item_header_s *)(metadata + new_offset - temp_size - sizeof(struct item_header_s));
-	item_header->magic = METADATA_ITEM_MAGIC;
 	item_header->size = temp_size + sizeof(struct item_header_s);
 	item_header->tag = tag;
 	item_header->idx = idx;
 	temp_ptr = metadata + new_offset - temp_size;
 	(void)memcpy(temp_ptr, itemdata, size);
+	/* readers take the item once they see the magic, so it goes last */
+	smp_store_release(&item_header->magic, METADATA_ITEM_MAGIC);
+
+	if (published == 0)
+		vio_metadata_write_end(flow_id, metadata);
 
 	return ret;
 }
@@ -142,8 +152,10 @@ void *vio_analysis_metadata(u32 flow_id, void *metadata, u8 tag, u8 idx)
 
 	while (temp_offset < osal_atomic_read(&meta_header->offset)) {
 		item_header = (struct item_header_s *)(metadata + temp_offset);
-		if ((tag == item_header->tag) && (idx == item_header->idx) &&
-				(METADATA_ITEM_MAGIC == item_header->magic)) {
+		/* an item without magic is still being filled, its size is not valid yet */
+		if (smp_load_acquire(&item_header->magic) != METADATA_ITEM_MAGIC)
+			break;
+		if ((tag == item_header->tag) && (idx == item_header->idx)) {
 			ret_buf = (void *)item_header + sizeof(struct item_header_s);
 			break;
 		}
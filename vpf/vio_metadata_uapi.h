@@ -0,0 +1,37 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _UAPI_VIO_METADATA_H_
+#define _UAPI_VIO_METADATA_H_
+
+#include <linux/types.h>
+
+#define VIO_METADATA_SLOT_NUM	10
+
+/*
+ * slot word of metadata ring: frame_id in high 32 bits, sequence in low 32 bits.
+ * sequence 0 means never used, odd means the slot is being reclaimed for a
+ * newer frame, every item published into the slot moves it on by 2.
+ */
+#define META_WORD(frame_id, seq) ((__s64)(((__u64)(frame_id) << 32) | (__u32)(seq)))
+#define META_WORD_FRAMEID(word) ((__u32)((__u64)(word) >> 32))
+#define META_WORD_SEQ(word) ((__u32)(word))
+
+/**
+ * @struct vio_metadata_ctrl
+ * @brief Control page in front of metadata slots, mapped read-only to user space
+ * together with the slots. User space reads a slot like a seqcount: read the
+ * slot word, skip it if the sequence is odd, copy the slot, then read the word
+ * again and retry if the frame id changed. Items are walked up to the header
+ * offset, the magic of an item is loaded with acquire semantics before the rest
+ * of it, and the walk stops at the first item whose magic is not set yet, that
+ * item is still being written. The kernel stores the magic last.
+ * @NO{S09E05C01}
+ */
+struct vio_metadata_ctrl {
+	__u32 slot_num;
+	__u32 slot_size;
+	__u32 data_offset; /* offset of slot 0 from the start of the mapping */
+	__u32 reserved;
+	__s64 slot_word[VIO_METADATA_SLOT_NUM];
+};
+
+#endif /* _UAPI_VIO_METADATA_H_ */
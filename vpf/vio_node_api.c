@@ -62,6 +62,10 @@ void vio_vnode_init(struct vio_node *vnode)
 		vnode->head = vnode;
 		osal_atomic_set(&vnode->rcount, 0);
 		osal_atomic_set(&vnode->start_cnt, 0);
+		vnode->sched_prio = GTASK_DEFAULT_PRIO;
+		vnode->sched_fps = 0;
+		vnode->sched_period_ns = 0;
+		(void)memset(&vnode->sstats, 0, sizeof(struct vio_sched_stats));
 		(void)memset(&vnode->frameid, 0, sizeof(struct frame_id_desc));
 		osal_spin_init(&vnode->slock);/*PRQA S 3334*/
 	}
@@ -86,6 +90,7 @@ void vio_vnode_init(struct vio_node *vnode)
 s32 vio_group_task_start(struct vio_group_task *gtask)
 {
 	s32 ret = 0;
+	u32 i;
 
 	if (IS_ERR_OR_NULL((void *)gtask)) {
 		vio_err("%s: group_task = 0x%p\n", __func__, gtask);
@@ -96,10 +101,15 @@ s32 vio_group_task_start(struct vio_group_task *gtask)
 		return ret;
 
 	gtask->hw_resource_en = 1;
-	gtask->sched_mode = GTASK_ROLL_SCHED;
+	/* keep the mode selected by vio_group_set_sched before start */
+	if (gtask->sched_set == 0)
+		gtask->sched_mode = GTASK_ROLL_SCHED;
 	gtask->rcount = 0;
+	gtask->prio_mask = 0;
 	osal_spin_init(&gtask->slock);/*PRQA S 3334*/
 	osal_list_head_init(&gtask->list);
+	for (i = 0; i < GTASK_PRIO_NUM; i++)
+		osal_list_head_init(&gtask->prio_list[i]);
 	osal_set_bit((s32)VIO_GTASK_START, &gtask->state);
 	vio_info("[%s] %s: sched_mode %d\n", gtask->name, __func__, gtask->sched_mode);
 
@@ -134,9 +144,10 @@ s32 vio_group_task_stop(struct vio_group_task *gtask)
 			osal_atomic_dec_return(&gtask->refcount) > 0)
 		return ret;
 
-	if (osal_list_empty(&gtask->list) == 0)
+	if (osal_list_empty(&gtask->list) == 0 || gtask->prio_mask != 0)
 		vio_err("%s: work list is not empty, please check\n", __func__);
 
+	gtask->sched_set = 0;
 	osal_clear_bit((s32)VIO_GTASK_START, &gtask->state);
 	vio_info("[%s] %s: done\n", gtask->name, __func__);
 
@@ -148,6 +159,13 @@ static struct vio_frame *vpf_get_sched_work(struct vio_group_task *gtask)
 {
 	struct vio_frame *frame, *tmp;
 	struct vio_node *vnode;
+	u32 prio;
+
+	if (gtask->sched_mode == GTASK_DEADLINE_SCHED) {
+		/* highest non-empty priority, earliest deadline is at the head */
+		prio = (u32)__ffs(gtask->prio_mask);
+		return osal_list_first_entry(&gtask->prio_list[prio], struct vio_frame, work_list);
+	}
 
 	frame = osal_list_first_entry(&gtask->list, struct vio_frame, work_list);
 	if (gtask->sched_mode == GTASK_ROLL_SCHED) {
@@ -163,6 +181,31 @@ static struct vio_frame *vpf_get_sched_work(struct vio_group_task *gtask)
 	return frame;
 }
 
+static void vpf_del_sched_work(struct vio_group_task *gtask, struct vio_frame *frame)
+{
+	osal_list_del(&frame->work_list);
+	if (gtask->sched_mode == GTASK_DEADLINE_SCHED &&
+		osal_list_empty(&gtask->prio_list[frame->sched_prio]) != 0)
+		gtask->prio_mask &= ~(1u << frame->sched_prio);
+}
+
+static void vpf_sched_stats_update(struct vio_node *vnode, const struct vio_frame *frame)
+{
+	u64 now, wait;
+	struct vio_sched_stats *sstats;
+
+	sstats = &vnode->sstats;
+	now = osal_time_get_ns();
+	wait = now - frame->queue_ns;
+	sstats->sched_count++;
+	sstats->total_wait_ns += wait;
+	sstats->last_wait_ns = wait;
+	if (wait > sstats->max_wait_ns)
+		sstats->max_wait_ns = wait;
+	if (now > frame->deadline_ns)
+		sstats->miss_count++;
+}
+
 static struct vio_node *vpf_get_ready_vnode(struct vio_group_task *gtask,
 	struct frame_id_desc *frameid)
 {
@@ -177,9 +220,10 @@ static struct vio_node *vpf_get_ready_vnode(struct vio_group_task *gtask,
 	}
 
 	frame = vpf_get_sched_work(gtask);
-	osal_list_del(&frame->work_list);
+	vpf_del_sched_work(gtask, frame);
 	frame->work_queued = 0;
 	vnode = frame->vnode;
+	vpf_sched_stats_update(vnode, frame);
 	osal_set_bit((s32)VIO_NODE_SHOT, &vnode->state);
 	osal_set_bit((s32)VIO_GTASK_SHOT, &gtask->state);
 	gtask->hw_resource_en = 0;
@@ -210,6 +254,7 @@ static void vio_update_hw_config(struct vio_group_task *gtask)
 			vnode = vnode->next;
 		}
 		vio_dbg("[S%d][%s]%s #2\n", leader->flow_id, leader->name, __func__);/*PRQA S 0685,1294*/
+		vio_hw_util_event(leader->id, leader->hw_id, VIO_UTIL_SRC_GTASK, 1u);
 		leader->frame_work(leader);
 	}
 }
@@ -240,6 +285,49 @@ static void vpf_fifo_sched_work(struct vio_group_task *gtask, struct vio_frame *
 {
 	osal_list_add_tail(&frame->work_list, &gtask->list);
 }
+
+static void vpf_deadline_sched_work(struct vio_group_task *gtask, struct vio_frame *frame)
+{
+	u8 queued = 0;
+	struct vio_frame *tmp;
+	osal_list_head_t *head;
+
+	/* deadlines of one context grow monotonically, so the walk usually stops at the tail */
+	head = &gtask->prio_list[frame->sched_prio];
+	osal_list_for_each_entry_reverse(tmp, head, work_list) {/*PRQA S 2810,0497*/
+		if (tmp->deadline_ns <= frame->deadline_ns) {
+			osal_list_add(&frame->work_list, &tmp->work_list);
+			queued = 1;
+			break;
+		}
+	}
+
+	if (queued == 0)
+		osal_list_add(&frame->work_list, head);
+	gtask->prio_mask |= 1u << frame->sched_prio;
+}
+
+/* called with gtask->slock held */
+static void vpf_queue_sched_work(struct vio_group_task *gtask, struct vio_node *vnode,
+	struct vio_frame *frame)
+{
+	osal_atomic_inc(&vnode->rcount);
+	gtask->rcount++;
+	frame->work_queued = 1;
+	frame->sched_prio = vnode->sched_prio;
+	frame->queue_ns = osal_time_get_ns();
+	if (vnode->sched_period_ns != 0)
+		frame->deadline_ns = frame->queue_ns + vnode->sched_period_ns;
+	else
+		frame->deadline_ns = GTASK_NO_DEADLINE;
+
+	if (gtask->sched_mode == GTASK_ROLL_SCHED)
+		vpf_roll_sched_work(gtask, frame);
+	else if (gtask->sched_mode == GTASK_DEADLINE_SCHED)
+		vpf_deadline_sched_work(gtask, frame);
+	else
+		vpf_fifo_sched_work(gtask, frame);
+}
 /**
  * @NO{S09E05C01}
  * @ASIL{B}
@@ -267,15 +355,8 @@ void vio_group_start_trigger(struct vio_node *vnode, struct vio_frame *frame)
 
 	gtask = vnode->gtask;
 	vio_e_barrier_irqs(gtask, flags);/*PRQA S 2996*/
-	if (osal_test_bit((s32)VIO_NODE_START, &vnode->state) != 0) {
-		osal_atomic_inc(&vnode->rcount);
-		gtask->rcount++;
-		frame->work_queued = 1;
-		if (gtask->sched_mode == GTASK_ROLL_SCHED)
-			vpf_roll_sched_work(gtask, frame);
-		else
-			vpf_fifo_sched_work(gtask, frame);
-	}
+	if (osal_test_bit((s32)VIO_NODE_START, &vnode->state) != 0)
+		vpf_queue_sched_work(gtask, vnode, frame);
 	vio_x_barrier_irqr(gtask, flags);/*PRQA S 2996*/
 
 	vio_update_hw_config(gtask);
@@ -284,6 +365,51 @@ void vio_group_start_trigger(struct vio_node *vnode, struct vio_frame *frame)
 }
 EXPORT_SYMBOL(vio_group_start_trigger);/*PRQA S 0605,0307*/
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Queue several frames of one context into worker queue in a single
+ * critical section, then start the first one if the hardware is free;
+ * @param[in] *vnode: point to struct vio_node instance;
+ * @param[in] **frames: array of struct vio_frame pointers;
+ * @param[in] count: number of frames;
+ * @retval None
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void vio_group_start_trigger_batch(struct vio_node *vnode, struct vio_frame **frames, u32 count)
+{
+	u32 i;
+	u64 flags = 0;
+	struct vio_group_task *gtask;
+
+	if (vnode == NULL || frames == NULL) {
+		vio_err("%s: vnode is 0x%p and frames is 0x%p\n", __func__, vnode, frames);
+		return;
+	}
+
+	if (count == 0)
+		return;
+
+	gtask = vnode->gtask;
+	vio_e_barrier_irqs(gtask, flags);/*PRQA S 2996*/
+	if (osal_test_bit((s32)VIO_NODE_START, &vnode->state) != 0) {
+		for (i = 0; i < count; i++)
+			vpf_queue_sched_work(gtask, vnode, frames[i]);
+	}
+	vio_x_barrier_irqr(gtask, flags);/*PRQA S 2996*/
+
+	vio_update_hw_config(gtask);
+
+	vio_dbg("[S%d][%s] %s: count %d\n", vnode->flow_id, vnode->name, __func__, count);
+}
+EXPORT_SYMBOL(vio_group_start_trigger_batch);/*PRQA S 0605,0307*/
+
 void vio_group_cancel_work(struct vio_node *vnode, struct vio_frame *frame)
 {
 	u64 flags = 0;
@@ -293,13 +419,111 @@ void vio_group_cancel_work(struct vio_node *vnode, struct vio_frame *frame)
 	vio_e_barrier_irqs(gtask, flags);/*PRQA S 2996*/
 	if (frame->work_queued == 1) {
 		osal_atomic_dec(&vnode->rcount);
-		osal_list_del(&frame->work_list);
+		vpf_del_sched_work(gtask, frame);
 		gtask->rcount--;
 		frame->work_queued = 0;
 	}
 	vio_x_barrier_irqr(gtask, flags);/*PRQA S 2996*/
 }
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Set scheduling mode of gtask and priority/fps of one context;
+ * The mode can only be switched while gtask has no pending work;
+ * @param[in] *vnode: point to struct vio_node instance;
+ * @param[in] *attr: point to struct vio_sched_attr instance;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_group_set_sched(struct vio_node *vnode, const struct vio_sched_attr *attr)
+{
+	u64 flags = 0;
+	s32 ret = 0;
+	struct vio_group_task *gtask;
+
+	gtask = vnode->gtask;
+	if (gtask == NULL) {
+		vio_err("[%s] %s: gtask is null\n", vnode->name, __func__);
+		return -EINVAL;
+	}
+
+	vpf_param_range_check(attr->sched_mode, GTASK_FIFO_SCHED, GTASK_DEADLINE_SCHED);
+	vpf_param_range_check(attr->priority, 0u, GTASK_PRIO_NUM - 1u);
+	vpf_param_range_check(attr->fps, 0u, GTASK_MAX_FPS);
+
+	if (osal_test_bit((s32)VIO_GTASK_START, &gtask->state) == 0) {
+		gtask->sched_mode = (u8)attr->sched_mode;
+		gtask->sched_set = 1;
+	} else {
+		vio_e_barrier_irqs(gtask, flags);/*PRQA S 2996*/
+		if (gtask->sched_mode != attr->sched_mode) {
+			if (gtask->rcount == 0)
+				gtask->sched_mode = (u8)attr->sched_mode;
+			else
+				ret = -EBUSY;
+		}
+		vio_x_barrier_irqr(gtask, flags);/*PRQA S 2996*/
+		if (ret < 0) {
+			vio_err("[%s] %s: gtask is busy, rcount %d\n", vnode->name, __func__, gtask->rcount);
+			return ret;
+		}
+	}
+
+	/* frames already queued keep the priority they were queued with */
+	vnode->sched_prio = (u8)attr->priority;
+	vnode->sched_fps = attr->fps;
+	if (attr->fps != 0)
+		vnode->sched_period_ns = 1000000000ULL / attr->fps;
+	else
+		vnode->sched_period_ns = 0;
+
+	vio_info("[%s][C%d] %s: mode %d prio %d fps %d\n", vnode->name, vnode->ctx_id, __func__,
+		gtask->sched_mode, attr->priority, attr->fps);
+
+	return ret;
+}
+EXPORT_SYMBOL(vio_group_set_sched);/*PRQA S 0605,0307*/
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Get scheduling statistics of one context;
+ * @param[in] *vnode: point to struct vio_node instance;
+ * @param[out] *sstats: point to struct vio_sched_stats instance;
+ * @retval None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void vio_group_get_sched_stats(struct vio_node *vnode, struct vio_sched_stats *sstats)
+{
+	u64 flags = 0;
+	struct vio_group_task *gtask;
+
+	gtask = vnode->gtask;
+	if (osal_test_bit((s32)VIO_GTASK_START, &gtask->state) != 0) {
+		vio_e_barrier_irqs(gtask, flags);/*PRQA S 2996*/
+		(void)memcpy(sstats, &vnode->sstats, sizeof(struct vio_sched_stats));
+		vio_x_barrier_irqr(gtask, flags);/*PRQA S 2996*/
+	} else {
+		(void)memcpy(sstats, &vnode->sstats, sizeof(struct vio_sched_stats));
+	}
+	sstats->sched_mode = gtask->sched_mode;
+	sstats->priority = vnode->sched_prio;
+	sstats->fps = vnode->sched_fps;
+}
+
 static void vpf_clear_done_flag(struct vio_node *vnode_leader)
 {
 	struct vio_node *next_vnode;
@@ -331,6 +555,7 @@ void vio_set_hw_free(struct vio_node *vnode)
 	struct vio_group_task *gtask;
 	struct vio_node *vnode_leader;
 	struct vio_node *next_vnode;
+	u32 hw_done = 0;
 
 	if (vnode == NULL) {
 		vio_err("%s: vnode is NULL\n", __func__);
@@ -356,9 +581,12 @@ void vio_set_hw_free(struct vio_node *vnode)
 		if (next_vnode == NULL || next_vnode->leader == 1) {
 			gtask->hw_resource_en = 1;
 			vpf_clear_done_flag(vnode_leader);
+			hw_done = 1;
 		}
 	} while (next_vnode != NULL && next_vnode->leader == 0);
 	vio_x_barrier_irqr(gtask, flags);/*PRQA S 2996*/
+	if (hw_done != 0u)
+		vio_hw_util_event(vnode_leader->id, vnode_leader->hw_id, VIO_UTIL_SRC_GTASK, 0u);
 	vio_dbg("[%s][S%d] %s: %s up hw_resource %d\n",
 		vnode->name, vnode->flow_id, __func__,
 		vnode_leader->name, gtask->hw_resource_en);
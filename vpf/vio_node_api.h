@@ -59,6 +59,12 @@
 
 #define GTASK_FIFO_SCHED 0
 #define GTASK_ROLL_SCHED 1
+#define GTASK_DEADLINE_SCHED 2
+
+#define GTASK_PRIO_NUM 4u /* 0 is the highest priority */
+#define GTASK_DEFAULT_PRIO (GTASK_PRIO_NUM - 1u)
+#define GTASK_MAX_FPS 240u
+#define GTASK_NO_DEADLINE (~0ULL)
 
 #define vio_e_barrier_irqs(this, flag)	osal_spin_lock_irqsave(&this->slock, &flag)
 #define vio_x_barrier_irqr(this, flag)	osal_spin_unlock_irqrestore(&this->slock, &flag)
@@ -229,6 +235,7 @@ struct vio_subdev {
 	u8 leader;
 	u8 reqbuf_flag;
 	u8 pingpong_ring;
+	u8 ring_capable; /* frames complete only via vio_frame_done(), COMPLETE queue never peeked */
 	u32 crc_value[VIO_BUFFER_MAX_PLANES];
 	u32 threshold_time;
 
@@ -262,10 +269,15 @@ struct vio_group_task {
 
 	u8 no_worker;
 	u8 sched_mode;
+	u8 sched_set; /* sched_mode is set by user before start */
 	u8 last_work;
 	u8 hw_resource_en;
 	osal_list_head_t list;
 	u32 rcount; /* request count */
+
+	/* GTASK_DEADLINE_SCHED: one queue per priority, each ordered by deadline */
+	osal_list_head_t prio_list[GTASK_PRIO_NUM];
+	u32 prio_mask; /* bit n is set when prio_list[n] is not empty */
 };
 
 /**
@@ -298,6 +310,16 @@ struct vio_node {
 	struct vio_group_task *gtask;
 	u8 path_print;
 
+	/* scheduling attribute and statistics, protected by gtask->slock */
+	u8 sched_prio;
+	u32 sched_fps;
+	u64 sched_period_ns;
+	struct vio_sched_stats sstats;
+
+	/* cache maintenance of driver-allocated buffers, done and elided */
+	atomic64_t cache_flush_bytes;
+	atomic64_t cache_skip_bytes;
+
 	u8 no_online_support;
 	osal_atomic_t start_cnt; /* resource count */
 	void (*frame_work)(struct vio_node *vnode);
@@ -345,7 +367,10 @@ void vio_vnode_init(struct vio_node *vnode);
 s32 vio_group_task_start(struct vio_group_task *group_task);
 s32 vio_group_task_stop(struct vio_group_task *group_task);
 void vio_group_start_trigger(struct vio_node *vnode, struct vio_frame *frame);
+void vio_group_start_trigger_batch(struct vio_node *vnode, struct vio_frame **frames, u32 count);
 void vio_group_cancel_work(struct vio_node *vnode, struct vio_frame *frame);
+s32 vio_group_set_sched(struct vio_node *vnode, const struct vio_sched_attr *attr);
+void vio_group_get_sched_stats(struct vio_node *vnode, struct vio_sched_stats *sstats);
 
 void vio_get_frame_id(struct vio_node *vnode);
 void vio_get_frame_id_by_flowid(u32 flow_id, struct frame_id_desc *frameid);
@@ -354,6 +379,8 @@ void vio_reset_module(u32 module, u32 cfg);
 void vio_set_hw_free(struct vio_node *vnode);
 
 s32 vio_subdev_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo);
+s32 vio_subdev_qbuf_batch(struct vio_subdev *vdev, const struct frame_info *frameinfo,
+	u32 count, u32 *queued);
 s32 vio_subdev_dqbuf(struct vio_subdev *vdev, struct frame_info *frameinfo);
 s32 vio_push_buf_to_next(struct vio_subdev *vdev);
 s32 vio_return_buf_to_prev(struct vio_subdev *vdev);
@@ -363,6 +390,9 @@ struct vio_node *vio_get_vnode(u32 flow_id, u32 module_id);
 s32 vio_check_drop_info(u32 flow_id, u32 frame_id);
 void vio_set_drop_info(u32 flow_id, u32 frame_id);
 void *vio_get_metadata(u32 flow_id, u32 frame_id);
+s32 vio_copy_metadata(u32 flow_id, u32 frame_id, void *dst);
+s32 vio_metadata_write_begin(u32 flow_id, void *metadata);
+void vio_metadata_write_end(u32 flow_id, void *metadata);
 
 void vio_frame_done(struct vio_subdev *vdev);
 void vio_frame_ndone(struct vio_subdev *vdev);
@@ -17,11 +17,10 @@
 /**
  * @NO{S09E05C01}
  * @ASIL{B}
- * @brief: Queue frame buffer into request queue;
- * @param[in] *vdev: point to struct vio_subdev instance;
- * @param[in] *frameinfo: point to struct frame_info instance;
- * @retval "= 0": failure
- * @retval "> 0": success
+ * @brief: Drop one dispatch reference of frame;
+ * @param[in] *framemgr: point to struct vio_framemgr instance;
+ * @param[in] *frame: point to struct vio_frame instance;
+ * @retval remaining dispatch count
  * @param[out] None
  * @data_read None
  * @data_updated None
@@ -30,20 +29,37 @@
  * @callergraph
  * @design
  */
-s32 vio_subdev_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
+static u16 vio_frame_put_dispatch(struct vio_framemgr *framemgr, struct vio_frame *frame)
+{
+	u16 dispatch_cnt;
+	u64 flags = 0;
+
+	/* ring mode has a single user thread, dispatch_cnt is not shared */
+	if (framemgr->ring_mode != 0u) {
+		if (frame->dispatch_cnt > 0u)
+			frame->dispatch_cnt--;
+		return frame->dispatch_cnt;
+	}
+
+	vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
+	if (frame->dispatch_cnt > 0u)
+		frame->dispatch_cnt--;
+	dispatch_cnt = frame->dispatch_cnt;
+	vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
+
+	return dispatch_cnt;
+}
+
+static s32 vio_subdev_qbuf_prepare(struct vio_subdev *vdev, const struct frame_info *frameinfo,
+	struct vio_frame **out)
 {
 	s32 ret = 0;
 	u32 index;
-	u64 flags = 0;
 	struct vio_framemgr *framemgr;
 	struct vio_frame *frame;
 	struct vio_node *vnode;
 
-	if (vdev == NULL || frameinfo == NULL) {
-		vio_err("%s: vdev is 0x%p and frameinfo is 0x%p\n", __func__, vdev, frameinfo);
-		return -EINVAL;
-	}
-
+	*out = NULL;
 	index = (u32)frameinfo->bufferindex;
 	framemgr = vdev->cur_fmgr;
 	vnode = vdev->vnode;
@@ -55,17 +71,11 @@ s32 vio_subdev_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 	}
 
 	frame = &framemgr->frames[index];
-	vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
-	if (frame->dispatch_cnt > 0)
-		frame->dispatch_cnt--;
-
-	if (frame->dispatch_cnt > 0u) {
-		vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
+	if (vio_frame_put_dispatch(framemgr, frame) > 0u)
 		return ret;
-	}
-	vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
 
-	if ((frame->state == FS_FREE) || (frame->state == FS_USED)) {
+	if (((frame->state == FS_FREE) || (frame->state == FS_USED)) &&
+			frame->ring_pending == 0u) {
 		if (frame->frameinfo.ion_id[0] != frameinfo->ion_id[0])
 			frame->buf_shared = 0;
 		(void)memcpy(&frame->frameinfo, frameinfo, sizeof(struct frame_info));
@@ -81,10 +91,6 @@ s32 vio_subdev_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 		}
 
 		vio_frame_sync_for_device(frame);
-
-		vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
-		trans_frame(framemgr, frame, FS_REQUEST);
-		vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
 	} else {
 		vio_err("[%s][S%d][F%d] %s: invalid frame state(%d)\n", vdev->name, vnode->flow_id,
 			index, __func__, frame->state);
@@ -92,6 +98,57 @@ s32 vio_subdev_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 		return -EINVAL;
 	}
 
+	*out = frame;
+
+	return ret;
+}
+
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Queue frame buffer into request queue;
+ * @param[in] *vdev: point to struct vio_subdev instance;
+ * @param[in] *frameinfo: point to struct frame_info instance;
+ * @retval "= 0": failure
+ * @retval "> 0": success
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_subdev_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
+{
+	s32 ret = 0;
+	u64 flags = 0;
+	struct vio_framemgr *framemgr;
+	struct vio_frame *frame;
+	struct vio_node *vnode;
+
+	if (vdev == NULL || frameinfo == NULL) {
+		vio_err("%s: vdev is 0x%p and frameinfo is 0x%p\n", __func__, vdev, frameinfo);
+		return -EINVAL;
+	}
+
+	framemgr = vdev->cur_fmgr;
+	vnode = vdev->vnode;
+
+	ret = vio_subdev_qbuf_prepare(vdev, frameinfo, &frame);
+	if (ret < 0 || frame == NULL)
+		return ret;
+
+	if (framemgr->ring_mode != 0u) {
+		ret = frame_ring_qbuf(framemgr, frame);
+		if (ret < 0)
+			return ret;
+	} else {
+		vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
+		trans_frame(framemgr, frame, FS_REQUEST);
+		vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
+	}
+
 	if (vdev->vdev_work != NULL)
 		vdev->vdev_work(vdev, frame);
 
@@ -100,12 +157,120 @@ s32 vio_subdev_qbuf(struct vio_subdev *vdev, const struct frame_info *frameinfo)
 
 	vio_dbg("[%s][S%d][F%d] %s: internal_buf %d\n",
 		vdev->name, vnode->flow_id,/*PRQA S 0685,1294*/
-		index, __func__, frame->internal_buf);
+		frame->index, __func__, frame->internal_buf);
 
 	return ret;
 }
 EXPORT_SYMBOL(vio_subdev_qbuf);
 
+/**
+ * @NO{S09E05C01}
+ * @ASIL{B}
+ * @brief: Queue several frame buffers of one context into request queue,
+ * taking framemgr and gtask locks once for the whole batch;
+ * A batch naming one buffer index twice is rejected before anything is queued;
+ * Frames prepared before a failing entry are still queued;
+ * @param[in] *vdev: point to struct vio_subdev instance;
+ * @param[in] *frameinfo: array of struct frame_info;
+ * @param[in] count: number of entries, at most VIO_QBUF_BATCH_MAX;
+ * @retval "= 0": success
+ * @retval "< 0": failure
+ * @param[out] *queued: number of entries accepted
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+s32 vio_subdev_qbuf_batch(struct vio_subdev *vdev, const struct frame_info *frameinfo,
+	u32 count, u32 *queued)
+{
+	s32 ret = 0;
+	u32 i, num = 0, accepted = 0;
+	u64 flags = 0;
+	struct vio_framemgr *framemgr;
+	struct vio_frame *frames[VIO_QBUF_BATCH_MAX];
+	u32 entry[VIO_QBUF_BATCH_MAX];
+	unsigned long *seen;
+	struct vio_frame *frame;
+	struct vio_node *vnode;
+
+	if (vdev == NULL || frameinfo == NULL || queued == NULL) {
+		vio_err("%s: vdev is 0x%p and frameinfo is 0x%p\n", __func__, vdev, frameinfo);
+		return -EINVAL;
+	}
+
+	*queued = 0;
+	if (count == 0 || count > VIO_QBUF_BATCH_MAX) {
+		vio_err("[%s] %s: wrong count(%d)\n", vdev->name, __func__, count);
+		return -EINVAL;
+	}
+
+	framemgr = vdev->cur_fmgr;
+	vnode = vdev->vnode;
+
+	seen = (unsigned long *)osal_kzalloc(sizeof(unsigned long) * BITS_TO_LONGS(framemgr->num_frames),
+		GFP_KERNEL);
+	if (seen == NULL)
+		return -ENOMEM;
+	for (i = 0; i < count; i++) {
+		num = (u32)frameinfo[i].bufferindex;
+		/* out of range index is reported by vio_subdev_qbuf_prepare */
+		if (num < framemgr->num_frames && test_and_set_bit(num, seen) != 0) {
+			vio_err("[%s][S%d] %s: duplicate frame index(%d) in batch\n",
+				vdev->name, vnode->flow_id, __func__, num);
+			osal_kfree((void *)seen);
+			return -EINVAL;
+		}
+	}
+	osal_kfree((void *)seen);
+	num = 0;
+
+	for (i = 0; i < count; i++) {
+		ret = vio_subdev_qbuf_prepare(vdev, &frameinfo[i], &frame);
+		if (ret < 0)
+			break;
+		accepted++;
+		if (frame != NULL) {
+			frames[num] = frame;
+			entry[num] = i;
+			num++;
+		}
+	}
+
+	if (framemgr->ring_mode != 0u) {
+		for (i = 0; i < num; i++) {
+			ret = frame_ring_qbuf(framemgr, frames[i]);
+			if (ret < 0) {
+				accepted = entry[i];
+				num = i;
+				break;
+			}
+		}
+	} else {
+		vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
+		for (i = 0; i < num; i++)
+			trans_frame(framemgr, frames[i], FS_REQUEST);
+		vio_x_barrier_irqr(framemgr, flags);/*PRQA S 2996*/
+	}
+
+	if (vdev->vdev_work != NULL) {
+		for (i = 0; i < num; i++)
+			vdev->vdev_work(vdev, frames[i]);
+	}
+
+	if ((vnode->leader == 1u) && (vdev->leader == 1u))
+		vio_group_start_trigger_batch(vnode, frames, num);
+
+	*queued = accepted;
+	vio_dbg("[%s][S%d] %s: queued %d/%d\n", vdev->name, vnode->flow_id,/*PRQA S 0685,1294*/
+		__func__, accepted, count);
+
+	return ret;
+}
+EXPORT_SYMBOL(vio_subdev_qbuf_batch);
+
 /**
  * @NO{S09E05C01}
  * @ASIL{B}
@@ -137,6 +302,17 @@ s32 vio_subdev_dqbuf(struct vio_subdev *vdev, struct frame_info *frameinfo)
 
 	framemgr = vdev->cur_fmgr;
 	vnode = vdev->vnode;
+	frame = frame_ring_dqbuf(framemgr);
+	if (frame != NULL) {
+		frame->dispatch_cnt++;
+		(void)memcpy(&vdev->curinfo, &frame->frameinfo, sizeof(struct frame_info));
+		(void)memcpy(frameinfo, &frame->frameinfo, sizeof(struct frame_info));
+		vio_frame_sync_for_cpu(frame);
+		vio_dbg("[%s][S%d][F%d] %s: ring done\n", vdev->name, vnode->flow_id,/*PRQA S 0685,1294*/
+			frame->index, __func__);
+		return ret;
+	}
+
 	vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
 	frame = peek_frame(framemgr, FS_COMPLETE);
 	if (frame != NULL) {
@@ -299,6 +475,7 @@ void vio_frame_done(struct vio_subdev *vdev)
 	vnode = vdev->vnode;
 	framemgr = vdev->cur_fmgr;
 	vio_e_barrier_irqs(framemgr, flags);
+	frame_ring_drain(framemgr);
 	frame = peek_frame(framemgr, FS_PROCESS);
 	if (frame != NULL) {
 		(void)memcpy(&frame->frameinfo.frameid, &vnode->frameid, sizeof(struct frame_id_desc));
@@ -313,13 +490,17 @@ void vio_frame_done(struct vio_subdev *vdev)
 		} else {
 			event = VIO_FRAME_DONE;
 			frame->frameinfo.frame_done |= FRAME_DONE;
-			trans_frame(framemgr, frame, FS_COMPLETE);
+			if (framemgr->ring_mode != 0u)
+				frame_ring_complete(framemgr, frame);
+			else
+				trans_frame(framemgr, frame, FS_COMPLETE);
 		}
 		vio_x_barrier_irqr(framemgr, flags);
 
 		metadata = vio_get_metadata(vnode->flow_id, vnode->frameid.frame_id);
 		if (metadata != NULL && frame->vbuf.metadata != NULL)
-			memcpy(frame->vbuf.metadata, metadata, METADATA_SIZE);
+			(void)vio_copy_metadata(vnode->flow_id, vnode->frameid.frame_id,
+				frame->vbuf.metadata);
 	} else {
 		vio_x_barrier_irqr(framemgr, flags);
 		event = VIO_FRAME_NDONE;
@@ -448,6 +629,7 @@ void vio_frame_predone(struct vio_subdev *vdev, u32 pre)
 	vnode = vdev->vnode;
 	framemgr = vdev->cur_fmgr;
 	vio_e_barrier_irqs(framemgr, flags);/*PRQA S 2996*/
+	frame_ring_drain(framemgr);
 	frame = peek_frame(framemgr, FS_PROCESS);
 	if (frame != NULL) {
 		memcpy(&frame->frameinfo.frameid, &vnode->frameid, sizeof(struct frame_id_desc));
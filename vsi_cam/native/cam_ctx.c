@@ -119,6 +119,7 @@ void cam_set_stat_info(struct cam_ctx *ctx, u32 type)
 {
 	struct vio_subdev *subdev = (struct vio_subdev *)ctx;
 	struct vio_node *vnode;
+	const struct cam_ops *ops = NULL;
 
 	if (unlikely(!subdev))
 		return;
@@ -131,6 +132,12 @@ void cam_set_stat_info(struct cam_ctx *ctx, u32 type)
 	else if (type == CAM_STAT_FE)
 		vio_set_stat_info(vnode->flow_id, vnode->id, STAT_FE,
 				  vnode->frameid.frame_id);
+
+	if (vnode->id < MODULE_NUM) {
+		ops = get_ops(vnode->id);
+		if (ops && ops->frame_event)
+			ops->frame_event(ctx, type);
+	}
 }
 
 bool cam_osd_update(struct cam_ctx *ctx)
@@ -12,6 +12,7 @@ struct cam_ops {
 	int (*osd_set_cfg)(struct cam_ctx *ctx, u32 ochn_id);
 	int (*read_hist)(struct cam_ctx *ctx, u32 ochn_id);
 	int (*set_mode)(struct cam_ctx *ctx, u32 mode);
+	void (*frame_event)(struct cam_ctx *ctx, u32 type);
 };
 
 int add_ops(u32 id, const struct cam_ops *ops);
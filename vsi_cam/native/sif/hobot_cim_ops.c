@@ -16,6 +16,8 @@
 #include "cam_uapi.h"
 #include "sif.h"
 #include "csi.h"
+#include "hobot_mipi_host.h"
+#include "hobot_mipi_host_ops.h"
 /**
  * Purpose: point to cim device struct
  * Range: 1-5
@@ -1184,3 +1186,39 @@ void cim_frame_work(struct vio_node *vnode)
 	vio_dbg("[S%d][N%d][C%d] %s done \n", vnode->flow_id, vnode->id,
 		vnode->ctx_id, __func__);
 }
+
+/**
+ * @NO{S10E04C01}
+ * @ASIL{B}
+ * @brief: Feed the frame start/end of the sif ipi to the mipi host frame statistics
+ * @param[in] *ctx: sink ctx of the sif ipi, the src subdev of vin_node
+ * @param[in] type: CAM_STAT_FS or CAM_STAT_FE
+ * @retval None
+ * @param[out] None
+ * @data_read None
+ * @data_updated None
+ * @compatibility None
+ * @callgraph
+ * @callergraph
+ * @design
+ */
+void cim_frame_event(struct cam_ctx *ctx, u32 type)
+{
+#ifdef CONFIG_HOBOT_MIPI_HOST
+	struct vio_subdev *vdev = (struct vio_subdev *)ctx;
+	struct vin_node_subdev *subdev;
+	const struct cim_attr *cim_attr;
+
+	if ((vdev == NULL) || (vdev->id != VNODE_ID_SRC))
+		return;
+	subdev = container_of(vdev, struct vin_node_subdev,
+			      vdev); /*PRQA S 2810,0497*/
+	cim_attr = &subdev->vin_attr.vin_node_attr.cim_attr;
+	if ((cim_attr->mipi_en == 0u) || (cim_attr->func.enable_pattern != 0u))
+		return;
+
+	/* irq context: the mipi host takes the timestamp on its own clock */
+	(void)hobot_mipi_host_frame_event_do((int32_t)cim_attr->mipi_rx, cim_attr->vc_index,
+		(type == CAM_STAT_FS) ? MIPIHOST_FRAME_START : MIPIHOST_FRAME_END, 0u);
+#endif
+}
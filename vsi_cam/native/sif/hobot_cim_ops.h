@@ -135,6 +135,8 @@ enum cim_src_type_e {
 	CIM_SRC_PATTERN
 };
 
+struct cam_ctx;
+
 int cim_set_ichn_attr(struct vio_video_ctx *vctx, vin_ichn_attr_t *cim_ichn_attr);
 int cim_set_ochn_buff_attr(struct vio_video_ctx *vctx,
 		vin_ochn_buff_attr_t *cim_ochn_buff_attr);
@@ -158,5 +160,6 @@ s32 cim_isp_update_calib_param(uint32_t flow_id,
 		uint32_t module_type, void *param);
 void cim_config_next_frame_addr(struct vio_node *vnode, u8 chn);
 void cim_frame_work(struct vio_node *vnode);
+void cim_frame_event(struct cam_ctx *ctx, u32 type);
 
 #endif /*HOBOT_CIM_OPS_H*/
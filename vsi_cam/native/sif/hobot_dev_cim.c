@@ -18,6 +18,7 @@
 /* #include "hobot_cim_stl.h" */
 /* #include "hobot_dev_vin_node.h" */
 #include "hobot_dev_cim.h"
+#include "cam_ops.h"
 
 #define SIF_DT_NAME "verisilicon,sif"
 
@@ -539,6 +540,10 @@ struct cim_interface_ops cim_cops = {
 
 DECLARE_VIO_CALLBACK_OPS(cim_interface, 0, &cim_cops);
 
+static const struct cam_ops cim_cam_ops = {
+	.frame_event = cim_frame_event,
+};
+
 #ifdef CIM_ISP_COPS
 static void empty_ipi_lost_fe_state(struct vio_node *vnode)
 {
@@ -916,6 +921,7 @@ static s32 cim_probe(struct platform_device *pdev)
 		vio_get_callback_ops(&g_cim_sensor_cops, VIN_MODULE, COPS_5);
 #endif
 	vio_register_callback_ops(&cb_cim_interface, VIN_MODULE, COPS_0);
+	add_ops(VIN_MODULE, &cim_cam_ops);
 
 	platform_set_drvdata(pdev, (void *)cim);
 	osal_spin_init(&cim->slock);
@@ -990,6 +996,7 @@ static s32 cim_remove(struct platform_device *pdev)
 	device_remove_file(dev, &dev_attr_cim_stat);
 	// devm_free_irq(dev, (u32)cim->irq, cim);
 	devm_kfree(dev, (void *)cim);
+	add_ops(VIN_MODULE, NULL);
 	vio_unregister_callback_ops(VIN_MODULE, COPS_0);
 	vio_unregister_callback_ops(VIN_MODULE, COPS_1);
 	// vio_unregister_callback_ops(VIN_MODULE, COPS_8);
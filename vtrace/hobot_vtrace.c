@@ -8,11 +8,23 @@ static vtrace_ctl_ctx_s g_ctl_ctx = {
 	.ctxid_mask = VTRACE_ALL,
 	.module_mask = VTRACE_ALL,
 	.level = LEVEL1,
+	.mode = VTRACE_MODE_TEXT,
+	.wm = {
+		.bytes = VTRACE_WM_BYTES_DEF,
+		.records = VTRACE_WM_RECS_DEF,
+		.latency_ms = VTRACE_LATENCY_MS_DEF,
+	},
 };
+
+/* size of each per-CPU binary ring in KB, rounded down to a power of 2 records */
+static uint32_t vtrace_ring_kb = VTRACE_BIN_RING_KB_DEF;
+module_param(vtrace_ring_kb, uint, 0444);
+MODULE_PARM_DESC(vtrace_ring_kb, "per-CPU binary trace ring size in KB");
 static char *public_type_name[VTRACE_PUBTYPE_MAX] = VTRACE_PUBLIC_NAME;
 static char *public_test_name[PUBLIC_TEST_PARAM_NUM] = PUBLIC_TEST_PARAM_NAME;
 static char *public_fs_name[PUBLIC_FS_PARAM_NUM] = PUBLIC_FS_PARAM_NAME;
 static char *public_fe_name[PUBLIC_FE_PARAM_NUM] = PUBLIC_FE_PARAM_NAME;
+static char *public_buf_name[PUBLIC_BUF_PARAM_NUM] = PUBLIC_BUF_PARAM_NAME;
 static char *public_drop_name[PUBLIC_DROP_PARAM_NUM] = PUBLIC_DROP_PARAM_NAME;
 static char *module_name[VNODE_ID_MAX] = VTRACE_MODULE_NAME;
 
@@ -149,6 +161,94 @@ static bool vtrace_offres(int32_t *copyto_off, int32_t *full_off,
 	return true;
 }
 
+static inline vtrace_bin_ring_head_s *vtrace_bin_ring(uint32_t cpu)
+{
+	return (vtrace_bin_ring_head_s *)(g_ctx.bin_base + (size_t)cpu * g_ctx.bin_stride);
+}
+
+/**
+ * vtrace_poll_arm() - Start the latency timer for the first pending event.
+ */
+static inline void vtrace_poll_arm(void)
+{
+	if (g_ctl_ctx.wm.latency_ms == 0u)
+		return;
+	if (atomic_cmpxchg(&g_ctx.poll_armed, 0, 1) == 0)
+		mod_timer(&g_ctx.poll_timer,
+			  jiffies + msecs_to_jiffies(g_ctl_ctx.wm.latency_ms));
+}
+
+/**
+ * vtrace_poll_notify() - Wake up the poll reader once the pending data
+ * reaches the watermark, otherwise make sure the latency timer runs.
+ */
+static inline void vtrace_poll_notify(bool over_wm)
+{
+	if (over_wm) {
+		if (wq_has_sleeper(&g_ctx.irq_wait))
+			wake_up(&g_ctx.irq_wait);
+		return;
+	}
+	vtrace_poll_arm();
+}
+
+static void vtrace_poll_timeout(struct timer_list *t)
+{
+	g_ctx.poll_expired = 1;
+	wake_up(&g_ctx.irq_wait);
+}
+
+/**
+ * vtrace_bin_send() - Save one fixed-size record to the ring of this CPU.
+ *
+ * The ring is only written by its own CPU with irq disabled, so the producer
+ * needs no lock; the oldest record is overwritten when the ring is full.
+ */
+static void vtrace_bin_send(uint32_t module_type, uint32_t param_type,
+			    uint32_t *param, uint32_t param_nums, uint64_t ts_ns,
+			    uint32_t flow_id, uint32_t frame_id, uint32_t ctx_id,
+			    uint32_t chnid)
+{
+	vtrace_bin_ring_head_s *ring;
+	vtrace_bin_rec_s *rec;
+	unsigned long flags;
+	uint64_t head, pending;
+	uint32_t i;
+
+	local_irq_save(flags);
+	ring = vtrace_bin_ring(raw_smp_processor_id());
+	head = ring->head;
+	if (head - READ_ONCE(ring->tail) >= g_ctx.bin_rec_num)
+		ring->overwritten++;
+
+	rec = (vtrace_bin_rec_s *)((void *)ring + PAGE_SIZE) +
+		(head & (g_ctx.bin_rec_num - 1u));
+	WRITE_ONCE(rec->seq, VTRACE_BIN_SEQ_BUSY);
+	smp_wmb();
+	rec->ts_ns = ts_ns;
+	rec->frame_id = frame_id;
+	rec->module_type = (uint8_t)module_type;
+	rec->param_type = (uint8_t)param_type;
+	rec->flow_id = (uint8_t)flow_id;
+	rec->ctx_id = (uint8_t)ctx_id;
+	rec->chn_id = (uint8_t)chnid;
+	if (param == NULL)
+		param_nums = 0;
+	param_nums = min(param_nums, VTRACE_BIN_PARAM_MAX);
+	rec->param_nums = (uint8_t)param_nums;
+	for (i = 0; i < param_nums; i++)
+		rec->param[i] = param[i];
+	smp_wmb();
+	WRITE_ONCE(rec->seq, (uint32_t)head);
+	/* publish the record */
+	smp_store_release(&ring->head, head + 1u);
+	pending = head + 1u - READ_ONCE(ring->tail);
+	local_irq_restore(flags);
+
+	g_ctx.new_data_comein = 1;
+	vtrace_poll_notify(pending >= g_ctl_ctx.wm.records);
+}
+
 /**
  * vtrace_send() - Send message to vtrace.
  * @param:  The pointer of data, vtrace just save this message without data if null
@@ -194,6 +294,14 @@ int32_t vtrace_send(uint32_t module_type, uint32_t param_type,
 	if (!vtrace_check_send_valid(module_type, flow_id, ctx_id, zone->level))
 		return 0;
 
+	/* binary mode: user space formats the record */
+	if (g_ctl_ctx.mode == VTRACE_MODE_BIN && g_ctx.bin_base != NULL) {
+		vtrace_bin_send(module_type, param_type, param, zone->param_nums,
+				(uint64_t)timespec64_to_ns(&ts1), flow_id, frame_id,
+				ctx_id, chnid);
+		return 0;
+	}
+
 	if (param_type < VTRACE_PUBTYPE_MAX) {
 		len += snprintf(&tmp_buf[len], VTRACE_SNP_MAX_SIZE, "[%s %s",
 				module_name[module_type], public_type_name[param_type]);
@@ -251,6 +359,7 @@ int32_t vtrace_send(uint32_t module_type, uint32_t param_type,
 	 * otherwhise hal pop will pop the same message
 	 */
 	g_ctx.new_data_comein = 1;
+	vtrace_poll_notify(next_off + len >= g_ctl_ctx.wm.bytes);
 
 	// ktime_get_real_ts64(&ts2);
 	// ts3 = timespec64_sub(ts2,ts1);
@@ -287,6 +396,21 @@ static int vtrace_mmap(struct file *file, struct vm_area_struct *vma)
 	int32_t ret;
 	uint32_t size = vma->vm_end - vma->vm_start;
 
+	if (vma->vm_pgoff >= VTRACE_BIN_MMAP_PGOFF) {
+		if (ctx->bin_base == NULL ||
+		    size > (size_t)nr_cpu_ids * ctx->bin_stride) {
+			vtrace_err("binary ring mmap size %d is invalid\n", size);
+			return -EINVAL;
+		}
+		ret = remap_vmalloc_range(vma, ctx->bin_base,
+					  vma->vm_pgoff - VTRACE_BIN_MMAP_PGOFF);
+		if (ret < 0) {
+			vtrace_err("mmap binary ring 0x%p fail\n", ctx->bin_base);
+			return ret;
+		}
+		return 0;
+	}
+
 	if (size > VTARCE_MEM_SIZE) {
 		vtrace_err("mmap size exceed max size, size = %d.\n", size);
 		return -1;
@@ -309,11 +433,105 @@ static bool check_data_valid(void)
 	return g_ctx.message_valid;
 }
 
+/**
+ * vtrace_pending() - Amount of data not read yet, bytes in text mode,
+ * records of the fullest ring in binary mode.
+ */
+static uint64_t vtrace_pending(void)
+{
+	vtrace_bin_ring_head_s *ring;
+	uint64_t pending, max_pending = 0;
+	uint32_t cpu;
+
+	if (g_ctl_ctx.mode == VTRACE_MODE_BIN && g_ctx.bin_base != NULL) {
+		for_each_possible_cpu(cpu) {
+			ring = vtrace_bin_ring(cpu);
+			pending = smp_load_acquire(&ring->head) - READ_ONCE(ring->tail);
+			max_pending = max(max_pending, pending);
+		}
+		return max_pending;
+	}
+
+	if (!g_ctx.new_data_comein)
+		return 0;
+	/* the whole buffer is pending when the pop has not ended yet */
+	if (g_ctx.halused_mask != 0u)
+		return 0;
+	return (uint64_t)osal_atomic_read(&g_ctx.cur_off);
+}
+
+static __poll_t vtrace_poll(struct file *file, struct poll_table_struct *wait)
+{
+	uint64_t pending, wm;
+	__poll_t mask = 0;
+
+	poll_wait(file, &g_ctx.irq_wait, wait);
+
+	if (check_data_valid())
+		return EPOLLIN | EPOLLRDNORM;
+
+	pending = vtrace_pending();
+	if (pending == 0u) {
+		/* all consumed, the next event starts a new latency window */
+		g_ctx.poll_expired = 0;
+		osal_atomic_set(&g_ctx.poll_armed, 0);
+		return 0;
+	}
+
+	wm = (g_ctl_ctx.mode == VTRACE_MODE_BIN) ? g_ctl_ctx.wm.records : g_ctl_ctx.wm.bytes;
+	if (pending >= wm || g_ctx.poll_expired) {
+		g_ctx.poll_expired = 0;
+		osal_atomic_set(&g_ctx.poll_armed, 0);
+		mask |= EPOLLIN | EPOLLRDNORM;
+	} else {
+		/* data left below watermark after the last read */
+		vtrace_poll_arm();
+	}
+
+	return mask;
+}
+
+static int32_t vtrace_name_get(unsigned long arg)
+{
+	vtrace_name_info_s *info;
+	vtrace_zone_info_s *zone;
+	uint32_t i;
+	int32_t ret = 0;
+
+	info = osal_kzalloc(sizeof(vtrace_name_info_s), OSAL_KMALLOC_KERNEL);
+	if (info == NULL)
+		return -ENOMEM;
+	if (copy_from_user(info, (void __user *)arg, sizeof(vtrace_name_info_s))) {
+		vtrace_err("copy_from_user fail at NAME_GET\n");
+		ret = -EFAULT;
+		goto out;
+	}
+	if (info->module_type >= VNODE_ID_MAX || info->param_type >= VTRACE_PARAM_MAX ||
+	    !g_ctx.buf_head[info->module_type].is_init[info->param_type]) {
+		ret = -ENOENT;
+		goto out;
+	}
+
+	zone = &g_ctx.buf_head[info->module_type].zone[info->param_type];
+	info->param_nums = min(zone->param_nums, VTRACE_BIN_PARAM_MAX);
+	info->level = zone->level;
+	for (i = 0; i < info->param_nums; i++)
+		strscpy(info->name[i], zone->name[i], VTRACE_NAME_LEN_MAX);
+	if (copy_to_user((void __user *)arg, info, sizeof(vtrace_name_info_s))) {
+		vtrace_err("copy_to_user fail at NAME_GET\n");
+		ret = -EFAULT;
+	}
+out:
+	osal_kfree(info);
+	return ret;
+}
+
 static long vtrace_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 {
 	int32_t ret = 0;
 	uint32_t value = 0;
 	uint32_t tmp_off;
+	vtrace_bin_info_s bin_info;
 	vtrace_public_test_s info = {.testinfo = 0};
 	static uint32_t frame_id = 0;
 
@@ -417,6 +635,42 @@ static long vtrace_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 			return -1;
 		}
 		break;
+	case VTRACE_MODE_SET:
+		if (copy_from_user(&value, (void __user *)arg, sizeof(uint32_t))) {
+			vtrace_err("copy_from_user fail at MODE_SET\n");
+			return -EFAULT;
+		}
+		if (value == VTRACE_MODE_BIN && g_ctx.bin_base == NULL)
+			return -ENOMEM;
+		g_ctl_ctx.mode = value ? VTRACE_MODE_BIN : VTRACE_MODE_TEXT;
+		break;
+	case VTRACE_BIN_INFO_GET:
+		if (g_ctx.bin_base == NULL)
+			return -ENOMEM;
+		bin_info.cpu_num = nr_cpu_ids;
+		bin_info.ring_stride = g_ctx.bin_stride;
+		bin_info.rec_size = sizeof(vtrace_bin_rec_s);
+		bin_info.rec_num = g_ctx.bin_rec_num;
+		bin_info.mmap_offset = VTRACE_BIN_MMAP_OFFSET;
+		if (copy_to_user((void __user *)arg, &bin_info, sizeof(bin_info))) {
+			vtrace_err("copy_to_user fail at BIN_INFO_GET\n");
+			return -EFAULT;
+		}
+		break;
+	case VTRACE_NAME_GET:
+		ret = vtrace_name_get(arg);
+		break;
+	case VTRACE_WATERMARK_SET:
+		if (copy_from_user(&g_ctl_ctx.wm, (void __user *)arg,
+				   sizeof(vtrace_watermark_s))) {
+			vtrace_err("copy_from_user fail at WATERMARK_SET\n");
+			return -EFAULT;
+		}
+		/* apply the new latency from the next event on */
+		del_timer(&g_ctx.poll_timer);
+		osal_atomic_set(&g_ctx.poll_armed, 0);
+		wake_up(&g_ctx.irq_wait);
+		break;
 	case VTRACE_TEST_SEND:
 		// vtrace_send(ISP_MODULE, VTRACE_PUBLIC_TEST,
 		// 	    (uint32_t *)&info, 1, frame_id++, 2, 3);
@@ -435,6 +689,7 @@ static const struct file_operations vtrace_cdev_ops = {
 	.open           = vtrace_open,
 	.release        = vtrace_release,
 	.mmap		= vtrace_mmap,
+	.poll		= vtrace_poll,
 	.unlocked_ioctl = vtrace_ioctl,
 	.compat_ioctl   = vtrace_ioctl,
 };
@@ -566,6 +821,73 @@ static ssize_t err_cnt_show(struct device *dev, struct device_attribute *attr,
 }
 static DEVICE_ATTR(err_cnt, S_IRUGO, err_cnt_show, NULL);
 
+static ssize_t mode_show(struct device *dev, struct device_attribute *attr,
+			 char *buf)
+{
+	return snprintf(buf, VTRACE_SYSFS_SIZE_MAX, "%s\n",
+			g_ctl_ctx.mode == VTRACE_MODE_BIN ? "bin" : "text");
+}
+
+static ssize_t mode_store(struct device *dev, struct device_attribute *attr,
+			  const char *buf, size_t len)
+{
+	if (sysfs_streq(buf, "bin") || sysfs_streq(buf, "1")) {
+		if (g_ctx.bin_base == NULL)
+			return -ENOMEM;
+		g_ctl_ctx.mode = VTRACE_MODE_BIN;
+	} else if (sysfs_streq(buf, "text") || sysfs_streq(buf, "0")) {
+		g_ctl_ctx.mode = VTRACE_MODE_TEXT;
+	} else {
+		return -EINVAL;
+	}
+	return len;
+}
+static DEVICE_ATTR(mode, S_IRUGO | S_IWUSR, mode_show, mode_store);
+
+static ssize_t bin_stat_show(struct device *dev, struct device_attribute *attr,
+			     char *buf)
+{
+	vtrace_bin_ring_head_s *ring;
+	ssize_t len = 0;
+	uint32_t cpu;
+
+	if (g_ctx.bin_base == NULL)
+		return snprintf(buf, PAGE_SIZE, "binary ring not allocated\n");
+
+	len += snprintf(&buf[len], PAGE_SIZE - len, "cpu\thead\ttail\toverwritten\n");
+	for_each_possible_cpu(cpu) {
+		ring = vtrace_bin_ring(cpu);
+		len += snprintf(&buf[len], PAGE_SIZE - len, "%u\t%llu\t%llu\t%llu\n",
+				cpu, READ_ONCE(ring->head), READ_ONCE(ring->tail),
+				READ_ONCE(ring->overwritten));
+	}
+	return len;
+}
+static DEVICE_ATTR(bin_stat, S_IRUGO, bin_stat_show, NULL);
+
+static ssize_t watermark_show(struct device *dev, struct device_attribute *attr,
+			      char *buf)
+{
+	return snprintf(buf, VTRACE_SYSFS_SIZE_MAX, "bytes %u records %u latency_ms %u\n",
+			g_ctl_ctx.wm.bytes, g_ctl_ctx.wm.records,
+			g_ctl_ctx.wm.latency_ms);
+}
+
+static ssize_t watermark_store(struct device *dev, struct device_attribute *attr,
+			       const char *buf, size_t len)
+{
+	vtrace_watermark_s wm;
+
+	if (sscanf(buf, "%u %u %u", &wm.bytes, &wm.records, &wm.latency_ms) != 3)
+		return -EINVAL;
+	g_ctl_ctx.wm = wm;
+	del_timer(&g_ctx.poll_timer);
+	osal_atomic_set(&g_ctx.poll_armed, 0);
+	wake_up(&g_ctx.irq_wait);
+	return len;
+}
+static DEVICE_ATTR(watermark, S_IRUGO | S_IWUSR, watermark_show, watermark_store);
+
 static int32_t vtrace_sysfs_create(struct device *dev)
 {
 	// if (device_create_file(dev, &dev_attr_frameinfo))
@@ -582,6 +904,12 @@ static int32_t vtrace_sysfs_create(struct device *dev)
 		return -ENOMEM;
 	if (device_create_file(dev, &dev_attr_err_cnt))
 		return -ENOMEM;
+	if (device_create_file(dev, &dev_attr_mode))
+		return -ENOMEM;
+	if (device_create_file(dev, &dev_attr_bin_stat))
+		return -ENOMEM;
+	if (device_create_file(dev, &dev_attr_watermark))
+		return -ENOMEM;
 
 	return 0;
 }
@@ -595,6 +923,9 @@ static void vtrace_sysfs_remove(struct device *dev)
 	device_remove_file(dev, &dev_attr_module_mask);
 	device_remove_file(dev, &dev_attr_level);
 	device_remove_file(dev, &dev_attr_err_cnt);
+	device_remove_file(dev, &dev_attr_mode);
+	device_remove_file(dev, &dev_attr_bin_stat);
+	device_remove_file(dev, &dev_attr_watermark);
 }
 
 static void vtrace_common_info_register(void)
@@ -608,6 +939,10 @@ static void vtrace_common_info_register(void)
 				PUBLIC_FS_PARAM_NUM, LEVEL0);
 		vtrace_register(i, VTRACE_PUBLIC_FE, public_fe_name,
 				PUBLIC_FS_PARAM_NUM, LEVEL0);
+		vtrace_register(i, VTRACE_PUBLIC_QBUF, public_buf_name,
+				PUBLIC_BUF_PARAM_NUM, LEVEL1);
+		vtrace_register(i, VTRACE_PUBLIC_DQBUF, public_buf_name,
+				PUBLIC_BUF_PARAM_NUM, LEVEL1);
 		vtrace_register(i, VTRACE_PUBLIC_DROP, public_drop_name,
 				PUBLIC_FS_PARAM_NUM, LEVEL0);
 	}
@@ -631,11 +966,48 @@ static int32_t vtrace_mem_alloc(uint32_t size)
 	return 0;
 }
 
+/**
+ * vtrace_bin_alloc() - Alloc the per-CPU binary rings, one head page
+ * followed by the records for each possible cpu.
+ */
+static int32_t vtrace_bin_alloc(void)
+{
+	vtrace_bin_ring_head_s *ring;
+	uint32_t rec_num, cpu;
+	void *ptr;
+
+	rec_num = clamp(vtrace_ring_kb, 1u, VTRACE_BIN_RING_KB_MAX) * 1024u /
+		  sizeof(vtrace_bin_rec_s);
+	rec_num = rounddown_pow_of_two(rec_num);
+	g_ctx.bin_rec_num = rec_num;
+	g_ctx.bin_stride = PAGE_SIZE + PAGE_ALIGN(rec_num * sizeof(vtrace_bin_rec_s));
+
+	ptr = vmalloc_user((size_t)nr_cpu_ids * g_ctx.bin_stride);
+	if (!ptr) {
+		vtrace_err("binary ring alloc failed, size = %d\n",
+			   nr_cpu_ids * g_ctx.bin_stride);
+		return -ENOMEM;
+	}
+	g_ctx.bin_base = ptr;
+
+	for_each_possible_cpu(cpu) {
+		ring = vtrace_bin_ring(cpu);
+		ring->rec_size = sizeof(vtrace_bin_rec_s);
+		ring->rec_num = rec_num;
+		ring->cpu = cpu;
+	}
+
+	return 0;
+}
+
 static void vtrace_mem_free(void)
 {
 	int32_t i, j;
 	vtrace_buf_head_s *buf_head = NULL;
 
+	vfree(g_ctx.bin_base);
+	g_ctx.bin_base = NULL;
+
 	ClearPageReserved(vmalloc_to_page(g_ctx.base));
 	ClearPageReserved(vmalloc_to_page(g_ctx.base+VTRACE_PING_PONG_SIZE));
 	vfree(g_ctx.base);
@@ -703,6 +1075,11 @@ static int32_t __init vtrace_init(void)
 {
 	int32_t ret;
 
+	/* ready before the cdev can be opened */
+	timer_setup(&g_ctx.poll_timer, vtrace_poll_timeout, 0);
+	osal_atomic_set(&g_ctx.poll_armed, 0);
+	g_ctx.poll_expired = 0;
+
 	ret = class_register(&vtrace_class);
 	if (ret < 0) {
 		vtrace_err("class init failed\n");
@@ -727,6 +1104,10 @@ static int32_t __init vtrace_init(void)
 		return ret;
 	}
 
+	/* text mode still works without the binary rings */
+	if (vtrace_bin_alloc() < 0)
+		vtrace_err("binary mode is unavailable\n");
+
 	vtrace_common_info_register();
 
 	init_waitqueue_head(&g_ctx.irq_wait);
@@ -762,6 +1143,7 @@ static void __exit vtrace_exit(void)
 	cdev_del(&vcdev->cdev);
 	class_unregister(&vtrace_class);
 	vio_unregister_callback_ops(DPU_MODULE, COPS_0);	//vtrace tmp using idu module id
+	del_timer_sync(&g_ctx.poll_timer);
 	vtrace_mem_free();
 	memset(&g_ctx, 0, sizeof(vtrace_ctx_s));
 
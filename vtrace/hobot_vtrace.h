@@ -11,6 +11,7 @@
 #include <linux/kfifo.h>
 #include <linux/mm.h>
 #include <linux/poll.h>
+#include <linux/timer.h>
 #include <linux/mod_devicetable.h>
 #include <linux/slab.h>
 #include <linux/printk.h>
@@ -32,6 +33,21 @@
 #define VTRACE_TIMEOUT		msecs_to_jiffies(3000)
 #define VTRACE_COPS_MAGIC	0x1234
 
+// binary trace
+#define VTRACE_MODE_TEXT	0u
+#define VTRACE_MODE_BIN		1u
+#define VTRACE_BIN_PARAM_MAX	10u
+#define VTRACE_BIN_RING_KB_DEF	64u
+#define VTRACE_BIN_RING_KB_MAX	4096u
+/* mmap offset of the binary rings, offset 0 stays the text pingpong buffer */
+#define VTRACE_BIN_MMAP_PGOFF	0x100u
+#define VTRACE_BIN_MMAP_OFFSET	((unsigned long)VTRACE_BIN_MMAP_PGOFF << PAGE_SHIFT)
+
+// poll wakeup default: half of the text buffer, a quarter of a ring, 100ms
+#define VTRACE_WM_BYTES_DEF	(VTRACE_PING_PONG_SIZE / 2)
+#define VTRACE_WM_RECS_DEF	(VTRACE_BIN_RING_KB_DEF * 1024u / 64u / 4u)
+#define VTRACE_LATENCY_MS_DEF	100u
+
 // vtrace pr
 #define vtrace_fmt(fmt)			"[HOBOT_VTRACE] (%s_%d): " fmt
 #define vtrace_pr_warp(p_func_, fmt, ...) do { \
@@ -58,17 +74,21 @@
 	"VNODE_ID_IDU1", \
 }
 
-// public param
+// public param, same ids as the vpf events in vio_debug_api.h
 #define VTRACE_PUBLIC_TEST	0u
 #define VTRACE_PUBLIC_FS	1u
 #define VTRACE_PUBLIC_FE	2u
-#define VTRACE_PUBLIC_DROP	3u
+#define VTRACE_PUBLIC_QBUF	3u
+#define VTRACE_PUBLIC_DQBUF	4u
+#define VTRACE_PUBLIC_DROP	5u
 #define VTRACE_PUBTYPE_MAX	10u
 #define VTRACE_PARAM_MAX	32u
 #define VTRACE_PUBLIC_NAME { \
 	"PUBLIC_TEST", \
 	"PUBLIC_FS", \
 	"PUBLIC_FE", \
+	"PUBLIC_QBUF", \
+	"PUBLIC_DQBUF", \
 	"PUBLIC_DROP", \
 }
 
@@ -102,7 +122,21 @@ typedef struct vtrace_public_fe {
 } vtrace_public_fe_s;
 #define PUBLIC_FE_PARAM_NUM	(sizeof(vtrace_public_fe_s)/sizeof(uint32_t))
 
-// 3. public frame start
+// 3. public qbuf, 4. public dqbuf
+#define PUBLIC_BUF_PARAM_NAME { \
+	"index", \
+	"depth", \
+	"wait_us", \
+}
+
+typedef struct vtrace_public_buf {
+	uint32_t index;		/* buffer index */
+	uint32_t depth;		/* frames left in the queue */
+	uint32_t wait_us;	/* dqbuf blocked time, 0 for qbuf */
+} vtrace_public_buf_s;
+#define PUBLIC_BUF_PARAM_NUM	(sizeof(vtrace_public_buf_s)/sizeof(uint32_t))
+
+// 5. public frame drop
 #define PUBLIC_DROP_PARAM_NAME { \
 	"timestamp", \
 }
@@ -123,6 +157,64 @@ typedef struct vtrace_buf_head {
 	bool is_init[VTRACE_PARAM_MAX];
 } vtrace_buf_head_s;
 
+/*
+ * Binary trace record, decoded by user space with the names from VTRACE_NAME_GET.
+ * seq is the low 32 bits of the record index, it is set to VTRACE_BIN_SEQ_BUSY
+ * while the record is being written.
+ */
+#define VTRACE_BIN_SEQ_BUSY	0xFFFFFFFFu
+typedef struct vtrace_bin_rec {
+	uint64_t ts_ns;
+	uint32_t seq;
+	uint32_t frame_id;
+	uint8_t module_type;
+	uint8_t param_type;
+	uint8_t param_nums;
+	uint8_t flow_id;
+	uint8_t ctx_id;
+	uint8_t chn_id;
+	uint16_t rsv;
+	uint32_t param[VTRACE_BIN_PARAM_MAX];
+} vtrace_bin_rec_s;
+
+/*
+ * Head page of one per-CPU ring, followed by rec_num records.
+ * head: records ever written, tail: records consumed (written by user space),
+ * overwritten: records lost because the ring was full when they were reused.
+ * Records [max(tail, head - rec_num), head) are valid.
+ */
+typedef struct vtrace_bin_ring_head {
+	uint64_t head;
+	uint64_t tail;
+	uint64_t overwritten;
+	uint32_t rec_size;
+	uint32_t rec_num;
+	uint32_t cpu;
+	uint32_t rsv;
+} vtrace_bin_ring_head_s;
+
+typedef struct vtrace_bin_info {
+	uint32_t cpu_num;		/**< number of rings */
+	uint32_t ring_stride;		/**< bytes between two rings, head page included */
+	uint32_t rec_size;
+	uint32_t rec_num;
+	uint64_t mmap_offset;		/**< mmap offset of the first ring */
+} vtrace_bin_info_s;
+
+typedef struct vtrace_name_info {
+	uint32_t module_type;		/**< input */
+	uint32_t param_type;		/**< input */
+	uint32_t param_nums;
+	uint32_t level;
+	char name[VTRACE_BIN_PARAM_MAX][VTRACE_NAME_LEN_MAX];
+} vtrace_name_info_s;
+
+typedef struct vtrace_watermark {
+	uint32_t bytes;			/**< text mode: wake up when so many bytes are pending */
+	uint32_t records;		/**< binary mode: wake up when a ring has so many records pending */
+	uint32_t latency_ms;		/**< wake up at most so late after the first pending event, 0 off */
+} vtrace_watermark_s;
+
 typedef enum vtrace_debug_level {
 	LEVEL0 = 0,
 	LEVEL1,
@@ -152,6 +244,12 @@ typedef struct vtrace_ctx {
 	uint32_t pop_swap;		/**< turn to 1 if in pop, to swap buffer */
 	vtrace_buf_head_s buf_head[VNODE_ID_MAX];
 	wait_queue_head_t irq_wait;
+	void *bin_base;			/**< base of the per-CPU binary rings */
+	uint32_t bin_stride;		/**< bytes of one ring with its head page */
+	uint32_t bin_rec_num;		/**< records of one ring, power of 2 */
+	struct timer_list poll_timer;	/**< bounds the delay of pending events below watermark */
+	osal_atomic_t poll_armed;	/**< poll_timer is armed for the pending events */
+	uint32_t poll_expired;		/**< pending events are older than latency_ms */
 } vtrace_ctx_s;
 
 typedef struct vtrace_ctl_ctx {
@@ -160,6 +258,8 @@ typedef struct vtrace_ctl_ctx {
 	uint32_t ctxid_mask;
 	uint32_t module_mask;
 	uint32_t level;
+	uint32_t mode;			/**< VTRACE_MODE_TEXT or VTRACE_MODE_BIN */
+	vtrace_watermark_s wm;
 } vtrace_ctl_ctx_s;
 
 int32_t vtrace_register(uint32_t module_type, uint32_t param_type, char **param_name,
@@ -178,5 +278,9 @@ int32_t vtrace_send(uint32_t module_type, uint32_t param_type, uint32_t *param,
 #define VTRACE_TIMEOUT_POP	_IOW(VTRACE_CDEV_MAGIC, 0x21, unsigned int)
 #define VTRACE_TIMEOUT_POP_END	_IOW(VTRACE_CDEV_MAGIC, 0x22, unsigned int)
 #define VTRACE_TEST_SEND	_IOW(VTRACE_CDEV_MAGIC, 0x23, unsigned int)
+#define VTRACE_MODE_SET		_IOW(VTRACE_CDEV_MAGIC, 0x24, unsigned int)
+#define VTRACE_BIN_INFO_GET	_IOR(VTRACE_CDEV_MAGIC, 0x25, vtrace_bin_info_s)
+#define VTRACE_NAME_GET		_IOWR(VTRACE_CDEV_MAGIC, 0x26, vtrace_name_info_s)
+#define VTRACE_WATERMARK_SET	_IOW(VTRACE_CDEV_MAGIC, 0x27, vtrace_watermark_s)
 
 #endif